@@ -21,6 +21,7 @@
 b2BroadPhase::b2BroadPhase()
 {
 	m_proxyCount = 0;
+	m_useGrid = false;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
@@ -37,9 +38,22 @@ b2BroadPhase::~b2BroadPhase()
 	b2Free(m_pairBuffer);
 }
 
+void b2BroadPhase::UseUniformGrid(const b2AABB& bounds, float32 cellSize)
+{
+	b2Assert(m_proxyCount == 0);
+	m_grid.Reset(bounds, cellSize);
+	m_useGrid = true;
+}
+
+void b2BroadPhase::UseDynamicTree()
+{
+	b2Assert(m_proxyCount == 0);
+	m_useGrid = false;
+}
+
 int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 {
-	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	int32 proxyId = m_useGrid ? m_grid.CreateProxy(aabb, userData) : m_tree.CreateProxy(aabb, userData);
 	++m_proxyCount;
 	BufferMove(proxyId);
 	return proxyId;
@@ -49,12 +63,19 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
-	m_tree.DestroyProxy(proxyId);
+	if (m_useGrid)
+	{
+		m_grid.DestroyProxy(proxyId);
+	}
+	else
+	{
+		m_tree.DestroyProxy(proxyId);
+	}
 }
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
-	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
+	bool buffer = m_useGrid ? m_grid.MoveProxy(proxyId, aabb, displacement) : m_tree.MoveProxy(proxyId, aabb, displacement);
 	if (buffer)
 	{
 		BufferMove(proxyId);
@@ -92,7 +113,7 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 	}
 }
 
-// This is called from b2DynamicTree::Query when we are gathering pairs.
+// This is called from b2DynamicTree::Query or b2UniformGrid::Query when we are gathering pairs.
 bool b2BroadPhase::QueryCallback(int32 proxyId)
 {
 	// A proxy cannot form a pair with itself.
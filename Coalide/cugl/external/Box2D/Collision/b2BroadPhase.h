@@ -22,6 +22,7 @@
 #include <Box2D/Common/b2Settings.h>
 #include <Box2D/Collision/b2Collision.h>
 #include <Box2D/Collision/b2DynamicTree.h>
+#include <Box2D/Collision/b2UniformGrid.h>
 #include <algorithm>
 
 struct b2Pair
@@ -33,6 +34,8 @@ struct b2Pair
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
+/// The proxies are kept in a dynamic tree by default. Bounded worlds of similarly
+/// sized bodies may use a uniform grid instead.
 class b2BroadPhase
 {
 public:
@@ -71,6 +74,18 @@ public:
 	/// Get the number of proxies.
 	int32 GetProxyCount() const;
 
+	/// Keep the proxies in a uniform grid covering the given bounds. This asserts
+	/// if there are any proxies.
+	/// @param bounds the region covered by the grid. Proxies outside of it still work.
+	/// @param cellSize the width and height of a grid cell, ideally about a body in size.
+	void UseUniformGrid(const b2AABB& bounds, float32 cellSize);
+
+	/// Keep the proxies in a dynamic tree (the default). This asserts if there are any proxies.
+	void UseDynamicTree();
+
+	/// Are the proxies kept in a uniform grid?
+	bool IsUniformGrid() const;
+
 	/// Update the pairs. This results in pair callbacks. This can only add pairs.
 	template <typename T>
 	void UpdatePairs(T* callback);
@@ -90,15 +105,18 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
-	/// Get the height of the embedded tree.
+	/// Get the height of the embedded tree. This is 0 for a uniform grid.
 	int32 GetTreeHeight() const;
 
-	/// Get the balance of the embedded tree.
+	/// Get the balance of the embedded tree. This is 0 for a uniform grid.
 	int32 GetTreeBalance() const;
 
-	/// Get the quality metric of the embedded tree.
+	/// Get the quality metric of the embedded tree. This is 0 for a uniform grid.
 	float32 GetTreeQuality() const;
 
+	/// Draw the structure holding the proxies: the internal tree nodes or the occupied grid cells.
+	void Draw(b2Draw* draw, const b2Color& color) const;
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -107,6 +125,7 @@ public:
 private:
 
 	friend class b2DynamicTree;
+	friend class b2UniformGrid;
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
@@ -114,6 +133,8 @@ private:
 	bool QueryCallback(int32 proxyId);
 
 	b2DynamicTree m_tree;
+	b2UniformGrid m_grid;
+	bool m_useGrid;
 
 	int32 m_proxyCount;
 
@@ -146,19 +167,19 @@ inline bool b2PairLessThan(const b2Pair& pair1, const b2Pair& pair2)
 
 inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
-	return m_tree.GetUserData(proxyId);
+	return m_useGrid ? m_grid.GetUserData(proxyId) : m_tree.GetUserData(proxyId);
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
-	return m_tree.GetFatAABB(proxyId);
+	return m_useGrid ? m_grid.GetFatAABB(proxyId) : m_tree.GetFatAABB(proxyId);
 }
 
 inline int32 b2BroadPhase::GetProxyCount() const
@@ -166,19 +187,36 @@ inline int32 b2BroadPhase::GetProxyCount() const
 	return m_proxyCount;
 }
 
+inline bool b2BroadPhase::IsUniformGrid() const
+{
+	return m_useGrid;
+}
+
 inline int32 b2BroadPhase::GetTreeHeight() const
 {
-	return m_tree.GetHeight();
+	return m_useGrid ? 0 : m_tree.GetHeight();
 }
 
 inline int32 b2BroadPhase::GetTreeBalance() const
 {
-	return m_tree.GetMaxBalance();
+	return m_useGrid ? 0 : m_tree.GetMaxBalance();
 }
 
 inline float32 b2BroadPhase::GetTreeQuality() const
 {
-	return m_tree.GetAreaRatio();
+	return m_useGrid ? 0.0f : m_tree.GetAreaRatio();
+}
+
+inline void b2BroadPhase::Draw(b2Draw* draw, const b2Color& color) const
+{
+	if (m_useGrid)
+	{
+		m_grid.Draw(draw, color);
+	}
+	else
+	{
+		m_tree.Draw(draw, color);
+	}
 }
 
 template <typename T>
@@ -198,10 +236,10 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
 		// We have to query the tree with the fat AABB so that
 		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		const b2AABB& fatAABB = GetFatAABB(m_queryProxyId);
 
 		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
+		Query(this, fatAABB);
 	}
 
 	// Reset move buffer
@@ -215,8 +253,8 @@ void b2BroadPhase::UpdatePairs(T* callback)
 	while (i < m_pairCount)
 	{
 		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		void* userDataA = GetUserData(primaryPair->proxyIdA);
+		void* userDataB = GetUserData(primaryPair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
 		++i;
@@ -240,18 +278,39 @@ void b2BroadPhase::UpdatePairs(T* callback)
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	if (m_useGrid)
+	{
+		m_grid.Query(callback, aabb);
+	}
+	else
+	{
+		m_tree.Query(callback, aabb);
+	}
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	if (m_useGrid)
+	{
+		m_grid.RayCast(callback, input);
+	}
+	else
+	{
+		m_tree.RayCast(callback, input);
+	}
 }
 
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
-	m_tree.ShiftOrigin(newOrigin);
+	if (m_useGrid)
+	{
+		m_grid.ShiftOrigin(newOrigin);
+	}
+	else
+	{
+		m_tree.ShiftOrigin(newOrigin);
+	}
 }
 
 #endif
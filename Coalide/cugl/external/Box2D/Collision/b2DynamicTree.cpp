@@ -778,3 +778,23 @@ void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
 }
+
+void b2DynamicTree::Draw(b2Draw* draw, const b2Color& color) const
+{
+	// Free nodes have a height of -1 and leaves a height of 0.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		const b2TreeNode* node = m_nodes + i;
+		if (node->height <= 0)
+		{
+			continue;
+		}
+
+		b2Vec2 vs[4];
+		vs[0].Set(node->aabb.lowerBound.x, node->aabb.lowerBound.y);
+		vs[1].Set(node->aabb.upperBound.x, node->aabb.lowerBound.y);
+		vs[2].Set(node->aabb.upperBound.x, node->aabb.upperBound.y);
+		vs[3].Set(node->aabb.lowerBound.x, node->aabb.upperBound.y);
+		draw->DrawPolygon(vs, 4, color);
+	}
+}
@@ -0,0 +1,356 @@
+/*
+* Copyright (c) 2026 Team FireCube
+*
+* This file is an addition to Box2D for Coalide.  It is not part of the
+* upstream Box2D distribution.
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Collision/b2UniformGrid.h>
+#include <string.h>
+
+b2UniformGrid::b2UniformGrid()
+{
+	m_origin.SetZero();
+	m_cellSize = 1.0f;
+	m_invCellSize = 1.0f;
+	m_columns = 0;
+	m_rows = 0;
+	m_cells = NULL;
+
+	m_entryCapacity = 0;
+	m_entries = NULL;
+	m_freeEntry = b2_nullCell;
+
+	m_proxyCount = 0;
+	m_proxyCapacity = 0;
+	m_proxies = NULL;
+	m_freeProxy = b2_nullCell;
+
+	m_bigList = b2_nullCell;
+	m_stamp = 0;
+}
+
+b2UniformGrid::~b2UniformGrid()
+{
+	b2Free(m_cells);
+	b2Free(m_entries);
+	b2Free(m_proxies);
+}
+
+void b2UniformGrid::Reset(const b2AABB& bounds, float32 cellSize)
+{
+	b2Assert(m_proxyCount == 0);
+	b2Assert(bounds.IsValid());
+	b2Assert(cellSize > 0.0f);
+
+	b2Vec2 extent = bounds.upperBound - bounds.lowerBound;
+	m_origin = bounds.lowerBound;
+	m_cellSize = cellSize;
+	m_invCellSize = 1.0f / cellSize;
+	m_columns = b2Max(1, int32(ceilf(extent.x * m_invCellSize)));
+	m_rows = b2Max(1, int32(ceilf(extent.y * m_invCellSize)));
+
+	b2Free(m_cells);
+	m_cells = (int32*)b2Alloc(m_columns * m_rows * sizeof(int32));
+	for (int32 i = 0; i < m_columns * m_rows; ++i)
+	{
+		m_cells[i] = b2_nullCell;
+	}
+
+	// Every entry was in a cell, so the whole pool is free.
+	m_freeEntry = b2_nullCell;
+	for (int32 i = m_entryCapacity - 1; i >= 0; --i)
+	{
+		m_entries[i].next = m_freeEntry;
+		m_freeEntry = i;
+	}
+	m_bigList = b2_nullCell;
+}
+
+int32 b2UniformGrid::AllocateProxy()
+{
+	// Expand the proxy pool as needed.
+	if (m_freeProxy == b2_nullCell)
+	{
+		b2Assert(m_proxyCount == m_proxyCapacity);
+
+		// The free list is empty. Rebuild a bigger pool.
+		int32 oldCapacity = m_proxyCapacity;
+		b2GridProxy* oldProxies = m_proxies;
+		m_proxyCapacity = b2Max(16, 2 * oldCapacity);
+		m_proxies = (b2GridProxy*)b2Alloc(m_proxyCapacity * sizeof(b2GridProxy));
+		if (oldProxies != NULL)
+		{
+			memcpy(m_proxies, oldProxies, oldCapacity * sizeof(b2GridProxy));
+			b2Free(oldProxies);
+		}
+
+		// Build a linked list for the free list.
+		for (int32 i = oldCapacity; i < m_proxyCapacity - 1; ++i)
+		{
+			m_proxies[i].next = i + 1;
+			m_proxies[i].userData = NULL;
+			m_proxies[i].stamp = 0;
+		}
+		m_proxies[m_proxyCapacity-1].next = b2_nullCell;
+		m_proxies[m_proxyCapacity-1].userData = NULL;
+		m_proxies[m_proxyCapacity-1].stamp = 0;
+		m_freeProxy = oldCapacity;
+	}
+
+	// Peel a proxy off the free list.
+	int32 proxyId = m_freeProxy;
+	m_freeProxy = m_proxies[proxyId].next;
+	m_proxies[proxyId].next = b2_nullCell;
+	m_proxies[proxyId].userData = NULL;
+	++m_proxyCount;
+	return proxyId;
+}
+
+void b2UniformGrid::FreeProxy(int32 proxyId)
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	b2Assert(0 < m_proxyCount);
+	m_proxies[proxyId].next = m_freeProxy;
+	m_proxies[proxyId].userData = NULL;
+	m_freeProxy = proxyId;
+	--m_proxyCount;
+}
+
+void b2UniformGrid::InsertProxy(int32 proxyId)
+{
+	b2GridProxy* proxy = m_proxies + proxyId;
+	ComputeCells(proxy->aabb, &proxy->lowerX, &proxy->lowerY, &proxy->upperX, &proxy->upperY);
+
+	int32 count = (proxy->upperX - proxy->lowerX + 1) * (proxy->upperY - proxy->lowerY + 1);
+	if (count > b2_gridMaxProxyCells)
+	{
+		proxy->lowerX = b2_nullCell;
+		proxy->next = m_bigList;
+		m_bigList = proxyId;
+		return;
+	}
+
+	for (int32 y = proxy->lowerY; y <= proxy->upperY; ++y)
+	{
+		for (int32 x = proxy->lowerX; x <= proxy->upperX; ++x)
+		{
+			if (m_freeEntry == b2_nullCell)
+			{
+				// Grow the entry pool.
+				int32 oldCapacity = m_entryCapacity;
+				b2GridEntry* oldEntries = m_entries;
+				m_entryCapacity = b2Max(64, 2 * oldCapacity);
+				m_entries = (b2GridEntry*)b2Alloc(m_entryCapacity * sizeof(b2GridEntry));
+				if (oldEntries != NULL)
+				{
+					memcpy(m_entries, oldEntries, oldCapacity * sizeof(b2GridEntry));
+					b2Free(oldEntries);
+				}
+
+				for (int32 i = oldCapacity; i < m_entryCapacity - 1; ++i)
+				{
+					m_entries[i].next = i + 1;
+				}
+				m_entries[m_entryCapacity-1].next = b2_nullCell;
+				m_freeEntry = oldCapacity;
+			}
+
+			int32 entry = m_freeEntry;
+			int32* cell = m_cells + y * m_columns + x;
+			m_freeEntry = m_entries[entry].next;
+			m_entries[entry].proxyId = proxyId;
+			m_entries[entry].next = *cell;
+			*cell = entry;
+		}
+	}
+}
+
+void b2UniformGrid::RemoveProxy(int32 proxyId)
+{
+	b2GridProxy* proxy = m_proxies + proxyId;
+	if (proxy->lowerX == b2_nullCell)
+	{
+		int32* link = &m_bigList;
+		while (*link != proxyId)
+		{
+			b2Assert(*link != b2_nullCell);
+			link = &m_proxies[*link].next;
+		}
+		*link = proxy->next;
+		proxy->next = b2_nullCell;
+		return;
+	}
+
+	for (int32 y = proxy->lowerY; y <= proxy->upperY; ++y)
+	{
+		for (int32 x = proxy->lowerX; x <= proxy->upperX; ++x)
+		{
+			// Cells are about the size of a body, so these lists are short.
+			int32* link = m_cells + y * m_columns + x;
+			while (m_entries[*link].proxyId != proxyId)
+			{
+				link = &m_entries[*link].next;
+				b2Assert(*link != b2_nullCell);
+			}
+
+			int32 entry = *link;
+			*link = m_entries[entry].next;
+			m_entries[entry].next = m_freeEntry;
+			m_freeEntry = entry;
+		}
+	}
+}
+
+int32 b2UniformGrid::CreateProxy(const b2AABB& aabb, void* userData)
+{
+	b2Assert(m_cells != NULL);
+	int32 proxyId = AllocateProxy();
+
+	// Fatten the aabb.
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	m_proxies[proxyId].aabb.lowerBound = aabb.lowerBound - r;
+	m_proxies[proxyId].aabb.upperBound = aabb.upperBound + r;
+	m_proxies[proxyId].userData = userData;
+
+	InsertProxy(proxyId);
+	return proxyId;
+}
+
+void b2UniformGrid::DestroyProxy(int32 proxyId)
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	RemoveProxy(proxyId);
+	FreeProxy(proxyId);
+}
+
+bool b2UniformGrid::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+
+	b2GridProxy* proxy = m_proxies + proxyId;
+	if (proxy->aabb.Contains(aabb))
+	{
+		return false;
+	}
+
+	// Extend AABB.
+	b2AABB b = aabb;
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	b.lowerBound = b.lowerBound - r;
+	b.upperBound = b.upperBound + r;
+
+	// Predict AABB displacement.
+	b2Vec2 d = b2_aabbMultiplier * displacement;
+
+	if (d.x < 0.0f)
+	{
+		b.lowerBound.x += d.x;
+	}
+	else
+	{
+		b.upperBound.x += d.x;
+	}
+
+	if (d.y < 0.0f)
+	{
+		b.lowerBound.y += d.y;
+	}
+	else
+	{
+		b.upperBound.y += d.y;
+	}
+
+	// Only relink if the proxy changed cells.
+	int32 lowerX, lowerY, upperX, upperY;
+	ComputeCells(b, &lowerX, &lowerY, &upperX, &upperY);
+	proxy->aabb = b;
+	if (proxy->lowerX != lowerX || proxy->lowerY != lowerY ||
+		proxy->upperX != upperX || proxy->upperY != upperY)
+	{
+		RemoveProxy(proxyId);
+		InsertProxy(proxyId);
+	}
+	return true;
+}
+
+void b2UniformGrid::Validate() const
+{
+	int32 freeCount = 0;
+	for (int32 i = m_freeProxy; i != b2_nullCell; i = m_proxies[i].next)
+	{
+		b2Assert(0 <= i && i < m_proxyCapacity);
+		++freeCount;
+	}
+	b2Assert(m_proxyCount + freeCount == m_proxyCapacity);
+
+	int32 entryCount = 0;
+	for (int32 i = 0; i < m_columns * m_rows; ++i)
+	{
+		int32 x = i % m_columns;
+		int32 y = i / m_columns;
+		for (int32 entry = m_cells[i]; entry != b2_nullCell; entry = m_entries[entry].next)
+		{
+			const b2GridProxy* proxy = m_proxies + m_entries[entry].proxyId;
+			b2Assert(proxy->lowerX <= x && x <= proxy->upperX);
+			b2Assert(proxy->lowerY <= y && y <= proxy->upperY);
+			B2_NOT_USED(proxy);
+			B2_NOT_USED(x);
+			B2_NOT_USED(y);
+			++entryCount;
+		}
+	}
+
+	for (int32 i = m_freeEntry; i != b2_nullCell; i = m_entries[i].next)
+	{
+		++entryCount;
+	}
+	b2Assert(entryCount == m_entryCapacity);
+	B2_NOT_USED(freeCount);
+	B2_NOT_USED(entryCount);
+}
+
+void b2UniformGrid::ShiftOrigin(const b2Vec2& newOrigin)
+{
+	// The cells move with the proxies, so no relinking is needed.
+	m_origin -= newOrigin;
+	for (int32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		m_proxies[i].aabb.lowerBound -= newOrigin;
+		m_proxies[i].aabb.upperBound -= newOrigin;
+	}
+}
+
+void b2UniformGrid::Draw(b2Draw* draw, const b2Color& color) const
+{
+	for (int32 i = 0; i < m_columns * m_rows; ++i)
+	{
+		if (m_cells[i] == b2_nullCell)
+		{
+			continue;
+		}
+
+		b2Vec2 lower = m_origin + m_cellSize * b2Vec2(float32(i % m_columns), float32(i / m_columns));
+		b2Vec2 upper = lower + b2Vec2(m_cellSize, m_cellSize);
+		b2Vec2 vs[4];
+		vs[0].Set(lower.x, lower.y);
+		vs[1].Set(upper.x, lower.y);
+		vs[2].Set(upper.x, upper.y);
+		vs[3].Set(lower.x, upper.y);
+		draw->DrawPolygon(vs, 4, color);
+	}
+}
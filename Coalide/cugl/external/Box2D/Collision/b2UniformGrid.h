@@ -0,0 +1,377 @@
+/*
+* Copyright (c) 2026 Team FireCube
+*
+* This file is an addition to Box2D for Coalide.  It is not part of the
+* upstream Box2D distribution.
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_UNIFORM_GRID_H
+#define B2_UNIFORM_GRID_H
+
+#include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Common/b2Draw.h>
+
+#define b2_nullCell (-1)
+
+/// A proxy in the uniform grid. The client does not interact with this directly.
+struct b2GridProxy
+{
+	/// Enlarged AABB
+	b2AABB aabb;
+
+	void* userData;
+
+	/// The cell range covered by the enlarged AABB. lowerX is b2_nullCell
+	/// for oversized proxies, which are kept in a separate list.
+	int32 lowerX, lowerY;
+	int32 upperX, upperY;
+
+	/// Next oversized proxy, or next free proxy.
+	int32 next;
+
+	/// The last query that reported this proxy.
+	mutable uint32 stamp;
+};
+
+/// A cell entry in the uniform grid. The client does not interact with this directly.
+struct b2GridEntry
+{
+	int32 proxyId;
+	int32 next;
+};
+
+/// A uniform grid broad-phase for bounded worlds of similarly sized bodies.
+/// The grid covers a fixed AABB with square cells, and each proxy is linked into
+/// every cell its fattened AABB overlaps. Proxies outside of the bounds are clamped
+/// to the border cells, so the bounds are a performance hint and not a limit.
+/// Proxies that would cover more than b2_gridMaxProxyCells cells are kept in a
+/// separate list that every query visits.
+///
+/// This has the same proxy interface as b2DynamicTree. Moving a proxy only
+/// touches the cells it enters and leaves, and there is no rebalancing.
+class b2UniformGrid
+{
+public:
+	/// Constructing the grid does not allocate any cells. Call Reset first.
+	b2UniformGrid();
+
+	/// Destroy the grid, freeing all cells and proxies.
+	~b2UniformGrid();
+
+	/// Set the grid bounds and cell size. This asserts if there are any proxies.
+	void Reset(const b2AABB& bounds, float32 cellSize);
+
+	/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
+	int32 CreateProxy(const b2AABB& aabb, void* userData);
+
+	/// Destroy a proxy. This asserts if the id is invalid.
+	void DestroyProxy(int32 proxyId);
+
+	/// Move a proxy with a swepted AABB. If the proxy has moved outside of its fattened AABB,
+	/// then the proxy is relinked into the cells of its new fattened AABB. Otherwise
+	/// the function returns immediately.
+	/// @return true if the proxy was relinked.
+	bool MoveProxy(int32 proxyId, const b2AABB& aabb1, const b2Vec2& displacement);
+
+	/// Get proxy user data.
+	/// @return the proxy user data or 0 if the id is invalid.
+	void* GetUserData(int32 proxyId) const;
+
+	/// Get the fat AABB for a proxy.
+	const b2AABB& GetFatAABB(int32 proxyId) const;
+
+	/// Query an AABB for overlapping proxies. The callback class
+	/// is called once for each proxy that overlaps the supplied AABB.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// Ray-cast against the proxies in the grid. This relies on the callback
+	/// to perform a exact ray-cast in the case were the proxy contains a shape.
+	/// The callback also performs the any collision filtering.
+	/// @param input the ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
+	/// @param callback a callback class that is called for each proxy that is hit by the ray.
+	template <typename T>
+	void RayCast(T* callback, const b2RayCastInput& input) const;
+
+	/// Validate this grid. For testing.
+	void Validate() const;
+
+	/// Get the number of cells in the grid.
+	int32 GetCellCount() const;
+
+	/// Get the size of a grid cell.
+	float32 GetCellSize() const;
+
+	/// Draw the outline of every occupied cell.
+	void Draw(b2Draw* draw, const b2Color& color) const;
+
+	/// Shift the world origin. Useful for large worlds.
+	/// The shift formula is: position -= newOrigin
+	/// @param newOrigin the new origin with respect to the old origin
+	void ShiftOrigin(const b2Vec2& newOrigin);
+
+private:
+
+	int32 AllocateProxy();
+	void FreeProxy(int32 proxyId);
+
+	void InsertProxy(int32 proxyId);
+	void RemoveProxy(int32 proxyId);
+
+	/// Compute the clamped cell range of an AABB.
+	void ComputeCells(const b2AABB& aabb, int32* lowerX, int32* lowerY, int32* upperX, int32* upperY) const;
+
+	/// Start a new query, returning a stamp that no proxy has.
+	uint32 NextStamp() const;
+
+	b2Vec2 m_origin;
+	float32 m_cellSize;
+	float32 m_invCellSize;
+	int32 m_columns;
+	int32 m_rows;
+
+	/// The first entry of each cell, row-major.
+	int32* m_cells;
+
+	b2GridEntry* m_entries;
+	int32 m_entryCapacity;
+	int32 m_freeEntry;
+
+	b2GridProxy* m_proxies;
+	int32 m_proxyCount;
+	int32 m_proxyCapacity;
+	int32 m_freeProxy;
+
+	/// The list of oversized proxies.
+	int32 m_bigList;
+
+	mutable uint32 m_stamp;
+};
+
+inline void* b2UniformGrid::GetUserData(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	return m_proxies[proxyId].userData;
+}
+
+inline const b2AABB& b2UniformGrid::GetFatAABB(int32 proxyId) const
+{
+	b2Assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	return m_proxies[proxyId].aabb;
+}
+
+inline int32 b2UniformGrid::GetCellCount() const
+{
+	return m_columns * m_rows;
+}
+
+inline float32 b2UniformGrid::GetCellSize() const
+{
+	return m_cellSize;
+}
+
+inline void b2UniformGrid::ComputeCells(const b2AABB& aabb, int32* lowerX, int32* lowerY, int32* upperX, int32* upperY) const
+{
+	// Clamp in floating point so that huge or degenerate AABBs cannot overflow.
+	float32 maxX = float32(m_columns - 1);
+	float32 maxY = float32(m_rows - 1);
+	*lowerX = int32(b2Clamp(floorf((aabb.lowerBound.x - m_origin.x) * m_invCellSize), 0.0f, maxX));
+	*lowerY = int32(b2Clamp(floorf((aabb.lowerBound.y - m_origin.y) * m_invCellSize), 0.0f, maxY));
+	*upperX = int32(b2Clamp(floorf((aabb.upperBound.x - m_origin.x) * m_invCellSize), 0.0f, maxX));
+	*upperY = int32(b2Clamp(floorf((aabb.upperBound.y - m_origin.y) * m_invCellSize), 0.0f, maxY));
+}
+
+inline uint32 b2UniformGrid::NextStamp() const
+{
+	++m_stamp;
+	if (m_stamp == 0)
+	{
+		// The stamp wrapped, so old stamps could collide with new ones.
+		for (int32 i = 0; i < m_proxyCapacity; ++i)
+		{
+			m_proxies[i].stamp = 0;
+		}
+		m_stamp = 1;
+	}
+	return m_stamp;
+}
+
+template <typename T>
+inline void b2UniformGrid::Query(T* callback, const b2AABB& aabb) const
+{
+	uint32 stamp = NextStamp();
+
+	for (int32 proxyId = m_bigList; proxyId != b2_nullCell; proxyId = m_proxies[proxyId].next)
+	{
+		if (b2TestOverlap(m_proxies[proxyId].aabb, aabb))
+		{
+			m_proxies[proxyId].stamp = stamp;
+			if (callback->QueryCallback(proxyId) == false)
+			{
+				return;
+			}
+		}
+	}
+
+	int32 lowerX, lowerY, upperX, upperY;
+	ComputeCells(aabb, &lowerX, &lowerY, &upperX, &upperY);
+
+	for (int32 y = lowerY; y <= upperY; ++y)
+	{
+		const int32* row = m_cells + y * m_columns;
+		for (int32 x = lowerX; x <= upperX; ++x)
+		{
+			for (int32 entry = row[x]; entry != b2_nullCell; entry = m_entries[entry].next)
+			{
+				int32 proxyId = m_entries[entry].proxyId;
+				const b2GridProxy* proxy = m_proxies + proxyId;
+				if (proxy->stamp == stamp)
+				{
+					continue;
+				}
+				proxy->stamp = stamp;
+
+				if (b2TestOverlap(proxy->aabb, aabb))
+				{
+					if (callback->QueryCallback(proxyId) == false)
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+inline void b2UniformGrid::RayCast(T* callback, const b2RayCastInput& input) const
+{
+	b2Vec2 p1 = input.p1;
+	b2Vec2 p2 = input.p2;
+	b2Vec2 r = p2 - p1;
+	b2Assert(r.LengthSquared() > 0.0f);
+	r.Normalize();
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	float32 maxFraction = input.maxFraction;
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * (p2 - p1);
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	uint32 stamp = NextStamp();
+
+	int32 lowerX, lowerY, upperX, upperY;
+	ComputeCells(segmentAABB, &lowerX, &lowerY, &upperX, &upperY);
+
+	// The big list is visited as an extra cell before the grid.
+	b2Vec2 cellExtents(0.5f * m_cellSize, 0.5f * m_cellSize);
+	for (int32 cell = -1; cell < (upperY - lowerY + 1) * (upperX - lowerX + 1); ++cell)
+	{
+		int32 first;
+		bool big = cell < 0;
+		if (big)
+		{
+			first = m_bigList;
+		}
+		else
+		{
+			int32 x = lowerX + cell % (upperX - lowerX + 1);
+			int32 y = lowerY + cell / (upperX - lowerX + 1);
+
+			// Skip cells the segment misses. Border cells are unbounded.
+			b2AABB box;
+			box.lowerBound.Set(m_origin.x + x * m_cellSize, m_origin.y + y * m_cellSize);
+			box.upperBound = box.lowerBound + 2.0f * cellExtents;
+			if (x > 0 && x < m_columns - 1 && y > 0 && y < m_rows - 1)
+			{
+				if (b2TestOverlap(box, segmentAABB) == false)
+				{
+					continue;
+				}
+
+				b2Vec2 c = box.GetCenter();
+				float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, cellExtents);
+				if (separation > 0.0f)
+				{
+					continue;
+				}
+			}
+
+			first = m_cells[y * m_columns + x];
+		}
+
+		for (int32 next = first; next != b2_nullCell; )
+		{
+			int32 proxyId = big ? next : m_entries[next].proxyId;
+			next = big ? m_proxies[next].next : m_entries[next].next;
+
+			const b2GridProxy* proxy = m_proxies + proxyId;
+			if (proxy->stamp == stamp)
+			{
+				continue;
+			}
+			proxy->stamp = stamp;
+
+			if (b2TestOverlap(proxy->aabb, segmentAABB) == false)
+			{
+				continue;
+			}
+
+			// Separating axis for segment (Gino, p80).
+			// |dot(v, p1 - c)| > dot(|v|, h)
+			b2Vec2 c = proxy->aabb.GetCenter();
+			b2Vec2 h = proxy->aabb.GetExtents();
+			float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+			if (separation > 0.0f)
+			{
+				continue;
+			}
+
+			b2RayCastInput subInput;
+			subInput.p1 = input.p1;
+			subInput.p2 = input.p2;
+			subInput.maxFraction = maxFraction;
+
+			float32 value = callback->RayCastCallback(subInput, proxyId);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				// Update segment bounding box.
+				maxFraction = value;
+				b2Vec2 t = p1 + maxFraction * (p2 - p1);
+				segmentAABB.lowerBound = b2Min(p1, t);
+				segmentAABB.upperBound = b2Max(p1, t);
+			}
+		}
+	}
+}
+
+#endif
@@ -23,12 +23,105 @@
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define B2_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define B2_SIMD_NEON 1
+#endif
 
 // Solver debugging is normally disabled because the block solver sometimes has to deal with a poorly conditioned effective mass matrix.
 #define B2_DEBUG_SOLVER 0
 
 bool g_blockSolve = true;
 
+// A batch of contacts stored by lane. Unused lanes are zero.
+struct b2ContactBatchPoint
+{
+	float32 rAx[b2_simdWidth], rAy[b2_simdWidth];
+	float32 rBx[b2_simdWidth], rBy[b2_simdWidth];
+	float32 normalImpulse[b2_simdWidth];
+	float32 tangentImpulse[b2_simdWidth];
+	float32 normalMass[b2_simdWidth];
+	float32 tangentMass[b2_simdWidth];
+	float32 velocityBias[b2_simdWidth];
+};
+
+struct b2ContactBatch
+{
+	b2ContactBatchPoint points[b2_maxManifoldPoints];
+	float32 normalX[b2_simdWidth], normalY[b2_simdWidth];
+	float32 invMassA[b2_simdWidth], invMassB[b2_simdWidth];
+	float32 invIA[b2_simdWidth], invIB[b2_simdWidth];
+	float32 friction[b2_simdWidth];
+	float32 tangentSpeed[b2_simdWidth];
+	float32 K11[b2_simdWidth], K12[b2_simdWidth], K21[b2_simdWidth], K22[b2_simdWidth];
+	float32 M11[b2_simdWidth], M12[b2_simdWidth], M21[b2_simdWidth], M22[b2_simdWidth];
+	int32 indexA[b2_simdWidth], indexB[b2_simdWidth];
+	int32 constraints[b2_simdWidth];
+	int32 count;
+	bool block;
+};
+
+// The lane operations of the batch solver. Without SSE2 or NEON, the
+// lanes are solved one after another by the same code.
+#if defined(B2_SIMD_SSE2)
+typedef __m128 b2FloatW;
+typedef __m128 b2MaskW;
+
+inline b2FloatW b2LoadW(const float32* a) { return _mm_loadu_ps(a); }
+inline void b2StoreW(float32* a, b2FloatW b) { _mm_storeu_ps(a, b); }
+inline b2FloatW b2SplatW(float32 a) { return _mm_set1_ps(a); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm_cmpge_ps(a, b); }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { return _mm_and_ps(a, b); }
+inline b2FloatW b2SelectW(b2MaskW m, b2FloatW a, b2FloatW b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+#elif defined(B2_SIMD_NEON)
+typedef float32x4_t b2FloatW;
+typedef uint32x4_t b2MaskW;
+
+inline b2FloatW b2LoadW(const float32* a) { return vld1q_f32(a); }
+inline void b2StoreW(float32* a, b2FloatW b) { vst1q_f32(a, b); }
+inline b2FloatW b2SplatW(float32 a) { return vdupq_n_f32(a); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return vaddq_f32(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return vsubq_f32(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return vmulq_f32(a, b); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return vminq_f32(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return vmaxq_f32(a, b); }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return vcgeq_f32(a, b); }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { return vandq_u32(a, b); }
+inline b2FloatW b2SelectW(b2MaskW m, b2FloatW a, b2FloatW b) { return vbslq_f32(m, a, b); }
+#else
+struct b2FloatW { float32 v[b2_simdWidth]; };
+struct b2MaskW { bool v[b2_simdWidth]; };
+
+inline b2FloatW b2LoadW(const float32* a) { b2FloatW r; for (int32 i = 0; i < b2_simdWidth; ++i) r.v[i] = a[i]; return r; }
+inline void b2StoreW(float32* a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a[i] = b.v[i]; }
+inline b2FloatW b2SplatW(float32 a) { b2FloatW r; for (int32 i = 0; i < b2_simdWidth; ++i) r.v[i] = a; return r; }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] += b.v[i]; return a; }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] -= b.v[i]; return a; }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] *= b.v[i]; return a; }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] = b2Min(a.v[i], b.v[i]); return a; }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] = b2Max(a.v[i], b.v[i]); return a; }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { b2MaskW r; for (int32 i = 0; i < b2_simdWidth; ++i) r.v[i] = a.v[i] >= b.v[i]; return r; }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] = a.v[i] && b.v[i]; return a; }
+inline b2FloatW b2SelectW(b2MaskW m, b2FloatW a, b2FloatW b) { for (int32 i = 0; i < b2_simdWidth; ++i) a.v[i] = m.v[i] ? a.v[i] : b.v[i]; return a; }
+#endif
+
+// Can this body be moved by a contact? Static and kinematic bodies may
+// appear in many lanes of a batch, because their velocity never changes.
+inline bool b2IsMovable(float32 invMass, float32 invI)
+{
+	return invMass > 0.0f || invI > 0.0f;
+}
+
 struct b2ContactPositionConstraint
 {
 	b2Vec2 localPoints[b2_maxManifoldPoints];
@@ -54,6 +147,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_slotCount = def->slotCount;
+	m_batches = NULL;
+	m_batchOrder = NULL;
+	m_batchCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -133,6 +230,14 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_batches)
+	{
+		m_allocator->Free(m_batches);
+	}
+	if (m_batchOrder)
+	{
+		m_allocator->Free(m_batchOrder);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -247,6 +352,11 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	if (m_step.batchedContacts && m_count > 1)
+	{
+		InitializeBatches();
+	}
 }
 
 void b2ContactSolver::WarmStart()
@@ -291,6 +401,12 @@ void b2ContactSolver::WarmStart()
 
 void b2ContactSolver::SolveVelocityConstraints()
 {
+	if (m_batches)
+	{
+		SolveBatches();
+		return;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -601,8 +717,373 @@ void b2ContactSolver::SolveVelocityConstraints()
 	}
 }
 
+// Color the contacts into batches. A contact joins the current batch unless
+// it shares a movable body with a contact already in it. Skipped contacts
+// are tried again on the next pass, so the original order is kept as far
+// as possible. Block solved contacts are batched separately.
+void b2ContactSolver::InitializeBatches()
+{
+	// The batch order is followed by the lane count of each batch.
+	m_batchOrder = (int32*)m_allocator->Allocate(2 * m_count * sizeof(int32));
+	int32* counts = m_batchOrder + m_count;
+	int32* pending = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	int32* stamps = (int32*)m_allocator->Allocate(m_slotCount * sizeof(int32));
+	for (int32 i = 0; i < m_slotCount; ++i)
+	{
+		stamps[i] = 0;
+	}
+
+	int32 ordered = 0;
+	int32 batchCount = 0;
+	int32 stamp = 0;
+	for (int32 pass = 0; pass < 2; ++pass)
+	{
+		// The first pass collects the normal contacts, the second the block contacts.
+		bool block = (pass == 1);
+		int32 pendingCount = 0;
+		for (int32 i = 0; i < m_count; ++i)
+		{
+			const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+			if ((vc->pointCount == 2 && g_blockSolve) == block)
+			{
+				pending[pendingCount++] = i;
+			}
+		}
+
+		while (pendingCount > 0)
+		{
+			int32 laneCount = 0;
+			int32 skipped = 0;
+			++stamp;
+			for (int32 k = 0; k < pendingCount; ++k)
+			{
+				int32 i = pending[k];
+				const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+				bool movableA = b2IsMovable(vc->invMassA, vc->invIA);
+				bool movableB = b2IsMovable(vc->invMassB, vc->invIB);
+				if ((movableA && stamps[vc->indexA] == stamp) || (movableB && stamps[vc->indexB] == stamp))
+				{
+					pending[skipped++] = i;
+					continue;
+				}
+
+				if (movableA)
+				{
+					stamps[vc->indexA] = stamp;
+				}
+				if (movableB)
+				{
+					stamps[vc->indexB] = stamp;
+				}
+				m_batchOrder[ordered++] = i;
+				if (++laneCount == b2_simdWidth)
+				{
+					counts[batchCount++] = laneCount;
+					laneCount = 0;
+					++stamp;
+				}
+			}
+
+			if (laneCount > 0)
+			{
+				counts[batchCount++] = laneCount;
+			}
+			pendingCount = skipped;
+		}
+	}
+	b2Assert(ordered == m_count);
+
+	m_allocator->Free(stamps);
+	m_allocator->Free(pending);
+
+	// Pack the constraints by lane.
+	m_batchCount = batchCount;
+	m_batches = (b2ContactBatch*)m_allocator->Allocate(batchCount * sizeof(b2ContactBatch));
+	memset(m_batches, 0, batchCount * sizeof(b2ContactBatch));
+
+	int32 next = 0;
+	for (int32 b = 0; b < batchCount; ++b)
+	{
+		b2ContactBatch* batch = m_batches + b;
+		batch->count = counts[b];
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			int32 i = m_batchOrder[next++];
+			const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+			batch->block = (vc->pointCount == 2 && g_blockSolve);
+			batch->constraints[lane] = i;
+			batch->indexA[lane] = vc->indexA;
+			batch->indexB[lane] = vc->indexB;
+			batch->normalX[lane] = vc->normal.x;
+			batch->normalY[lane] = vc->normal.y;
+			batch->invMassA[lane] = vc->invMassA;
+			batch->invMassB[lane] = vc->invMassB;
+			batch->invIA[lane] = vc->invIA;
+			batch->invIB[lane] = vc->invIB;
+			batch->friction[lane] = vc->friction;
+			batch->tangentSpeed[lane] = vc->tangentSpeed;
+			batch->K11[lane] = vc->K.ex.x;
+			batch->K12[lane] = vc->K.ey.x;
+			batch->K21[lane] = vc->K.ex.y;
+			batch->K22[lane] = vc->K.ey.y;
+			batch->M11[lane] = vc->normalMass.ex.x;
+			batch->M12[lane] = vc->normalMass.ey.x;
+			batch->M21[lane] = vc->normalMass.ex.y;
+			batch->M22[lane] = vc->normalMass.ey.y;
+
+			// A missing second point has no mass, so it never applies an impulse.
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				const b2VelocityConstraintPoint* vcp = vc->points + j;
+				b2ContactBatchPoint* bp = batch->points + j;
+				bp->rAx[lane] = vcp->rA.x;
+				bp->rAy[lane] = vcp->rA.y;
+				bp->rBx[lane] = vcp->rB.x;
+				bp->rBy[lane] = vcp->rB.y;
+				bp->normalImpulse[lane] = vcp->normalImpulse;
+				bp->tangentImpulse[lane] = vcp->tangentImpulse;
+				bp->normalMass[lane] = vcp->normalMass;
+				bp->tangentMass[lane] = vcp->tangentMass;
+				bp->velocityBias[lane] = vcp->velocityBias;
+			}
+		}
+	}
+}
+
+// This is SolveVelocityConstraints for b2_simdWidth contacts at a time.
+void b2ContactSolver::SolveBatches()
+{
+	float32 gather[6][b2_simdWidth];
+	const b2FloatW zero = b2SplatW(0.0f);
+
+	for (int32 b = 0; b < m_batchCount; ++b)
+	{
+		b2ContactBatch* batch = m_batches + b;
+
+		memset(gather, 0, sizeof(gather));
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			const b2Velocity& velA = m_velocities[batch->indexA[lane]];
+			const b2Velocity& velB = m_velocities[batch->indexB[lane]];
+			gather[0][lane] = velA.v.x;
+			gather[1][lane] = velA.v.y;
+			gather[2][lane] = velA.w;
+			gather[3][lane] = velB.v.x;
+			gather[4][lane] = velB.v.y;
+			gather[5][lane] = velB.w;
+		}
+
+		b2FloatW vAx = b2LoadW(gather[0]);
+		b2FloatW vAy = b2LoadW(gather[1]);
+		b2FloatW wA = b2LoadW(gather[2]);
+		b2FloatW vBx = b2LoadW(gather[3]);
+		b2FloatW vBy = b2LoadW(gather[4]);
+		b2FloatW wB = b2LoadW(gather[5]);
+
+		b2FloatW mA = b2LoadW(batch->invMassA);
+		b2FloatW iA = b2LoadW(batch->invIA);
+		b2FloatW mB = b2LoadW(batch->invMassB);
+		b2FloatW iB = b2LoadW(batch->invIB);
+
+		b2FloatW nx = b2LoadW(batch->normalX);
+		b2FloatW ny = b2LoadW(batch->normalY);
+		b2FloatW tx = ny;
+		b2FloatW ty = b2SubW(zero, nx);
+		b2FloatW friction = b2LoadW(batch->friction);
+		b2FloatW tangentSpeed = b2LoadW(batch->tangentSpeed);
+
+		// Solve tangent constraints first because non-penetration is more important
+		// than friction.
+		for (int32 j = 0; j < b2_maxManifoldPoints; ++j)
+		{
+			b2ContactBatchPoint* bp = batch->points + j;
+			b2FloatW rAx = b2LoadW(bp->rAx);
+			b2FloatW rAy = b2LoadW(bp->rAy);
+			b2FloatW rBx = b2LoadW(bp->rBx);
+			b2FloatW rBy = b2LoadW(bp->rBy);
+
+			// Relative velocity at contact
+			b2FloatW dvx = b2SubW(b2SubW(vBx, b2MulW(wB, rBy)), b2SubW(vAx, b2MulW(wA, rAy)));
+			b2FloatW dvy = b2SubW(b2AddW(vBy, b2MulW(wB, rBx)), b2AddW(vAy, b2MulW(wA, rAx)));
+
+			// Compute tangent force
+			b2FloatW vt = b2SubW(b2AddW(b2MulW(dvx, tx), b2MulW(dvy, ty)), tangentSpeed);
+			b2FloatW lambda = b2MulW(b2LoadW(bp->tangentMass), b2SubW(zero, vt));
+
+			// b2Clamp the accumulated force
+			b2FloatW oldImpulse = b2LoadW(bp->tangentImpulse);
+			b2FloatW maxFriction = b2MulW(friction, b2LoadW(bp->normalImpulse));
+			b2FloatW newImpulse = b2MaxW(b2SubW(zero, maxFriction), b2MinW(b2AddW(oldImpulse, lambda), maxFriction));
+			lambda = b2SubW(newImpulse, oldImpulse);
+			b2StoreW(bp->tangentImpulse, newImpulse);
+
+			// Apply contact impulse
+			b2FloatW Px = b2MulW(lambda, tx);
+			b2FloatW Py = b2MulW(lambda, ty);
+
+			vAx = b2SubW(vAx, b2MulW(mA, Px));
+			vAy = b2SubW(vAy, b2MulW(mA, Py));
+			wA = b2SubW(wA, b2MulW(iA, b2SubW(b2MulW(rAx, Py), b2MulW(rAy, Px))));
+
+			vBx = b2AddW(vBx, b2MulW(mB, Px));
+			vBy = b2AddW(vBy, b2MulW(mB, Py));
+			wB = b2AddW(wB, b2MulW(iB, b2SubW(b2MulW(rBx, Py), b2MulW(rBy, Px))));
+		}
+
+		// Solve normal constraints
+		if (batch->block == false)
+		{
+			for (int32 j = 0; j < b2_maxManifoldPoints; ++j)
+			{
+				b2ContactBatchPoint* bp = batch->points + j;
+				b2FloatW rAx = b2LoadW(bp->rAx);
+				b2FloatW rAy = b2LoadW(bp->rAy);
+				b2FloatW rBx = b2LoadW(bp->rBx);
+				b2FloatW rBy = b2LoadW(bp->rBy);
+
+				// Relative velocity at contact
+				b2FloatW dvx = b2SubW(b2SubW(vBx, b2MulW(wB, rBy)), b2SubW(vAx, b2MulW(wA, rAy)));
+				b2FloatW dvy = b2SubW(b2AddW(vBy, b2MulW(wB, rBx)), b2AddW(vAy, b2MulW(wA, rAx)));
+
+				// Compute normal impulse
+				b2FloatW vn = b2AddW(b2MulW(dvx, nx), b2MulW(dvy, ny));
+				b2FloatW lambda = b2MulW(b2LoadW(bp->normalMass), b2SubW(b2LoadW(bp->velocityBias), vn));
+
+				// b2Clamp the accumulated impulse
+				b2FloatW oldImpulse = b2LoadW(bp->normalImpulse);
+				b2FloatW newImpulse = b2MaxW(b2AddW(oldImpulse, lambda), zero);
+				lambda = b2SubW(newImpulse, oldImpulse);
+				b2StoreW(bp->normalImpulse, newImpulse);
+
+				// Apply contact impulse
+				b2FloatW Px = b2MulW(lambda, nx);
+				b2FloatW Py = b2MulW(lambda, ny);
+
+				vAx = b2SubW(vAx, b2MulW(mA, Px));
+				vAy = b2SubW(vAy, b2MulW(mA, Py));
+				wA = b2SubW(wA, b2MulW(iA, b2SubW(b2MulW(rAx, Py), b2MulW(rAy, Px))));
+
+				vBx = b2AddW(vBx, b2MulW(mB, Px));
+				vBy = b2AddW(vBy, b2MulW(mB, Py));
+				wB = b2AddW(wB, b2MulW(iB, b2SubW(b2MulW(rBx, Py), b2MulW(rBy, Px))));
+			}
+		}
+		else
+		{
+			// The block solver of SolveVelocityConstraints. Every lane tests
+			// all four cases, and keeps the first one that is valid.
+			b2ContactBatchPoint* cp1 = batch->points + 0;
+			b2ContactBatchPoint* cp2 = batch->points + 1;
+			b2FloatW r1Ax = b2LoadW(cp1->rAx), r1Ay = b2LoadW(cp1->rAy);
+			b2FloatW r1Bx = b2LoadW(cp1->rBx), r1By = b2LoadW(cp1->rBy);
+			b2FloatW r2Ax = b2LoadW(cp2->rAx), r2Ay = b2LoadW(cp2->rAy);
+			b2FloatW r2Bx = b2LoadW(cp2->rBx), r2By = b2LoadW(cp2->rBy);
+			b2FloatW K11 = b2LoadW(batch->K11), K12 = b2LoadW(batch->K12);
+			b2FloatW K21 = b2LoadW(batch->K21), K22 = b2LoadW(batch->K22);
+
+			b2FloatW ax = b2LoadW(cp1->normalImpulse);
+			b2FloatW ay = b2LoadW(cp2->normalImpulse);
+
+			// Relative velocity at contact
+			b2FloatW dv1x = b2SubW(b2SubW(vBx, b2MulW(wB, r1By)), b2SubW(vAx, b2MulW(wA, r1Ay)));
+			b2FloatW dv1y = b2SubW(b2AddW(vBy, b2MulW(wB, r1Bx)), b2AddW(vAy, b2MulW(wA, r1Ax)));
+			b2FloatW dv2x = b2SubW(b2SubW(vBx, b2MulW(wB, r2By)), b2SubW(vAx, b2MulW(wA, r2Ay)));
+			b2FloatW dv2y = b2SubW(b2AddW(vBy, b2MulW(wB, r2Bx)), b2AddW(vAy, b2MulW(wA, r2Ax)));
+
+			// Compute normal velocity
+			b2FloatW vn1 = b2AddW(b2MulW(dv1x, nx), b2MulW(dv1y, ny));
+			b2FloatW vn2 = b2AddW(b2MulW(dv2x, nx), b2MulW(dv2y, ny));
+
+			// Compute b' = b - K * a
+			b2FloatW bx = b2SubW(vn1, b2LoadW(cp1->velocityBias));
+			b2FloatW by = b2SubW(vn2, b2LoadW(cp2->velocityBias));
+			bx = b2SubW(bx, b2AddW(b2MulW(K11, ax), b2MulW(K12, ay)));
+			by = b2SubW(by, b2AddW(b2MulW(K21, ax), b2MulW(K22, ay)));
+
+			// Case 1: vn = 0
+			b2FloatW x1x = b2SubW(zero, b2AddW(b2MulW(b2LoadW(batch->M11), bx), b2MulW(b2LoadW(batch->M12), by)));
+			b2FloatW x1y = b2SubW(zero, b2AddW(b2MulW(b2LoadW(batch->M21), bx), b2MulW(b2LoadW(batch->M22), by)));
+			b2MaskW case1 = b2AndW(b2GreaterEqualW(x1x, zero), b2GreaterEqualW(x1y, zero));
+
+			// Case 2: vn1 = 0 and x2 = 0
+			b2FloatW x2x = b2SubW(zero, b2MulW(b2LoadW(cp1->normalMass), bx));
+			b2MaskW case2 = b2AndW(b2GreaterEqualW(x2x, zero), b2GreaterEqualW(b2AddW(b2MulW(K21, x2x), by), zero));
+
+			// Case 3: vn2 = 0 and x1 = 0
+			b2FloatW x3y = b2SubW(zero, b2MulW(b2LoadW(cp2->normalMass), by));
+			b2MaskW case3 = b2AndW(b2GreaterEqualW(x3y, zero), b2GreaterEqualW(b2AddW(b2MulW(K12, x3y), bx), zero));
+
+			// Case 4: x1 = 0 and x2 = 0
+			b2MaskW case4 = b2AndW(b2GreaterEqualW(bx, zero), b2GreaterEqualW(by, zero));
+
+			// If there is no solution, keep the old impulse.
+			b2FloatW xx = b2SelectW(case1, x1x, b2SelectW(case2, x2x, b2SelectW(case3, zero, b2SelectW(case4, zero, ax))));
+			b2FloatW xy = b2SelectW(case1, x1y, b2SelectW(case2, zero, b2SelectW(case3, x3y, b2SelectW(case4, zero, ay))));
+
+			// Apply incremental impulse
+			b2FloatW dx = b2SubW(xx, ax);
+			b2FloatW dy = b2SubW(xy, ay);
+			b2FloatW P1x = b2MulW(dx, nx), P1y = b2MulW(dx, ny);
+			b2FloatW P2x = b2MulW(dy, nx), P2y = b2MulW(dy, ny);
+
+			vAx = b2SubW(vAx, b2MulW(mA, b2AddW(P1x, P2x)));
+			vAy = b2SubW(vAy, b2MulW(mA, b2AddW(P1y, P2y)));
+			wA = b2SubW(wA, b2MulW(iA, b2AddW(b2SubW(b2MulW(r1Ax, P1y), b2MulW(r1Ay, P1x)),
+											  b2SubW(b2MulW(r2Ax, P2y), b2MulW(r2Ay, P2x)))));
+
+			vBx = b2AddW(vBx, b2MulW(mB, b2AddW(P1x, P2x)));
+			vBy = b2AddW(vBy, b2MulW(mB, b2AddW(P1y, P2y)));
+			wB = b2AddW(wB, b2MulW(iB, b2AddW(b2SubW(b2MulW(r1Bx, P1y), b2MulW(r1By, P1x)),
+											  b2SubW(b2MulW(r2Bx, P2y), b2MulW(r2By, P2x)))));
+
+			// Accumulate
+			b2StoreW(cp1->normalImpulse, xx);
+			b2StoreW(cp2->normalImpulse, xy);
+		}
+
+		b2StoreW(gather[0], vAx);
+		b2StoreW(gather[1], vAy);
+		b2StoreW(gather[2], wA);
+		b2StoreW(gather[3], vBx);
+		b2StoreW(gather[4], vBy);
+		b2StoreW(gather[5], wB);
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			b2Velocity& velA = m_velocities[batch->indexA[lane]];
+			b2Velocity& velB = m_velocities[batch->indexB[lane]];
+			velA.v.Set(gather[0][lane], gather[1][lane]);
+			velA.w = gather[2][lane];
+			velB.v.Set(gather[3][lane], gather[4][lane]);
+			velB.w = gather[5][lane];
+		}
+	}
+}
+
+// Copy the batch impulses back to the velocity constraints.
+void b2ContactSolver::StoreBatches()
+{
+	for (int32 b = 0; b < m_batchCount; ++b)
+	{
+		const b2ContactBatch* batch = m_batches + b;
+		for (int32 lane = 0; lane < batch->count; ++lane)
+		{
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + batch->constraints[lane];
+			for (int32 j = 0; j < vc->pointCount; ++j)
+			{
+				vc->points[j].normalImpulse = batch->points[j].normalImpulse[lane];
+				vc->points[j].tangentImpulse = batch->points[j].tangentImpulse[lane];
+			}
+		}
+	}
+}
+
 void b2ContactSolver::StoreImpulses()
 {
+	if (m_batches)
+	{
+		StoreBatches();
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
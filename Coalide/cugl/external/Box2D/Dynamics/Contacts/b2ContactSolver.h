@@ -27,6 +27,7 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2ContactBatch;
 
 struct b2VelocityConstraintPoint
 {
@@ -63,6 +64,7 @@ struct b2ContactSolverDef
 	int32 count;
 	b2Position* positions;
 	b2Velocity* velocities;
+	int32 slotCount;	// the length of positions and velocities
 	b2StackAllocator* allocator;
 };
 
@@ -81,6 +83,13 @@ public:
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// Contacts are solved in SIMD batches (b2_simdWidth wide) if
+	// b2TimeStep::batchedContacts is set. No two contacts in a batch
+	// share a body that can move.
+	void InitializeBatches();
+	void SolveBatches();
+	void StoreBatches();
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
@@ -89,6 +98,10 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+	int32 m_slotCount;
+	b2ContactBatch* m_batches;
+	int32* m_batchOrder;
+	int32 m_batchCount;
 };
 
 #endif
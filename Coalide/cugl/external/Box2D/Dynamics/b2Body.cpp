@@ -30,8 +30,10 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	b2Assert(b2IsValid(bd->angularVelocity));
 	b2Assert(b2IsValid(bd->angularDamping) && bd->angularDamping >= 0.0f);
 	b2Assert(b2IsValid(bd->linearDamping) && bd->linearDamping >= 0.0f);
+	b2Assert(b2IsValid(bd->surfaceFriction) && bd->surfaceFriction >= 0.0f);
 
 	m_flags = 0;
+	m_movedIndex = -1;
 
 	if (bd->bullet)
 	{
@@ -76,6 +78,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_linearDamping = bd->linearDamping;
 	m_angularDamping = bd->angularDamping;
+	m_surfaceFriction = bd->surfaceFriction;
 	m_gravityScale = bd->gravityScale;
 
 	m_force.SetZero();
@@ -441,6 +444,8 @@ void b2Body::SetTransform(const b2Vec2& position, float32 angle)
 	{
 		f->Synchronize(broadPhase, m_xf, m_xf);
 	}
+
+	m_world->MarkMoved(this);
 }
 
 void b2Body::SynchronizeFixtures()
@@ -536,6 +541,7 @@ void b2Body::Dump()
 	b2Log("  bd.angularVelocity = %.15lef;\n", m_angularVelocity);
 	b2Log("  bd.linearDamping = %.15lef;\n", m_linearDamping);
 	b2Log("  bd.angularDamping = %.15lef;\n", m_angularDamping);
+	b2Log("  bd.surfaceFriction = %.15lef;\n", m_surfaceFriction);
 	b2Log("  bd.allowSleep = bool(%d);\n", m_flags & e_autoSleepFlag);
 	b2Log("  bd.awake = bool(%d);\n", m_flags & e_awakeFlag);
 	b2Log("  bd.fixedRotation = bool(%d);\n", m_flags & e_fixedRotationFlag);
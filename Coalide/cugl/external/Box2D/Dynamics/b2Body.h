@@ -60,6 +60,7 @@ struct b2BodyDef
 		angularVelocity = 0.0f;
 		linearDamping = 0.0f;
 		angularDamping = 0.0f;
+		surfaceFriction = 0.0f;
 		allowSleep = true;
 		awake = true;
 		fixedRotation = false;
@@ -96,6 +97,11 @@ struct b2BodyDef
 	/// time step when the damping parameter is large.
 	float32 angularDamping;
 
+	/// Surface friction resists the motion of the body over an implicit ground,
+	/// as in a top-down game. It is the maximum force (and torque) that it applies,
+	/// like a b2FrictionJoint to a static body, but without a constraint.
+	float32 surfaceFriction;
+
 	/// Set this flag to false if this body should never fall asleep. Note that
 	/// this increases CPU usage.
 	bool allowSleep;
@@ -297,6 +303,12 @@ public:
 	/// Set the angular damping of the body.
 	void SetAngularDamping(float32 angularDamping);
 
+	/// Get the surface friction of the body.
+	float32 GetSurfaceFriction() const;
+
+	/// Set the surface friction of the body.
+	void SetSurfaceFriction(float32 surfaceFriction);
+
 	/// Get the gravity scale of the body.
 	float32 GetGravityScale() const;
 
@@ -416,7 +428,8 @@ private:
 		e_bulletFlag		= 0x0008,
 		e_fixedRotationFlag	= 0x0010,
 		e_activeFlag		= 0x0020,
-		e_toiFlag			= 0x0040
+		e_toiFlag			= 0x0040,
+		e_movedFlag			= 0x0080
 	};
 
 	b2Body(const b2BodyDef* bd, b2World* world);
@@ -437,6 +450,9 @@ private:
 
 	int32 m_islandIndex;
 
+	// The index of this body in the world moved list, if it has e_movedFlag.
+	int32 m_movedIndex;
+
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
@@ -463,6 +479,7 @@ private:
 
 	float32 m_linearDamping;
 	float32 m_angularDamping;
+	float32 m_surfaceFriction;
 	float32 m_gravityScale;
 
 	float32 m_sleepTime;
@@ -607,6 +624,16 @@ inline void b2Body::SetAngularDamping(float32 angularDamping)
 	m_angularDamping = angularDamping;
 }
 
+inline float32 b2Body::GetSurfaceFriction() const
+{
+	return m_surfaceFriction;
+}
+
+inline void b2Body::SetSurfaceFriction(float32 surfaceFriction)
+{
+	m_surfaceFriction = surfaceFriction;
+}
+
 inline float32 b2Body::GetGravityScale() const
 {
 	return m_gravityScale;
@@ -151,10 +151,22 @@ b2Island::b2Island(
 	int32 jointCapacity,
 	b2StackAllocator* allocator,
 	b2ContactListener* listener)
+	: b2Island(bodyCapacity, contactCapacity, jointCapacity, bodyCapacity, allocator, listener)
+{
+}
+
+b2Island::b2Island(
+	int32 bodyCapacity,
+	int32 contactCapacity,
+	int32 jointCapacity,
+	int32 slotCapacity,
+	b2StackAllocator* allocator,
+	b2ContactListener* listener)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
 	m_jointCapacity	 = jointCapacity;
+	m_slotCapacity = slotCapacity;
 	m_bodyCount = 0;
 	m_contactCount = 0;
 	m_jointCount = 0;
@@ -162,12 +174,16 @@ b2Island::b2Island(
 	m_allocator = allocator;
 	m_listener = listener;
 
+	m_parallel = false;
+	m_impulses = NULL;
+	m_sleep = false;
+
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
 	m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
 
-	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
-	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+	m_velocities = (b2Velocity*)m_allocator->Allocate(m_slotCapacity * sizeof(b2Velocity));
+	m_positions = (b2Position*)m_allocator->Allocate(m_slotCapacity * sizeof(b2Position));
 }
 
 b2Island::~b2Island()
@@ -190,6 +206,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
+		int32 k = b->m_islandIndex;
 
 		b2Vec2 c = b->m_sweep.c;
 		float32 a = b->m_sweep.a;
@@ -197,8 +214,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		float32 w = b->m_angularVelocity;
 
 		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		// Static bodies never move, and may be shared by other threads.
+		if (m_parallel == false || b->m_type != b2_staticBody)
+		{
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
 
 		if (b->m_type == b2_dynamicBody)
 		{
@@ -215,12 +236,25 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			// v2 = v1 * 1 / (1 + c * dt)
 			v *= 1.0f / (1.0f + h * b->m_linearDamping);
 			w *= 1.0f / (1.0f + h * b->m_angularDamping);
+
+			// Apply surface friction. This is the impulse of a friction joint
+			// to a static body, clamped so that it can stop the body but never
+			// reverse it.
+			if (b->m_surfaceFriction > 0.0f)
+			{
+				float32 maxSpeed = h * b->m_surfaceFriction * b->m_invMass;
+				float32 speed = v.Length();
+				v = speed > maxSpeed ? ((speed - maxSpeed) / speed) * v : b2Vec2_zero;
+
+				float32 maxSpin = h * b->m_surfaceFriction * b->m_invI;
+				w = b2Abs(w) > maxSpin ? w - (w > 0.0f ? maxSpin : -maxSpin) : 0.0f;
+			}
 		}
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		m_positions[k].c = c;
+		m_positions[k].a = a;
+		m_velocities[k].v = v;
+		m_velocities[k].w = w;
 	}
 
 	timer.Reset();
@@ -238,6 +272,7 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	contactSolverDef.count = m_contactCount;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.slotCount = m_slotCapacity;
 	contactSolverDef.allocator = m_allocator;
 
 	b2ContactSolver contactSolver(&contactSolverDef);
@@ -274,10 +309,11 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	// Integrate positions
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Vec2 c = m_positions[i].c;
-		float32 a = m_positions[i].a;
-		b2Vec2 v = m_velocities[i].v;
-		float32 w = m_velocities[i].w;
+		int32 k = m_bodies[i]->m_islandIndex;
+		b2Vec2 c = m_positions[k].c;
+		float32 a = m_positions[k].a;
+		b2Vec2 v = m_velocities[k].v;
+		float32 w = m_velocities[k].w;
 
 		// Check for large velocities
 		b2Vec2 translation = h * v;
@@ -298,10 +334,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		c += h * v;
 		a += h * w;
 
-		m_positions[i].c = c;
-		m_positions[i].a = a;
-		m_velocities[i].v = v;
-		m_velocities[i].w = w;
+		m_positions[k].c = c;
+		m_positions[k].a = a;
+		m_velocities[k].v = v;
+		m_velocities[k].w = w;
 	}
 
 	// Solve position constraints
@@ -330,10 +366,16 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
+		if (m_parallel && body->m_type == b2_staticBody)
+		{
+			continue;
+		}
+
+		int32 k = body->m_islandIndex;
+		body->m_sweep.c = m_positions[k].c;
+		body->m_sweep.a = m_positions[k].a;
+		body->m_linearVelocity = m_velocities[k].v;
+		body->m_angularVelocity = m_velocities[k].w;
 		body->SynchronizeTransform();
 	}
 
@@ -370,7 +412,12 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 			}
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		if (minSleepTime >= b2_timeToSleep && positionSolved && m_parallel)
+		{
+			// The world puts the island to sleep on the main thread
+			m_sleep = true;
+		}
+		else if (minSleepTime >= b2_timeToSleep && positionSolved)
 		{
 			for (int32 i = 0; i < m_bodyCount; ++i)
 			{
@@ -403,6 +450,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 	contactSolverDef.step = subStep;
 	contactSolverDef.positions = m_positions;
 	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.slotCount = m_slotCapacity;
 	b2ContactSolver contactSolver(&contactSolverDef);
 
 	// Solve position constraints.
@@ -515,7 +563,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
 
 void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 {
-	if (m_listener == NULL)
+	if (m_listener == NULL && m_impulses == NULL)
 	{
 		return;
 	}
@@ -534,6 +582,13 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 			impulse.tangentImpulses[j] = vc->points[j].tangentImpulse;
 		}
 
-		m_listener->PostSolve(c, &impulse);
+		if (m_impulses != NULL)
+		{
+			m_impulses[i] = impulse;
+		}
+		else
+		{
+			m_listener->PostSolve(c, &impulse);
+		}
 	}
 }
@@ -27,6 +27,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -36,6 +37,11 @@ class b2Island
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	/// The slot capacity is the size of the position and velocity arrays.
+	/// It exceeds the body capacity when static bodies have shared slots.
+	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
+			int32 slotCapacity, b2StackAllocator* allocator, b2ContactListener* listener);
 	~b2Island();
 
 	void Clear()
@@ -78,9 +84,17 @@ public:
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
 
+	// These are indexed by b2Body::m_islandIndex
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
 
+	// Set when solving on a worker thread. Shared static bodies are not
+	// written, the impulses are stored in m_impulses instead of reported,
+	// and m_sleep is set instead of putting the bodies to sleep.
+	bool m_parallel;
+	b2ContactImpulse* m_impulses;
+	bool m_sleep;
+
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
@@ -88,6 +102,7 @@ public:
 	int32 m_bodyCapacity;
 	int32 m_contactCapacity;
 	int32 m_jointCapacity;
+	int32 m_slotCapacity;
 };
 
 #endif
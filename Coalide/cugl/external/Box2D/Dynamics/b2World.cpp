@@ -32,8 +32,27 @@
 #include <Box2D/Collision/b2TimeOfImpact.h>
 #include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2Timer.h>
+#include <atomic>
+#include <string.h>
 #include <new>
 
+/// The task that solves the islands recorded by b2World::SolveParallel.
+/// Each lane pulls the next unsolved island until there are none left.
+class b2IslandSolver : public b2Task
+{
+public:
+	b2IslandSolver(b2World* world, const b2TimeStep& step) : m_world(world), m_step(step), m_next(0) {}
+
+	void Execute(int32 lane) override
+	{
+		m_world->SolveLane(lane, m_step, this);
+	}
+
+	b2World* m_world;
+	const b2TimeStep& m_step;
+	std::atomic<int32> m_next;
+};
+
 b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = NULL;
@@ -46,6 +65,7 @@ b2World::b2World(const b2Vec2& gravity)
 	m_jointCount = 0;
 
 	m_warmStarting = true;
+	m_contactBatching = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
@@ -61,6 +81,12 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_taskScheduler = NULL;
+	for (int32 i = 0; i < b2_maxSolverLanes; ++i)
+	{
+		m_laneAllocators[i] = NULL;
+	}
 }
 
 b2World::~b2World()
@@ -82,6 +108,15 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	for (int32 i = 0; i < b2_maxSolverLanes; ++i)
+	{
+		if (m_laneAllocators[i])
+		{
+			m_laneAllocators[i]->~b2StackAllocator();
+			b2Free(m_laneAllocators[i]);
+		}
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -104,6 +139,12 @@ void b2World::SetDebugDraw(b2Draw* debugDraw)
 	g_debugDraw = debugDraw;
 }
 
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+	b2Assert(IsLocked() == false);
+	m_taskScheduler = scheduler;
+}
+
 b2Body* b2World::CreateBody(const b2BodyDef* def)
 {
 	b2Assert(IsLocked() == false);
@@ -125,6 +166,9 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	// A new body has moved as far as the client is concerned.
+	MarkMoved(b);
+
 	return b;
 }
 
@@ -204,6 +248,11 @@ void b2World::DestroyBody(b2Body* b)
 		m_bodyList = b->m_next;
 	}
 
+	if (b->m_flags & b2Body::e_movedFlag)
+	{
+		m_movedBodies[b->m_movedIndex] = NULL;
+	}
+
 	--m_bodyCount;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
@@ -382,13 +431,130 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+// Grow an island from the seed body with a depth first search. If staticSlots
+// is not NULL, static bodies keep a slot shared by every island of this step.
+void b2World::BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize, int32* staticSlots)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
+	int32 stackCount = 0;
+	stack[stackCount++] = seed;
+	seed->m_flags |= b2Body::e_islandFlag;
+
+	// Perform a depth first search (DFS) on the constraint graph.
+	while (stackCount > 0)
+	{
+		// Grab the next body off the stack and add it to the island.
+		b2Body* b = stack[--stackCount];
+		b2Assert(b->IsActive() == true);
+		if (staticSlots && b->GetType() == b2_staticBody)
+		{
+			// Static bodies share one slot across all islands.
+			if (b->m_islandIndex < 0)
+			{
+				b->m_islandIndex = (*staticSlots)++;
+			}
+			island->m_bodies[island->m_bodyCount++] = b;
+		}
+		else
+		{
+			island->Add(b);
+		}
 
+		// Make sure the body is awake.
+		b->SetAwake(true);
+
+		// To keep islands as small as possible, we don't
+		// propagate islands across static bodies.
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		// Search all contacts connected to this body.
+		for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			b2Contact* contact = ce->contact;
+
+			// Has this contact already been added to an island?
+			if (contact->m_flags & b2Contact::e_islandFlag)
+			{
+				continue;
+			}
+
+			// Is this contact solid and touching?
+			if (contact->IsEnabled() == false ||
+				contact->IsTouching() == false)
+			{
+				continue;
+			}
+
+			// Skip sensors.
+			bool sensorA = contact->m_fixtureA->m_isSensor;
+			bool sensorB = contact->m_fixtureB->m_isSensor;
+			if (sensorA || sensorB)
+			{
+				continue;
+			}
+
+			island->Add(contact);
+			contact->m_flags |= b2Contact::e_islandFlag;
+
+			b2Body* other = ce->other;
+
+			// Was the other body already added to this island?
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
+
+		// Search all joints connect to this body.
+		for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		{
+			if (je->joint->m_islandFlag == true)
+			{
+				continue;
+			}
+
+			b2Body* other = je->other;
+
+			// Don't simulate joints connected to inactive bodies.
+			if (other->IsActive() == false)
+			{
+				continue;
+			}
+
+			island->Add(je->joint);
+			je->joint->m_islandFlag = true;
+
+			if (other->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
+
+			b2Assert(stackCount < stackSize);
+			stack[stackCount++] = other;
+			other->m_flags |= b2Body::e_islandFlag;
+		}
+	}
+
+	// Allow static bodies to participate in other islands.
+	for (int32 i = 0; i < island->m_bodyCount; ++i)
+	{
+		b2Body* b = island->m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			b->m_flags &= ~b2Body::e_islandFlag;
+		}
+	}
+}
+
+// Build and simulate all awake islands on the calling thread.
+void b2World::SolveIslands(const b2TimeStep& step)
+{
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
@@ -396,21 +562,6 @@ void b2World::Solve(const b2TimeStep& step)
 					&m_stackAllocator,
 					m_contactManager.m_contactListener);
 
-	// Clear all the island flags.
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
-	{
-		b->m_flags &= ~b2Body::e_islandFlag;
-	}
-	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
-	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
-	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
-	{
-		j->m_islandFlag = false;
-	}
-
-	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
@@ -431,121 +582,225 @@ void b2World::Solve(const b2TimeStep& step)
 			continue;
 		}
 
-		// Reset island and stack.
 		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+		BuildIsland(seed, &island, stack, stackSize, NULL);
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		b2Profile profile;
+		island.Solve(&profile, step, m_gravity, m_allowSleep);
+		m_profile.solveInit += profile.solveInit;
+		m_profile.solveVelocity += profile.solveVelocity;
+		m_profile.solvePosition += profile.solvePosition;
+	}
+
+	m_stackAllocator.Free(stack);
+}
+
+// Record all awake islands, solve them on the task scheduler, and then apply
+// the results in island order so that the outcome matches SolveIslands.
+void b2World::SolveParallel(const b2TimeStep& step)
+{
+	m_islands.clear();
+	m_islandBodies.clear();
+	m_islandContacts.clear();
+	m_islandJoints.clear();
+	m_islandImpulses.clear();
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->GetType() == b2_staticBody)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			b2Assert(b->IsActive() == true);
-			island.Add(b);
+			b->m_islandIndex = -1;
+		}
+	}
 
-			// Make sure the body is awake.
-			b->SetAwake(true);
+	{
+		b2Island island(m_bodyCount,
+						m_contactManager.m_contactCount,
+						m_jointCount,
+						&m_stackAllocator,
+						NULL);
+
+		int32 staticSlots = 0;
+		int32 stackSize = m_bodyCount;
+		b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+		for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+		{
+			if (seed->m_flags & b2Body::e_islandFlag)
+			{
+				continue;
+			}
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->GetType() == b2_staticBody)
+			if (seed->IsAwake() == false || seed->IsActive() == false)
 			{
 				continue;
 			}
 
-			// Search all contacts connected to this body.
-			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			// The seed can be dynamic or kinematic.
+			if (seed->GetType() == b2_staticBody)
 			{
-				b2Contact* contact = ce->contact;
+				continue;
+			}
 
-				// Has this contact already been added to an island?
-				if (contact->m_flags & b2Contact::e_islandFlag)
+			island.Clear();
+			BuildIsland(seed, &island, stack, stackSize, &staticSlots);
+
+			// Dynamic bodies go after every static slot seen so far.
+			b2IslandRange range;
+			range.bodyStart = (int32)m_islandBodies.size();
+			range.bodyCount = island.m_bodyCount;
+			range.contactStart = (int32)m_islandContacts.size();
+			range.contactCount = island.m_contactCount;
+			range.jointStart = (int32)m_islandJoints.size();
+			range.jointCount = island.m_jointCount;
+			range.slotCount = staticSlots + island.m_bodyCount;
+			range.sleep = false;
+			memset(&range.profile, 0, sizeof(b2Profile));
+
+			for (int32 i = 0; i < island.m_bodyCount; ++i)
+			{
+				b2Body* b = island.m_bodies[i];
+				if (b->GetType() != b2_staticBody)
 				{
-					continue;
+					b->m_islandIndex += staticSlots;
 				}
+				m_islandBodies.push_back(b);
+			}
+			m_islandContacts.insert(m_islandContacts.end(), island.m_contacts, island.m_contacts + island.m_contactCount);
+			m_islandJoints.insert(m_islandJoints.end(), island.m_joints, island.m_joints + island.m_jointCount);
+			m_islands.push_back(range);
+		}
 
-				// Is this contact solid and touching?
-				if (contact->IsEnabled() == false ||
-					contact->IsTouching() == false)
-				{
-					continue;
-				}
+		m_stackAllocator.Free(stack);
+	}
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
+	int32 islandCount = (int32)m_islands.size();
+	if (islandCount == 0)
+	{
+		return;
+	}
 
-				island.Add(contact);
-				contact->m_flags |= b2Contact::e_islandFlag;
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	if (listener)
+	{
+		m_islandImpulses.resize(m_islandContacts.size());
+	}
 
-				b2Body* other = ce->other;
+	int32 lanes = b2Min(b2Min(m_taskScheduler->GetParallelism(), (int32)b2_maxSolverLanes), islandCount);
+	for (int32 i = 0; i < lanes; ++i)
+	{
+		if (m_laneAllocators[i] == NULL)
+		{
+			void* mem = b2Alloc(sizeof(b2StackAllocator));
+			m_laneAllocators[i] = new (mem) b2StackAllocator;
+		}
+	}
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
+	b2IslandSolver solver(this, step);
+	if (lanes == 1)
+	{
+		solver.Execute(0);
+	}
+	else
+	{
+		m_taskScheduler->Run(&solver, lanes);
+	}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
-			}
+	// Apply the results on this thread, in island order.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange& range = m_islands[i];
+		m_profile.solveInit += range.profile.solveInit;
+		m_profile.solveVelocity += range.profile.solveVelocity;
+		m_profile.solvePosition += range.profile.solvePosition;
 
-			// Search all joints connect to this body.
-			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+		if (listener)
+		{
+			for (int32 j = 0; j < range.contactCount; ++j)
 			{
-				if (je->joint->m_islandFlag == true)
-				{
-					continue;
-				}
-
-				b2Body* other = je->other;
-
-				// Don't simulate joints connected to inactive bodies.
-				if (other->IsActive() == false)
-				{
-					continue;
-				}
-
-				island.Add(je->joint);
-				je->joint->m_islandFlag = true;
-
-				if (other->m_flags & b2Body::e_islandFlag)
-				{
-					continue;
-				}
-
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+				int32 k = range.contactStart + j;
+				listener->PostSolve(m_islandContacts[k], &m_islandImpulses[k]);
 			}
 		}
 
-		b2Profile profile;
-		island.Solve(&profile, step, m_gravity, m_allowSleep);
-		m_profile.solveInit += profile.solveInit;
-		m_profile.solveVelocity += profile.solveVelocity;
-		m_profile.solvePosition += profile.solvePosition;
-
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		if (range.sleep)
 		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->GetType() == b2_staticBody)
+			for (int32 j = 0; j < range.bodyCount; ++j)
 			{
-				b->m_flags &= ~b2Body::e_islandFlag;
+				m_islandBodies[range.bodyStart + j]->SetAwake(false);
 			}
 		}
 	}
+}
 
-	m_stackAllocator.Free(stack);
+// Solve islands on one lane of the task scheduler. Each lane has its own
+// stack allocator, and no two islands write to the same body.
+void b2World::SolveLane(int32 lane, const b2TimeStep& step, b2IslandSolver* solver)
+{
+	b2StackAllocator* allocator = m_laneAllocators[lane];
+	int32 islandCount = (int32)m_islands.size();
+
+	for (int32 i = solver->m_next++; i < islandCount; i = solver->m_next++)
+	{
+		b2IslandRange& range = m_islands[i];
+		b2Island island(range.bodyCount,
+						range.contactCount,
+						range.jointCount,
+						range.slotCount,
+						allocator,
+						NULL);
+
+		memcpy(island.m_bodies, &m_islandBodies[range.bodyStart], range.bodyCount * sizeof(b2Body*));
+		if (range.contactCount > 0)
+		{
+			memcpy(island.m_contacts, &m_islandContacts[range.contactStart], range.contactCount * sizeof(b2Contact*));
+		}
+		if (range.jointCount > 0)
+		{
+			memcpy(island.m_joints, &m_islandJoints[range.jointStart], range.jointCount * sizeof(b2Joint*));
+		}
+		island.m_bodyCount = range.bodyCount;
+		island.m_contactCount = range.contactCount;
+		island.m_jointCount = range.jointCount;
+		island.m_parallel = true;
+		if (m_islandImpulses.empty() == false && range.contactCount > 0)
+		{
+			island.m_impulses = &m_islandImpulses[range.contactStart];
+		}
+
+		island.Solve(&range.profile, step, m_gravity, m_allowSleep);
+		range.sleep = island.m_sleep;
+	}
+}
+
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	m_profile.solveInit = 0.0f;
+	m_profile.solveVelocity = 0.0f;
+	m_profile.solvePosition = 0.0f;
+
+	// Clear all the island flags.
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b->m_flags &= ~b2Body::e_islandFlag;
+	}
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		c->m_flags &= ~b2Contact::e_islandFlag;
+	}
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->m_islandFlag = false;
+	}
+
+	if (m_taskScheduler && m_taskScheduler->GetParallelism() > 1)
+	{
+		SolveParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
 
 	{
 		b2Timer timer;
@@ -565,6 +820,7 @@ void b2World::Solve(const b2TimeStep& step)
 
 			// Update fixtures (for broad-phase).
 			b->SynchronizeFixtures();
+			MarkMoved(b);
 		}
 
 		// Look for new contacts.
@@ -860,6 +1116,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.batchedContacts = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -874,6 +1131,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			}
 
 			body->SynchronizeFixtures();
+			MarkMoved(body);
 
 			// Invalidate all contact TOIs on this displaced body.
 			for (b2ContactEdge* ce = body->m_contactList; ce; ce = ce->next)
@@ -923,6 +1181,7 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.batchedContacts = m_contactBatching;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
@@ -1252,6 +1511,108 @@ void b2World::DrawDebugData()
 			g_debugDraw->DrawTransform(xf);
 		}
 	}
+
+	if (flags & b2Draw::e_contactBit)
+	{
+		b2Color color(0.9f, 0.9f, 0.3f);
+		b2WorldManifold worldManifold;
+		for (b2Contact* c = m_contactManager.m_contactList; c; c = c->GetNext())
+		{
+			if (c->IsTouching() == false || c->IsEnabled() == false)
+			{
+				continue;
+			}
+
+			c->GetWorldManifold(&worldManifold);
+			int32 pointCount = c->GetManifold()->pointCount;
+			for (int32 i = 0; i < pointCount; ++i)
+			{
+				g_debugDraw->DrawPoint(worldManifold.points[i], 4.0f, color);
+			}
+		}
+	}
+
+	if (flags & b2Draw::e_broadPhaseBit)
+	{
+		m_contactManager.m_broadPhase.Draw(g_debugDraw, b2Color(0.3f, 0.3f, 0.9f));
+	}
+}
+
+void b2World::UseUniformGrid(const b2AABB& bounds, float32 cellSize)
+{
+	RebuildProxies(true, bounds, cellSize);
+}
+
+void b2World::UseDynamicTree()
+{
+	b2AABB bounds;
+	bounds.lowerBound.SetZero();
+	bounds.upperBound.SetZero();
+	RebuildProxies(false, bounds, 0.0f);
+}
+
+// Move every proxy to a new broad-phase structure. Contacts refer to
+// fixtures, not proxies, so they survive the move.
+void b2World::RebuildProxies(bool grid, const b2AABB& bounds, float32 cellSize)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	b2BroadPhase* broadPhase = &m_contactManager.m_broadPhase;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->DestroyProxies(broadPhase);
+		}
+	}
+
+	if (grid)
+	{
+		broadPhase->UseUniformGrid(bounds, cellSize);
+	}
+	else
+	{
+		broadPhase->UseDynamicTree();
+	}
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->IsActive() == false)
+		{
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->CreateProxies(broadPhase, b->m_xf);
+		}
+	}
+}
+
+void b2World::MarkMoved(b2Body* body)
+{
+	if ((body->m_flags & b2Body::e_movedFlag) == 0)
+	{
+		body->m_flags |= b2Body::e_movedFlag;
+		body->m_movedIndex = int32(m_movedBodies.size());
+		m_movedBodies.push_back(body);
+	}
+}
+
+void b2World::ClearMovedBodies()
+{
+	for (size_t i = 0; i < m_movedBodies.size(); ++i)
+	{
+		if (m_movedBodies[i])
+		{
+			m_movedBodies[i]->m_flags &= ~b2Body::e_movedFlag;
+		}
+	}
+	m_movedBodies.clear();
 }
 
 int32 b2World::GetProxyCount() const
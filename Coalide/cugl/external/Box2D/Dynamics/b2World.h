@@ -25,6 +25,7 @@
 #include <Box2D/Dynamics/b2ContactManager.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
+#include <vector>
 
 struct b2AABB;
 struct b2BodyDef;
@@ -34,6 +35,8 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2Island;
+class b2IslandSolver;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -66,6 +69,14 @@ public:
 	/// by you and must remain in scope.
 	void SetDebugDraw(b2Draw* debugDraw);
 
+	/// Register a task scheduler to solve independent islands in parallel.
+	/// Each island is solved by a single thread, and the results (including
+	/// the b2ContactListener::PostSolve calls) are applied in the same order
+	/// as the serial solver. Pass NULL to solve on the calling thread. The
+	/// scheduler is owned by you and must remain in scope.
+	void SetTaskScheduler(b2TaskScheduler* scheduler);
+	b2TaskScheduler* GetTaskScheduler() const { return m_taskScheduler; }
+
 	/// Create a rigid body given a definition. No reference to the definition
 	/// is retained.
 	/// @warning This function is locked during callbacks.
@@ -149,6 +160,11 @@ public:
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
 
+	/// Enable/disable solving contacts in SIMD batches. Batches reorder the
+	/// contacts, so results differ slightly from the serial solver. For testing.
+	void SetContactBatching(bool flag) { m_contactBatching = flag; }
+	bool GetContactBatching() const { return m_contactBatching; }
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 	bool GetContinuousPhysics() const { return m_continuousPhysics; }
@@ -157,6 +173,20 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Keep the broad-phase proxies in a uniform grid instead of a dynamic tree.
+	/// This suits bounded worlds whose bodies are all about one cell in size.
+	/// Existing proxies are moved to the grid.
+	/// @param bounds the region covered by the grid. Bodies outside of it still collide.
+	/// @param cellSize the width and height of a grid cell.
+	void UseUniformGrid(const b2AABB& bounds, float32 cellSize);
+
+	/// Keep the broad-phase proxies in a dynamic tree (the default).
+	/// Existing proxies are moved to the tree.
+	void UseDynamicTree();
+
+	/// Are the broad-phase proxies kept in a uniform grid?
+	bool IsUniformGrid() const;
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -169,6 +199,23 @@ public:
 	/// Get the number of contacts (each may have 0 or more contact points).
 	int32 GetContactCount() const;
 
+	/// Get the bodies whose transform may have changed since the last call to
+	/// ClearMovedBodies. These are the new bodies, the bodies that were awake
+	/// during a step, and the bodies moved with b2Body::SetTransform. Use this
+	/// to sync your game objects without visiting the sleeping and static bodies.
+	/// A body destroyed since the last clear leaves a NULL entry.
+	b2Body* const* GetMovedBodies() const;
+
+	/// Get the number of entries in the moved body list.
+	int32 GetMovedBodyCount() const;
+
+	/// Empty the moved body list.
+	void ClearMovedBodies();
+
+	/// Add a body to the moved body list. Use this when the client must
+	/// sync a body that did not move, such as one whose shape changed.
+	void MarkMoved(b2Body* body);
+
 	/// Get the height of the dynamic tree.
 	int32 GetTreeHeight() const;
 
@@ -223,13 +270,20 @@ private:
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2IslandSolver;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveParallel(const b2TimeStep& step);
+	void SolveLane(int32 lane, const b2TimeStep& step, b2IslandSolver* solver);
+	void BuildIsland(b2Body* seed, b2Island* island, b2Body** stack, int32 stackSize, int32* staticSlots);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
 
+	void RebuildProxies(bool grid, const b2AABB& bounds, float32 cellSize);
+
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
@@ -255,12 +309,26 @@ private:
 
 	// These are for debugging the solver.
 	bool m_warmStarting;
+	bool m_contactBatching;
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	// Parallel island solving. The island arrays are kept between
+	// steps so that they do not allocate once they have grown.
+	b2TaskScheduler* m_taskScheduler;
+	b2StackAllocator* m_laneAllocators[b2_maxSolverLanes];
+	std::vector<b2IslandRange> m_islands;
+	std::vector<b2Body*> m_islandBodies;
+	std::vector<b2Contact*> m_islandContacts;
+
+	// The bodies that may have moved since the client last cleared them.
+	std::vector<b2Body*> m_movedBodies;
+	std::vector<b2Joint*> m_islandJoints;
+	std::vector<b2ContactImpulse> m_islandImpulses;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -308,6 +376,21 @@ inline int32 b2World::GetContactCount() const
 	return m_contactManager.m_contactCount;
 }
 
+inline b2Body* const* b2World::GetMovedBodies() const
+{
+	return m_movedBodies.empty() ? NULL : &m_movedBodies[0];
+}
+
+inline int32 b2World::GetMovedBodyCount() const
+{
+	return int32(m_movedBodies.size());
+}
+
+inline bool b2World::IsUniformGrid() const
+{
+	return m_contactManager.m_broadPhase.IsUniformGrid();
+}
+
 inline void b2World::SetGravity(const b2Vec2& gravity)
 {
 	m_gravity = gravity;
@@ -152,4 +152,31 @@ public:
 									const b2Vec2& normal, float32 fraction) = 0;
 };
 
+/// A unit of parallel work. See b2TaskScheduler.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Called once for every index passed to b2TaskScheduler::Run.
+	/// Different indices may run on different threads at the same time.
+	virtual void Execute(int32 index) = 0;
+};
+
+/// Implement this class to let the world solve independent islands on
+/// worker threads. See b2World::SetTaskScheduler.
+class b2TaskScheduler
+{
+public:
+	virtual ~b2TaskScheduler() {}
+
+	/// The number of tasks that can usefully run at once, including the
+	/// calling thread. The world solves serially if this is less than 2.
+	virtual int32 GetParallelism() = 0;
+
+	/// Call task->Execute(i) exactly once for each i in [0, count), and
+	/// return only when all of them are complete.
+	virtual void Run(b2Task* task, int32 count) = 0;
+};
+
 #endif
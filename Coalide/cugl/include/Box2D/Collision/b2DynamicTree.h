@@ -20,6 +20,7 @@
 #define B2_DYNAMIC_TREE_H
 
 #include <Box2D/Collision/b2Collision.h>
+#include <Box2D/Common/b2Draw.h>
 #include <Box2D/Common/b2GrowableStack.h>
 
 #define b2_nullNode (-1)
@@ -118,6 +119,9 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	/// Draw the fat AABB of every internal node (the leaves are the proxies).
+	void Draw(b2Draw* draw, const b2Color& color) const;
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -67,6 +67,10 @@ typedef double float64;
 /// This is a dimensionless multiplier.
 #define b2_aabbMultiplier		2.0f
 
+/// The largest number of cells a proxy may cover in the uniform grid broad-phase.
+/// Bigger proxies are kept in a list that every query visits.
+#define b2_gridMaxProxyCells	64
+
 /// A small length used as a collision and constraint tolerance. Usually it is
 /// chosen to be numerically significant, but visually insignificant.
 #define b2_linearSlop			0.005f
@@ -89,6 +93,13 @@ typedef double float64;
 /// Maximum number of contacts to be handled to solve a TOI impact.
 #define b2_maxTOIContacts			32
 
+/// Maximum number of threads that may solve islands at the same time.
+/// Each one has its own stack allocator.
+#define b2_maxSolverLanes			8
+
+/// The number of contacts solved together by the SIMD contact solver.
+#define b2_simdWidth				4
+
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
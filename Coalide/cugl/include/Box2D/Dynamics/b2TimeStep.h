@@ -43,6 +43,7 @@ struct b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	bool batchedContacts;	// solve the contacts in SIMD batches
 };
 
 /// This is an internal structure.
@@ -59,6 +60,21 @@ struct b2Velocity
 	float32 w;
 };
 
+/// This is an internal structure.
+/// An island recorded for solving on a worker thread.
+struct b2IslandRange
+{
+	int32 bodyStart;
+	int32 bodyCount;
+	int32 contactStart;
+	int32 contactCount;
+	int32 jointStart;
+	int32 jointCount;
+	int32 slotCount;	// size of the position and velocity arrays
+	b2Profile profile;
+	bool sleep;			// whether the island fell asleep
+};
+
 /// Solver Data
 struct b2SolverData
 {
@@ -956,7 +956,9 @@ public:
      *
      * @param color the color tinting this node.
      */
-    virtual void setColor(Color4 color) { _tintColor = color; }
+    virtual void setColor(Color4 color) {
+        if (_tintColor != color) { _tintColor = color; markDirty(); }
+    }
 
     /**
      * Returns the absolute color tinting this node.
@@ -989,7 +991,9 @@ public:
      *
      * @param visible   true if the node is visible.
      */
-    void setVisible(bool visible) { _isVisible = visible; }
+    void setVisible(bool visible) {
+        if (_isVisible != visible) { _isVisible = visible; markDirty(); }
+    }
     
     /**
      * Returns true if this node is tinted by its parent.
@@ -1011,7 +1015,9 @@ public:
      *
      * @param flag  Whether this node is tinted by its parent.
      */
-    void setRelativeColor(bool flag) { _hasParentColor = flag; }
+    void setRelativeColor(bool flag) {
+        if (_hasParentColor != flag) { _hasParentColor = flag; markDirty(); }
+    }
     
     
 #pragma mark -
@@ -1063,6 +1069,7 @@ public:
      * @param scale the uniform scaling factor.
      */
     void setScale(float scale) {
+        if (_scale.x == scale && _scale.y == scale) return;
         _scale.set(scale,scale);
         if (!_useTransform) updateTransform();
     }
@@ -1078,6 +1085,7 @@ public:
      * @param vec   the non-uniform scaling factor.
      */
     void setScale(const Vec2& vec) {
+        if (_scale == vec) return;
         _scale = vec;
         if (!_useTransform) updateTransform();
     }
@@ -1094,6 +1102,7 @@ public:
      * @param sy    the y-axis scaling factor.
      */
     void setScale(float sx, float sy) {
+        if (_scale.x == sx && _scale.y == sy) return;
         _scale.set(sx,sy);
         if (!_useTransform) updateTransform();
     }
@@ -1119,6 +1128,7 @@ public:
      * @param angle the rotation angle of this node.
      */
     void setAngle(float angle) {
+        if (_angle == angle) return;
         _angle = angle;
         if (!_useTransform) updateTransform();
     }
@@ -1866,6 +1876,18 @@ public:
      */
     virtual void doLayout();
 
+    /**
+     * Marks the scene of this node as changed since it was last rendered.
+     *
+     * The attribute setters of a node call this method whenever they change
+     * the appearance of the node (e.g. its transform, color, visibility, or
+     * texture).  Actions change nodes through these setters, so a running
+     * action marks the scene as well.  A subclass with its own visual state
+     * should call this method when that state changes.  This method does
+     * nothing if the node is not in a scene.
+     */
+    void markDirty();
+
 private:
 #pragma mark -
 #pragma mark Internal Helpers
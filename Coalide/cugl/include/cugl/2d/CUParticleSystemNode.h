@@ -0,0 +1,306 @@
+//
+//  CUParticleSystemNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node for short-lived sprite particles,
+//  such as sparks, debris and smoke.  Instead of making an animation node for
+//  each effect, a game adds emitter types to a single particle system and
+//  bursts particles from them.
+//
+//  The particles of each emitter type are stored in pooled, contiguous arrays.
+//  They are updated four at a time with SIMD instructions where available, and
+//  all of the particles of an emitter type are drawn in a single fill call.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#ifndef __CU_PARTICLE_SYSTEM_NODE_H__
+#define __CU_PARTICLE_SYSTEM_NODE_H__
+
+#include <cugl/2d/CUNode.h>
+#include <cugl/renderer/CUTexture.h>
+#include <cugl/renderer/CUVertex.h>
+#include <vector>
+#include <random>
+
+/** The most particles an emitter type may hold (so indices fit in a short) */
+#define PARTICLE_MAX_CAPACITY   16384
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark ParticleSystemNode
+
+/**
+ * A scene graph node that draws pooled sprite particles.
+ *
+ * A particle system holds one or more emitter types.  Each emitter type has
+ * a texture (optionally a filmstrip), a particle lifetime and a range of
+ * initial speeds and angles.  Calling {@link burst} spawns particles of that
+ * type at a position in the coordinate space of this node.  The particles
+ * play the filmstrip once over their lifetime and then disappear.
+ *
+ * The particles are not nodes.  They are stored by emitter type in pooled
+ * arrays of floats, and are updated on the elapsed time with {@link update}.
+ * Each emitter type is drawn with a single fill of the sprite batch,
+ * however many particles are alive.
+ *
+ * The node itself has no content size.  It should be placed at the origin of
+ * the layer whose coordinates are passed to {@link burst}.
+ */
+class ParticleSystemNode : public Node {
+public:
+    /**
+     * The definition of an emitter type.
+     *
+     * This class is intended to be used as a struct.  The default values make
+     * particles that sit still for a quarter second with the whole texture.
+     */
+    class Emitter {
+    public:
+        /** The particle texture (nullptr for solid squares) */
+        std::shared_ptr<Texture> texture;
+        /** The number of rows in the filmstrip */
+        int rows;
+        /** The number of columns in the filmstrip */
+        int cols;
+        /** The number of frames in the filmstrip (0 for rows*cols) */
+        int frames;
+        /** The size of a particle (zero for the size of one frame) */
+        Size size;
+        /** The shortest particle lifetime in seconds */
+        float minLifetime;
+        /** The longest particle lifetime in seconds */
+        float maxLifetime;
+        /** The slowest initial particle speed */
+        float minSpeed;
+        /** The fastest initial particle speed */
+        float maxSpeed;
+        /** The smallest initial angle of motion, in radians */
+        float minAngle;
+        /** The largest initial angle of motion, in radians */
+        float maxAngle;
+        /** The constant acceleration of every particle */
+        Vec2 acceleration;
+        /** The color of a particle when it spawns */
+        Color4 startColor;
+        /** The color of a particle when it dies */
+        Color4 endColor;
+        /** The maximum number of live particles */
+        int capacity;
+
+        /**
+         * Creates an emitter definition with the default values.
+         */
+        Emitter() : rows(1), cols(1), frames(0), minLifetime(0.25f), maxLifetime(0.25f),
+        minSpeed(0), maxSpeed(0), minAngle(0), maxAngle(0),
+        startColor(Color4::WHITE), endColor(Color4::WHITE), capacity(256) { }
+    };
+
+protected:
+    /**
+     * The particles of one emitter type.
+     *
+     * The particle attributes are stored as separate arrays, padded to a
+     * multiple of four so that they can be updated with SIMD instructions.
+     */
+    class Pool {
+    public:
+        /** The emitter definition */
+        Emitter emitter;
+        /** The size of a particle */
+        Size size;
+        /** The number of frames in the filmstrip */
+        int frames;
+        /** The number of live particles */
+        int count;
+        /** The particle x-coordinates */
+        std::vector<float> px;
+        /** The particle y-coordinates */
+        std::vector<float> py;
+        /** The particle x-velocities */
+        std::vector<float> vx;
+        /** The particle y-velocities */
+        std::vector<float> vy;
+        /** The particle ages, as a fraction of their lifetime */
+        std::vector<float> age;
+        /** The reciprocal particle lifetimes */
+        std::vector<float> rate;
+    };
+
+    /** The particles of each emitter type */
+    std::vector<Pool> _pools;
+    /** The vertices of the emitter type being drawn */
+    std::vector<Vertex2> _vertices;
+    /** The quad indices shared by every emitter type */
+    std::vector<unsigned short> _indices;
+    /** The random generator for spawning particles */
+    std::minstd_rand _random;
+
+    /**
+     * Returns a random value in the range [min,max]
+     *
+     * @param min   The range minimum
+     * @param max   The range maximum
+     *
+     * @return a random value in the range [min,max]
+     */
+    float random(float min, float max);
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an empty particle system.
+     *
+     * You must initialize this node before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ParticleSystemNode() : Node() {
+        _name = "ParticleSystemNode";
+    }
+
+    /**
+     * Releases all resources allocated with this node.
+     *
+     * This will release, but not necessarily delete the emitter textures.
+     */
+    ~ParticleSystemNode() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed node can be safely reinitialized. All particles and emitter
+     * types are removed.
+     */
+    virtual void dispose() override;
+
+    /**
+     * Initializes a particle system with no emitter types.
+     *
+     * @return true if initialization was successful.
+     */
+    virtual bool init() override;
+
+    /**
+     * Returns a newly allocated particle system with no emitter types.
+     *
+     * @return a newly allocated particle system with no emitter types.
+     */
+    static std::shared_ptr<ParticleSystemNode> alloc() {
+        std::shared_ptr<ParticleSystemNode> node = std::make_shared<ParticleSystemNode>();
+        return (node->init() ? node : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Emitters
+    /**
+     * Adds an emitter type to this particle system.
+     *
+     * The capacity of the emitter is clamped to PARTICLE_MAX_CAPACITY. The
+     * arrays for the particles are allocated now, so bursting particles never
+     * allocates memory.
+     *
+     * @param emitter   The emitter definition
+     *
+     * @return the index of the new emitter type
+     */
+    int addEmitter(const Emitter& emitter);
+
+    /**
+     * Returns the number of emitter types in this particle system.
+     *
+     * @return the number of emitter types in this particle system.
+     */
+    size_t getEmitterCount() const { return _pools.size(); }
+
+    /**
+     * Returns the number of live particles of the given emitter type.
+     *
+     * @param emitter   The emitter index
+     *
+     * @return the number of live particles of the given emitter type.
+     */
+    int getParticleCount(int emitter) const { return _pools[emitter].count; }
+
+#pragma mark -
+#pragma mark Particles
+    /**
+     * Spawns particles of the given emitter type.
+     *
+     * The position is in the coordinate space of this node.  If the emitter
+     * is at capacity, the extra particles are dropped.
+     *
+     * @param emitter   The emitter index
+     * @param position  The spawn position
+     * @param count     The number of particles to spawn
+     */
+    void burst(int emitter, const Vec2& position, int count = 1);
+
+    /**
+     * Removes all live particles, but keeps the emitter types.
+     */
+    void clearParticles();
+
+    /**
+     * Advances every particle by the given elapsed time.
+     *
+     * Particles that reach the end of their lifetime are removed.
+     *
+     * @param dt    The elapsed time in seconds
+     */
+    void update(float dt);
+
+#pragma mark -
+#pragma mark Rendering
+    /**
+     * Draws the live particles via the given SpriteBatch.
+     *
+     * Each emitter type is drawn with a single fill call.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the Node color.
+     */
+    virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) override;
+
+private:
+    /** This macro disables the copy constructor (not allowed on scene graphs) */
+    CU_DISALLOW_COPY_AND_ASSIGN(ParticleSystemNode);
+};
+
+}
+
+#endif /* __CU_PARTICLE_SYSTEM_NODE_H__ */
@@ -77,6 +77,10 @@ protected:
     bool _zDirty;
     /** Indicates whether auto-sorting is active */
     bool _zSort;
+    /** Indicates whether a node has changed since the last render */
+    bool _dirty;
+    /** The camera matrix of the last render */
+    Mat4 _rendered;
   
     /** The blending equation for this scene */
     GLenum _blendEquation;
@@ -322,7 +326,9 @@ public:
      *
      * @parm color  The tint color for this scene.
      */
-    void setColor(Color4 color) { _color = color; }
+    void setColor(Color4 color) {
+        if (_color != color) { _color = color; _dirty = true; }
+    }
     
     /**
      * Returns a string representation of this scene for debugging purposes.
@@ -858,6 +864,34 @@ public:
      */
     void sortZOrder();
     
+#pragma mark -
+#pragma mark Redrawing
+    /**
+     * Returns true if this scene has changed since it was last rendered.
+     *
+     * A scene changes whenever a node in it changes its transform, color,
+     * visibility, or texture, whenever a node is added or removed, and
+     * whenever the camera moves.  Nodes report their own changes with
+     * {@link Node#markDirty}.  If this value is false, the last render is
+     * still correct, so an application may skip drawing the frame.
+     *
+     * A scene is dirty when it is first created.
+     *
+     * @return true if this scene has changed since it was last rendered.
+     */
+    bool isDirty() const;
+
+    /**
+     * Sets whether this scene has changed since it was last rendered.
+     *
+     * Rendering the scene resets this value to false.  Set it to true to
+     * force the next frame to redraw (e.g. when a node changes in a way that
+     * its setters cannot detect).
+     *
+     * @param value Whether this scene has changed since it was last rendered.
+     */
+    void setDirty(bool value) { _dirty = value; }
+
 #pragma mark -
 #pragma mark Scene Logic
     /**
@@ -901,7 +935,7 @@ public:
      *
      * @param batch     The SpriteBatch to draw with.
      */
-    void render(const std::shared_ptr<SpriteBatch>& batch);
+    virtual void render(const std::shared_ptr<SpriteBatch>& batch);
     
 private:
 #pragma mark -
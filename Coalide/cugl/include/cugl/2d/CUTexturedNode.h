@@ -449,7 +449,9 @@ public:
      * @param srcFactor Specifies how the source blending factors are computed
      * @param dstFactor Specifies how the destination blending factors are computed.
      */
-    void setBlendFunc(GLenum srcFactor, GLenum dstFactor) { _srcFactor = srcFactor; _dstFactor = dstFactor; }
+    void setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
+        _srcFactor = srcFactor; _dstFactor = dstFactor; markDirty();
+    }
     
     /**
      * Returns the source blending factor
@@ -494,7 +496,7 @@ public:
      *
      * @param equation  Specifies how source and destination colors are combined
      */
-    void setBlendEquation(GLenum equation) { _blendEquation = equation; }
+    void setBlendEquation(GLenum equation) { _blendEquation = equation; markDirty(); }
     
     /**
      * Returns the blending equation for this textured node
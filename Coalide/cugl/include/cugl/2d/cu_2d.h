@@ -37,6 +37,7 @@
 #include "CUWireNode.h"
 #include "CUNinePatch.h"
 #include "CUAnimationNode.h"
+#include "CUParticleSystemNode.h"
 #include "CULabel.h"
 #include "CUButton.h"
 #include "CUProgressBar.h"
@@ -133,6 +133,24 @@ public:
      * pre-maturely.
      */
     virtual ~ComplexObstacle();
+    
+    using Obstacle::init;
+    
+    /**
+     * Initializes a new complex physics object at the given point
+     *
+     * A complex obstacle is always updated by its world, as its children may
+     * move or change shape while the root body is static or asleep.
+     *
+     * @param  vec  Initial position in world coordinates
+     *
+     * @return  true if the obstacle is initialized properly, false otherwise.
+     */
+    virtual bool init(const Vec2& vec) override {
+        bool success = Obstacle::init(vec);
+        _alwaysUpdated = true;
+        return success;
+    }
  
     
 #pragma mark -
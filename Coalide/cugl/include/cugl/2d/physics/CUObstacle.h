@@ -83,6 +83,10 @@ protected:
     b2MassData _massdata;
     /** Whether or not to use the custom mass data */
     bool _masseffect;
+    /** Whether this body is slowed by the surface friction of the world */
+    bool _grounded;
+    /** Whether the world updates this obstacle every step, even if it did not move */
+    bool _alwaysUpdated;
     
     /** The wireframe parent for debugging. */
     std::shared_ptr<Node> _scene;
@@ -124,6 +128,16 @@ private:
     /** Whether the object has changed shape and needs a new fixture */
     bool _dirty;
     
+    /// Track world membership (managed by ObstacleWorld)
+    /** The position of this object in its world (-1 if not in a world) */
+    int _worldIndex;
+    /** The position of this object in the always updated list of its world (-1 if none) */
+    int _alwaysIndex;
+    /** The last world step that updated this object */
+    Uint64 _updateStep;
+    
+    friend class ObstacleWorld;
+    
 
 #pragma mark -
 #pragma mark Constructors
@@ -553,6 +567,63 @@ public:
      */
     virtual void setAngularDamping(float value) { _bodyinfo.angularDamping = value; }
     
+    /**
+     * Returns true if this body is slowed by the surface friction of the world.
+     *
+     * In a top-down game, bodies slide over the ground. If the ObstacleWorld
+     * has a surface friction grid, each step applies the friction of the cell
+     * under a grounded body to that body.  Bodies that are not grounded (such
+     * as projectiles) are unaffected by the grid.
+     *
+     * @return true if this body is slowed by the surface friction of the world.
+     */
+    bool isGrounded() const { return _grounded; }
+    
+    /**
+     * Sets whether this body is slowed by the surface friction of the world.
+     *
+     * In a top-down game, bodies slide over the ground. If the ObstacleWorld
+     * has a surface friction grid, each step applies the friction of the cell
+     * under a grounded body to that body.  Bodies that are not grounded (such
+     * as projectiles) are unaffected by the grid.
+     *
+     * Clearing this flag removes any surface friction from the body.
+     *
+     * @param value whether this body is slowed by the surface friction of the world.
+     */
+    void setGrounded(bool value);
+    
+    /**
+     * Returns true if the world updates this obstacle every step.
+     *
+     * After each step, an {@link ObstacleWorld} only calls {@link update} on
+     * the obstacles whose bodies moved.  Sleeping and static obstacles are
+     * skipped, as their scene graph nodes are already in place.  Obstacles that
+     * keep timers or other state in update should set this flag, so that they
+     * are updated even when their body is asleep.
+     *
+     * @return true if the world updates this obstacle every step.
+     */
+    bool isAlwaysUpdated() const { return _alwaysUpdated; }
+    
+    /**
+     * Sets whether the world updates this obstacle every step.
+     *
+     * After each step, an {@link ObstacleWorld} only calls {@link update} on
+     * the obstacles whose bodies moved.  Sleeping and static obstacles are
+     * skipped, as their scene graph nodes are already in place.  Obstacles that
+     * keep timers or other state in update should set this flag, so that they
+     * are updated even when their body is asleep.
+     *
+     * This flag must be set before the obstacle is added to a world.
+     *
+     * @param value whether the world updates this obstacle every step.
+     */
+    void setAlwaysUpdated(bool value) {
+        CUAssertLog(_worldIndex < 0, "Obstacle is already in a world");
+        _alwaysUpdated = value;
+    }
+    
     /**
      * Copies the state from the given body to the body def.
      *
@@ -806,9 +877,12 @@ public:
      * collisions to complete before they are reset.  Shapes (and their properties)
      * are reset in the update method.
      *
+     * As a world only updates the obstacles that moved, a dirty obstacle is
+     * marked as moved so that its shape is reset on the next step.
+     *
      * @param value  whether the shape information must be updated.
      */
-    void markDirty(bool value) { _dirty = value; }
+    void markDirty(bool value);
     
 #pragma mark -
 #pragma mark Physics Methods
@@ -858,6 +932,9 @@ public:
      * In other words, this is the method that updates the scene graph.  If you
      * forget to call it, it will not draw your changes.
      *
+     * An {@link ObstacleWorld} only calls this method when the body moved,
+     * unless the obstacle is {@link isAlwaysUpdated}.
+     *
      * @param delta Timing values from parent loop
      */
     virtual void update(float delta) {
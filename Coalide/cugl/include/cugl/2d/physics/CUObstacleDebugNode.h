@@ -0,0 +1,156 @@
+//
+//  CUObstacleDebugNode.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that draws the debug data of an
+//  ObstacleWorld (shapes, AABBs, joints, contacts and the broad-phase).  It
+//  replaces the old approach of giving every obstacle its own wireframe node,
+//  which had to be rebuilt whenever an obstacle changed.  The node has no
+//  state of its own; it asks the world for the debug data each frame and
+//  draws it all as one batch of lines.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#ifndef __CU_OBSTACLE_DEBUG_NODE_H__
+#define __CU_OBSTACLE_DEBUG_NODE_H__
+
+#include <cugl/2d/CUNode.h>
+#include <cugl/2d/physics/CUObstacleWorld.h>
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark ObstacleDebugNode
+
+/**
+ * A scene graph node that draws the debug data of an ObstacleWorld.
+ *
+ * The node draws in physics coordinates.  Scale it (or one of its ancestors)
+ * by the drawing scale of the world, the same as a debug node for obstacle
+ * wireframes.  The categories of debug data are chosen with
+ * {@link ObstacleWorld#setDebugFlags}.
+ *
+ * Hiding this node skips the debug drawing entirely, so there is no cost to
+ * leaving it in the scene graph.
+ */
+class ObstacleDebugNode : public Node {
+protected:
+    /** The world to draw */
+    std::shared_ptr<ObstacleWorld> _world;
+    
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates a debug node with no world.
+     *
+     * You must initialize this node before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ObstacleDebugNode() : Node() {
+        _name = "ObstacleDebugNode";
+    }
+    
+    /**
+     * Releases all resources allocated with this node.
+     *
+     * This will release, but not necessarily delete the world.
+     */
+    ~ObstacleDebugNode() { dispose(); }
+    
+    /**
+     * Disposes all of the resources used by this node.
+     *
+     * A disposed node can be safely reinitialized. The world is released.
+     */
+    virtual void dispose() override;
+    
+    /**
+     * Initializes a debug node for the given world.
+     *
+     * @param world The world to draw
+     *
+     * @return true if initialization was successful.
+     */
+    bool initWithWorld(const std::shared_ptr<ObstacleWorld>& world);
+    
+    /**
+     * Returns a newly allocated debug node for the given world.
+     *
+     * @param world The world to draw
+     *
+     * @return a newly allocated debug node for the given world.
+     */
+    static std::shared_ptr<ObstacleDebugNode> allocWithWorld(const std::shared_ptr<ObstacleWorld>& world) {
+        std::shared_ptr<ObstacleDebugNode> node = std::make_shared<ObstacleDebugNode>();
+        return (node->initWithWorld(world) ? node : nullptr);
+    }
+    
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the world drawn by this node.
+     *
+     * @return the world drawn by this node.
+     */
+    const std::shared_ptr<ObstacleWorld>& getWorld() const { return _world; }
+    
+    /**
+     * Sets the world drawn by this node.
+     *
+     * @param world The world to draw
+     */
+    void setWorld(const std::shared_ptr<ObstacleWorld>& world) { _world = world; }
+    
+#pragma mark -
+#pragma mark Rendering
+    /**
+     * Draws the debug data of the world via the given SpriteBatch.
+     *
+     * @param batch     The SpriteBatch to draw with.
+     * @param transform The global transformation matrix.
+     * @param tint      The tint to blend with the Node color.
+     */
+    virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) override;
+    
+private:
+    /** This macro disables the copy constructor (not allowed on scene graphs) */
+    CU_DISALLOW_COPY_AND_ASSIGN(ObstacleDebugNode);
+};
+
+}
+
+#endif /* __CU_OBSTACLE_DEBUG_NODE_H__ */
@@ -46,14 +46,20 @@
 #define __CU_PHYSICS_WORLD_H__
 
 #include <vector>
+#include <memory>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <cugl/math/cu_math.h>
+#include <cugl/renderer/CUVertex.h>
 class b2World;
 
 namespace cugl {
 
 // Forward declaration of the Obstacle class
 class Obstacle;
+// Forward declaration of the thread pool
+class ThreadPool;
+// Forward declaration of the sprite batch
+class SpriteBatch;
 
 /** Default amount of time for a physics engine step. */
 #define DEFAULT_WORLD_STEP  1/60.0f
@@ -77,7 +83,31 @@ class Obstacle;
  * closures assigned to attributes.  This allows you to modify the callback 
  * functions while the program is running.
  */
-class ObstacleWorld : public b2ContactListener, b2DestructionListener, b2ContactFilter {
+class ObstacleWorld : public b2ContactListener, b2DestructionListener, b2ContactFilter, b2TaskScheduler {
+public:
+    /**
+     * The categories of physics debug data.
+     *
+     * These values match the flags of b2Draw, and may be combined with a
+     * bitwise or.
+     */
+    enum DebugFlags {
+        /** The outline of every fixture, colored by body state */
+        DEBUG_SHAPES    = 0x0001,
+        /** The joint connections */
+        DEBUG_JOINTS    = 0x0002,
+        /** The fat AABB of every fixture proxy */
+        DEBUG_AABBS     = 0x0004,
+        /** The broad-phase pairs (unused by Box2D) */
+        DEBUG_PAIRS     = 0x0008,
+        /** The center of mass frame of every body */
+        DEBUG_CENTERS   = 0x0010,
+        /** The points of every touching contact */
+        DEBUG_CONTACTS  = 0x0020,
+        /** The broad-phase structure (tree nodes or occupied grid cells) */
+        DEBUG_BROADPHASE = 0x0040
+    };
+
 protected:
     /** Reference to the Box2D world */
     b2World* _world;
@@ -92,12 +122,27 @@ protected:
     /** The current gravitational value of the world */
     Vec2 _gravity;
     
-    /** The list of objects in this world */
+    /** The list of objects in this world (in no particular order) */
     std::vector<std::shared_ptr<Obstacle>> _objects;
+    /** The objects updated every step, even if they did not move */
+    std::vector<Obstacle*> _alwaysUpdated;
+    /** The objects that moved in the last step (scratch space for update) */
+    std::vector<Obstacle*> _moved;
+    /** The number of steps taken, used to update each object at most once a step */
+    Uint64 _stepCount;
     
     /** The boundary of the world */
     Rect _bounds;
     
+    /** The surface friction of each grid cell, row-major from the bounds origin */
+    std::vector<float> _surface;
+    /** The number of columns in the surface friction grid */
+    int _surfaceCols;
+    /** The number of rows in the surface friction grid */
+    int _surfaceRows;
+    /** The width and height of a surface friction cell */
+    float _surfaceSize;
+    
     /** Whether or not to activate the collision listener */
     bool _collide;
     /** Whether or not to activate the filter listener */
@@ -105,6 +150,28 @@ protected:
     /** Whether or not to activate the destruction listener */
     bool _destroy;
     
+    /** The thread pool for solving islands in parallel (may be nullptr) */
+    std::shared_ptr<ThreadPool> _solverThreads;
+    
+    /** The categories of debug data to draw */
+    Uint32 _debugFlags;
+    /** The debug line segments of the current frame (two vertices each) */
+    std::vector<Vertex2> _debugLines;
+    /** The line indices, which are the identity for every batch */
+    std::vector<unsigned short> _debugIndices;
+    
+    /**
+     * Removes the obstacle at the given position from the object lists.
+     *
+     * The last obstacle is swapped into its place, so this takes constant time.
+     * This method does not deactivate the physics of the obstacle.
+     *
+     * @param index The position of the obstacle in the object list
+     *
+     * @release a reference to the obstacle
+     */
+    void detachObstacle(size_t index);
+    
     
 #pragma mark -
 #pragma mark Constructors
@@ -162,6 +229,28 @@ public:
      */
     bool init(const Rect& bounds, const Vec2& gravity);
 
+    /**
+     * Initializes a new physics world with a uniform grid broadphase
+     *
+     * The specified bounds are in terms of the Box2d world, not the screen.
+     * A few attached to this Box2d world should have ways to convert between
+     * the coordinate systems.
+     *
+     * By default, Box2d finds collision pairs with a dynamic AABB tree. If
+     * cellSize is positive, this world will instead use a uniform grid of
+     * that cell size covering the bounds.  The grid is much cheaper to update
+     * when the world is bounded and every obstacle is about a cell in size,
+     * as in a tile-based level.  Obstacles outside of the bounds still collide,
+     * but they share the border cells.
+     *
+     * @param  bounds   The game bounds in Box2d coordinates
+     * @param  gravity  The gravitational force on this Box2d world
+     * @param  cellSize The broadphase cell size (0 for the dynamic tree)
+     *
+     * @return  true if the controller is initialized properly, false otherwise.
+     */
+    bool init(const Rect& bounds, const Vec2& gravity, float cellSize);
+
     
 #pragma mark -
 #pragma mark Static Constructors
@@ -200,6 +289,31 @@ public:
         return (result->init(bounds,gravity) ? result : nullptr);
     }
 
+    /**
+     * Returns a newly allocated physics world with a uniform grid broadphase
+     *
+     * The specified bounds are in terms of the Box2d world, not the screen.
+     * A few attached to this Box2d world should have ways to convert between
+     * the coordinate systems.
+     *
+     * By default, Box2d finds collision pairs with a dynamic AABB tree. If
+     * cellSize is positive, this world will instead use a uniform grid of
+     * that cell size covering the bounds.  The grid is much cheaper to update
+     * when the world is bounded and every obstacle is about a cell in size,
+     * as in a tile-based level.  Obstacles outside of the bounds still collide,
+     * but they share the border cells.
+     *
+     * @param  bounds   The game bounds in Box2d coordinates
+     * @param  gravity  The gravitational force on this Box2d world
+     * @param  cellSize The broadphase cell size (0 for the dynamic tree)
+     *
+     * @return a newly allocated physics world
+     */
+    static std::shared_ptr<ObstacleWorld> alloc(const Rect& bounds, const Vec2& gravity, float cellSize) {
+        std::shared_ptr<ObstacleWorld> result = std::make_shared<ObstacleWorld>();
+        return (result->init(bounds,gravity,cellSize) ? result : nullptr);
+    }
+
     
 #pragma mark -
 #pragma mark Physics Handling
@@ -316,6 +430,11 @@ public:
      * physics.  The primary method is the step() method in world.  This implementation
      * works for all applications and should not need to be overwritten.
      *
+     * After the step, this method calls {@link Obstacle#update} only on the
+     * obstacles whose bodies moved (or were added, reshaped or teleported),
+     * along with those that are {@link Obstacle#isAlwaysUpdated}.  Sleeping
+     * and static obstacles cost nothing.
+     *
      * @param dt Number of seconds since last animation frame
      */
     void update(float dt);
@@ -344,6 +463,9 @@ public:
     /**
      * Returns a read-only reference to the list of active obstacles.
      *
+     * Obstacles are removed by swapping the last obstacle into their place,
+     * so this list is in no particular order.
+     *
      * @return a read-only reference to the list of active obstacles.
      */
     const std::vector<std::shared_ptr<Obstacle>>& getObstacles() { return _objects; }
@@ -367,10 +489,11 @@ public:
      * Immediately removes an obstacle from the physics world
      *
      * The obstacle will be released immediately. The physics will be deactivated
-     * and it will be removed from the Box2D world. This method of removing 
-     * objects is very heavy weight, and should only be used for single object 
-     * removal.  If you want to remove multiple objects, then you should mark 
-     * them for removal and call garbageCollect.
+     * and it will be removed from the Box2D world. Finding the obstacle takes
+     * constant time, but destroying its body is still heavy weight, so this
+     * should only be used for single object removal.  If you want to remove
+     * multiple objects, then you should mark them for removal and call
+     * garbageCollect.
      *
      * Removing an obstacle does not automatically delete the obstacle itself.
      * However, this world releases ownership, which may lead to it being
@@ -692,6 +815,156 @@ public:
     }
 
 
+#pragma mark -
+#pragma mark Surface Friction
+    /**
+     * Resets the surface friction grid to the given size.
+     *
+     * In a top-down game, the ground resists the motion of the bodies on it.
+     * This grid divides the world (starting at the origin of the bounds) into
+     * square cells, each with its own friction.  Before each step, every
+     * {@link Obstacle#isGrounded()} obstacle receives the friction of the cell
+     * under its position. Friction is the maximum force (and torque) applied
+     * against the motion of the obstacle.  All cells start with no friction.
+     *
+     * A grid with no cells disables surface friction.
+     *
+     * @param  cols the number of columns in the grid
+     * @param  rows the number of rows in the grid
+     * @param  size the width and height of a cell
+     */
+    void setSurfaceGrid(int cols, int rows, float size=1.0f);
+    
+    /**
+     * Returns the surface friction of the given grid cell.
+     *
+     * Cells outside of the grid have no friction.
+     *
+     * @param  col  the grid column
+     * @param  row  the grid row
+     *
+     * @return the surface friction of the given grid cell.
+     */
+    float getSurfaceFriction(int col, int row) const {
+        if (col < 0 || row < 0 || col >= _surfaceCols || row >= _surfaceRows) {
+            return 0.0f;
+        }
+        return _surface[row*_surfaceCols+col];
+    }
+    
+    /**
+     * Returns the surface friction at the given position.
+     *
+     * Positions outside of the grid have no friction.
+     *
+     * @param  pos  the position in Box2d coordinates
+     *
+     * @return the surface friction at the given position.
+     */
+    float getSurfaceFriction(const Vec2& pos) const;
+    
+    /**
+     * Sets the surface friction of the given grid cell.
+     *
+     * Friction is the maximum force (and torque) applied against the motion of
+     * an obstacle in this cell.
+     *
+     * @param  col      the grid column
+     * @param  row      the grid row
+     * @param  friction the surface friction
+     */
+    void setSurfaceFriction(int col, int row, float friction);
+
+
+#pragma mark -
+#pragma mark Parallel Solving
+    /**
+     * Sets the thread pool used to solve the physics islands.
+     *
+     * An island is a group of obstacles that touch (or are joined), either
+     * directly or through other obstacles.  Islands that only meet at static
+     * obstacles are independent, and can be solved at the same time.  When
+     * this pool is set, each step solves those islands on the pool workers
+     * (and the calling thread).  The results are applied in the same order
+     * as the serial solver, so the simulation is unchanged.
+     *
+     * The collision callbacks are still called on the thread that calls
+     * {@link update}.  Setting this value to nullptr solves every island on
+     * the calling thread.  This method may not be called during a step.
+     *
+     * @param  pool the thread pool for solving islands
+     */
+    void setSolverThreads(const std::shared_ptr<ThreadPool>& pool);
+    
+    /**
+     * Returns the thread pool used to solve the physics islands.
+     *
+     * If this value is nullptr, every island is solved on the thread that
+     * calls {@link update}.
+     *
+     * @return the thread pool used to solve the physics islands.
+     */
+    const std::shared_ptr<ThreadPool>& getSolverThreads() const { return _solverThreads; }
+    
+    /**
+     * Returns the number of threads that may solve islands at once.
+     *
+     * This is the number of pool workers, plus the thread calling {@link update}.
+     *
+     * @return the number of threads that may solve islands at once.
+     */
+    int32 GetParallelism() override;
+    
+    /**
+     * Executes the task count times, and returns when they are all done.
+     *
+     * The executions are spread over the solver threads.
+     *
+     * @param  task     the task to execute
+     * @param  count    the number of executions
+     */
+    void Run(b2Task* task, int32 count) override;
+
+
+#pragma mark -
+#pragma mark Debug Drawing
+    /**
+     * Returns the categories of debug data drawn by {@link drawDebug}.
+     *
+     * The value is a bitwise or of {@link DebugFlags}.
+     *
+     * @return the categories of debug data drawn by {@link drawDebug}.
+     */
+    Uint32 getDebugFlags() const { return _debugFlags; }
+    
+    /**
+     * Sets the categories of debug data drawn by {@link drawDebug}.
+     *
+     * The value is a bitwise or of {@link DebugFlags}.  By default, only the
+     * shapes are drawn.
+     *
+     * @param flags The categories of debug data to draw
+     */
+    void setDebugFlags(Uint32 flags) { _debugFlags = flags; }
+    
+    /**
+     * Draws the debug data of this world as lines with the given batch.
+     *
+     * The data comes straight from the Box2D world each call, so there is
+     * no per-obstacle state to keep up to date.  All of the lines are drawn
+     * in as few outline calls as possible (one unless there are more than
+     * 32K segments).
+     *
+     * The transform maps physics coordinates to the coordinates of the batch.
+     * The batch must be active.
+     *
+     * @param batch     The SpriteBatch to draw with
+     * @param transform The transform from physics coordinates
+     * @param tint      The color to multiply with the debug colors
+     */
+    void drawDebug(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint=Color4::WHITE);
+    
+    
 #pragma mark -
 #pragma mark Query Functions
     /**
@@ -37,5 +37,6 @@
 #include "CUPolygonObstacle.h"
 #include "CUCapsuleObstacle.h"
 #include "CUObstacleSelector.h"
+#include "CUObstacleDebugNode.h"
 
 #endif /* __CU_PHYSICS_PKG_H__ */
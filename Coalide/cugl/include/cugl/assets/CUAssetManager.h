@@ -422,6 +422,18 @@ public:
      */
     size_t waitCount() const;
     
+    /**
+     * Returns the approximate memory used by the loaded assets in bytes.
+     *
+     * The value returned is the sum of the memory usage for all attached
+     * loaders.  Only the textures and font atlases are measured, as they
+     * are the bulk of the (GPU) memory of a game.  This method must be
+     * called on the main thread.
+     *
+     * @return the approximate memory used by the loaded assets in bytes.
+     */
+    size_t getMemoryUsage() const;
+    
     /**
      * Returns true if the loader has finished loading all assets.
      *
@@ -487,6 +487,16 @@ public:
      * @param charset   The default atlas character set
      */
     void setCharacterSet(const std::string& charset) { _charset = charset; }
+    
+    /**
+     * Returns the approximate GPU memory used by the loaded font atlases in bytes.
+     *
+     * Fonts without an atlas render each string to its own texture, and those
+     * textures are not counted.  This method must be called on the main thread.
+     *
+     * @return the approximate GPU memory used by the loaded font atlases in bytes.
+     */
+    size_t getMemoryUsage() const override;
 };
 
 }
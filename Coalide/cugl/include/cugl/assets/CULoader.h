@@ -680,6 +680,20 @@ public:
      */
     virtual size_t waitCount() const { return 0; }
     
+    /**
+     * Returns the approximate memory used by the loaded assets in bytes.
+     *
+     * This is a rough way to measure the cost of the loaded assets. Loaders
+     * should count the memory that they can measure cheaply (such as the
+     * GPU memory of a texture), and ignore the rest.
+     *
+     * This method is abstract and should be overridden in child classes to
+     * support the appropriate asset type.
+     *
+     * @return the approximate memory used by the loaded assets in bytes.
+     */
+    virtual size_t getMemoryUsage() const { return 0; }
+    
     /**
      * Returns true if the loader has finished loading all assets.
      *
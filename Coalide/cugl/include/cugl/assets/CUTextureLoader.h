@@ -405,6 +405,12 @@ public:
      */
     void setMipMaps(bool flag) { _mipmaps = flag; }
 
+    /**
+     * Returns the approximate GPU memory used by the loaded textures in bytes.
+     *
+     * @return the approximate GPU memory used by the loaded textures in bytes.
+     */
+    size_t getMemoryUsage() const override;
 };
 
 }
@@ -41,6 +41,7 @@
 #include <cugl/audio/CUSound.h>
 #include <cugl/audio/CUMusic.h>
 #include <cugl/util/CUTimestamp.h>
+#include <cugl/util/CUDebug.h>
 #include <functional>
 #include <unordered_map>
 #include <vector>
@@ -52,6 +53,12 @@
 #define AUDIO_OUTPUT_CHANNELS 2
 /** The default sampling frequency */
 #define AUDIO_FREQUENCY 44100
+/** The number of volume buses for sound cues */
+#define AUDIO_BUS_COUNT 4
+/** The default memory budget (in bytes) of the sound cache */
+#define AUDIO_CACHE_BUDGET      (16*1024*1024)
+/** The default size (in bytes) of the largest sound in the cache */
+#define AUDIO_CACHE_THRESHOLD   (1024*1024)
 
 /** Comment this out to use SDL sound on Mac/iOS (not recommended) */
 #if defined (__MACOSX__) || defined (__IPHONEOS__)
@@ -65,6 +72,8 @@ namespace cugl {
 class SoundChannel;
 /** Opaque reference to "hidden" package class for the music queue */
 class MusicQueue;
+/** Opaque reference to "hidden" package class for the sound cache */
+class SoundCache;
     
 /**
  * Class provides a singleton audio engine
@@ -77,7 +86,9 @@ class MusicQueue;
  * allow you to queue up music asset.  All other sounds should be preloaded.
  * The user specifies sound instances (there may be may sound instances for
  * a single asset) by a predefined key.  This cuts down on the overhead of 
- * managing the sound identifier. 
+ * managing the sound identifier.  Sounds that are triggered frequently should
+ * instead be registered as cues, which are played by integer id and return
+ * integer voice handles {@see registerCue}.
  *
  * You cannot create new instances of this class.  Instead, you should access 
  * the singleton through the three static methods: start(), stop() and get().
@@ -112,6 +123,8 @@ private:
     
     /** The queue for handling music assets */
     std::shared_ptr<MusicQueue> _mqueue;
+    /** The shared cache of decoded sound buffers */
+    std::shared_ptr<SoundCache> _cache;
     
     /** The number of supported audio channels */
     unsigned int _capacity;
@@ -122,6 +135,40 @@ private:
     /** The queue for subsequent sound loops */
     std::deque<std::string> _equeue;
     
+    /**
+     * A preloaded sound registered for handle-based playback.
+     *
+     * The cue tracks its own active voices so that instance limits can be
+     * enforced without any key lookups.
+     */
+    typedef struct Cue {
+        /** The sound asset for this cue (nullptr if the slot is free) */
+        std::shared_ptr<Sound> sound;
+        /** The maximum number of simultaneous voices for this cue */
+        unsigned int limit;
+        /** The priority of the voices of this cue (higher is more important) */
+        int priority;
+        /** The volume bus of this cue */
+        unsigned int bus;
+        /** The number of voices of this cue currently active */
+        unsigned int active;
+    } Cue;
+    
+    /** The registered cues, indexed by cue id */
+    std::vector<Cue> _cues;
+    /** The voice handle active on each channel (0 if none) */
+    std::vector<Uint32> _voices;
+    /** The cue of the voice active on each channel (-1 if none) */
+    std::vector<int> _voiceCues;
+    /** The volume (before the bus volume) of the voice on each channel */
+    std::vector<float> _voiceVolumes;
+    /** The volume of each bus */
+    float _buses[AUDIO_BUS_COUNT];
+    /** The number of channels currently holding an active voice */
+    unsigned int _voiceCount;
+    /** The serial number for the next voice handle */
+    Uint32 _voiceSerial;
+    
     /** 
      * Callback function for background music
      *
@@ -155,7 +202,11 @@ private:
      *
      * The engine must be initialized before is can be used.
      */
-    AudioEngine() : _capacity(0) {}
+    AudioEngine() : _capacity(0), _voiceCount(0), _voiceSerial(1) {
+        for(int ii = 0; ii < AUDIO_BUS_COUNT; ii++) {
+            _buses[ii] = 1.0f;
+        }
+    }
     
     /**
      * Disposes of the singleton audio engine.
@@ -199,6 +250,45 @@ private:
      */
     void removeKey(std::string key);
     
+    /**
+     * Returns the channel for the given voice handle, or -1 if it is not active.
+     *
+     * A voice handle encodes its channel, so this is a constant time check.
+     * Handles of voices that have completed (or were stopped) are stale and
+     * return -1, even if the channel has since been reused.
+     *
+     * @param voice The voice handle
+     *
+     * @return the channel for the given voice handle, or -1 if it is not active.
+     */
+    int getVoiceChannel(Uint32 voice) const {
+        if (voice == 0 || _capacity == 0) {
+            return -1;
+        }
+        int id = (int)(voice % _capacity);
+        return _voices[id] == voice ? id : -1;
+    }
+    
+    /**
+     * Purges the voice on the given channel from the list of active voices.
+     *
+     * This method is the voice equivalent of {@link removeKey}.  It does not
+     * stop the channel; it only releases the voice from its cue.
+     *
+     * @param id    The channel of the voice to purge
+     */
+    void removeVoice(int id);
+    
+    /**
+     * Stops the voice on the given channel and purges it.
+     *
+     * A voice that is still waiting in the shadow of a stopped sound is swapped
+     * in first, as a channel can only stop its primary sound.
+     *
+     * @param id    The channel of the voice to stop
+     */
+    void haltVoice(int id);
+    
     
 #pragma mark -
 #pragma mark Static Accessors
@@ -617,7 +707,7 @@ public:
      * @return the number of channels available for sound effects.
      */
     size_t getAvailableChannels() const {
-        return (size_t)_capacity-_effects.size();
+        return (size_t)_capacity-_effects.size()-_voiceCount;
     }
     
     /**
@@ -1074,6 +1164,223 @@ public:
     void gcEffect(int id, bool status);
     
     
+#pragma mark -
+#pragma mark Sound Cues
+    /**
+     * Registers a preloaded sound as a cue, returning the cue id.
+     *
+     * Cues are an alternative to key-based sound effects for sounds that are
+     * triggered often, such as collision sounds.  A cue is registered once,
+     * and every call to {@link playCue} returns a lightweight integer voice
+     * handle.  Neither playing a cue nor querying a voice allocates strings
+     * or performs any map lookups.
+     *
+     * The limit is the maximum number of voices of this cue that may play at
+     * the same time.  This limit is enforced by the engine, so the application
+     * does not need to check whether the sound is already playing.
+     *
+     * The priority decides which voices are sacrificed when there are too
+     * many sounds.  When every channel is busy, a new voice steals the channel
+     * of the lowest priority voice, provided that voice has a lower priority
+     * than the new one.  Mixing backends with a time budget also drop the
+     * lowest priority voices first.  Key-based sound effects have priority 0.
+     *
+     * The bus is the volume group of the cue {@see setBusVolume}.
+     *
+     * Cue ids are reused after {@link unregisterCue}.  This method returns -1
+     * if the sound is nullptr, the limit is 0, or the bus is out of range.
+     *
+     * @param sound     The sound asset for the cue
+     * @param limit     The maximum number of simultaneous voices for the cue
+     * @param priority  The voice priority (higher values are more important)
+     * @param bus       The volume bus for the cue
+     *
+     * @return the cue id (or -1 on failure)
+     */
+    int registerCue(const std::shared_ptr<Sound>& sound, unsigned int limit=1,
+                    int priority=0, unsigned int bus=0);
+    
+    /**
+     * Unregisters the given cue, stopping all of its voices.
+     *
+     * The cue id may be returned by a later call to {@link registerCue}.
+     *
+     * @param cue   The cue id
+     */
+    void unregisterCue(int cue);
+    
+    /**
+     * Plays a voice of the given cue, returning the voice handle.
+     *
+     * If the cue already has as many active voices as its limit, the voice
+     * will not play unless force is true.  In that case, it will stop the
+     * oldest voice of this cue and take its place.  If there are no available
+     * channels, this method steals the channel of the lowest priority voice
+     * (the oldest among equals) if that voice has a lower priority than this
+     * cue.  If force is true, it steals that channel regardless of priority.
+     * A cue never interrupts a key-based sound effect.
+     *
+     * A voice handle is never 0, so this method returns 0 if the voice could
+     * not be played.  Handles become stale when the voice completes or is
+     * stopped; every voice method is safe to call with a stale handle.
+     *
+     * @param  cue      The cue id
+     * @param  loop     Whether to loop the voice continuously
+     * @param  volume   The voice volume (< 0 to use asset default volume)
+     * @param  force    Whether to force another voice to stop.
+     *
+     * @return the voice handle (or 0 if the voice could not be played)
+     */
+    Uint32 playCue(int cue, bool loop=false, float volume=-1.0f, bool force=false);
+    
+    /**
+     * Returns the number of voices of the given cue currently active.
+     *
+     * @param cue   The cue id
+     *
+     * @return the number of voices of the given cue currently active.
+     */
+    unsigned int getCueActive(int cue) const {
+        CUAssertLog(cue >= 0 && cue < (int)_cues.size(), "Cue %d is out of range", cue);
+        return _cues[cue].active;
+    }
+    
+    /**
+     * Returns true if the voice handle refers to an active voice.
+     *
+     * @param  voice    the voice handle
+     *
+     * @return true if the voice handle refers to an active voice.
+     */
+    bool isActiveVoice(Uint32 voice) const {
+        return getVoiceChannel(voice) != -1;
+    }
+    
+    /**
+     * Returns the current state of the given voice.
+     *
+     * If the voice handle is stale, it returns State::INACTIVE.
+     *
+     * @param  voice    the voice handle
+     *
+     * @return the current state of the given voice.
+     */
+    State getVoiceState(Uint32 voice) const;
+    
+    /**
+     * Sets the current volume of the given voice.
+     *
+     * The volume is relative to the bus of the voice.  If the voice handle
+     * is stale, this method does nothing.
+     *
+     * @param  voice    the voice handle
+     * @param  volume   the current volume of the voice
+     */
+    void setVoiceVolume(Uint32 voice, float volume);
+    
+    /**
+     * Stops the given voice, releasing its channel.
+     *
+     * If the voice handle is stale, this method does nothing.
+     *
+     * @param  voice    the voice handle
+     */
+    void stopVoice(Uint32 voice);
+    
+    /**
+     * Returns the volume of the given bus.
+     *
+     * @param  bus      the bus index
+     *
+     * @return the volume of the given bus.
+     */
+    float getBusVolume(unsigned int bus) const {
+        CUAssertLog(bus < AUDIO_BUS_COUNT, "Bus %d is out of range", bus);
+        return _buses[bus];
+    }
+    
+    /**
+     * Sets the volume of the given bus.
+     *
+     * Every voice of a cue on this bus plays at its own volume times the
+     * bus volume.  The change applies to the active voices immediately.
+     *
+     * @param  bus      the bus index
+     * @param  volume   the bus volume (0 to 1)
+     */
+    void setBusVolume(unsigned int bus, float volume);
+    
+    
+#pragma mark -
+#pragma mark Sound Cache
+    /**
+     * Returns the memory budget (in bytes) of the sound cache.
+     *
+     * Sound assets for the same file share one decoded buffer.  Buffers
+     * stay in the cache after their sounds are released, so that they can
+     * be reused by the next level.  Unused buffers are freed (oldest first)
+     * whenever the cache exceeds this budget.
+     *
+     * @return the memory budget (in bytes) of the sound cache.
+     */
+    size_t getSoundBudget() const;
+    
+    /**
+     * Sets the memory budget (in bytes) of the sound cache.
+     *
+     * Sound assets for the same file share one decoded buffer.  Buffers
+     * stay in the cache after their sounds are released, so that they can
+     * be reused by the next level.  Unused buffers are freed (oldest first)
+     * whenever the cache exceeds this budget.
+     *
+     * @param bytes The memory budget (in bytes) of the sound cache
+     */
+    void setSoundBudget(size_t bytes);
+    
+    /**
+     * Returns the size (in bytes) of the largest sound in the cache.
+     *
+     * Sounds that decode to more than this are not cached.  Each such asset
+     * owns its buffer, and frees it when it is deleted.  Audio that long
+     * should generally be loaded as {@link Music}, which is streamed.
+     *
+     * @return the size (in bytes) of the largest sound in the cache.
+     */
+    size_t getSoundThreshold() const;
+    
+    /**
+     * Sets the size (in bytes) of the largest sound in the cache.
+     *
+     * Sounds that decode to more than this are not cached.  Each such asset
+     * owns its buffer, and frees it when it is deleted.  Audio that long
+     * should generally be loaded as {@link Music}, which is streamed.  This
+     * setting only applies to sounds loaded after the call.
+     *
+     * @param bytes The size (in bytes) of the largest sound in the cache
+     */
+    void setSoundThreshold(size_t bytes);
+    
+    /**
+     * Returns the memory (in bytes) of all the buffers in the sound cache.
+     *
+     * This includes unused buffers that have not been freed yet, but not
+     * sounds over the cache threshold.
+     *
+     * @return the memory (in bytes) of all the buffers in the sound cache.
+     */
+    size_t getSoundMemory() const;
+    
+    /**
+     * Frees every buffer in the sound cache that is not in use.
+     *
+     * Call this after unloading a level to release its sounds immediately.
+     */
+    void purgeSounds();
+    
+    /** Allow sound assets access to the cache */
+    friend class Sound;
+    
+    
 #pragma mark -
 #pragma mark Global Management
     /**
@@ -65,6 +65,9 @@ namespace impl {
      */
     struct AudioBuffer;
 }
+
+/** The shared cache of decoded sound buffers */
+class SoundCache;
     
 /**
  * Class provides a reference to a pre-loaded asset.
@@ -78,6 +81,10 @@ namespace impl {
  * no cross-platform lossless encodings for both Androi and iOS.  For lossy
  * encodings, only OGG Vorbis is good enough for sound effects.
  *
+ * Sounds for the same file share a single buffer from the audio engine
+ * cache, so loading a file twice costs no extra memory.  Only buffers that
+ * fit the cache threshold are shared {@see AudioEngine#setSoundThreshold}.
+ *
  * The internal representation of the sound buffer is platform dependent.
  * You should never attempt to access the buffer directly.
  */
@@ -90,6 +97,8 @@ private:
     std::string  _source;
     /** The (platform-specific) data for the file */
     impl::AudioBuffer* _buffer;
+    /** The cache owning the buffer (nullptr if the buffer is not shared) */
+    std::shared_ptr<SoundCache> _cache;
     /** The default volume for this sound */
     float _volume;
     
@@ -122,6 +131,8 @@ public:
      *
      * The sound will be decompressed into PCM (e.g. WAV data) which is 
      * possibly large. This will be stored in a platform specific buffer.
+     * If another sound has already decompressed this file, this sound will
+     * share its buffer.
      *
      * @param  source   the source file for the sound
      *
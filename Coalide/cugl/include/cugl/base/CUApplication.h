@@ -34,6 +34,7 @@
 #ifndef __CU_APPLICATION_H__
 #define __CU_APPLICATION_H__
 #include <cugl/util/CUTimestamp.h>
+#include <cugl/util/CUFrameRecorder.h>
 #include <cugl/math/CUColor4.h>
 #include <cugl/math/CURect.h>
 #include <unordered_map>
@@ -43,6 +44,11 @@
 
 namespace cugl {
 
+/** Forward references */
+class RenderSnapshot;
+class ThreadPool;
+class WaitGroup;
+
 /**
  * The storage type for all user-defined callbacks.
  *
@@ -170,16 +176,55 @@ protected:
 
     
 private:
-    /** The millisecond equivalent of the FPS; used to delay the core loop */
-    unsigned int _delay;
+    /** The performance counter equivalent of the FPS; used to pace the core loop */
+    Uint64 _period;
+    /** The performance counter deadline for the end of the current frame */
+    Uint64 _deadline;
+    /** The number of display refreshes in a frame (0 if not a divisor of the refresh rate) */
+    int _swapInterval;
+    /** Whether the application should synchronize buffer swaps with the display */
+    bool _vsync;
+    /** Whether the buffer swap paces the frames (so the application need not) */
+    bool _synced;
+    /** The target FPS when there is nothing to redraw */
+    float _idleFPS;
+    /** The performance counter equivalent of the idle FPS */
+    Uint64 _idlePeriod;
+    /** Whether the current frame has nothing to draw (and so is paced at the idle FPS) */
+    bool _idle;
+    /** Whether the window was exposed or resized, so the next frame must redraw */
+    bool _exposed;
     
     /** A window of moving averages to track the FPS */
     std::deque<float> _fpswindow;
+    /** A ring buffer of recent frame intervals (in seconds) */
+    std::vector<float> _intervals;
+    /** The next position in the ring buffer of frame intervals */
+    size_t _intervalNext;
+    /** The number of frame intervals recorded */
+    size_t _intervalCount;
+    /** The flight recorder of recent frame timings */
+    std::shared_ptr<FrameRecorder> _recorder;
+    
+    /** Whether update and draw run on a game thread, one frame ahead of present */
+    bool _pipelined;
+    /** The game thread (when pipelined) */
+    std::shared_ptr<ThreadPool> _pipeline;
+    /** The group to join the game thread at the end of a frame */
+    std::shared_ptr<WaitGroup> _pipelineGroup;
+    /** The snapshots recorded by draw and replayed by present, swapped each frame */
+    std::shared_ptr<RenderSnapshot> _snapshots[2];
+    /** The clear color of the snapshot to present */
+    Color4f _presentColor;
+    /** Whether draw recorded the latest snapshot (set on the game thread) */
+    bool _recorded;
+    /** Whether the snapshot to present has a frame */
+    bool _presenting;
 
-    /** The SDL timestamp for the start of an animation frame */
-    Uint32 _start;
-    /** The SDL timestamp for the end of an animation frame */
-    Uint32 _finish;
+    /** The performance counter for the start of an animation frame */
+    Uint64 _start;
+    /** The performance counter for the end of an animation frame */
+    Uint64 _finish;
     
     /** Counter to assign unique keys to callbacks */
     Uint32 _funcid;
@@ -199,6 +244,33 @@ private:
      */
     void processCallbacks(Uint32 millis);
     
+    /**
+     * Recomputes the frame period and the buffer swap interval.
+     *
+     * If the target FPS is close to the refresh rate of the display divided
+     * by a whole number, the FPS is snapped to that rate.  When vsync is on,
+     * the buffer swap then waits that many display refreshes.  Otherwise the
+     * application paces the frames itself.  It still keeps a swap interval of
+     * 1 in that case (such as an unknown refresh rate), so frames do not tear.
+     * Vsync is only turned off by {@link setVSync}.
+     */
+    void updatePacing();
+    
+    /**
+     * Waits until the end of the current frame.
+     *
+     * If the buffer swap is synchronized with the display, the swap has
+     * already paced the frame, and this method only waits if the swap
+     * returned early.  Otherwise, this method waits for a deadline that
+     * advances by a fixed period each frame, so rounding never accumulates.
+     * It sleeps coarsely and then spins for the last few milliseconds, as
+     * the operating system sleep is not precise.
+     *
+     * If nothing was drawn this frame, this method waits out a frame at the
+     * idle FPS instead.
+     */
+    void pace();
+    
 #pragma mark -
 #pragma mark Constructors
 public:
@@ -336,9 +408,45 @@ public:
      *
      * When overriding this method, you do not need to call the parent method
      * at all. The default implmentation does nothing.
+     *
+     * If the application is pipelined, this method is called on the game
+     * thread right after {@link update}, and must not make any OpenGL calls.
+     * Instead, it should record the frame to {@link getRecordSnapshot} (e.g.
+     * with {@link SpriteBatch#setSnapshot}).
      */
     virtual void draw() { }
 
+    /**
+     * The method called to draw the previous frame when pipelined.
+     *
+     * This method is only called if the application is pipelined. It is
+     * called on the main thread (which owns the OpenGL context) while the
+     * game thread updates and records the next frame.  It should replay
+     * {@link getPresentSnapshot} (e.g. with {@link SpriteBatch#replay}).
+     *
+     * When overriding this method, you do not need to call the parent method
+     * at all. The default implmentation does nothing.
+     */
+    virtual void present() { }
+
+    /**
+     * Returns true if the application needs to draw this frame.
+     *
+     * This method is called after {@link update}, on the same thread. If it
+     * returns false, the application skips both {@link draw} and the buffer
+     * swap, so the last frame stays on the screen.  While there is nothing
+     * to draw, the application runs at the idle FPS (see {@link setIdleFPS})
+     * to save power.  It returns to the normal FPS as soon as this method
+     * returns true.  Static screens, like menus, should override this method
+     * to return {@link Scene#isDirty} of the active scene.
+     *
+     * The application always redraws after the window is exposed or resized,
+     * regardless of this value.  The default implementation returns true.
+     *
+     * @return true if the application needs to draw this frame.
+     */
+    virtual bool needsRedraw() { return true; }
+
     
 #pragma mark -
 #pragma mark Application Loop
@@ -671,6 +779,10 @@ public:
      * it may run slower. However, it does guarantee that the program never 
      * runs faster than this FPS value.
      *
+     * If this value is close to the display refresh rate divided by a whole
+     * number (e.g. 60 on a 59.94 Hz or a 120 Hz display), the frames are
+     * paced to the display instead.
+     *
      * This method may be safely changed at any time while the application
      * is running.
      *
@@ -693,6 +805,27 @@ public:
      * @return the target frames per second of this application.
      */
     float getFPS() const { return _fps; }
+
+    /**
+     * Sets the target frames per second when there is nothing to redraw.
+     *
+     * When {@link needsRedraw} returns false, the application does not draw
+     * or swap the frame, and only processes input and updates at this rate.
+     * A lower value saves more power, but delays the response to input by
+     * up to one idle frame.  This value is capped at the target FPS.
+     *
+     * By default, this value is 15 frames per second.
+     *
+     * @param fps   The target frames per second when there is nothing to redraw
+     */
+    void setIdleFPS(float fps) { _idleFPS = fps; updatePacing(); }
+
+    /**
+     * Returns the target frames per second when there is nothing to redraw.
+     *
+     * @return the target frames per second when there is nothing to redraw.
+     */
+    float getIdleFPS() const { return _idleFPS; }
     
     /**
      * Returns the average frames per second over the last 10 frames.
@@ -705,6 +838,109 @@ public:
      */
     float getAverageFPS() const;
     
+    /**
+     * Sets whether to synchronize the buffer swaps with the display.
+     *
+     * The buffer swap only paces the frames if the target FPS is a divisor
+     * of the display refresh rate, and the platform supports it.  Otherwise
+     * the application paces the frames with a high resolution timer, but
+     * the swaps still wait for the display refresh.  Swaps are only
+     * unsynchronized if this value is false.
+     *
+     * This method may be safely changed at any time while the application
+     * is running.  By default, this value is true.
+     *
+     * @param flag  Whether to synchronize the buffer swaps with the display
+     */
+    void setVSync(bool flag) { _vsync = flag; updatePacing(); }
+    
+    /**
+     * Returns true if this application synchronizes buffer swaps with the display.
+     *
+     * This is the value requested with {@link setVSync}.  The swaps may still
+     * be unsynchronized if the platform does not support it.
+     *
+     * @return true if this application synchronizes buffer swaps with the display.
+     */
+    bool isVSync() const { return _vsync; }
+    
+    /**
+     * Returns the variance of the recent frame intervals in milliseconds squared.
+     *
+     * A frame interval is the time between the start of two consecutive
+     * frames.  This value measures how stable the frame pacing is, which
+     * matters more to smooth motion than the average FPS.
+     *
+     * @return the variance of the recent frame intervals in milliseconds squared.
+     */
+    float getFrameIntervalVariance() const;
+    
+    /**
+     * Returns the flight recorder of recent frame timings.
+     *
+     * The recorder keeps the stage timings of the last few seconds of frames.
+     * By default, any frame that takes more than twice the target frame time
+     * is a hitch, and writes a snapshot of the recorder to the save directory.
+     * Use this recorder to change the budget, or to read the frames directly.
+     * Changing the FPS resets the budget to twice the new frame time.
+     *
+     * The recorder is created when the application is initialized.
+     *
+     * @return the flight recorder of recent frame timings.
+     */
+    FrameRecorder* getFrameRecorder() const { return _recorder.get(); }
+    
+    /**
+     * Sets whether update and draw run on a game thread.
+     *
+     * When an application is pipelined, the methods {@link update} and
+     * {@link draw} run on a game thread, and draw records the frame to a
+     * snapshot instead of drawing it.  At the same time, the main thread
+     * calls {@link present} to draw the snapshot recorded in the previous
+     * frame.  The threads join at the end of every frame, and the snapshots
+     * are swapped.  This overlaps the simulation with the OpenGL submission,
+     * at the cost of one frame of latency.
+     *
+     * As update runs on the game thread, it must not make any OpenGL calls.
+     * This includes creating textures (which asset loaders already do on the
+     * main thread) and releasing the last reference to one. Such work should
+     * go in a callback of {@link schedule}, which is always executed on the
+     * main thread while the game thread is idle.  The timings of update are
+     * recorded in parallel with the render stage of the flight recorder.
+     *
+     * This method should only be called on the main thread, such as from
+     * {@link onStartup} or a scheduled callback. By default, this value is
+     * false.
+     *
+     * @param flag  Whether update and draw run on a game thread
+     */
+    void setPipelined(bool flag);
+    
+    /**
+     * Returns true if update and draw run on a game thread.
+     *
+     * @return true if update and draw run on a game thread.
+     */
+    bool isPipelined() const { return _pipelined; }
+    
+    /**
+     * Returns the snapshot for {@link draw} to record to when pipelined.
+     *
+     * This value is nullptr if the application is not pipelined.
+     *
+     * @return the snapshot for {@link draw} to record to when pipelined.
+     */
+    const std::shared_ptr<RenderSnapshot>& getRecordSnapshot() const { return _snapshots[1]; }
+    
+    /**
+     * Returns the snapshot for {@link present} to replay when pipelined.
+     *
+     * This value is nullptr if the application is not pipelined.
+     *
+     * @return the snapshot for {@link present} to replay when pipelined.
+     */
+    const std::shared_ptr<RenderSnapshot>& getPresentSnapshot() const { return _snapshots[0]; }
+    
     /**
      * Sets the clear color of this application
      *
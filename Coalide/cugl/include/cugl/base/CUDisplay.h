@@ -188,6 +188,8 @@ protected:
     Rect _usable;
     /** The pixel density of the device */
     Vec2 _scale;
+    /** The refresh rate of the display in Hz (0 if unknown) */
+    float _refresh;
     
 
 #pragma mark -
@@ -366,6 +368,18 @@ public:
      * @return the aspect of this monitor.
      */
     Aspect getAspect() const { return _aspect;   }
+    
+    /**
+     * Returns the refresh rate of this monitor in Hz.
+     *
+     * This is the refresh rate of the current display mode, as reported by
+     * the operating system.  Some platforms round this value to an integer
+     * (e.g. 59 for 59.94 Hz).  If the platform does not report a refresh
+     * rate, this method returns 0.
+     *
+     * @return the refresh rate of this monitor in Hz.
+     */
+    float getRefreshRate() const { return _refresh; }
 
     /**
      * Returns true if this device has a landscape orientation
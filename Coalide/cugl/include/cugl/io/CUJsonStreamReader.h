@@ -0,0 +1,397 @@
+//
+//  CUJsonStreamReader.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an event-driven (SAX-style) JSON reader.  Unlike
+//  JsonReader, it never builds the JSON string or a DOM in memory.  Instead
+//  it parses the file a chunk at a time, reporting objects, arrays, keys and
+//  values to a JsonHandler as it encounters them.  This is the preferred way
+//  to read large files into an application-specific data structure, as peak
+//  memory is just the read buffer plus whatever the handler keeps.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#ifndef __CU_JSON_STREAM_READER_H__
+#define __CU_JSON_STREAM_READER_H__
+#include <cugl/io/CUTextReader.h>
+#include <string>
+
+namespace  cugl {
+
+/** Forward reference to a parsed JSON tree */
+class JsonValue;
+
+/**
+ * This class is the receiver of events from a {@link JsonStreamReader}.
+ *
+ * Subclass this class and override the events that you care about.  The
+ * default implementation of every event does nothing.  Each event returns
+ * a boolean; returning false aborts the parse, and causes
+ * {@link JsonStreamReader#parse} to return false.
+ *
+ * Events arrive in document order.  For an object, the reader reports
+ * {@link startObject()}, then a {@link key} event before each member value,
+ * and finally {@link endObject()}.  Arrays are the same without keys.
+ * The string passed to {@link key} and {@link string} is a scratch buffer
+ * that is reused by the reader; copy it if you need to keep it.
+ */
+class JsonHandler {
+public:
+    /**
+     * Deletes this handler
+     */
+    virtual ~JsonHandler() {}
+
+    /**
+     * Called when the reader encounters the start of an object.
+     *
+     * @return false to abort parsing
+     */
+    virtual bool startObject() { return true; }
+
+    /**
+     * Called when the reader encounters the end of an object.
+     *
+     * @return false to abort parsing
+     */
+    virtual bool endObject() { return true; }
+
+    /**
+     * Called when the reader encounters the start of an array.
+     *
+     * @return false to abort parsing
+     */
+    virtual bool startArray() { return true; }
+
+    /**
+     * Called when the reader encounters the end of an array.
+     *
+     * @return false to abort parsing
+     */
+    virtual bool endArray() { return true; }
+
+    /**
+     * Called when the reader encounters the key of an object member.
+     *
+     * The next event will be the value for this key.
+     *
+     * @param key   The (unescaped) key
+     *
+     * @return false to abort parsing
+     */
+    virtual bool key(const std::string& key) { return true; }
+
+    /**
+     * Called when the reader encounters a number.
+     *
+     * @param value The number value
+     *
+     * @return false to abort parsing
+     */
+    virtual bool number(double value) { return true; }
+
+    /**
+     * Called when the reader encounters a string value.
+     *
+     * @param value The (unescaped) string
+     *
+     * @return false to abort parsing
+     */
+    virtual bool string(const std::string& value) { return true; }
+
+    /**
+     * Called when the reader encounters a boolean value.
+     *
+     * @param value The boolean value
+     *
+     * @return false to abort parsing
+     */
+    virtual bool boolean(bool value) { return true; }
+
+    /**
+     * Called when the reader encounters a null value.
+     *
+     * @return false to abort parsing
+     */
+    virtual bool null() { return true; }
+};
+
+
+/**
+ * Event-driven JSON extension to {@link TextReader}.
+ *
+ * This class parses a JSON value directly from the read buffer of the file,
+ * refilling the buffer as needed.  The parse reports events to a
+ * {@link JsonHandler}, and never constructs the JSON string or DOM.  Like
+ * {@link JsonReader}, the JSON value may be embedded in a larger text file,
+ * and the stream is left just after the value when the parse completes.
+ *
+ * By default, this class (and every class in the io package) accesses the
+ * application save directory {@see Application#getSaveDirectory()}.  If you
+ * want to access another directory, you must provide an absolute path for
+ * the file name.  Keep in mind that absolute paths are very dangerous on
+ * mobile devices, because they do not have proper file systems.  You should
+ * confine all files to either the asset or the save directory.
+ */
+class JsonStreamReader : public TextReader {
+private:
+    /** The scratch buffer for strings and keys */
+    std::string _token;
+    /** The scratch buffer for numbers */
+    std::string _digits;
+
+#pragma mark -
+#pragma mark Internal Methods
+    /**
+     * Returns the next character without consuming it, or -1 at the end.
+     *
+     * @return the next character without consuming it, or -1 at the end.
+     */
+    int peek() {
+        if (_bufoff < 0 || _bufoff >= (Sint32)_sbuffer.size()) {
+            fill();
+            if (_bufoff < 0 || _bufoff >= (Sint32)_sbuffer.size()) {
+                return -1;
+            }
+        }
+        return (unsigned char)_sbuffer[_bufoff];
+    }
+
+    /**
+     * Returns the next non-whitespace character without consuming it.
+     *
+     * @return the next non-whitespace character without consuming it.
+     */
+    int peekToken();
+
+    /**
+     * Returns true if it read a string into the token buffer.
+     *
+     * The stream must be at the opening quote.
+     *
+     * @return true if it read a string into the token buffer.
+     */
+    bool readString();
+
+    /**
+     * Returns true if it read four hex digits, storing the result in code.
+     *
+     * @param code  The value to store the result
+     *
+     * @return true if it read four hex digits, storing the result in code.
+     */
+    bool readHex(Uint32& code);
+
+    /**
+     * Returns true if it read a number, storing the result in value.
+     *
+     * @param value The value to store the result
+     *
+     * @return true if it read a number, storing the result in value.
+     */
+    bool readNumber(double& value);
+
+    /**
+     * Returns true if the stream matches the given literal, consuming it.
+     *
+     * @param literal   The literal to match
+     *
+     * @return true if the stream matches the given literal, consuming it.
+     */
+    bool readLiteral(const char* literal);
+
+    /**
+     * Returns true if it read an object key and the following colon.
+     *
+     * The key is reported to the handler.
+     *
+     * @param handler   The event handler
+     *
+     * @return true if it read an object key and the following colon.
+     */
+    bool readKey(JsonHandler& handler);
+
+    /**
+     * Returns false after reporting a parse error
+     *
+     * @param message   The error message
+     *
+     * @return false (for convenience)
+     */
+    bool fail(const char* message);
+
+public:
+#pragma mark -
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated stream reader for the given file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated stream reader for the given file.
+     */
+    static std::shared_ptr<JsonStreamReader> alloc(const std::string& file) {
+        std::shared_ptr<JsonStreamReader> result = std::make_shared<JsonStreamReader>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated stream reader for the given file.
+     *
+     * If the file is a relative path, this reader will look for the file in
+     * the application save directory {@see Application#getSaveDirectory()}.
+     * If you wish to read a file in any other directory, you must provide
+     * an absolute path.
+     *
+     * @param file  the path (absolute or relative) to the file
+     *
+     * @return a newly allocated stream reader for the given file.
+     */
+    static std::shared_ptr<JsonStreamReader> alloc(const Pathname& file) {
+        std::shared_ptr<JsonStreamReader> result = std::make_shared<JsonStreamReader>();
+        return (result->init(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated stream reader for the given file.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file  the relative path to the file
+     *
+     * @return a newly allocated stream reader for the given file.
+     */
+    static std::shared_ptr<JsonStreamReader> allocWithAsset(const std::string& file) {
+        std::shared_ptr<JsonStreamReader> result = std::make_shared<JsonStreamReader>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated stream reader for the given file with the specified capacity.
+     *
+     * This initializer assumes that the file name is a relative path. It will
+     * search the application assert directory {@see Application#getAssetDirectory()}
+     * for the file and return false if it cannot find it there.
+     *
+     * @param file      the relative path to the file
+     * @param capacity  the buffer capacity for reading chunks
+     *
+     * @return a newly allocated stream reader for the given file with the specified capacity.
+     */
+    static std::shared_ptr<JsonStreamReader> allocWithAsset(const std::string& file, unsigned int capacity) {
+        std::shared_ptr<JsonStreamReader> result = std::make_shared<JsonStreamReader>();
+        return (result->initWithAsset(file,capacity) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated stream reader for an in-memory JSON string.
+     *
+     * This allows the same handler to be used on JSON that has already been
+     * loaded, such as the contents of a {@link JsonValue}.
+     *
+     * @param json  the JSON string to read
+     *
+     * @return a newly allocated stream reader for an in-memory JSON string.
+     */
+    static std::shared_ptr<JsonStreamReader> allocWithString(const std::string& json) {
+        std::shared_ptr<JsonStreamReader> result = std::make_shared<JsonStreamReader>();
+        return (result->initWithString(json) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Initializers
+    /**
+     * Initializes this reader for an in-memory JSON string.
+     *
+     * The string is copied into the read buffer, and there is no backing
+     * file.  The method {@link reset()} is not supported on such a reader.
+     *
+     * @param json  the JSON string to read
+     *
+     * @return true if the reader is initialized properly, false otherwise.
+     */
+    bool initWithString(const std::string& json);
+
+#pragma mark -
+#pragma mark Read Methods
+    /**
+     * Returns true if it parsed the next JSON value in the stream.
+     *
+     * This method skips any leading whitespace, and then parses exactly one
+     * JSON value (usually an object), reporting events to the handler as it
+     * goes.  The stream is left just after that value.
+     *
+     * If there is a parsing error, this  method will return false.  Detailed
+     * information about the parsing error will be passed to an assert.  Hence
+     * error messages are suppressed if asserts are turned off.  This method
+     * also returns false (without an assert) if the handler aborts the parse.
+     *
+     * @param handler   The receiver of the parse events
+     *
+     * @return true if it parsed the next JSON value in the stream.
+     */
+    bool parse(JsonHandler& handler);
+    
+    /**
+     * Returns true if it reported the given JSON tree to the handler.
+     *
+     * This method sends the same events as {@link parse}, but it walks a
+     * tree that is already parsed.  This allows a handler to read a JSON
+     * tree without formatting it as text and parsing it again.  This method
+     * returns false if the handler aborts the walk.
+     *
+     * @param json      The JSON tree to report
+     * @param handler   The receiver of the events
+     *
+     * @return true if it reported the given JSON tree to the handler.
+     */
+    static bool walk(const JsonValue* json, JsonHandler& handler);
+};
+
+}
+#endif /* __CU_JSON_STREAM_READER_H__ */
@@ -32,6 +32,7 @@
 #include "CUTextReader.h"
 #include "CUTextWriter.h"
 #include "CUJsonReader.h"
+#include "CUJsonStreamReader.h"
 #include "CUJsonWriter.h"
 #include "CUBinaryReader.h"
 #include "CUBinaryWriter.h"
@@ -0,0 +1,251 @@
+//
+//  CURenderSnapshot.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorded frame of sprite batch draw calls.  When a
+//  sprite batch records to a snapshot, every flush appends its vertices and
+//  indices to the snapshot, together with the texture, perspective, blending
+//  and drawing command of the flush.  The snapshot can then be replayed by
+//  the sprite batch on another thread.  This allows a game thread to update
+//  and traverse the scene graph for one frame while the thread that owns the
+//  OpenGL context draws the previous one.  A snapshot also records when the
+//  sprite batch switches render targets.
+//
+//  A snapshot is meant to be reused.  Clearing a snapshot keeps the capacity
+//  of its buffers, so a snapshot stops allocating after the first few frames.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+
+#ifndef __CU_RENDER_SNAPSHOT_H__
+#define __CU_RENDER_SNAPSHOT_H__
+
+#include <SDL/SDL.h>
+#include <cugl/math/CUMat4.h>
+#include <cugl/math/CURect.h>
+#include <cugl/renderer/CUVertex.h>
+#include <vector>
+
+namespace cugl {
+
+/** Forward references */
+class Texture;
+class RenderTarget;
+
+/**
+ * This class is a recorded frame of sprite batch draw calls.
+ *
+ * A snapshot is a single mesh of vertices and indices, divided into commands.
+ * Each command is a range of the indices, together with the texture and the
+ * pipeline state to draw them with.  The indices of every command refer to
+ * the shared vertex array, so the whole mesh can be uploaded at once when the
+ * snapshot is replayed.  A command with no texture (and no indices) is not
+ * drawn.  Instead, it switches the render target of the commands after it.
+ *
+ * A snapshot holds a reference to the texture of each command, so a texture
+ * cannot be deleted between the recording and the replay.  As the last
+ * reference may be released when the snapshot is cleared, the snapshot
+ * should be cleared on the thread that owns the OpenGL context.  This is
+ * done automatically by {@link SpriteBatch#replay}.
+ *
+ * Snapshots are not thread safe.  A snapshot must either be recorded or be
+ * replayed, but never both at the same time.  The usual approach is to keep
+ * two snapshots, and swap them every frame.
+ */
+class RenderSnapshot {
+public:
+    /**
+     * A range of indices drawn with the same pipeline state.
+     */
+    class Command {
+    public:
+        /** The texture of this command */
+        std::shared_ptr<Texture> texture;
+        /** The perspective matrix of this command */
+        Mat4 perspective;
+        /** The drawing command (GL_TRIANGLES or GL_LINES) */
+        GLenum command;
+        /** The blending equation of this command */
+        GLenum blendEquation;
+        /** The source factor for the blend function */
+        GLenum srcFactor;
+        /** The destination factor for the blend function */
+        GLenum dstFactor;
+        /** The position of the first index of this command */
+        unsigned int offset;
+        /** The number of indices of this command */
+        unsigned int count;
+        /** The render target of a switch command (nullptr for the display) */
+        std::shared_ptr<RenderTarget> target;
+        /** The viewport of a switch command */
+        Rect viewport;
+    };
+
+#pragma mark Values
+private:
+    /** The vertices of every command */
+    std::vector<Vertex2> _vertices;
+    /** The indices of every command (into the shared vertex array) */
+    std::vector<GLuint> _indices;
+    /** The recorded commands */
+    std::vector<Command> _commands;
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates an empty snapshot with no capacity.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a snapshot on
+     * the heap, use one of the static constructors instead.
+     */
+    RenderSnapshot() {}
+
+    /**
+     * Deletes this snapshot, disposing all resources.
+     */
+    ~RenderSnapshot() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this snapshot.
+     *
+     * Unlike {@link clear}, this method releases the capacity of the buffers.
+     */
+    void dispose();
+
+    /**
+     * Initializes an empty snapshot with the given vertex capacity.
+     *
+     * The index capacity will be 3 times the vertex capacity. The buffers
+     * still grow if a frame needs more than this.
+     *
+     * @param capacity  The number of vertices to reserve
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(unsigned int capacity);
+
+    /**
+     * Returns a newly allocated snapshot with the given vertex capacity.
+     *
+     * The index capacity will be 3 times the vertex capacity. The buffers
+     * still grow if a frame needs more than this.
+     *
+     * @param capacity  The number of vertices to reserve
+     *
+     * @return a newly allocated snapshot with the given vertex capacity.
+     */
+    static std::shared_ptr<RenderSnapshot> alloc(unsigned int capacity) {
+        std::shared_ptr<RenderSnapshot> result = std::make_shared<RenderSnapshot>();
+        return (result->init(capacity) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Recording
+    /**
+     * Removes every command from this snapshot, keeping the capacity.
+     *
+     * This releases the texture references of the commands, so it should be
+     * called on the thread that owns the OpenGL context.
+     */
+    void clear();
+
+    /**
+     * Returns true if this snapshot has no commands.
+     *
+     * @return true if this snapshot has no commands.
+     */
+    bool isEmpty() const { return _commands.empty(); }
+
+    /**
+     * Appends a mesh to this snapshot with the given pipeline state.
+     *
+     * The indices are relative to the given vertices, and are shifted to the
+     * vertex array of the snapshot.  If the pipeline state is the same as that
+     * of the previous command, the mesh is merged into that command.
+     *
+     * @param vertices      The vertices of the mesh
+     * @param vsize         The number of vertices
+     * @param indices       The indices of the mesh
+     * @param isize         The number of indices
+     * @param texture       The texture of the mesh
+     * @param perspective   The perspective matrix of the mesh
+     * @param command       The drawing command (GL_TRIANGLES or GL_LINES)
+     * @param equation      The blending equation
+     * @param srcFactor     The source factor for the blend function
+     * @param dstFactor     The destination factor for the blend function
+     */
+    void append(const Vertex2* vertices, unsigned int vsize,
+                const GLuint* indices, unsigned int isize,
+                const std::shared_ptr<Texture>& texture, const Mat4& perspective,
+                GLenum command, GLenum equation, GLenum srcFactor, GLenum dstFactor);
+
+    /**
+     * Appends a switch of the render target to this snapshot.
+     *
+     * The commands after this one draw to the given target, in the given
+     * viewport.  A nullptr target is the display, and the viewport is then
+     * ignored.  Commands are never merged across a switch.
+     *
+     * @param target    The render target to draw to (nullptr for the display)
+     * @param viewport  The region of the target to draw to
+     */
+    void appendTarget(const std::shared_ptr<RenderTarget>& target, const Rect& viewport);
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the vertices of every command.
+     *
+     * @return the vertices of every command.
+     */
+    const std::vector<Vertex2>& getVertices() const { return _vertices; }
+
+    /**
+     * Returns the indices of every command.
+     *
+     * @return the indices of every command.
+     */
+    const std::vector<GLuint>& getIndices() const { return _indices; }
+
+    /**
+     * Returns the recorded commands.
+     *
+     * @return the recorded commands.
+     */
+    const std::vector<Command>& getCommands() const { return _commands; }
+};
+
+}
+
+#endif /* __CU_RENDER_SNAPSHOT_H__ */
@@ -0,0 +1,212 @@
+//
+//  CURenderTarget.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an offscreen framebuffer with a color texture.  A
+//  sprite batch can draw into a render target instead of the display, and
+//  the texture can then be drawn to the display like any other texture.  This
+//  is how a game draws part of a scene at a lower resolution and scales it
+//  up afterwards.
+//
+//  The target binds and restores the previous framebuffer and viewport, so it
+//  works with platforms (like iOS) where the display is not framebuffer 0.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+
+#ifndef __CU_RENDER_TARGET_H__
+#define __CU_RENDER_TARGET_H__
+
+#include <cugl/math/CUColor4.h>
+#include <cugl/math/CURect.h>
+#include <cugl/renderer/CUTexture.h>
+
+namespace cugl {
+
+/**
+ * This class is an offscreen framebuffer with a color texture.
+ *
+ * A render target is bound with {@link bind} and released with {@link unbind}.
+ * Binding a target clears it to its clear color, and sets the viewport to
+ * the given region of the texture.  The region may be smaller than the
+ * texture, so a target can be drawn at a lower resolution without being
+ * reallocated.  Unbinding restores the framebuffer and the viewport that
+ * were active when the target was bound.
+ *
+ * Sprite batches bind render targets with {@link SpriteBatch#setRenderTarget},
+ * which also works while the sprite batch records a snapshot.  A target must
+ * be allocated on the thread that owns the OpenGL context.
+ */
+class RenderTarget {
+#pragma mark Values
+private:
+    /** The OpenGL framebuffer */
+    GLuint _framebuffer;
+    /** The color texture of the framebuffer */
+    std::shared_ptr<Texture> _texture;
+    /** The color to clear the target to when it is bound */
+    Color4f _clearColor;
+    /** The framebuffer to restore when unbound */
+    GLint _previous;
+    /** The viewport to restore when unbound */
+    GLint _viewport[4];
+    /** Whether this target is currently bound */
+    bool _bound;
+
+public:
+#pragma mark -
+#pragma mark Constructors
+    /**
+     * Creates a degenerate render target with no framebuffer.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a render target
+     * on the heap, use one of the static constructors instead.
+     */
+    RenderTarget();
+
+    /**
+     * Deletes this render target, disposing all resources.
+     */
+    ~RenderTarget() { dispose(); }
+
+    /**
+     * Deletes the framebuffer and the texture of this render target.
+     *
+     * You must reinitialize the render target to use it.
+     */
+    void dispose();
+
+    /**
+     * Initializes a render target with the given dimensions.
+     *
+     * The texture is an RGBA texture with linear filtering, so that it can
+     * be scaled up smoothly.
+     *
+     * @param width     The target width in pixels
+     * @param height    The target height in pixels
+     *
+     * @return true if initialization was successful.
+     */
+    bool init(int width, int height);
+
+    /**
+     * Returns a newly allocated render target with the given dimensions.
+     *
+     * The texture is an RGBA texture with linear filtering, so that it can
+     * be scaled up smoothly.
+     *
+     * @param width     The target width in pixels
+     * @param height    The target height in pixels
+     *
+     * @return a newly allocated render target with the given dimensions.
+     */
+    static std::shared_ptr<RenderTarget> alloc(int width, int height) {
+        std::shared_ptr<RenderTarget> result = std::make_shared<RenderTarget>();
+        return (result->init(width, height) ? result : nullptr);
+    }
+
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the width of this target in pixels.
+     *
+     * @return the width of this target in pixels.
+     */
+    int getWidth() const { return _texture == nullptr ? 0 : (int)_texture->getWidth(); }
+
+    /**
+     * Returns the height of this target in pixels.
+     *
+     * @return the height of this target in pixels.
+     */
+    int getHeight() const { return _texture == nullptr ? 0 : (int)_texture->getHeight(); }
+
+    /**
+     * Returns the color texture of this target.
+     *
+     * Texture coordinate (0,0) is the bottom left corner of the target.
+     *
+     * @return the color texture of this target.
+     */
+    const std::shared_ptr<Texture>& getTexture() const { return _texture; }
+
+    /**
+     * Returns the color this target is cleared to when it is bound.
+     *
+     * @return the color this target is cleared to when it is bound.
+     */
+    Color4f getClearColor() const { return _clearColor; }
+
+    /**
+     * Sets the color this target is cleared to when it is bound.
+     *
+     * @param color The color this target is cleared to when it is bound.
+     */
+    void setClearColor(const Color4f& color) { _clearColor = color; }
+
+    /**
+     * Returns true if this target is currently bound.
+     *
+     * @return true if this target is currently bound.
+     */
+    bool isBound() const { return _bound; }
+
+#pragma mark -
+#pragma mark Binding
+    /**
+     * Binds this target and clears it, drawing to the whole texture.
+     *
+     * The previous framebuffer and viewport are restored by {@link unbind}.
+     */
+    void bind() { bind(Rect(0, 0, (float)getWidth(), (float)getHeight())); }
+
+    /**
+     * Binds this target and clears it, drawing to the given region.
+     *
+     * The viewport is set to the region (in pixels), so the perspective of
+     * the drawing is scaled to fit it.  The previous framebuffer and viewport
+     * are restored by {@link unbind}.
+     *
+     * @param viewport  The region of the texture to draw to
+     */
+    void bind(const Rect& viewport);
+
+    /**
+     * Restores the framebuffer and viewport active before this target was bound.
+     */
+    void unbind();
+};
+
+}
+
+#endif /* __CU_RENDER_TARGET_H__ */
@@ -57,6 +57,8 @@ namespace cugl {
 class SpriteShader;
 class Affine2;
 class Texture;
+class RenderSnapshot;
+class RenderTarget;
 class Rect;
 class Poly2;
     
@@ -130,6 +132,10 @@ private:
     bool _initialized;
     /** Whether this sprite batch is currently active */
     bool _active;
+    /** The snapshot to record to instead of drawing (nullptr when drawing) */
+    std::shared_ptr<RenderSnapshot> _snapshot;
+    /** The render target to draw to (nullptr for the display) */
+    std::shared_ptr<RenderTarget> _target;
 
     /** The blank (nullptr) texture */
     static std::shared_ptr<Texture> _blank;
@@ -472,6 +478,42 @@ public:
      * @return the blending equation for this sprite batch
      */
     GLenum getBlendEquation() const { return _blendEquation; }
+
+    /**
+     * Sets the render target to draw to, using the whole target.
+     *
+     * See {@link setRenderTarget(const std::shared_ptr<RenderTarget>&, const Rect&)}.
+     *
+     * @param target    The render target to draw to (nullptr for the display)
+     */
+    void setRenderTarget(const std::shared_ptr<RenderTarget>& target);
+
+    /**
+     * Sets the render target to draw to, using the given region.
+     *
+     * The target is bound (and cleared) immediately, and the region becomes
+     * the viewport, so the perspective matrix is scaled to fit it.  A nullptr
+     * target returns to drawing on the display, with the original viewport.
+     * When recording, the switch is recorded to the snapshot instead, and it
+     * takes place when the snapshot is replayed.
+     *
+     * You should return to the display before the end of the frame (or the
+     * end of the recording).  Changing this value will cause the sprite batch
+     * to flush.
+     *
+     * @param target    The render target to draw to (nullptr for the display)
+     * @param viewport  The region of the target to draw to (in pixels)
+     */
+    void setRenderTarget(const std::shared_ptr<RenderTarget>& target, const Rect& viewport);
+
+    /**
+     * Returns the render target to draw to.
+     *
+     * If this value is nullptr, the sprite batch draws to the display.
+     *
+     * @return the render target to draw to.
+     */
+    const std::shared_ptr<RenderTarget>& getRenderTarget() const { return _target; }
     
 #pragma mark -
 #pragma mark Rendering
@@ -516,6 +558,56 @@ public:
      */
     void flush();
 
+    /**
+     * Sets the snapshot to record to instead of drawing.
+     *
+     * While a snapshot is set, this sprite batch makes no OpenGL calls. Every
+     * flush appends the mesh and the pipeline state to the snapshot instead,
+     * so the drawing pass can take place on a thread without the OpenGL
+     * context.  Setting the snapshot to nullptr returns to drawing.
+     *
+     * The snapshot is replayed with {@link replay} on the thread that owns
+     * the OpenGL context.  Recording and replaying may happen at the same
+     * time, provided that they use different snapshots.  This value may NOT
+     * be changed during a drawing pass.
+     *
+     * @param snapshot  The snapshot to record to (or nullptr to draw)
+     */
+    void setSnapshot(const std::shared_ptr<RenderSnapshot>& snapshot);
+
+    /**
+     * Returns the snapshot to record to instead of drawing.
+     *
+     * If this value is nullptr, the sprite batch draws immediately.
+     *
+     * @return the snapshot to record to instead of drawing.
+     */
+    const std::shared_ptr<RenderSnapshot>& getSnapshot() const { return _snapshot; }
+
+    /**
+     * Returns true if this sprite batch records to a snapshot instead of drawing.
+     *
+     * @return true if this sprite batch records to a snapshot instead of drawing.
+     */
+    bool isRecording() const { return _snapshot != nullptr; }
+
+    /**
+     * Draws the given snapshot and then clears it.
+     *
+     * The whole snapshot is uploaded to the vertex buffers at once, and each
+     * command is a single draw call.  This method only uses the shader and
+     * the buffers of this sprite batch, and none of its drawing state, so it
+     * is safe to replay one snapshot while recording another.  It must be
+     * called on the thread that owns the OpenGL context, and not during a
+     * drawing pass of that thread.
+     *
+     * Render target switches in the snapshot bind the targets in turn, and
+     * the display is restored when the replay is done.
+     *
+     * @param snapshot  The snapshot to draw
+     */
+    void replay(const std::shared_ptr<RenderSnapshot>& snapshot);
+
 #pragma mark -
 #pragma mark Solid Shapes
     /**
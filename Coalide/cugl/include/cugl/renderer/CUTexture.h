@@ -324,6 +324,17 @@ public:
      */
     void buildMipMaps();
     
+    /**
+     * Returns the approximate GPU memory used by this texture in bytes.
+     *
+     * The estimate is the size of the pixel data, plus a third for mipmaps.
+     * A subtexture shares the memory of its parent, so this method returns
+     * 0 for a subtexture.  It also returns 0 for an unallocated texture.
+     *
+     * @return the approximate GPU memory used by this texture in bytes.
+     */
+    size_t getMemoryUsage() const;
+    
     /**
      * Returns the OpenGL buffer for this texture.
      *
@@ -33,6 +33,8 @@
 #include "CUShader.h"
 #include "CUSpriteShader.h"
 #include "CUSpriteBatch.h"
+#include "CURenderSnapshot.h"
+#include "CURenderTarget.h"
 #include "CUCamera.h"
 #include "CUOrthographicCamera.h"
 #include "CUPerspectiveCamera.h"
@@ -0,0 +1,378 @@
+//
+//  CUFrameRecorder.h
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a flight recorder of frame timings.  The recorder keeps the
+//  subsystem timings of the last few seconds of animation frames in a fixed
+//  ring buffer.  When a frame runs over budget, the recorder writes the
+//  window of frames leading up to it to the save directory.  This gives us
+//  hitch data from player devices, instead of just a moving average.
+//
+//  The recorder is always on, so it is designed to be cheap.  The buffer is
+//  allocated once, and a timed scope is two clock reads.  A snapshot is a
+//  copy of the buffer, which is formatted and written on a worker thread.  Scopes are nesting
+//  aware, so a recursive method (like a scene graph sort) is timed only once.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#ifndef __CU_FRAME_RECORDER_H__
+#define __CU_FRAME_RECORDER_H__
+#include <cugl/base/CUBase.h>
+#include <cugl/util/CUTimestamp.h>
+#include <cugl/util/CUThreadPool.h>
+#include <string>
+#include <vector>
+
+/** The number of stages timed by a frame recorder */
+#define FRAME_RECORDER_STAGES   6
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Frame Recorder
+/**
+ * Class to record the subsystem timings of recent animation frames.
+ *
+ * Each frame is split into stages: update, physics, sort, render, swap and
+ * sleep.  A stage is timed with a {@link Scope} on the stack.  The update
+ * stage contains the physics and sort stages, as they are called from the
+ * update method of an application.  The recorder also counts the number of
+ * sprite batch flushes (draw calls) and vertices in each frame.
+ *
+ * The recorder keeps a fixed number of frames in a ring buffer.  When a
+ * frame takes longer than the budget, the recorder writes the buffer to the
+ * file hitch_n.csv in the save directory.  The files are reused in a cycle
+ * of {@link getMaxSnapshots} files, so a long session does not fill up the
+ * device.  After a snapshot, the recorder waits a full window before it
+ * writes another one, so a burst of slow frames is one snapshot.
+ *
+ * The snapshot is written by a worker thread, so a hitch does not format or
+ * write a file on the main loop.  The frames are copied to a preallocated
+ * buffer, and a hitch is not written if the previous snapshot is still in
+ * progress.
+ *
+ * Scopes are recorded by the active recorder of the current thread. The
+ * {@link Application} activates its recorder on the main thread, so work on
+ * other threads (like a batch simulation) is never recorded.
+ */
+class FrameRecorder {
+public:
+    /** The stages of an animation frame */
+    enum Stage : int {
+        /** The update method of the application */
+        UPDATE  = 0,
+        /** The physics step (part of update) */
+        PHYSICS = 1,
+        /** The z-order sort of the scene graph (part of update) */
+        SORT    = 2,
+        /** The clear and the draw method of the application */
+        RENDER  = 3,
+        /** The swap of the window buffers */
+        SWAP    = 4,
+        /** The sleep at the end of the frame */
+        SLEEP   = 5
+    };
+
+    /** The timings of a single animation frame */
+    struct Frame {
+        /** The number of the frame since the recorder started */
+        Uint64 index;
+        /** The length of the frame in microseconds */
+        Uint32 total;
+        /** The length of each stage in microseconds */
+        Uint32 stages[FRAME_RECORDER_STAGES];
+        /** The number of sprite batch flushes */
+        Uint32 flushes;
+        /** The number of vertices (indices) drawn by the sprite batch flushes */
+        Uint32 vertices;
+    };
+
+    /**
+     * Class to time a stage of the current frame.
+     *
+     * A scope starts timing when it is created, and adds its time to the stage
+     * when it is deleted.  If a scope for the same stage is already open, the
+     * scope does nothing.  If there is no active recorder, the scope does
+     * nothing.  This class should only be created on the stack.
+     */
+    class Scope {
+    private:
+        /** The recorder timing this scope (nullptr if not timed) */
+        FrameRecorder* _recorder;
+        /** The stage of this scope */
+        Stage _stage;
+        /** The start of this scope (a raw clock value, so an untimed scope is free) */
+        timestamp_t _start;
+
+    public:
+        /**
+         * Opens a scope for the given stage.
+         *
+         * @param stage The stage to time
+         */
+        Scope(Stage stage) : _recorder(FrameRecorder::_active), _stage(stage) {
+            if (_recorder != nullptr && _recorder->_depth[stage]++ == 0) {
+                _start = cuclock_t::now();
+            }
+        }
+
+        /**
+         * Closes this scope, adding its time to the stage.
+         */
+        ~Scope() {
+            if (_recorder != nullptr && --_recorder->_depth[_stage] == 0) {
+                auto micros = std::chrono::duration_cast<std::chrono::microseconds>(cuclock_t::now()-_start);
+                _recorder->_current.stages[_stage] += (Uint32)micros.count();
+            }
+        }
+    };
+
+private:
+    /** This macro disables the copy constructor (not allowed on recorders) */
+    CU_DISALLOW_COPY_AND_ASSIGN(FrameRecorder);
+
+    /** The active recorder of this thread */
+    static thread_local FrameRecorder* _active;
+
+    /** The ring buffer of recent frames */
+    std::vector<Frame> _frames;
+    /** The position of the next frame in the ring buffer */
+    size_t _head;
+    /** The number of frames recorded */
+    Uint64 _count;
+    /** The frame being recorded */
+    Frame _current;
+    /** The start of the frame being recorded */
+    Timestamp _start;
+    /** The number of open scopes for each stage */
+    int _depth[FRAME_RECORDER_STAGES];
+
+    /** The longest frame (in microseconds) that is not a hitch */
+    Uint32 _budget;
+    /** The number of snapshot files to cycle through */
+    Uint32 _maxSnapshots;
+    /** The number of snapshots written */
+    Uint32 _snapshots;
+    /** The number of frames over budget */
+    Uint32 _hitches;
+    /** The first frame that may be written to a snapshot */
+    Uint64 _cooldown;
+    /** The frames of the snapshot being written (preallocated) */
+    std::vector<Frame> _snapshot;
+    /** The worker thread writing the snapshots (created on the first hitch) */
+    std::shared_ptr<ThreadPool> _writer;
+    /** The snapshot being written (if it is not done) */
+    std::shared_ptr<WaitGroup> _writing;
+    /** A reusable buffer for the snapshot text (writer only) */
+    std::string _buffer;
+
+    /**
+     * Writes the snapshot frames to the given snapshot file.
+     *
+     * This method is called by the writer thread.
+     *
+     * @param frames    The number of frames in the snapshot
+     * @param budget    The budget when the hitch occurred
+     * @param hitch     The frame that was over budget
+     * @param file      The number of the snapshot file
+     */
+    void writeSnapshot(size_t frames, Uint32 budget, Uint64 hitch, Uint32 file);
+
+public:
+#pragma mark Constructors
+    /**
+     * Creates a recorder with no frames.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a recorder on
+     * the heap, use one of the static constructors instead.
+     */
+    FrameRecorder();
+
+    /**
+     * Deletes this recorder, disposing all resources.
+     */
+    ~FrameRecorder() { dispose(); }
+
+    /**
+     * Disposes all of the resources used by this recorder.
+     *
+     * If this is the active recorder, it is deactivated.  If a snapshot is
+     * being written, this method blocks until it is done.
+     */
+    void dispose();
+
+    /**
+     * Initializes a recorder with the given window and budget.
+     *
+     * A budget of 0 never writes a snapshot.
+     *
+     * @param window    The number of frames to keep
+     * @param budget    The longest frame (in microseconds) that is not a hitch
+     *
+     * @return true if the recorder is initialized properly, false otherwise.
+     */
+    bool init(Uint32 window, Uint32 budget);
+
+    /**
+     * Returns a newly allocated recorder with the given window and budget.
+     *
+     * A budget of 0 never writes a snapshot.
+     *
+     * @param window    The number of frames to keep
+     * @param budget    The longest frame (in microseconds) that is not a hitch
+     *
+     * @return a newly allocated recorder with the given window and budget.
+     */
+    static std::shared_ptr<FrameRecorder> alloc(Uint32 window, Uint32 budget) {
+        std::shared_ptr<FrameRecorder> result = std::make_shared<FrameRecorder>();
+        return (result->init(window,budget) ? result : nullptr);
+    }
+
+#pragma mark Activation
+    /**
+     * Returns the active recorder of the current thread (or nullptr).
+     *
+     * @return the active recorder of the current thread (or nullptr).
+     */
+    static FrameRecorder* get() { return _active; }
+
+    /**
+     * Makes this the active recorder of the current thread.
+     */
+    void activate() { _active = this; }
+
+    /**
+     * Adds a sprite batch flush to the active recorder, if any.
+     *
+     * @param vertices  The number of vertices (indices) drawn by the flush
+     */
+    static void countFlush(Uint32 vertices) {
+        if (_active != nullptr) {
+            _active->_current.flushes++;
+            _active->_current.vertices += vertices;
+        }
+    }
+
+#pragma mark Settings
+    /**
+     * Returns the longest frame (in microseconds) that is not a hitch.
+     *
+     * @return the longest frame (in microseconds) that is not a hitch.
+     */
+    Uint32 getBudget() const { return _budget; }
+
+    /**
+     * Sets the longest frame (in microseconds) that is not a hitch.
+     *
+     * A budget of 0 never writes a snapshot.
+     *
+     * @param budget    The longest frame (in microseconds) that is not a hitch
+     */
+    void setBudget(Uint32 budget) { _budget = budget; }
+
+    /**
+     * Returns the number of snapshot files to cycle through.
+     *
+     * @return the number of snapshot files to cycle through.
+     */
+    Uint32 getMaxSnapshots() const { return _maxSnapshots; }
+
+    /**
+     * Sets the number of snapshot files to cycle through.
+     *
+     * A value of 0 never writes a snapshot.
+     *
+     * @param count The number of snapshot files to cycle through
+     */
+    void setMaxSnapshots(Uint32 count) { _maxSnapshots = count; }
+
+#pragma mark Recording
+    /**
+     * Starts recording a new frame.
+     */
+    void beginFrame();
+
+    /**
+     * Finishes the current frame, and adds it to the ring buffer.
+     *
+     * If the frame is over budget, this may write a snapshot.
+     */
+    void endFrame();
+
+    /**
+     * Returns the number of frames in the ring buffer.
+     *
+     * @return the number of frames in the ring buffer.
+     */
+    size_t size() const { return _count < _frames.size() ? (size_t)_count : _frames.size(); }
+
+    /**
+     * Returns a frame in the ring buffer.
+     *
+     * Frame 0 is the oldest frame in the buffer.
+     *
+     * @param index The frame position
+     *
+     * @return a frame in the ring buffer.
+     */
+    const Frame& getFrame(size_t index) const;
+
+    /**
+     * Returns the number of frames over budget since the recorder started.
+     *
+     * @return the number of frames over budget since the recorder started.
+     */
+    Uint32 getHitches() const { return _hitches; }
+
+    /**
+     * Returns the number of snapshots taken since the recorder started.
+     *
+     * The snapshots are written by a worker thread, so the file of the last
+     * snapshot may not be complete yet.
+     *
+     * @return the number of snapshots taken since the recorder started.
+     */
+    Uint32 getSnapshots() const { return _snapshots; }
+
+#pragma mark Analysis
+    /**
+     * Returns true if the given frame is GPU bound.
+     *
+     * OpenGL ES has no portable GPU timer queries, so this is a heuristic.
+     * A frame is GPU bound when it misses a display refresh, and most of the
+     * frame period is spent drawing and waiting on the buffer swap (which
+     * blocks on the GPU).  A frame with a slow update also misses a refresh,
+     * and its swap then waits on vsync as long as a GPU bound swap.  Hence a
+     * frame is only GPU bound if its update is well under the frame period.
+     *
+     * @param frame     The frame timings
+     * @param budget    The frame period in microseconds
+     *
+     * @return true if the given frame is GPU bound.
+     */
+    static bool isGpuBound(const Frame& frame, float budget);
+};
+
+}
+
+#endif /* __CU_FRAME_RECORDER_H__ */
@@ -6,6 +6,11 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  The pool is a work-stealing scheduler.  Every worker owns a set of deques
+//  (one per priority lane).  A worker pops its own work LIFO, and steals the
+//  oldest work of its siblings when it runs dry.  Tasks may be tracked with
+//  futures or wait groups, and loops can be split with parallelFor.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -37,8 +42,12 @@
 #include <cugl/base/CUBase.h>
 #include <SDL/SDL.h>
 #include <condition_variable>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <mutex>
 #include <stdio.h>
-#include <queue>
+#include <deque>
 #include <vector>
 #include <thread>
 
@@ -49,15 +58,119 @@
 
 namespace cugl {
 
+#pragma mark -
+#pragma mark Wait Group
+/**
+ * Class to track the completion of a group of tasks.
+ *
+ * A wait group is a counter of outstanding tasks.  Every task added to the
+ * group increments the counter, and every completed task decrements it. A
+ * thread may block on the group until the counter reaches zero.
+ *
+ * Wait groups are shared between the submitting thread and the workers, so
+ * they should always be allocated with the static constructor.  If you wait
+ * on a group from {@link ThreadPool#wait}, the waiting thread will help
+ * execute tasks instead of sleeping.
+ */
+class WaitGroup {
+private:
+    /** The number of tasks that have not yet completed */
+    std::atomic<int> _count;
+    /** A mutex lock for the completion condition */
+    std::mutex _mutex;
+    /** A condition variable to signal the completion of the group */
+    std::condition_variable _condition;
+
+public:
+    /**
+     * Creates an empty wait group.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a wait group
+     * on the heap, use the static constructor instead.
+     */
+    WaitGroup() : _count(0) { }
+    
+    /**
+     * Returns a newly allocated (empty) wait group.
+     *
+     * @return a newly allocated (empty) wait group.
+     */
+    static std::shared_ptr<WaitGroup> alloc() {
+        return std::make_shared<WaitGroup>();
+    }
+    
+    /**
+     * Adds the given number of tasks to this group.
+     *
+     * This method should be called before the tasks are submitted to the
+     * thread pool.  Otherwise, a waiting thread might wake up too early.
+     *
+     * @param amount    The number of tasks to add
+     */
+    void add(int amount = 1) { _count += amount; }
+    
+    /**
+     * Marks a single task in this group as complete.
+     *
+     * If this is the last outstanding task, any waiting thread is woken up.
+     */
+    void done();
+    
+    /**
+     * Returns true if every task in this group has completed.
+     *
+     * @return true if every task in this group has completed.
+     */
+    bool isDone() const { return _count.load() <= 0; }
+    
+    /**
+     * Returns the number of tasks that have not yet completed.
+     *
+     * @return the number of tasks that have not yet completed.
+     */
+    int pending() const { return _count.load(); }
+    
+    /**
+     * Blocks the calling thread until every task in the group is complete.
+     *
+     * This method does not help with the tasks.  If called from a worker of
+     * the pool executing these tasks, use {@link ThreadPool#wait} instead to
+     * prevent a deadlock.
+     */
+    void wait();
+    
+    /**
+     * Blocks the calling thread until the group is complete or time expires.
+     *
+     * @param millis    The maximum number of milliseconds to wait
+     *
+     * @return true if every task in the group is complete.
+     */
+    bool wait(Uint32 millis);
+    
+    // Copying is only allowed via shared pointer.
+    CU_DISALLOW_COPY_AND_ASSIGN(WaitGroup);
+};
+
 #pragma mark -
 #pragma mark Thread Pool
 
 /**
  *  Class to providing a collection of worker threads.
  *
- *  This is a general purpose class for performing tasks asynchronously.  There 
- *  is no notification process for when a task is complete.  Instead, your task 
- *  should either set a flag, or execute a callback when it is done.
+ *  This is a general purpose class for performing tasks asynchronously. You
+ *  may either fire off a task and have it set a flag or execute a callback
+ *  when done, or you may track it with a future (see {@link submit}) or a
+ *  {@link WaitGroup}.
+ *
+ *  Internally, the pool is a work-stealing scheduler.  Each worker has its
+ *  own deque for each {@link Priority} lane.  Tasks added by a worker go to
+ *  the back of the deque of that worker, while tasks added by other threads
+ *  are dealt round-robin to the workers.  A worker always drains the most
+ *  urgent lane first, taking from the back of its own deque and stealing
+ *  from the front of the other deques.  This keeps fork-join work (such as
+ *  {@link parallelFor}) local and cache friendly, while still spreading it
+ *  across all the cores.
  *
  *  There are some important safety considerations for using this class over
  *  direct thread objects. For example, stopping a thread pool does not shut it 
@@ -65,15 +178,58 @@ namespace cugl {
  *  it is not safe to delete a thread pool until it is completely shutdown.
  *
  *  More importantly, we do not allow for detached threads. This makes no sense
- *  in this application, because the threads share a resource (_taskQueue) with 
- *  the main thread that will be deleted.  It is therefore unsafe for the 
+ *  in this application, because the threads share a resource (the task deques)
+ *  with the main thread that will be deleted.  It is therefore unsafe for the
  *  threads to ever detach.
  *
  *  See the class {@link AssetManager} for an example of how to use a thread 
  *  pool.
  */
 class ThreadPool {
+public:
+    /**
+     * The priority lane of a task.
+     *
+     * Workers always execute the task of the most urgent non-empty lane.
+     * There is no preemption, so a long task in a low lane can still delay
+     * a task in a higher lane if every worker is busy.
+     */
+    enum class Priority : int {
+        /** Gameplay jobs (AI, physics, culling) that must finish this frame */
+        HIGH   = 0,
+        /** The default priority, used for asset loading */
+        NORMAL = 1,
+        /** Speculative background work that can wait indefinitely */
+        LOW    = 2
+    };
+    
+    /** The number of priority lanes */
+    static const int LANES = 3;
+    
 private:
+    /**
+     * The task deques of a single worker.
+     *
+     * Each worker has its own lock, so that the workers only contend with
+     * each other when they steal.
+     */
+    class Worker {
+    public:
+        /** The thread pool that owns this worker */
+        ThreadPool* pool;
+        /** The position of this worker in the pool */
+        int index;
+        /** The SDL identifier of the thread (assigned at thread start) */
+        std::atomic<SDL_threadID> thread;
+        /** A mutex lock for the task deques */
+        std::mutex mutex;
+        /** The task deques, one for each priority lane */
+        std::deque< std::function<void()> > lanes[LANES];
+        
+        /** Creates a worker for the given pool */
+        Worker(ThreadPool* owner, int pos) : pool(owner), index(pos), thread(0) {}
+    };
+    
     /** The individual worker threads for this thread pool */
 #ifdef CU_SDL_THREADS
     std::vector<SDL_Thread*> _workers;
@@ -81,32 +237,69 @@ private:
     std::vector<std::thread> _workers;
 #endif
     
-    /** Tasks waiting to be assigned to a thread */
-    std::queue< std::function<void()> > _taskQueue;
+    /** The task deques for each of the worker threads */
+    std::vector<std::unique_ptr<Worker>> _queues;
     
-    /** A mutex lock for the task queue */
+    /** The number of tasks waiting to be assigned to a thread */
+    std::atomic<int> _pending;
+    /** The next worker to receive a task from outside of the pool */
+    std::atomic<unsigned int> _nextQueue;
+    
+    /** A mutex lock for sleeping workers */
     std::mutex _queueMutex;
     /** A condition variable to manage tasks waiting for a worker */
     std::condition_variable _taskCondition;
     
     /** Whether or not the thread pool has been marked for shutdown */
-    bool _stop;
+    std::atomic<bool> _stop;
     /** The number of child threads that are completed */
-    int _complete;
+    std::atomic<int> _complete;
+    
+    /**
+     * Returns the index of the worker for the calling thread.
+     *
+     * If the calling thread is not part of this pool, this returns -1.
+     *
+     * @return the index of the worker for the calling thread.
+     */
+    int currentWorker() const;
+    
+    /**
+     * Pushes a task on the appropriate deque and wakes up a worker.
+     *
+     * @param task      The task to schedule
+     * @param priority  The priority lane of the task
+     */
+    void schedule(std::function<void()>&& task, Priority priority);
+    
+    /**
+     * Acquires the most urgent available task, if any.
+     *
+     * The worker at the given index looks at its own deque first.  If that
+     * is empty, it steals from the other workers.  Only lanes at or above
+     * the given priority are considered.
+     *
+     * @param index     The worker index (or -1 for an external thread)
+     * @param task      The task to fill in
+     * @param priority  The least urgent lane to consider
+     *
+     * @return true if a task was acquired
+     */
+    bool acquire(int index, std::function<void()>& task, Priority priority = Priority::LOW);
     
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.  
+     * This function pulls tasks from the task deques, stealing if necessary.
      *
-     * This implementation is safe to use with std::thread.
+     * @param index The index of the worker for this thread
      */
-    void threadFunc();
+    void threadFunc(int index);
 
     /**
      * The body function of a single thread.
      *
-     * This function pulls tasks from the task queue.
+     * This function pulls tasks from the task deques, stealing if necessary.
      *
      * This static implementation uses the SDL thread API.  It should be used
      * on Android and Windows, which have special thread requirements.
@@ -124,15 +317,15 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool 
      * on the heap, use one of the static constructors instead.
      */
-    ThreadPool() :_stop(false), _complete(0) { }
+    ThreadPool() : _pending(0), _nextQueue(0), _stop(false), _complete(0) { }
     
     /**
      * Deletes this thread pool, destroying all resources.
      *
      * It is a bad idea to destroy the thread pool if the pool is not yet shut
-     * down. The task queue is shared by the child threads, so we cannot delete
-     * it until all the threads complete.  This destructor will block unti 
-     * showndown.
+     * down. The task deques are shared by the child threads, so we cannot
+     * delete them until all the threads complete.  This destructor will block
+     * until shutdown.
      */
     ~ThreadPool() { dispose(); }
     
@@ -141,8 +334,9 @@ public:
      *
      * A disposed thread pool can be safely reinitialized. However, it is a bad 
      * idea to destroy the thread pool if the pool is not yet shut down. The 
-     * task queue is shared by the child threads, so we cannot delete it until 
-     * all the threads complete.  This destructor will block unti showndown.
+     * task deques are shared by the child threads, so we cannot delete them
+     * until all the threads complete.  This method joins the workers and so
+     * will block until shutdown.
      */
     void dispose();
     
@@ -188,15 +382,120 @@ public:
      * worker.
      *
      * @param  task     the task function to add to the thread pool
+     * @param  priority the priority lane for this task
+     */
+    void addTask(const std::function<void()> &task, Priority priority = Priority::NORMAL);
+    
+    /**
+     * Adds a task to the thread pool as part of the given wait group.
+     *
+     * The task is added to the group before it is scheduled, and the group
+     * is notified once the task has executed.
+     *
+     * @param  task     the task function to add to the thread pool
+     * @param  group    the wait group to track this task
+     * @param  priority the priority lane for this task
+     */
+    void addTask(const std::function<void()> &task, const std::shared_ptr<WaitGroup>& group,
+                 Priority priority = Priority::NORMAL);
+    
+    /**
+     * Adds a task to the thread pool, returning a future for its result.
+     *
+     * The task may be any function (or lambda) with no parameters.  Its
+     * return value (or exception) is delivered through the future.  If the
+     * pool is stopped before the task executes, the future will report a
+     * broken promise.
+     *
+     * Do not block on the future from a worker of this pool unless you are
+     * certain the task is already running.  Use a {@link WaitGroup} and
+     * {@link wait} for fork-join work inside of a task.
+     *
+     * @param  func     the task function to add to the thread pool
+     * @param  priority the priority lane for this task
+     *
+     * @return a future for the result of the task
      */
-    void addTask(const std::function<void()> &task);
+    template <typename F>
+    auto submit(F func, Priority priority = Priority::NORMAL) -> std::future<decltype(func())> {
+        typedef decltype(func()) R;
+        std::shared_ptr<std::packaged_task<R()>> task = std::make_shared<std::packaged_task<R()>>(func);
+        std::future<R> result = task->get_future();
+        schedule([task] { (*task)(); }, priority);
+        return result;
+    }
+    
+    /**
+     * Blocks until every task in the wait group is complete.
+     *
+     * Unlike {@link WaitGroup#wait}, the calling thread helps out while it
+     * waits, executing any pending task (most urgent lane first).  The tasks
+     * of the group may be in any lane, so the caller never skips a lane.
+     * This makes it safe to wait from inside a task of this pool.
+     *
+     * @param  group    the wait group to wait on
+     */
+    void wait(const std::shared_ptr<WaitGroup>& group);
+    
+    /**
+     * Executes the body for every index in the range [begin,end) in parallel.
+     *
+     * The range is split into chunks of (at least) grain indices, and each
+     * chunk is passed to body as a half-open subrange [start,stop). The
+     * calling thread executes chunks as well, and this method returns only
+     * when the entire range is complete.  If the range is no bigger than a
+     * single grain, the body is executed directly on the calling thread.
+     *
+     * The chunks must be independent of each other.  The order in which
+     * they execute is not specified.
+     *
+     * @param  begin    the first index of the range
+     * @param  end      the index after the last index of the range
+     * @param  grain    the minimum number of indices in a chunk
+     * @param  body     the function to execute on each chunk
+     * @param  priority the priority lane for the chunks
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t, size_t)>& body,
+                     Priority priority = Priority::HIGH);
+    
+    /**
+     * Executes a single pending task on the calling thread, if there is one.
+     *
+     * This allows the main thread to contribute to the pool (for example,
+     * while waiting on a loading screen).  Only lanes at or above the given
+     * priority are considered.
+     *
+     * @param  priority the least urgent lane to consider
+     *
+     * @return true if a task was executed
+     */
+    bool runPendingTask(Priority priority = Priority::LOW);
+    
+    /**
+     * Returns the number of tasks that are waiting for a worker.
+     *
+     * This value is only a snapshot, as the workers run concurrently.
+     *
+     * @return the number of tasks that are waiting for a worker.
+     */
+    int getPendingTasks() const { return _pending.load(); }
+    
+    /**
+     * Returns the number of worker threads in this pool.
+     *
+     * @return the number of worker threads in this pool.
+     */
+    int getThreadCount() const { return (int)_queues.size(); }
     
     /**
      * Stop the thread pool, marking it for shut down.
      *
-     * A stopped thread pool is marked for shutdown, but it shutdown has not 
-     * necessarily completed.  Shutdown will be complete when the current child 
-     * threads have finished with their tasks.
+     * A stopped thread pool is marked for shutdown, and this method joins the
+     * child threads.  Shutdown will be complete when the current child
+     * threads have finished with their tasks.  Any task that has not started
+     * by then is discarded.  A discarded task still counts as done for its
+     * {@link WaitGroup}, so no thread is left waiting on it.
      */
     void stop();
     
@@ -218,7 +517,7 @@ public:
      *
      * @return whether the thread pool has been shut down.
      */
-    bool isShutdown() const { return _workers.size() == _complete; }
+    bool isShutdown() const { return _workers.size() == (size_t)_complete.load(); }
     
     // Copying is only allowed via shared pointer.
     CU_DISALLOW_COPY_AND_ASSIGN(ThreadPool);
@@ -39,6 +39,7 @@
 #include <cugl/2d/layout/CULayout.h>
 #include <cugl/renderer/CUCamera.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/util/CUFrameRecorder.h>
 #include <cugl/assets/CUAssetManager.h>
 #include <sstream>
 #include <algorithm>
@@ -315,9 +316,13 @@ Node* Node::copy(Node* dst) {
  * @param  y    The x-coordinate of the node in its parent's coordinate system.
  */
 void Node::setPosition(float x, float y) {
+    if (_position.x == x && _position.y == y) {
+        return;
+    }
     _combined.m[12] += (x-_position.x);
     _combined.m[13] += (y-_position.y);
     _position.set(x,y);
+    markDirty();
 }
 
 /**
@@ -486,6 +491,7 @@ void Node::updateTransform() {
     }
     _combined.m[12] += _position.x-offset.x;
     _combined.m[13] += _position.y-offset.y;
+    markDirty();
 }
 
 
@@ -599,7 +605,7 @@ void Node::addChild(const std::shared_ptr<Node>& child, int zval) {
     _children.push_back(child);
     child->setParent(this);
     child->pushScene(_graph);
-    
+    markDirty();
 }
 
 /**
@@ -622,6 +628,7 @@ void Node::swapChild(const std::shared_ptr<Node>& child1, const std::shared_ptr<
     child1->setParent(nullptr);
     child2->pushScene(_graph);
     child1->pushScene(nullptr);
+    markDirty();
     
     // Check if we are dirty and/or inherit children
     bool childdirty = false;
@@ -650,6 +657,7 @@ void Node::removeChild(unsigned int pos) {
     child->setParent(nullptr);
     child->pushScene(nullptr);
     child->_childOffset = -1;
+    markDirty();
     for(int ii = pos; ii < _children.size()-1; ii++) {
         _children[ii] = _children[ii+1];
         _children[ii]->_childOffset = ii;
@@ -717,10 +725,29 @@ void Node::removeAllChildren() {
         (*it)->_childOffset = -1;
         (*it)->pushScene(nullptr);
     }
+    if (!_children.empty()) {
+        markDirty();
+    }
     _children.clear();
     _zDirty = false;
 }
 
+/**
+ * Marks the scene of this node as changed since it was last rendered.
+ *
+ * The attribute setters of a node call this method whenever they change
+ * the appearance of the node (e.g. its transform, color, visibility, or
+ * texture).  Actions change nodes through these setters, so a running
+ * action marks the scene as well.  A subclass with its own visual state
+ * should call this method when that state changes.  This method does
+ * nothing if the node is not in a scene.
+ */
+void Node::markDirty() {
+    if (_graph != nullptr) {
+        _graph->setDirty(true);
+    }
+}
+
 /**
  * Recursively sets the scene graph for this node and all its children.
  *
@@ -769,6 +796,9 @@ void Node::doLayout() {
  * @param z The local Z order value.
  */
 void Node::setZOrder(int z) {
+    if (_zOrder != z) {
+        markDirty();
+    }
     _zOrder = z;
     
     // Notify the parent if we have a problem.
@@ -848,6 +878,7 @@ bool Node::compareNodeSibs(const std::shared_ptr<Node>& a, const std::shared_ptr
  */
 void Node::sortZOrder() {
     if (_zDirty) {
+        FrameRecorder::Scope scope(FrameRecorder::SORT);
         std::sort(_children.begin(),_children.end(),Node::compareNodeSibs);
         // Fix the offsets
         int ii = 0;
@@ -0,0 +1,349 @@
+//
+//  CUParticleSystemNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node for short-lived sprite particles,
+//  such as sparks, debris and smoke.  Instead of making an animation node for
+//  each effect, a game adds emitter types to a single particle system and
+//  bursts particles from them.
+//
+//  The particles of each emitter type are stored in pooled, contiguous arrays.
+//  They are updated four at a time with SIMD instructions where available, and
+//  all of the particles of an emitter type are drawn in a single fill call.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/2d/CUParticleSystemNode.h>
+#include <cugl/renderer/CUSpriteBatch.h>
+#include <cugl/util/CUDebug.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CU_PARTICLE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define CU_PARTICLE_NEON
+#endif
+
+using namespace cugl;
+
+/** The number of particles updated at once */
+#define PARTICLE_LANES  4
+
+#pragma mark -
+#pragma mark SIMD Wrappers
+
+#if defined(CU_PARTICLE_SSE2)
+typedef __m128 ParticleW;
+inline ParticleW particleLoad(const float* a) { return _mm_loadu_ps(a); }
+inline void particleStore(float* a, ParticleW b) { _mm_storeu_ps(a, b); }
+inline ParticleW particleSplat(float a) { return _mm_set1_ps(a); }
+inline ParticleW particleAdd(ParticleW a, ParticleW b) { return _mm_add_ps(a, b); }
+inline ParticleW particleMul(ParticleW a, ParticleW b) { return _mm_mul_ps(a, b); }
+#elif defined(CU_PARTICLE_NEON)
+typedef float32x4_t ParticleW;
+inline ParticleW particleLoad(const float* a) { return vld1q_f32(a); }
+inline void particleStore(float* a, ParticleW b) { vst1q_f32(a, b); }
+inline ParticleW particleSplat(float a) { return vdupq_n_f32(a); }
+inline ParticleW particleAdd(ParticleW a, ParticleW b) { return vaddq_f32(a, b); }
+inline ParticleW particleMul(ParticleW a, ParticleW b) { return vmulq_f32(a, b); }
+#else
+struct ParticleW { float v[PARTICLE_LANES]; };
+inline ParticleW particleLoad(const float* a) { ParticleW r; for (int i = 0; i < PARTICLE_LANES; ++i) r.v[i] = a[i]; return r; }
+inline void particleStore(float* a, ParticleW b) { for (int i = 0; i < PARTICLE_LANES; ++i) a[i] = b.v[i]; }
+inline ParticleW particleSplat(float a) { ParticleW r; for (int i = 0; i < PARTICLE_LANES; ++i) r.v[i] = a; return r; }
+inline ParticleW particleAdd(ParticleW a, ParticleW b) { for (int i = 0; i < PARTICLE_LANES; ++i) a.v[i] += b.v[i]; return a; }
+inline ParticleW particleMul(ParticleW a, ParticleW b) { for (int i = 0; i < PARTICLE_LANES; ++i) a.v[i] *= b.v[i]; return a; }
+#endif
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed node can be safely reinitialized. All particles and emitter
+ * types are removed.
+ */
+void ParticleSystemNode::dispose() {
+    _pools.clear();
+    _vertices.clear();
+    _indices.clear();
+    Node::dispose();
+}
+
+/**
+ * Initializes a particle system with no emitter types.
+ *
+ * @return true if initialization was successful.
+ */
+bool ParticleSystemNode::init() {
+    if (!Node::init()) {
+        return false;
+    }
+    _random.seed(0);
+    return true;
+}
+
+/**
+ * Returns a random value in the range [min,max]
+ *
+ * @param min   The range minimum
+ * @param max   The range maximum
+ *
+ * @return a random value in the range [min,max]
+ */
+float ParticleSystemNode::random(float min, float max) {
+    if (max <= min) {
+        return min;
+    }
+    std::uniform_real_distribution<float> dist(min, max);
+    return dist(_random);
+}
+
+
+#pragma mark -
+#pragma mark Emitters
+/**
+ * Adds an emitter type to this particle system.
+ *
+ * The capacity of the emitter is clamped to PARTICLE_MAX_CAPACITY. The
+ * arrays for the particles are allocated now, so bursting particles never
+ * allocates memory.
+ *
+ * @param emitter   The emitter definition
+ *
+ * @return the index of the new emitter type
+ */
+int ParticleSystemNode::addEmitter(const Emitter& emitter) {
+    CUAssertLog(emitter.rows > 0 && emitter.cols > 0, "The filmstrip must have at least one frame");
+    CUAssertLog(emitter.minLifetime > 0, "The particle lifetime must be positive");
+
+    Pool pool;
+    pool.emitter  = emitter;
+    pool.emitter.capacity = std::max(0, std::min(emitter.capacity, PARTICLE_MAX_CAPACITY));
+    pool.frames   = emitter.frames > 0 ? std::min(emitter.frames, emitter.rows*emitter.cols) : emitter.rows*emitter.cols;
+    pool.count    = 0;
+    pool.size     = emitter.size;
+    if (pool.size.width <= 0 || pool.size.height <= 0) {
+        if (emitter.texture != nullptr) {
+            pool.size.set(emitter.texture->getWidth()/(float)emitter.cols,
+                          emitter.texture->getHeight()/(float)emitter.rows);
+        } else {
+            pool.size.set(1, 1);
+        }
+    }
+
+    // Pad to the SIMD width so the update never needs a tail loop
+    size_t padded = ((pool.emitter.capacity+PARTICLE_LANES-1)/PARTICLE_LANES)*PARTICLE_LANES;
+    pool.px.assign(padded, 0.0f);
+    pool.py.assign(padded, 0.0f);
+    pool.vx.assign(padded, 0.0f);
+    pool.vy.assign(padded, 0.0f);
+    pool.age.assign(padded, 0.0f);
+    pool.rate.assign(padded, 0.0f);
+    int capacity = pool.emitter.capacity;
+    _pools.push_back(std::move(pool));
+
+    // The quad indices are shared by all emitter types
+    size_t quads = _indices.size()/6;
+    if ((int)quads < capacity) {
+        quads = (size_t)capacity;
+        _indices.resize(quads*6);
+        for (size_t ii = 0; ii < quads; ii++) {
+            unsigned short base = (unsigned short)(4*ii);
+            _indices[6*ii  ] = base;
+            _indices[6*ii+1] = base+1;
+            _indices[6*ii+2] = base+2;
+            _indices[6*ii+3] = base+2;
+            _indices[6*ii+4] = base+3;
+            _indices[6*ii+5] = base;
+        }
+        _vertices.resize(quads*4);
+    }
+    return (int)_pools.size()-1;
+}
+
+
+#pragma mark -
+#pragma mark Particles
+/**
+ * Spawns particles of the given emitter type.
+ *
+ * The position is in the coordinate space of this node.  If the emitter
+ * is at capacity, the extra particles are dropped.
+ *
+ * @param emitter   The emitter index
+ * @param position  The spawn position
+ * @param count     The number of particles to spawn
+ */
+void ParticleSystemNode::burst(int emitter, const Vec2& position, int count) {
+    CUAssertLog(emitter >= 0 && emitter < (int)_pools.size(), "Emitter %d is out of range", emitter);
+    Pool& pool = _pools[emitter];
+    const Emitter& def = pool.emitter;
+    int total = std::min(pool.count+count, def.capacity);
+    for (int ii = pool.count; ii < total; ii++) {
+        float speed = random(def.minSpeed, def.maxSpeed);
+        float angle = random(def.minAngle, def.maxAngle);
+        pool.px[ii] = position.x;
+        pool.py[ii] = position.y;
+        pool.vx[ii] = speed*cosf(angle);
+        pool.vy[ii] = speed*sinf(angle);
+        pool.age[ii] = 0.0f;
+        pool.rate[ii] = 1.0f/random(def.minLifetime, std::max(def.minLifetime, def.maxLifetime));
+    }
+    pool.count = total;
+    markDirty();
+}
+
+/**
+ * Removes all live particles, but keeps the emitter types.
+ */
+void ParticleSystemNode::clearParticles() {
+    for (auto it = _pools.begin(); it != _pools.end(); ++it) {
+        it->count = 0;
+    }
+    markDirty();
+}
+
+/**
+ * Advances every particle by the given elapsed time.
+ *
+ * Particles that reach the end of their lifetime are removed.
+ *
+ * @param dt    The elapsed time in seconds
+ */
+void ParticleSystemNode::update(float dt) {
+    ParticleW step = particleSplat(dt);
+    for (auto it = _pools.begin(); it != _pools.end(); ++it) {
+        Pool& pool = *it;
+        if (pool.count == 0) {
+            continue;
+        }
+        markDirty();
+
+        // Integrate four particles at a time (the padding absorbs the tail)
+        ParticleW ax = particleSplat(pool.emitter.acceleration.x*dt);
+        ParticleW ay = particleSplat(pool.emitter.acceleration.y*dt);
+        for (int ii = 0; ii < pool.count; ii += PARTICLE_LANES) {
+            ParticleW vx = particleAdd(particleLoad(&pool.vx[ii]), ax);
+            ParticleW vy = particleAdd(particleLoad(&pool.vy[ii]), ay);
+            particleStore(&pool.vx[ii], vx);
+            particleStore(&pool.vy[ii], vy);
+            particleStore(&pool.px[ii], particleAdd(particleLoad(&pool.px[ii]), particleMul(vx, step)));
+            particleStore(&pool.py[ii], particleAdd(particleLoad(&pool.py[ii]), particleMul(vy, step)));
+            particleStore(&pool.age[ii], particleAdd(particleLoad(&pool.age[ii]),
+                                                     particleMul(particleLoad(&pool.rate[ii]), step)));
+        }
+
+        // Remove the dead particles by moving the last one into the hole
+        int ii = 0;
+        while (ii < pool.count) {
+            if (pool.age[ii] >= 1.0f) {
+                int last = --pool.count;
+                pool.px[ii] = pool.px[last];
+                pool.py[ii] = pool.py[last];
+                pool.vx[ii] = pool.vx[last];
+                pool.vy[ii] = pool.vy[last];
+                pool.age[ii] = pool.age[last];
+                pool.rate[ii] = pool.rate[last];
+            } else {
+                ii++;
+            }
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Rendering
+/**
+ * Draws the live particles via the given SpriteBatch.
+ *
+ * Each emitter type is drawn with a single fill call.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the Node color.
+ */
+void ParticleSystemNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+    for (auto it = _pools.begin(); it != _pools.end(); ++it) {
+        const Pool& pool = *it;
+        if (pool.count == 0) {
+            continue;
+        }
+
+        const Emitter& def = pool.emitter;
+        float minS = 0, maxS = 1, minT = 0, maxT = 1;
+        if (def.texture != nullptr) {
+            minS = def.texture->getMinS();
+            maxS = def.texture->getMaxS();
+            minT = def.texture->getMinT();
+            maxT = def.texture->getMaxT();
+        }
+        float spanS = (maxS-minS)/def.cols;
+        float spanT = (maxT-minT)/def.rows;
+        float hw = pool.size.width/2.0f;
+        float hh = pool.size.height/2.0f;
+
+        for (int ii = 0; ii < pool.count; ii++) {
+            int frame = std::min((int)(pool.age[ii]*pool.frames), pool.frames-1);
+            float s0 = minS+(frame % def.cols)*spanS;
+            float t0 = minT+(frame / def.cols)*spanT;
+            Color4 color = def.startColor.getLerp(def.endColor, pool.age[ii]);
+
+            Vertex2* quad = &_vertices[4*ii];
+            quad[0].position.set(pool.px[ii]-hw, pool.py[ii]-hh);
+            quad[0].texcoord.set(s0, t0+spanT);
+            quad[1].position.set(pool.px[ii]+hw, pool.py[ii]-hh);
+            quad[1].texcoord.set(s0+spanS, t0+spanT);
+            quad[2].position.set(pool.px[ii]+hw, pool.py[ii]+hh);
+            quad[2].texcoord.set(s0+spanS, t0);
+            quad[3].position.set(pool.px[ii]-hw, pool.py[ii]+hh);
+            quad[3].texcoord.set(s0, t0);
+            for (int jj = 0; jj < 4; jj++) {
+                quad[jj].color = color;
+            }
+        }
+
+        batch->setColor(tint);
+        batch->setTexture(def.texture);
+        batch->setBlendEquation(GL_FUNC_ADD);
+        batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        batch->fill(_vertices.data(), (unsigned int)(4*pool.count), 0,
+                    _indices.data(), (unsigned int)(6*pool.count), 0, transform);
+    }
+}
@@ -41,6 +41,7 @@
 
 #include <cugl/2d/CUScene.h>
 #include <cugl/util/CUStrings.h>
+#include <cugl/util/CUFrameRecorder.h>
 #include <sstream>
 #include <algorithm>
 
@@ -63,6 +64,7 @@ _srcFactor(GL_SRC_ALPHA),
 _dstFactor(GL_ONE_MINUS_SRC_ALPHA),
 _zDirty(false),
 _zSort(false),
+_dirty(true),
 _active(false)
 {}
 
@@ -79,6 +81,7 @@ void Scene::dispose() {
     _color = Color4::WHITE;
     _zDirty = false;
     _zSort  = false;
+    _dirty  = true;
     _active = false;
 }
 
@@ -254,6 +257,7 @@ void Scene::addChild(const std::shared_ptr<Node>& child, int zval) {
     _children.push_back(child);
     child->setParent(nullptr);
     child->pushScene(this);
+    _dirty = true;
 }
 
 /**
@@ -277,6 +281,7 @@ void Scene::swapChild(const std::shared_ptr<Node>& child1, const std::shared_ptr
     child1->setParent(nullptr);
     child2->pushScene(this);
     child1->pushScene(nullptr);
+    _dirty = true;
 
     // Check if we are dirty and/or inherit children
     bool childdirty = false;
@@ -305,6 +310,7 @@ void Scene::removeChild(unsigned int pos) {
     child->setParent(nullptr);
     child->pushScene(nullptr);
     child->_childOffset = -1;
+    _dirty = true;
     for(int ii = pos; ii < _children.size()-1; ii++) {
         _children[ii] = _children[ii+1];
         _children[ii]->_childOffset = ii;
@@ -374,10 +380,30 @@ void Scene::removeAllChildren() {
         (*it)->_childOffset = -1;
         (*it)->pushScene(nullptr);
     }
+    _dirty = _dirty || !_children.empty();
     _children.clear();
     _zDirty = false;
 }
 
+#pragma mark -
+#pragma mark Redrawing
+/**
+ * Returns true if this scene has changed since it was last rendered.
+ *
+ * A scene changes whenever a node in it changes its transform, color,
+ * visibility, or texture, whenever a node is added or removed, and
+ * whenever the camera moves.  Nodes report their own changes with
+ * {@link Node#markDirty}.  If this value is false, the last render is
+ * still correct, so an application may skip drawing the frame.
+ *
+ * A scene is dirty when it is first created.
+ *
+ * @return true if this scene has changed since it was last rendered.
+ */
+bool Scene::isDirty() const {
+    return _dirty || (_camera != nullptr && _camera->getCombined() != _rendered);
+}
+
 #pragma mark -
 #pragma mark Z-order
 /**
@@ -389,6 +415,7 @@ void Scene::removeAllChildren() {
  */
 void Scene::sortZOrder() {
     if (_zDirty) {
+        FrameRecorder::Scope scope(FrameRecorder::SORT);
         std::sort(_children.begin(),_children.end(),Node::compareNodeSibs);
         // Fix the offsets
         int ii = 0;
@@ -431,4 +458,6 @@ void Scene::render(const std::shared_ptr<SpriteBatch>& batch) {
     batch->end();
     batch->setBlendFunc(_srcFactor, _dstFactor);
     batch->setBlendEquation(_blendEquation);
+    _rendered = _camera->getCombined();
+    _dirty = false;
 }
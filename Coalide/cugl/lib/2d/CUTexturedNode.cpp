@@ -352,6 +352,7 @@ void TexturedNode::setTexture(const std::shared_ptr<Texture>& texture) {
     if (_texture != temp) {
         _texture = temp;
         updateTextureCoords();
+        markDirty();
     }
 }
 
@@ -390,6 +391,7 @@ void TexturedNode::shiftPolygon(float dx, float dy) {
         it->texcoord.x += dx/w;
         it->texcoord.y -= dy/h;
     }
+    markDirty();
 }
 
 /**
@@ -486,7 +488,7 @@ void TexturedNode::generateRenderData() {
 void TexturedNode::clearRenderData() {
     _vertices.clear();
     _rendered = false;
-    
+    markDirty();
 }
 
 /**
@@ -497,6 +499,7 @@ void TexturedNode::clearRenderData() {
  * of the texture.
  */
 void TexturedNode::updateTextureCoords() {
+    markDirty();
     if (!_rendered) {
         return;
     }
@@ -45,6 +45,7 @@
 //  Version: 11/6/16
 //
 #include <cugl/2d/physics/CUObstacle.h>
+#include <Box2D/Dynamics/b2World.h>
 #include <memory>
 #include <iostream>
 #include <sstream>
@@ -63,7 +64,10 @@ using namespace cugl;
 Obstacle::Obstacle() :
 _scene(nullptr),
 _debug(nullptr),
-_listener(nullptr)
+_listener(nullptr),
+_worldIndex(-1),
+_alwaysIndex(-1),
+_updateStep(0)
 { }
 
 /**
@@ -100,10 +104,32 @@ bool Obstacle::init(const Vec2& vec) {
     
     // Turn off the mass information
     _masseffect = false;
+    _grounded = false;
+    _alwaysUpdated = false;
     
     return true;
 }
 
+/**
+ * Sets whether this body is slowed by the surface friction of the world.
+ *
+ * In a top-down game, bodies slide over the ground. If the ObstacleWorld
+ * has a surface friction grid, each step applies the friction of the cell
+ * under a grounded body to that body.  Bodies that are not grounded (such
+ * as projectiles) are unaffected by the grid.
+ *
+ * Clearing this flag removes any surface friction from the body.
+ *
+ * @param value whether this body is slowed by the surface friction of the world.
+ */
+void Obstacle::setGrounded(bool value) {
+    _grounded = value;
+    b2Body* body = getBody();
+    if (!value && body != nullptr) {
+        body->SetSurfaceFriction(0.0f);
+    }
+}
+
 /**
  * Copies the state from the given body to the body def.
  *
@@ -239,6 +265,29 @@ void Obstacle::updateDebug() {
 }
 
 
+#pragma mark -
+#pragma mark Garbage Collection
+/**
+ * Sets whether the shape information must be updated.
+ *
+ * Attributes tied to the geometry (and not just forces/position) must wait for
+ * collisions to complete before they are reset.  Shapes (and their properties)
+ * are reset in the update method.
+ *
+ * As a world only updates the obstacles that moved, a dirty obstacle is
+ * marked as moved so that its shape is reset on the next step.
+ *
+ * @param value  whether the shape information must be updated.
+ */
+void Obstacle::markDirty(bool value) {
+    _dirty = value;
+    b2Body* body = getBody();
+    if (value && body != nullptr) {
+        body->GetWorld()->MarkMoved(body);
+    }
+}
+
+
 #pragma mark -
 #pragma Debugging Methods
 
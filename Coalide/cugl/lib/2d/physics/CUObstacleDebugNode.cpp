@@ -0,0 +1,90 @@
+//
+//  CUObstacleDebugNode.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a scene graph node that draws the debug data of an
+//  ObstacleWorld (shapes, AABBs, joints, contacts and the broad-phase).  It
+//  replaces the old approach of giving every obstacle its own wireframe node,
+//  which had to be rebuilt whenever an obstacle changed.  The node has no
+//  state of its own; it asks the world for the debug data each frame and
+//  draws it all as one batch of lines.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/2d/physics/CUObstacleDebugNode.h>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this node.
+ *
+ * A disposed node can be safely reinitialized. The world is released.
+ */
+void ObstacleDebugNode::dispose() {
+    _world = nullptr;
+    Node::dispose();
+}
+
+/**
+ * Initializes a debug node for the given world.
+ *
+ * @param world The world to draw
+ *
+ * @return true if initialization was successful.
+ */
+bool ObstacleDebugNode::initWithWorld(const std::shared_ptr<ObstacleWorld>& world) {
+    if (!Node::init()) {
+        return false;
+    }
+    _world = world;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Rendering
+/**
+ * Draws the debug data of the world via the given SpriteBatch.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the Node color.
+ */
+void ObstacleDebugNode::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+    if (_world != nullptr) {
+        _world->drawDebug(batch, transform, tint);
+    }
+}
@@ -48,6 +48,9 @@
 #include <Box2D/Collision/b2Collision.h>
 #include <cugl/2d/physics/CUObstacleWorld.h>
 #include <cugl/2d/physics/CUObstacle.h>
+#include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUFrameRecorder.h>
+#include <cugl/renderer/CUSpriteBatch.h>
 
 using namespace cugl;
 
@@ -55,6 +58,12 @@ using namespace cugl;
 
 /** The default value of gravity (going down) */
 #define DEFAULT_GRAVITY -9.8f
+/** The number of segments in a debug circle */
+#define DEBUG_CIRCLE_SEGMENTS   16
+/** The length of the axes of a debug transform */
+#define DEBUG_AXIS_LENGTH       0.4f
+/** The most debug vertices in one outline call (even, so segments are not split) */
+#define DEBUG_BATCH_VERTICES    65534
 
 #pragma mark -
 #pragma mark Proxy Classes
@@ -151,6 +160,101 @@ public:
     }
 };
 
+/**
+ * A b2Draw implementation that streams line segments into a vertex list.
+ *
+ * Solid shapes are outlined, since the whole list is drawn as lines.
+ */
+class DebugDrawProxy : public b2Draw {
+public:
+    /** The vertex list to append to (two vertices per segment) */
+    std::vector<Vertex2>* lines;
+    /** The size of a screen pixel in physics units */
+    float pixel;
+    
+    /**
+     * Creates a new debug draw proxy
+     */
+    DebugDrawProxy() : lines(nullptr), pixel(1.0f) { }
+    
+    /**
+     * Appends a line segment in the given color.
+     *
+     * @param p1    The segment start
+     * @param p2    The segment end
+     * @param color The segment color
+     */
+    void append(const b2Vec2& p1, const b2Vec2& p2, Color4 color) {
+        Vertex2 vert;
+        vert.color = color;
+        vert.position.set(p1.x,p1.y);
+        lines->push_back(vert);
+        vert.position.set(p2.x,p2.y);
+        lines->push_back(vert);
+    }
+    
+    /**
+     * Returns the CUGL color for a Box2D color.
+     *
+     * @param color The Box2D color
+     *
+     * @return the CUGL color for a Box2D color.
+     */
+    static Color4 convert(const b2Color& color) {
+        return Color4(Color4f(color.r,color.g,color.b,color.a));
+    }
+    
+    /** Draws a closed polygon provided in CCW order. */
+    void DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override {
+        Color4 tint = convert(color);
+        for(int32 ii = 0; ii < vertexCount; ii++) {
+            append(vertices[ii],vertices[(ii+1) % vertexCount],tint);
+        }
+    }
+    
+    /** Draws a solid closed polygon provided in CCW order. */
+    void DrawSolidPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color) override {
+        DrawPolygon(vertices, vertexCount, color);
+    }
+    
+    /** Draws a circle. */
+    void DrawCircle(const b2Vec2& center, float32 radius, const b2Color& color) override {
+        Color4 tint = convert(color);
+        float32 step = 2.0f*b2_pi/DEBUG_CIRCLE_SEGMENTS;
+        b2Vec2 prev = center+radius*b2Vec2(1.0f,0.0f);
+        for(int ii = 1; ii <= DEBUG_CIRCLE_SEGMENTS; ii++) {
+            b2Vec2 next = center+radius*b2Vec2(cosf(ii*step),sinf(ii*step));
+            append(prev,next,tint);
+            prev = next;
+        }
+    }
+    
+    /** Draws a solid circle, with a line showing its rotation. */
+    void DrawSolidCircle(const b2Vec2& center, float32 radius, const b2Vec2& axis, const b2Color& color) override {
+        DrawCircle(center, radius, color);
+        append(center,center+radius*axis,convert(color));
+    }
+    
+    /** Draws a line segment. */
+    void DrawSegment(const b2Vec2& p1, const b2Vec2& p2, const b2Color& color) override {
+        append(p1,p2,convert(color));
+    }
+    
+    /** Draws a transform as a red x-axis and a green y-axis. */
+    void DrawTransform(const b2Transform& xf) override {
+        append(xf.p,xf.p+DEBUG_AXIS_LENGTH*xf.q.GetXAxis(),Color4::RED);
+        append(xf.p,xf.p+DEBUG_AXIS_LENGTH*xf.q.GetYAxis(),Color4::GREEN);
+    }
+    
+    /** Draws a point as a cross that is size pixels wide. */
+    void DrawPoint(const b2Vec2& p, float32 size, const b2Color& color) override {
+        Color4 tint = convert(color);
+        float32 half = 0.5f*size*pixel;
+        append(p+b2Vec2(-half,-half),p+b2Vec2(half,half),tint);
+        append(p+b2Vec2(-half,half),p+b2Vec2(half,-half),tint);
+    }
+};
+
 
 #pragma mark -
 #pragma mark Constructors
@@ -162,9 +266,14 @@ public:
  */
 ObstacleWorld::ObstacleWorld() :
 _world(nullptr),
+_stepCount(0),
+_surfaceCols(0),
+_surfaceRows(0),
+_surfaceSize(1.0f),
 _collide(false),
 _filters(false),
-_destroy(false) {
+_destroy(false),
+_debugFlags(DEBUG_SHAPES) {
     _lockstep   = false;
     _stepssize  = DEFAULT_WORLD_STEP;
     _itvelocity = DEFAULT_WORLD_VELOC;
@@ -189,6 +298,12 @@ void ObstacleWorld::dispose() {
         delete _world;
         _world  = nullptr;
     }
+    _solverThreads = nullptr;
+    _debugLines.clear();
+    _debugIndices.clear();
+    _surface.clear();
+    _surfaceCols = 0;
+    _surfaceRows = 0;
     onBeginContact = nullptr;
     onEndContact   = nullptr;
     beforeSolve    = nullptr;
@@ -229,13 +344,44 @@ bool ObstacleWorld::init(const Rect& bounds) {
  * @return  true if the controller is initialized properly, false otherwise.
  */
 bool ObstacleWorld::init(const Rect& bounds, const Vec2& gravity) {
+    return init(bounds,gravity,0.0f);
+}
+
+/**
+ * Initializes a new physics world with a uniform grid broadphase
+ *
+ * The specified bounds are in terms of the Box2d world, not the screen.
+ * A few attached to this Box2d world should have ways to convert between
+ * the coordinate systems.
+ *
+ * By default, Box2d finds collision pairs with a dynamic AABB tree. If
+ * cellSize is positive, this world will instead use a uniform grid of
+ * that cell size covering the bounds.  The grid is much cheaper to update
+ * when the world is bounded and every obstacle is about a cell in size,
+ * as in a tile-based level.  Obstacles outside of the bounds still collide,
+ * but they share the border cells.
+ *
+ * @param  bounds   The game bounds in Box2d coordinates
+ * @param  gravity  The gravitational force on this Box2d world
+ * @param  cellSize The broadphase cell size (0 for the dynamic tree)
+ *
+ * @return  true if the controller is initialized properly, false otherwise.
+ */
+bool ObstacleWorld::init(const Rect& bounds, const Vec2& gravity, float cellSize) {
     CUAssertLog(!_world,"Attempt to reinitialize and active world");
+    CUAssertLog(cellSize >= 0, "Broadphase cell size %.3f is negative", cellSize);
     _bounds = bounds;
     _world = new b2World(b2Vec2(gravity.x,gravity.y));
-    if (_world) {
-        return true;
+    if (!_world) {
+        return false;
+    }
+    if (cellSize > 0) {
+        b2AABB aabb;
+        aabb.lowerBound.Set(bounds.getMinX(),bounds.getMinY());
+        aabb.upperBound.Set(bounds.getMaxX(),bounds.getMaxY());
+        _world->UseUniformGrid(aabb,cellSize);
     }
-    return false;
+    return true;
 }
 
 
@@ -256,8 +402,19 @@ bool ObstacleWorld::init(const Rect& bounds, const Vec2& gravity) {
  */
 void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
     CUAssertLog(inBounds(obj.get()), "Obstacle is not in bounds");
+    CUAssertLog(obj->_worldIndex < 0, "Obstacle is already in a world");
+    obj->_worldIndex = (int)_objects.size();
     _objects.push_back(obj);
+    if (obj->isAlwaysUpdated()) {
+        obj->_alwaysIndex = (int)_alwaysUpdated.size();
+        _alwaysUpdated.push_back(obj.get());
+    }
     obj->activatePhysics(*_world);
+    
+    b2Body* body = obj->getBody();
+    if (!_surface.empty() && obj->isGrounded() && body != nullptr) {
+        body->SetSurfaceFriction(getSurfaceFriction(obj->getPosition()));
+    }
 }
 
 /**
@@ -275,14 +432,13 @@ void ObstacleWorld::addObstacle(const std::shared_ptr<Obstacle>& obj) {
  * @release a reference to the obstacle
  */
 void ObstacleWorld::removeObstacle(Obstacle* obj) {
-    for(auto it = _objects.begin(); it != _objects.end(); ++it) {
-        if (it->get() == obj) {
-            obj->deactivatePhysics(*_world);
-            _objects.erase(it);
-            return;
-        }
+    int index = obj->_worldIndex;
+    if (index < 0 || index >= (int)_objects.size() || _objects[index].get() != obj) {
+        CUAssertLog(false, "Physics object not present in world");
+        return;
     }
-    CUAssertLog(false, "Physics object not present in world");
+    obj->deactivatePhysics(*_world);
+    detachObstacle(index);
 }
 
 /**
@@ -294,22 +450,44 @@ void ObstacleWorld::removeObstacle(Obstacle* obj) {
  * This method is the efficient, preferred way to remove objects.
  */
 void ObstacleWorld::garbageCollect() {
-    size_t count = 0;
-    size_t pos = 0;
-    for(size_t ii = 0; ii < _objects.size(); ii++) {
+    size_t ii = 0;
+    while (ii < _objects.size()) {
         if (_objects[ii]->isRemoved()) {
+            // The last object moves into this slot, so check it next
             _objects[ii]->deactivatePhysics(*_world);
-            _objects[ii] = nullptr;
+            detachObstacle(ii);
         } else {
-            if (pos != ii) {
-                _objects[pos] = _objects[ii];
-                _objects[ii]  = nullptr;
-            }
-            pos++;
-            count++;
+            ii++;
         }
     }
-    _objects.resize(count);
+}
+
+/**
+ * Removes the obstacle at the given position from the object lists.
+ *
+ * The last obstacle is swapped into its place, so this takes constant time.
+ * This method does not deactivate the physics of the obstacle.
+ *
+ * @param index The position of the obstacle in the object list
+ *
+ * @release a reference to the obstacle
+ */
+void ObstacleWorld::detachObstacle(size_t index) {
+    Obstacle* obj = _objects[index].get();
+    if (obj->_alwaysIndex >= 0) {
+        Obstacle* last = _alwaysUpdated.back();
+        _alwaysUpdated[obj->_alwaysIndex] = last;
+        last->_alwaysIndex = obj->_alwaysIndex;
+        _alwaysUpdated.pop_back();
+        obj->_alwaysIndex = -1;
+    }
+    obj->_worldIndex = -1;
+    
+    if (index+1 < _objects.size()) {
+        _objects[index] = std::move(_objects.back());
+        _objects[index]->_worldIndex = (int)index;
+    }
+    _objects.pop_back();
 }
 
 /**
@@ -322,8 +500,12 @@ void ObstacleWorld::clear() {
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
         obj->deactivatePhysics(*_world);
+        obj->_worldIndex = -1;
+        obj->_alwaysIndex = -1;
     }
     _objects.clear();
+    _alwaysUpdated.clear();
+    _moved.clear();
 }
 
 
@@ -359,12 +541,44 @@ void ObstacleWorld::setGravity(const Vec2& gravity) {
  * @param delta Number of seconds since last animation frame
  */
 void ObstacleWorld::update(float dt) {
+    FrameRecorder::Scope scope(FrameRecorder::PHYSICS);
+    
     // Turn the physics engine crank.
     _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+    _stepCount++;
     
-    // Post process all objects after physics (this updates graphics)
-    for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
-        Obstacle* obj = it->get();
+    // Collect the obstacles that moved. Child bodies of a complex obstacle
+    // are not in this world, and are updated by their parent.
+    _moved.clear();
+    b2Body* const* bodies = _world->GetMovedBodies();
+    for(int ii = 0; ii < _world->GetMovedBodyCount(); ii++) {
+        Obstacle* obj = (bodies[ii] == nullptr ? nullptr : (Obstacle*)bodies[ii]->GetUserData());
+        if (obj != nullptr && obj->_worldIndex >= 0 && obj->_updateStep != _stepCount &&
+            _objects[obj->_worldIndex].get() == obj) {
+            obj->_updateStep = _stepCount;
+            _moved.push_back(obj);
+        }
+    }
+    
+    // Clear before updating, so that anything moved by an update is seen next step
+    _world->ClearMovedBodies();
+    for(auto it = _alwaysUpdated.begin(); it != _alwaysUpdated.end(); ++it) {
+        if ((*it)->_updateStep != _stepCount) {
+            (*it)->_updateStep = _stepCount;
+            _moved.push_back(*it);
+        }
+    }
+    
+    // Post process the objects after physics (this updates graphics)
+    for(auto it = _moved.begin() ; it != _moved.end(); ++it) {
+        Obstacle* obj = *it;
+        
+        // Slow the grounded obstacles by the surface under them. A body that
+        // did not move keeps the friction of the cell it is still in.
+        b2Body* body = obj->getBody();
+        if (!_surface.empty() && obj->isGrounded() && body != nullptr) {
+            body->SetSurfaceFriction(getSurfaceFriction(obj->getPosition()));
+        }
         obj->update(dt);
     }
 }
@@ -442,6 +656,174 @@ void ObstacleWorld::activateDestructionCallbacks(bool flag) {
 }
 
 
+#pragma mark -
+#pragma mark Surface Friction
+/**
+ * Resets the surface friction grid to the given size.
+ *
+ * In a top-down game, the ground resists the motion of the bodies on it.
+ * This grid divides the world (starting at the origin of the bounds) into
+ * square cells, each with its own friction.  Before each step, every
+ * {@link Obstacle#isGrounded()} obstacle receives the friction of the cell
+ * under its position. Friction is the maximum force (and torque) applied
+ * against the motion of the obstacle.  All cells start with no friction.
+ *
+ * A grid with no cells disables surface friction.
+ *
+ * @param  cols the number of columns in the grid
+ * @param  rows the number of rows in the grid
+ * @param  size the width and height of a cell
+ */
+void ObstacleWorld::setSurfaceGrid(int cols, int rows, float size) {
+    CUAssertLog(cols >= 0 && rows >= 0, "Surface grid %d x %d is invalid", cols, rows);
+    CUAssertLog(size > 0, "Surface cell size %f is invalid", size);
+    _surfaceCols = cols;
+    _surfaceRows = rows;
+    _surfaceSize = size;
+    _surface.assign((size_t)(cols*rows), 0.0f);
+}
+
+/**
+ * Returns the surface friction at the given position.
+ *
+ * Positions outside of the grid have no friction.
+ *
+ * @param  pos  the position in Box2d coordinates
+ *
+ * @return the surface friction at the given position.
+ */
+float ObstacleWorld::getSurfaceFriction(const Vec2& pos) const {
+    float x = (pos.x-_bounds.origin.x)/_surfaceSize;
+    float y = (pos.y-_bounds.origin.y)/_surfaceSize;
+    if (x < 0 || y < 0) {
+        return 0.0f;
+    }
+    return getSurfaceFriction((int)x, (int)y);
+}
+
+/**
+ * Sets the surface friction of the given grid cell.
+ *
+ * Friction is the maximum force (and torque) applied against the motion of
+ * an obstacle in this cell.
+ *
+ * @param  col      the grid column
+ * @param  row      the grid row
+ * @param  friction the surface friction
+ */
+void ObstacleWorld::setSurfaceFriction(int col, int row, float friction) {
+    CUAssertLog(col >= 0 && row >= 0 && col < _surfaceCols && row < _surfaceRows,
+                "Surface cell (%d,%d) is out of range", col, row);
+    CUAssertLog(friction >= 0, "Surface friction %f is negative", friction);
+    _surface[row*_surfaceCols+col] = friction;
+}
+
+
+#pragma mark -
+#pragma mark Parallel Solving
+/**
+ * Sets the thread pool used to solve the physics islands.
+ *
+ * An island is a group of obstacles that touch (or are joined), either
+ * directly or through other obstacles.  Islands that only meet at static
+ * obstacles are independent, and can be solved at the same time.  When
+ * this pool is set, each step solves those islands on the pool workers
+ * (and the calling thread).  The results are applied in the same order
+ * as the serial solver, so the simulation is unchanged.
+ *
+ * The collision callbacks are still called on the thread that calls
+ * {@link update}.  Setting this value to nullptr solves every island on
+ * the calling thread.  This method may not be called during a step.
+ *
+ * @param  pool the thread pool for solving islands
+ */
+void ObstacleWorld::setSolverThreads(const std::shared_ptr<ThreadPool>& pool) {
+    CUAssertLog(_world, "Attempt to configure an uninitialized world");
+    _solverThreads = pool;
+    _world->SetTaskScheduler(pool == nullptr ? nullptr : this);
+}
+
+/**
+ * Returns the number of threads that may solve islands at once.
+ *
+ * This is the number of pool workers, plus the thread calling {@link update}.
+ *
+ * @return the number of threads that may solve islands at once.
+ */
+int32 ObstacleWorld::GetParallelism() {
+    return (_solverThreads == nullptr ? 1 : _solverThreads->getThreadCount()+1);
+}
+
+/**
+ * Executes the task count times, and returns when they are all done.
+ *
+ * The executions are spread over the solver threads.
+ *
+ * @param  task     the task to execute
+ * @param  count    the number of executions
+ */
+void ObstacleWorld::Run(b2Task* task, int32 count) {
+    _solverThreads->parallelFor(0, (size_t)count, 1, [=](size_t begin, size_t end) {
+        for(size_t ii = begin; ii < end; ii++) {
+            task->Execute((int32)ii);
+        }
+    });
+}
+
+
+#pragma mark -
+#pragma mark Debug Drawing
+/**
+ * Draws the debug data of this world as lines with the given batch.
+ *
+ * The data comes straight from the Box2D world each call, so there is
+ * no per-obstacle state to keep up to date.  All of the lines are drawn
+ * in as few outline calls as possible (one unless there are more than
+ * 32K segments).
+ *
+ * The transform maps physics coordinates to the coordinates of the batch.
+ * The batch must be active.
+ *
+ * @param batch     The SpriteBatch to draw with
+ * @param transform The transform from physics coordinates
+ * @param tint      The color to multiply with the debug colors
+ */
+void ObstacleWorld::drawDebug(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+    if (_world == nullptr || _debugFlags == 0) {
+        return;
+    }
+    
+    // Points are sized in pixels, so measure a pixel in physics units
+    DebugDrawProxy proxy;
+    float scale = Vec2(transform.m[0],transform.m[1]).length();
+    proxy.pixel = scale > 0 ? 1.0f/scale : 1.0f;
+    proxy.lines = &_debugLines;
+    proxy.SetFlags(_debugFlags);
+    
+    _debugLines.clear();
+    _world->SetDebugDraw(&proxy);
+    _world->DrawDebugData();
+    _world->SetDebugDraw(nullptr);
+    if (_debugLines.empty()) {
+        return;
+    }
+    
+    size_t needed = std::min(_debugLines.size(),(size_t)DEBUG_BATCH_VERTICES);
+    while (_debugIndices.size() < needed) {
+        _debugIndices.push_back((unsigned short)_debugIndices.size());
+    }
+    
+    batch->setColor(tint);
+    batch->setTexture(nullptr);
+    batch->setBlendEquation(GL_FUNC_ADD);
+    batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    for(size_t start = 0; start < _debugLines.size(); start += DEBUG_BATCH_VERTICES) {
+        unsigned int count = (unsigned int)std::min(_debugLines.size()-start,(size_t)DEBUG_BATCH_VERTICES);
+        batch->outline(_debugLines.data()+start, count, 0, _debugIndices.data(), count, 0, transform);
+    }
+}
+
+
 #pragma mark -
 #pragma mark Query Functions
 
@@ -548,3 +548,21 @@ size_t AssetManager::waitCount() const {
     }
     return _preload ? result+1 : result;
 }
+
+/**
+ * Returns the approximate memory used by the loaded assets in bytes.
+ *
+ * The value returned is the sum of the memory usage for all attached
+ * loaders.  Only the textures and font atlases are measured, as they
+ * are the bulk of the (GPU) memory of a game.  This method must be
+ * called on the main thread.
+ *
+ * @return the approximate memory used by the loaded assets in bytes.
+ */
+size_t AssetManager::getMemoryUsage() const {
+    size_t result = 0;
+    for(auto it = _handlers.begin(); it != _handlers.end(); ++it) {
+        result += it->second->getMemoryUsage();
+    }
+    return result;
+}
@@ -249,3 +249,23 @@ bool FontLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback cal
     
     return success;
 }
+
+#pragma mark -
+#pragma mark Properties
+/**
+ * Returns the approximate GPU memory used by the loaded font atlases in bytes.
+ *
+ * Fonts without an atlas render each string to its own texture, and those
+ * textures are not counted.  This method must be called on the main thread.
+ *
+ * @return the approximate GPU memory used by the loaded font atlases in bytes.
+ */
+size_t FontLoader::getMemoryUsage() const {
+    size_t result = 0;
+    for(auto it = _assets.begin(); it != _assets.end(); ++it) {
+        if (it->second->hasAtlas()) {
+            result += it->second->getAtlas()->getMemoryUsage();
+        }
+    }
+    return result;
+}
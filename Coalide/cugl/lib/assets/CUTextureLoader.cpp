@@ -483,3 +483,18 @@ void TextureLoader::parseAtlas(const std::shared_ptr<JsonValue>& json, const std
     }
 }
 
+
+#pragma mark -
+#pragma mark Properties
+/**
+ * Returns the approximate GPU memory used by the loaded textures in bytes.
+ *
+ * @return the approximate GPU memory used by the loaded textures in bytes.
+ */
+size_t TextureLoader::getMemoryUsage() const {
+    size_t result = 0;
+    for(auto it = _assets.begin(); it != _assets.end(); ++it) {
+        result += it->second->getMemoryUsage();
+    }
+    return result;
+}
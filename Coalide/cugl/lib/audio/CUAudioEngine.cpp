@@ -40,6 +40,7 @@
 #include "platform/CUAudioEngine-impl.h"
 #include "CUSoundChannel.h"
 #include "CUMusicQueue.h"
+#include "CUSoundCache.h"
 
 using namespace cugl;
 
@@ -75,7 +76,16 @@ bool AudioEngine::init(unsigned int channels) {
         std::shared_ptr<SoundChannel> entity = SoundChannel::alloc(ii);
         _channels.push_back(entity);
     }
+    _voices.resize(_capacity,0);
+    _voiceCues.resize(_capacity,-1);
+    _voiceVolumes.resize(_capacity,0.0f);
+    _voiceCount = 0;
+    _voiceSerial = 1;
+    for(int ii = 0; ii < AUDIO_BUS_COUNT; ii++) {
+        _buses[ii] = 1.0f;
+    }
     _mqueue = MusicQueue::alloc();
+    _cache  = SoundCache::alloc(AUDIO_CACHE_BUDGET,AUDIO_CACHE_THRESHOLD);
     
     // Initialize callbacks here
     return true;
@@ -90,7 +100,13 @@ bool AudioEngine::init(unsigned int channels) {
 void AudioEngine::dispose() {
     if (_capacity) {
         _mqueue = nullptr;
+        _cache  = nullptr;
         _channels.clear();
+        _cues.clear();
+        _voices.clear();
+        _voiceCues.clear();
+        _voiceVolumes.clear();
+        _voiceCount = 0;
         _capacity = 0;
         
         cugl::impl::AudioStop();
@@ -143,6 +159,15 @@ void AudioEngine::gcEffect(int id, bool status) {
         return;
     } else if (!channel->attached()) {
         return;
+    } else if (_voices[id]) {
+        // Voices have no key to report
+        removeVoice(id);
+        if (channel->attached() == 2) {
+            channel->advance();
+        } else {
+            channel->clear();
+        }
+        return;
     }
     
     std::string key = channel->getPrimaryKey();
@@ -178,6 +203,42 @@ void AudioEngine::removeKey(std::string key) {
     }
 }
 
+/**
+ * Purges the voice on the given channel from the list of active voices.
+ *
+ * This method is the voice equivalent of {@link removeKey}.  It does not
+ * stop the channel; it only releases the voice from its cue.
+ *
+ * @param id    The channel of the voice to purge
+ */
+void AudioEngine::removeVoice(int id) {
+    if (_voices[id]) {
+        _cues[_voiceCues[id]].active--;
+        _voices[id] = 0;
+        _voiceCues[id] = -1;
+        _voiceCount--;
+    }
+}
+
+
+/**
+ * Stops the voice on the given channel and purges it.
+ *
+ * A voice that is still waiting in the shadow of a stopped sound is swapped
+ * in first, as a channel can only stop its primary sound.
+ *
+ * @param id    The channel of the voice to stop
+ */
+void AudioEngine::haltVoice(int id) {
+    SoundChannel* channel = _channels[id].get();
+    if (channel->attached() == 2) {
+        channel->advance();
+    }
+    if (!channel->isStopped()) {
+        channel->stop();
+    }
+    removeVoice(id);
+}
 
 #pragma mark -
 #pragma mark Static Accessors
@@ -677,6 +738,7 @@ bool AudioEngine::playEffect(const std::string& key, const std::shared_ptr<Sound
         _channels[audioID]->attach(key,sound,vol,loop);
         _channels[audioID]->play();
     }
+    _channels[audioID]->setPriority(0);
     _effects.emplace(key,audioID);
     _equeue.push_back(key);
     return true;
@@ -957,6 +1019,9 @@ void AudioEngine::stopAllEffects() {
     }
     _effects.clear();
     _equeue.clear();
+    for(int ii = 0; ii < _capacity; ii++) {
+        removeVoice(ii);
+    }
 }
 
 /**
@@ -984,6 +1049,342 @@ void AudioEngine::resumeAllEffects() {
 }
 
 
+#pragma mark -
+#pragma mark Sound Cues
+/**
+ * Registers a preloaded sound as a cue, returning the cue id.
+ *
+ * Cues are an alternative to key-based sound effects for sounds that are
+ * triggered often, such as collision sounds.  A cue is registered once,
+ * and every call to {@link playCue} returns a lightweight integer voice
+ * handle.  Neither playing a cue nor querying a voice allocates strings
+ * or performs any map lookups.
+ *
+ * The limit is the maximum number of voices of this cue that may play at
+ * the same time.  This limit is enforced by the engine, so the application
+ * does not need to check whether the sound is already playing.
+ *
+ * The priority decides which voices are sacrificed when there are too
+ * many sounds.  When every channel is busy, a new voice steals the channel
+ * of the lowest priority voice, provided that voice has a lower priority
+ * than the new one.  Mixing backends with a time budget also drop the
+ * lowest priority voices first.  Key-based sound effects have priority 0.
+ *
+ * The bus is the volume group of the cue {@see setBusVolume}.
+ *
+ * Cue ids are reused after {@link unregisterCue}.  This method returns -1
+ * if the sound is nullptr, the limit is 0, or the bus is out of range.
+ *
+ * @param sound     The sound asset for the cue
+ * @param limit     The maximum number of simultaneous voices for the cue
+ * @param priority  The voice priority (higher values are more important)
+ * @param bus       The volume bus for the cue
+ *
+ * @return the cue id (or -1 on failure)
+ */
+int AudioEngine::registerCue(const std::shared_ptr<Sound>& sound, unsigned int limit,
+                             int priority, unsigned int bus) {
+    if (sound == nullptr || limit == 0) {
+        CULogError("Cue requires a sound and a positive instance limit");
+        return -1;
+    } else if (bus >= AUDIO_BUS_COUNT) {
+        CULogError("Bus %d is out of range", bus);
+        return -1;
+    }
+    
+    int cue = -1;
+    for(int ii = 0; cue == -1 && ii < (int)_cues.size(); ii++) {
+        if (_cues[ii].sound == nullptr) {
+            cue = ii;
+        }
+    }
+    if (cue == -1) {
+        cue = (int)_cues.size();
+        _cues.push_back(Cue());
+    }
+    _cues[cue].sound  = sound;
+    _cues[cue].limit  = limit;
+    _cues[cue].active = 0;
+    _cues[cue].priority = priority;
+    _cues[cue].bus = bus;
+    return cue;
+}
+
+/**
+ * Unregisters the given cue, stopping all of its voices.
+ *
+ * The cue id may be returned by a later call to {@link registerCue}.
+ *
+ * @param cue   The cue id
+ */
+void AudioEngine::unregisterCue(int cue) {
+    CUAssertLog(cue >= 0 && cue < (int)_cues.size(), "Cue %d is out of range", cue);
+    for(int ii = 0; _cues[cue].active && ii < _capacity; ii++) {
+        if (_voiceCues[ii] == cue) {
+            haltVoice(ii);
+        }
+    }
+    _cues[cue].sound = nullptr;
+    _cues[cue].limit = 0;
+}
+
+/**
+ * Plays a voice of the given cue, returning the voice handle.
+ *
+ * If the cue already has as many active voices as its limit, the voice
+ * will not play unless force is true.  In that case, it will stop the
+ * oldest voice of this cue and take its place.  If there are no available
+ * channels, this method steals the channel of the lowest priority voice
+ * (the oldest among equals) if that voice has a lower priority than this
+ * cue.  If force is true, it steals that channel regardless of priority.
+ * A cue never interrupts a key-based sound effect.
+ *
+ * A voice handle is never 0, so this method returns 0 if the voice could
+ * not be played.  Handles become stale when the voice completes or is
+ * stopped; every voice method is safe to call with a stale handle.
+ *
+ * @param  cue      The cue id
+ * @param  loop     Whether to loop the voice continuously
+ * @param  volume   The voice volume (< 0 to use asset default volume)
+ * @param  force    Whether to force another voice to stop.
+ *
+ * @return the voice handle (or 0 if the voice could not be played)
+ */
+Uint32 AudioEngine::playCue(int cue, bool loop, float volume, bool force) {
+    CUAssertLog(cue >= 0 && cue < (int)_cues.size() && _cues[cue].sound != nullptr,
+                "Cue %d is not registered", cue);
+    
+    // Handles are serial*capacity+channel, so the oldest has the least handle
+    int audioID = -1;
+    bool shadow = false;
+    Cue* entry = &_cues[cue];
+    if (entry->active >= entry->limit) {
+        if (!force) {
+            return 0;
+        }
+        for(int ii = 0; ii < _capacity; ii++) {
+            if (_voiceCues[ii] == cue && (audioID == -1 || _voices[ii] < _voices[audioID])) {
+                audioID = ii;
+            }
+        }
+    }
+    
+    for(int ii = 0; audioID == -1 && ii < _capacity; ii++) {
+        if (!_channels[ii]->attached()) {
+            audioID = ii;
+        }
+    }
+    
+    // Search for those queued for deletion if necessary
+    for(int ii = 0; audioID == -1 && ii < _capacity; ii++) {
+        if (_channels[ii]->isStopped() && _channels[ii]->attached() == 1) {
+            audioID = ii;
+            shadow = true;
+        }
+    }
+    
+    if (audioID == -1) {
+        int victim = -1;
+        for(int ii = 0; ii < _capacity; ii++) {
+            if (_voices[ii]) {
+                if (victim == -1) {
+                    victim = ii;
+                } else {
+                    int p1 = _cues[_voiceCues[ii]].priority;
+                    int p2 = _cues[_voiceCues[victim]].priority;
+                    if (p1 < p2 || (p1 == p2 && _voices[ii] < _voices[victim])) {
+                        victim = ii;
+                    }
+                }
+            }
+        }
+        if (victim != -1 && (force || _cues[_voiceCues[victim]].priority < entry->priority)) {
+            audioID = victim;
+        }
+    }
+    
+    if (audioID == -1) {
+        // Fail if nothing available
+        CULogError("No available sound channels");
+        return 0;
+    } else if (_voices[audioID]) {
+        haltVoice(audioID);
+        shadow = true;
+    }
+    
+    float vol = (volume >= 0 ? volume : entry->sound->getVolume());
+    std::shared_ptr<SoundChannel> thechannel = _channels[audioID];
+    thechannel->attach(std::string(),entry->sound,vol*_buses[entry->bus],loop);
+    thechannel->setPriority(entry->priority);
+    if (shadow) {
+        Application::get()->schedule([=] {
+            if (thechannel->attached() == 2) {
+                thechannel->advance();
+            }
+            return false;
+        });
+    } else {
+        thechannel->play();
+    }
+    
+    Uint32 voice = _voiceSerial*_capacity+audioID;
+    _voiceSerial = (_voiceSerial < UINT32_MAX/_capacity-1 ? _voiceSerial+1 : 1);
+    _voices[audioID] = voice;
+    _voiceCues[audioID] = cue;
+    _voiceVolumes[audioID] = vol;
+    _voiceCount++;
+    entry->active++;
+    return voice;
+}
+
+/**
+ * Returns the current state of the given voice.
+ *
+ * If the voice handle is stale, it returns State::INACTIVE.
+ *
+ * @param  voice    the voice handle
+ *
+ * @return the current state of the given voice.
+ */
+AudioEngine::State AudioEngine::getVoiceState(Uint32 voice) const {
+    int id = getVoiceChannel(voice);
+    if (id == -1) {
+        return State::INACTIVE;
+    }
+    return _channels[id]->isPaused() ? State::PAUSED : State::PLAYING;
+}
+
+/**
+ * Sets the current volume of the given voice.
+ *
+ * The volume is relative to the bus of the voice.  If the voice handle
+ * is stale, this method does nothing.
+ *
+ * @param  voice    the voice handle
+ * @param  volume   the current volume of the voice
+ */
+void AudioEngine::setVoiceVolume(Uint32 voice, float volume) {
+    int id = getVoiceChannel(voice);
+    if (id != -1) {
+        _voiceVolumes[id] = volume;
+        _channels[id]->setVolume(volume*_buses[_cues[_voiceCues[id]].bus]);
+    }
+}
+
+/**
+ * Stops the given voice, releasing its channel.
+ *
+ * If the voice handle is stale, this method does nothing.
+ *
+ * @param  voice    the voice handle
+ */
+void AudioEngine::stopVoice(Uint32 voice) {
+    int id = getVoiceChannel(voice);
+    if (id != -1) {
+        haltVoice(id);
+    }
+}
+
+/**
+ * Sets the volume of the given bus.
+ *
+ * Every voice of a cue on this bus plays at its own volume times the
+ * bus volume.  The change applies to the active voices immediately.
+ *
+ * @param  bus      the bus index
+ * @param  volume   the bus volume (0 to 1)
+ */
+void AudioEngine::setBusVolume(unsigned int bus, float volume) {
+    CUAssertLog(bus < AUDIO_BUS_COUNT, "Bus %d is out of range", bus);
+    CUAssertLog(volume >= 0 && volume <= 1, "The volume %.3f is out of range", volume);
+    _buses[bus] = volume;
+    for(int ii = 0; ii < _capacity; ii++) {
+        if (_voices[ii] && _cues[_voiceCues[ii]].bus == bus) {
+            _channels[ii]->setVolume(_voiceVolumes[ii]*volume);
+        }
+    }
+}
+
+
+#pragma mark -
+#pragma mark Sound Cache
+/**
+ * Returns the memory budget (in bytes) of the sound cache.
+ *
+ * Sound assets for the same file share one decoded buffer.  Buffers
+ * stay in the cache after their sounds are released, so that they can
+ * be reused by the next level.  Unused buffers are freed (oldest first)
+ * whenever the cache exceeds this budget.
+ *
+ * @return the memory budget (in bytes) of the sound cache.
+ */
+size_t AudioEngine::getSoundBudget() const {
+    return _cache->getBudget();
+}
+
+/**
+ * Sets the memory budget (in bytes) of the sound cache.
+ *
+ * Sound assets for the same file share one decoded buffer.  Buffers
+ * stay in the cache after their sounds are released, so that they can
+ * be reused by the next level.  Unused buffers are freed (oldest first)
+ * whenever the cache exceeds this budget.
+ *
+ * @param bytes The memory budget (in bytes) of the sound cache
+ */
+void AudioEngine::setSoundBudget(size_t bytes) {
+    _cache->setBudget(bytes);
+}
+
+/**
+ * Returns the size (in bytes) of the largest sound in the cache.
+ *
+ * Sounds that decode to more than this are not cached.  Each such asset
+ * owns its buffer, and frees it when it is deleted.  Audio that long
+ * should generally be loaded as {@link Music}, which is streamed.
+ *
+ * @return the size (in bytes) of the largest sound in the cache.
+ */
+size_t AudioEngine::getSoundThreshold() const {
+    return _cache->getThreshold();
+}
+
+/**
+ * Sets the size (in bytes) of the largest sound in the cache.
+ *
+ * Sounds that decode to more than this are not cached.  Each such asset
+ * owns its buffer, and frees it when it is deleted.  Audio that long
+ * should generally be loaded as {@link Music}, which is streamed.  This
+ * setting only applies to sounds loaded after the call.
+ *
+ * @param bytes The size (in bytes) of the largest sound in the cache
+ */
+void AudioEngine::setSoundThreshold(size_t bytes) {
+    _cache->setThreshold(bytes);
+}
+
+/**
+ * Returns the memory (in bytes) of all the buffers in the sound cache.
+ *
+ * This includes unused buffers that have not been freed yet, but not
+ * sounds over the cache threshold.
+ *
+ * @return the memory (in bytes) of all the buffers in the sound cache.
+ */
+size_t AudioEngine::getSoundMemory() const {
+    return _cache->getUsage();
+}
+
+/**
+ * Frees every buffer in the sound cache that is not in use.
+ *
+ * Call this after unloading a level to release its sounds immediately.
+ */
+void AudioEngine::purgeSounds() {
+    _cache->purge();
+}
+
+
 #pragma mark -
 #pragma mark Global Management
 /**
@@ -50,6 +50,7 @@
 #include <cugl/util/CUDebug.h>
 #include <cugl/audio/CUAudioEngine.h>
 #include "platform/CUAudioEngine-impl.h"
+#include "CUSoundCache.h"
 
 using namespace cugl;
 
@@ -60,11 +61,16 @@ using namespace cugl;
  * sound data to use it.
  */
 void Sound::dispose() {
-    _source.clear();
     if (_buffer) {
-        cugl::impl::AudioFreeBuffer(_buffer);
+        if (_cache) {
+            _cache->release(_source);
+        } else {
+            cugl::impl::AudioFreeBuffer(_buffer);
+        }
         _buffer = nullptr;
     }
+    _cache = nullptr;
+    _source.clear();
 }
 
 /**
@@ -72,6 +78,8 @@ void Sound::dispose() {
  *
  * The sound will be decompressed into PCM (e.g. WAV data) which is
  * possibly large. This will be stored in a platform specific buffer.
+ * If another sound has already decompressed this file, this sound will
+ * share its buffer.
  *
  * @param  source   the source file for the sound
  *
@@ -81,7 +89,13 @@ bool Sound::init(const std::string& source) {
     CUAssertLog(AudioEngine::get(), "AudioEngine must be initialized before loading sound assets");
 
     _source = source;
-    _buffer = cugl::impl::AudioLoadBuffer(source.c_str());
+    _cache  = AudioEngine::get()->_cache;
+    
+    bool cached = false;
+    _buffer = _cache->acquire(source,cached);
+    if (!cached) {
+        _cache = nullptr;
+    }
     return (bool)_buffer;
 }
 
@@ -0,0 +1,252 @@
+//
+//  CUSoundCache.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a shared cache of decoded sound effects.  Sound assets
+//  that load the same file share a single PCM buffer, already converted to
+//  the format of the output device.  The cache tracks the memory of every
+//  buffer, and keeps released buffers around (for the next level) until it
+//  exceeds its memory budget.  Files whose PCM exceeds the size threshold are
+//  never cached; long audio should be streamed as Music instead.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include "CUSoundCache.h"
+#include "platform/CUAudioEngine-impl.h"
+#include <cugl/util/CUDebug.h>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Releases all unreferenced buffers in this cache.
+ *
+ * Buffers still in use are freed when their sounds release them.
+ */
+void SoundCache::dispose() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    trim(0);
+}
+
+/**
+ * Initializes this cache with the given budget and threshold.
+ *
+ * @param budget    The number of bytes the cache tries to stay within
+ * @param threshold The largest buffer (in bytes) that may be cached
+ *
+ * @return true if the cache was initialized successfully
+ */
+bool SoundCache::init(size_t budget, size_t threshold) {
+    _budget = budget;
+    _threshold = threshold;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Buffer Management
+/**
+ * Evicts unreferenced buffers until the cache is within the given budget.
+ *
+ * This method assumes the lock is held.
+ *
+ * @param budget    The number of bytes to stay within
+ */
+void SoundCache::trim(size_t budget) {
+    while (_usage > budget) {
+        auto victim = _entries.end();
+        for(auto it = _entries.begin(); it != _entries.end(); ++it) {
+            if (it->second.refs == 0 && (victim == _entries.end() || it->second.stamp < victim->second.stamp)) {
+                victim = it;
+            }
+        }
+        if (victim == _entries.end()) {
+            return;
+        }
+        _usage -= victim->second.bytes;
+        impl::AudioFreeBuffer(victim->second.buffer);
+        _entries.erase(victim);
+    }
+}
+
+/**
+ * Returns the PCM buffer for the given file, loading it if necessary.
+ *
+ * If the buffer is cached, this method shares it and sets cached to true.
+ * If the buffer is larger than the threshold, this method returns a new
+ * buffer and sets cached to false; the caller must free that buffer with
+ * {@link impl::AudioFreeBuffer}.  This method returns nullptr if the file
+ * cannot be decoded.
+ *
+ * @param path      The path to the sound file
+ * @param cached    Set to whether the buffer belongs to the cache
+ *
+ * @return the PCM buffer for the given file
+ */
+impl::AudioBuffer* SoundCache::acquire(const std::string& path, bool& cached) {
+    cached = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(path);
+        if (it != _entries.end()) {
+            it->second.refs++;
+            cached = true;
+            return it->second.buffer;
+        }
+    }
+    
+    // Decode outside of the lock, as this is slow
+    impl::AudioBuffer* buffer = impl::AudioLoadBuffer(path.c_str());
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    
+    size_t bytes = impl::AudioGetBufferBytes(buffer);
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (bytes > _threshold) {
+        CUWarn("Sound '%s' is too large to cache (%zu bytes); consider loading it as Music",
+               path.c_str(), bytes);
+        return buffer;
+    }
+    
+    auto it = _entries.find(path);
+    if (it != _entries.end()) {
+        // Another thread decoded it first
+        impl::AudioFreeBuffer(buffer);
+        it->second.refs++;
+        cached = true;
+        return it->second.buffer;
+    }
+    
+    Entry entry;
+    entry.buffer = buffer;
+    entry.bytes  = bytes;
+    entry.refs   = 1;
+    entry.stamp  = ++_clock;
+    _entries.emplace(path,entry);
+    _usage += bytes;
+    trim(_budget);
+    cached = true;
+    return buffer;
+}
+
+/**
+ * Releases a cached buffer acquired for the given file.
+ *
+ * The buffer is not freed immediately.  It is only freed when the cache
+ * needs the memory, or when it is purged.
+ *
+ * @param path      The path to the sound file
+ */
+void SoundCache::release(const std::string& path) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _entries.find(path);
+    CUAssertLog(it != _entries.end() && it->second.refs > 0, "Sound '%s' is not in use", path.c_str());
+    it->second.refs--;
+    it->second.stamp = ++_clock;
+    trim(_budget);
+}
+
+/**
+ * Frees every cached buffer that is not in use.
+ *
+ * Call this between levels to drop the sounds of the previous level.
+ */
+void SoundCache::purge() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    trim(0);
+}
+
+
+#pragma mark -
+#pragma mark Attributes
+/**
+ * Returns the number of bytes the cache tries to stay within.
+ *
+ * @return the number of bytes the cache tries to stay within.
+ */
+size_t SoundCache::getBudget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+/**
+ * Sets the number of bytes the cache tries to stay within.
+ *
+ * Unreferenced buffers are evicted immediately if the cache is over the
+ * new budget.
+ *
+ * @param budget    The number of bytes the cache tries to stay within
+ */
+void SoundCache::setBudget(size_t budget) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = budget;
+    trim(_budget);
+}
+
+/**
+ * Returns the largest buffer (in bytes) that may be cached.
+ *
+ * @return the largest buffer (in bytes) that may be cached.
+ */
+size_t SoundCache::getThreshold() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _threshold;
+}
+
+/**
+ * Sets the largest buffer (in bytes) that may be cached.
+ *
+ * This only applies to buffers loaded after this call.
+ *
+ * @param threshold The largest buffer (in bytes) that may be cached
+ */
+void SoundCache::setThreshold(size_t threshold) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _threshold = threshold;
+}
+
+/**
+ * Returns the number of bytes of all cached buffers.
+ *
+ * This includes buffers in use and unreferenced buffers that have not
+ * been evicted yet.  It does not include uncached buffers.
+ *
+ * @return the number of bytes of all cached buffers.
+ */
+size_t SoundCache::getUsage() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _usage;
+}
@@ -0,0 +1,245 @@
+//
+//  CUSoundCache.h
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a shared cache of decoded sound effects.  Sound assets
+//  that load the same file share a single PCM buffer, already converted to
+//  the format of the output device.  The cache tracks the memory of every
+//  buffer, and keeps released buffers around (for the next level) until it
+//  exceeds its memory budget.  Files whose PCM exceeds the size threshold are
+//  never cached; long audio should be streamed as Music instead.
+//
+//  This file is an internal header.  It is not accessible by general users
+//  of the CUGL API.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#ifndef __CU_SOUND_CACHE_H__
+#define __CU_SOUND_CACHE_H__
+#include <cugl/base/CUBase.h>
+#include <unordered_map>
+#include <string>
+#include <mutex>
+
+namespace cugl {
+    
+// We use the impl namespace for platform-dependent data.
+namespace impl {
+    struct AudioBuffer;
+}
+
+#pragma mark -
+#pragma mark Sound Cache
+/**
+ * Reference counted cache of decoded sound effects.
+ *
+ * Every {@link Sound} acquires its PCM buffer from this cache, keyed by the
+ * file path.  Sounds for the same file share one buffer.  When the last
+ * sound releases a buffer, it stays in the cache so that reloading the file
+ * (such as on a level restart) costs nothing.  Unreferenced buffers are
+ * evicted, least recently used first, whenever the cache exceeds its budget.
+ * Buffers in use are never evicted, so the budget may be exceeded if the
+ * active sounds need more memory than that.
+ *
+ * Buffers larger than the threshold are not cached at all.  They belong to
+ * the sound that loaded them, and are freed with it.
+ *
+ * Sounds are loaded on worker threads, so all methods of this class are
+ * thread safe.
+ */
+class SoundCache {
+private:
+    /** An entry in the cache */
+    typedef struct Entry {
+        /** The decoded PCM buffer */
+        impl::AudioBuffer* buffer;
+        /** The size of the buffer in bytes */
+        size_t bytes;
+        /** The number of sounds using this buffer */
+        unsigned int refs;
+        /** The time of the last release (for LRU eviction) */
+        Uint64 stamp;
+    } Entry;
+    
+    /** The cached buffers, keyed by file path */
+    std::unordered_map<std::string, Entry> _entries;
+    /** The lock protecting the cache */
+    mutable std::mutex _mutex;
+    /** The number of bytes the cache tries to stay within */
+    size_t _budget;
+    /** The largest buffer (in bytes) that may be cached */
+    size_t _threshold;
+    /** The number of bytes of all cached buffers */
+    size_t _usage;
+    /** The logical clock for eviction order */
+    Uint64 _clock;
+    
+    /**
+     * Evicts unreferenced buffers until the cache is within the given budget.
+     *
+     * This method assumes the lock is held.
+     *
+     * @param budget    The number of bytes to stay within
+     */
+    void trim(size_t budget);
+    
+#pragma mark Constructors
+public:
+    /**
+     * Creates a new, uninitialized sound cache.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    SoundCache() : _budget(0), _threshold(0), _usage(0), _clock(0) {}
+    
+    /**
+     * Disposes of this sound cache, releasing all unreferenced buffers.
+     */
+    ~SoundCache() { dispose(); }
+    
+    /**
+     * Releases all unreferenced buffers in this cache.
+     *
+     * Buffers still in use are freed when their sounds release them.
+     */
+    void dispose();
+    
+    /**
+     * Initializes this cache with the given budget and threshold.
+     *
+     * @param budget    The number of bytes the cache tries to stay within
+     * @param threshold The largest buffer (in bytes) that may be cached
+     *
+     * @return true if the cache was initialized successfully
+     */
+    bool init(size_t budget, size_t threshold);
+    
+    /**
+     * Returns a newly allocated cache with the given budget and threshold.
+     *
+     * @param budget    The number of bytes the cache tries to stay within
+     * @param threshold The largest buffer (in bytes) that may be cached
+     *
+     * @return a newly allocated cache with the given budget and threshold.
+     */
+    static std::shared_ptr<SoundCache> alloc(size_t budget, size_t threshold) {
+        std::shared_ptr<SoundCache> result = std::make_shared<SoundCache>();
+        return (result->init(budget,threshold) ? result : nullptr);
+    }
+    
+#pragma mark -
+#pragma mark Buffer Management
+    /**
+     * Returns the PCM buffer for the given file, loading it if necessary.
+     *
+     * If the buffer is cached, this method shares it and sets cached to true.
+     * If the buffer is larger than the threshold, this method returns a new
+     * buffer and sets cached to false; the caller must free that buffer with
+     * {@link impl::AudioFreeBuffer}.  This method returns nullptr if the file
+     * cannot be decoded.
+     *
+     * @param path      The path to the sound file
+     * @param cached    Set to whether the buffer belongs to the cache
+     *
+     * @return the PCM buffer for the given file
+     */
+    impl::AudioBuffer* acquire(const std::string& path, bool& cached);
+    
+    /**
+     * Releases a cached buffer acquired for the given file.
+     *
+     * The buffer is not freed immediately.  It is only freed when the cache
+     * needs the memory, or when it is purged.
+     *
+     * @param path      The path to the sound file
+     */
+    void release(const std::string& path);
+    
+    /**
+     * Frees every cached buffer that is not in use.
+     *
+     * Call this between levels to drop the sounds of the previous level.
+     */
+    void purge();
+    
+#pragma mark -
+#pragma mark Attributes
+    /**
+     * Returns the number of bytes the cache tries to stay within.
+     *
+     * @return the number of bytes the cache tries to stay within.
+     */
+    size_t getBudget() const;
+    
+    /**
+     * Sets the number of bytes the cache tries to stay within.
+     *
+     * Unreferenced buffers are evicted immediately if the cache is over the
+     * new budget.
+     *
+     * @param budget    The number of bytes the cache tries to stay within
+     */
+    void setBudget(size_t budget);
+    
+    /**
+     * Returns the largest buffer (in bytes) that may be cached.
+     *
+     * @return the largest buffer (in bytes) that may be cached.
+     */
+    size_t getThreshold() const;
+    
+    /**
+     * Sets the largest buffer (in bytes) that may be cached.
+     *
+     * This only applies to buffers loaded after this call.
+     *
+     * @param threshold The largest buffer (in bytes) that may be cached
+     */
+    void setThreshold(size_t threshold);
+    
+    /**
+     * Returns the number of bytes of all cached buffers.
+     *
+     * This includes buffers in use and unreferenced buffers that have not
+     * been evicted yet.  It does not include uncached buffers.
+     *
+     * @return the number of bytes of all cached buffers.
+     */
+    size_t getUsage() const;
+};
+
+}
+#endif /* __CU_SOUND_CACHE_H__ */
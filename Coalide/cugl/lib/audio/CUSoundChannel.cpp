@@ -430,3 +430,17 @@ void SoundChannel::setLoop(bool loop) {
     _primaryLoop = loop;
     impl::AudioSetChannelLoop(_player,loop);
 }
+
+/**
+ * Sets the mixing priority of this channel.
+ *
+ * Mixing backends with a time budget drop the lowest priority channels
+ * first when they run out of time.  Other backends ignore this value.
+ * The priority belongs to the channel, so it applies to the primary and
+ * the shadow asset alike.
+ *
+ * @param  priority the mixing priority (higher is more important)
+ */
+void SoundChannel::setPriority(int priority) {
+    impl::AudioSetChannelPriority(_player,priority);
+}
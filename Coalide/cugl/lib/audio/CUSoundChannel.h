@@ -476,6 +476,18 @@ public:
      */
     void setLoop(bool loop);
     
+    /**
+     * Sets the mixing priority of this channel.
+     *
+     * Mixing backends with a time budget drop the lowest priority channels
+     * first when they run out of time.  Other backends ignore this value.
+     * The priority belongs to the channel, so it applies to the primary and
+     * the shadow asset alike.
+     *
+     * @param  priority the mixing priority (higher is more important)
+     */
+    void setPriority(int priority);
+    
     /** Allow the AudioEngine access to the player */
     friend class AudioEngine;
 };
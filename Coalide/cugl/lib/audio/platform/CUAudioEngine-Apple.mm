@@ -592,6 +592,19 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->pcmb.format.sampleRate;
 }
 
+/**
+ * Returns the memory (in bytes) used by the given PCM buffer
+ *
+ * Buffers are read in the (float) processing format of the file.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the memory (in bytes) used by the given PCM buffer
+ */
+size_t AudioGetBufferBytes(AudioBuffer* source) {
+    return (size_t)source->pcmb.frameCapacity*source->pcmb.format.channelCount*sizeof(float);
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -938,6 +951,18 @@ void AudioSetChannelVolume(AudioChannel* player, float volume) {
     player->node.volume = volume;
 }
 
+/**
+ * Sets the mixing priority for this sound channel
+ *
+ * AVFoundation mixes the channels itself without a time budget, so this
+ * value is ignored.
+ *
+ * @param player    The sound channel
+ * @param priority  The mixing priority (higher is more important)
+ */
+void AudioSetChannelPriority(AudioChannel*, int) {
+}
+
 /**
  * Sets the loop option for this sound channel
  *
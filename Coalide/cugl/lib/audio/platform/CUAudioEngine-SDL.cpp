@@ -9,6 +9,22 @@
 //  On Apple platforms, you can switch between solutions by defining/undefining
 //  the CU_AUDIO_AVFOUNDATION compiler variable.
 //
+//  When CU_MUSIC_STREAMING is defined, OGG Vorbis music is not decoded by
+//  SDL Mixer.  Instead, a worker thread decodes it into a lock-free ring
+//  buffer, and the audio callback only copies PCM out of that buffer.  The
+//  thread resamples the music to the device format itself, as the bundled
+//  SDL is too old for SDL_AudioStream.  This requires the vorbisfile
+//  library, which the Android SDL Mixer exports.
+//
+//  When CU_AUDIO_SOFTMIX is defined, sound effects are not mixed by SDL Mixer
+//  either.  The channels are mixed by a vectorized (SSE2 or NEON) mixer in
+//  the post-mix hook.  Voices are mixed in priority order, and the mixer
+//  silently skips the lowest priority voices once it exceeds its time budget
+//  (CU_AUDIO_MIX_BUDGET, as a fraction of the block time).  The mixer never
+//  takes a lock.  It mixes from a snapshot of the channels published by the
+//  game thread, and finished channels are garbage collected on the game
+//  thread by a scheduled application callback.
+//
 //  CUGL zlib License:
 //      This software is provided 'as-is', without any express or implied
 //      warranty.  In no event will the authors be held liable for any damages
@@ -34,14 +50,65 @@
 #include "CUAudioEngine-impl.h"
 #include <cugl/audio/CUMusic.h>
 #include <cugl/audio/CUAudioEngine.h>
+#include <cugl/base/CUApplication.h>
 #include <cugl/util/CUDebug.h>
 #include <SDL/SDL_mixer.h>
 #include <vector>
+#include <string>
+#include <algorithm>
 
 /** The mixer block size */
 // SMALLER = LESS LAG, BUT MORE CPU LOAD
 #define MIX_BLOCK_SIZE  1024
 
+/** Comment this out to let SDL Mixer decode OGG music in the audio callback */
+#if defined (__ANDROID__)
+    #define CU_MUSIC_STREAMING 1
+#endif
+
+#if defined (CU_MUSIC_STREAMING)
+#include <vorbis/vorbisfile.h>
+
+/** The seconds of music to decode ahead of the audio callback */
+#ifndef CU_MUSIC_READ_AHEAD
+    #define CU_MUSIC_READ_AHEAD 1.0
+#endif
+/** The maximum number of audio frames decoded at once */
+#define STREAM_DECODE_FRAMES    1024
+/** The milliseconds the decoder sleeps when it is not signaled */
+#define STREAM_POLL_TIME        20
+
+/** The decoder is not attached to any music */
+#define STREAM_IDLE     0
+/** The decoder is actively decoding music */
+#define STREAM_PLAYING  1
+/** The decoder reached the end, and the callback is emptying the buffer */
+#define STREAM_DRAINING 2
+/** The callback emptied the buffer; the decoder must report completion */
+#define STREAM_ENDED    3
+#endif
+
+/** Uncomment this to mix sound effects with the vectorized software mixer */
+//#define CU_AUDIO_SOFTMIX 1
+
+#if defined (CU_AUDIO_SOFTMIX)
+/** The flag marking a snapshot that the mixer has not read yet */
+#define SNAPSHOT_FRESH  4
+
+/** The fraction of the block time the mixer may spend on sound effects */
+#ifndef CU_AUDIO_MIX_BUDGET
+    #define CU_AUDIO_MIX_BUDGET 0.25
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CU_MIX_SSE2 1
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+    #include <arm_neon.h>
+    #define CU_MIX_NEON 1
+#endif
+#endif
+
 namespace cugl {
 namespace impl {
     
@@ -75,8 +142,58 @@ typedef struct AudioBuffer {
  */
 typedef struct AudioStream {
     Mix_Music* music;
+    /** The file for this stream (to reopen it for decoding) */
+    std::string path;
 } AudioStream;
 
+#if defined (CU_AUDIO_SOFTMIX)
+/**
+ * The playback state of a sound channel in the software mixer.
+ *
+ * The game thread changes its copy of this state in the AudioChannel, and
+ * publishes a copy of every channel to the mixer.  A change to serial means
+ * a new playback (or seek), so the mixer restarts from the given position.
+ * A change to deadline only replaces the expiration.  Any other attribute
+ * is simply copied on every block.
+ */
+typedef struct AudioVoice {
+    /** The PCM data being played, in the device format (nullptr if none) */
+    const Sint16* data;
+    /** The number of audio frames in the PCM data */
+    Uint32 length;
+    /** The current audio frame */
+    Uint32 position;
+    /** The audio frames left before the channel halts (0 for no limit) */
+    Uint32 expire;
+    /** The channel volume (0 to 1) */
+    float volume;
+    /** The mixing priority (higher is more important) */
+    int priority;
+    /** Whether to loop back to the beginning at the end of the data */
+    bool looping;
+    /** Whether playback is paused */
+    bool paused;
+    /** The playback request this state belongs to */
+    Uint32 serial;
+    /** The expiration request this state belongs to */
+    Uint32 deadline;
+} AudioVoice;
+
+/**
+ * The progress of a sound channel in the software mixer.
+ *
+ * These are written by the audio callback and read by the game thread.
+ */
+typedef struct AudioProgress {
+    /** The playback request the mixer is playing */
+    SDL_atomic_t serial;
+    /** The current audio frame of that playback */
+    SDL_atomic_t frame;
+    /** The last playback request that finished playing */
+    SDL_atomic_t finished;
+} AudioProgress;
+#endif
+
 /**
  * Reference to the SDL implementation of a sound channel.
  *
@@ -95,8 +212,109 @@ typedef struct AudioChannel {
     double bitrate;
     /** Whether or not this channel was terminated manually */
     bool manual;
+#if defined (CU_AUDIO_SOFTMIX)
+    /** The playback state, as requested by the game thread */
+    AudioVoice state;
+#endif
 } AudioChannel;
 
+#if defined (CU_MUSIC_STREAMING)
+/**
+ * A lock-free ring buffer of PCM samples in the device format.
+ *
+ * There is exactly one writer (the decoder thread) and one reader (the audio
+ * callback).  The positions are free-running sample counters, so the number
+ * of buffered samples is always head-tail, even after they wrap around.
+ */
+typedef struct AudioRing {
+    /** The sample buffer */
+    Sint16* data;
+    /** The number of samples in the buffer (a power of two) */
+    Uint32 capacity;
+    /** The write position (only changed by the decoder) */
+    SDL_atomic_t head;
+    /** The read position (only changed by the audio callback) */
+    SDL_atomic_t tail;
+} AudioRing;
+
+/**
+ * Reference to the decoder for streaming OGG music.
+ *
+ * The decoder thread decodes and resamples a block of music without the
+ * lock, while it is marked busy.  It only takes the lock to publish the
+ * block to the ring buffer.  Any other thread that changes the vorbis file
+ * or the resampler must hold the lock and wait until the decoder is not
+ * busy (see {@link StreamLock}).  The audio callback never takes the lock;
+ * it communicates with the decoder through the ring buffer and the atomic
+ * state.  The remaining attributes are only changed while the music hook is
+ * detached, so the callback cannot see them change.
+ */
+typedef struct AudioDecoder {
+    /** The vorbis decoder state */
+    OggVorbis_File ogg;
+    /** The file being decoded */
+    SDL_RWops* source;
+    /** Whether the vorbis decoder state is open */
+    bool open;
+    /** Whether the decoder has reached the end of the file */
+    bool eof;
+    /** The number of channels of the vorbis file */
+    int inputs;
+    /** The vorbis frames for each device frame */
+    double step;
+    /** The position of the next device frame, relative to the previous vorbis frame */
+    double position;
+    /** The last vorbis frame of the previous block */
+    std::vector<float> previous;
+    /** Whether the previous vorbis frame is valid */
+    bool primed;
+    /** The decoded block in the device format, waiting for the ring buffer */
+    std::vector<Sint16> pending;
+    /** The number of frames in the decoded block */
+    Uint32 pendingSize;
+    /** The number of frames of the decoded block already in the ring buffer */
+    Uint32 pendingNext;
+    /** The decoded PCM waiting for the audio callback */
+    AudioRing ring;
+    /** The number of samples to keep decoded ahead of the callback */
+    Uint32 readAhead;
+    /** The number of output channels of the device */
+    int channels;
+    /** The sample rate of the device */
+    int frequency;
+    
+    /** The decoder thread */
+    SDL_Thread* thread;
+    /** The lock for the vorbis decoder state */
+    SDL_mutex* lock;
+    /** The condition to wake up the decoder thread */
+    SDL_cond* wake;
+    /** The condition signaled when the decoder is no longer busy */
+    SDL_cond* idle;
+    /** Whether the decoder thread is decoding a block without the lock */
+    bool busy;
+    /** Whether the decoder thread should keep running */
+    SDL_atomic_t alive;
+    
+    /** The stream state (STREAM_IDLE, STREAM_PLAYING, ...) */
+    SDL_atomic_t state;
+    /** Whether playback is paused */
+    SDL_atomic_t paused;
+    /** Whether to loop back to the beginning at the end of the file */
+    SDL_atomic_t loop;
+    /** The music volume (0 to MIX_MAX_VOLUME) */
+    SDL_atomic_t volume;
+    /** A pending fade out request in milliseconds (0 for none) */
+    SDL_atomic_t fadeRequest;
+    /** The audio frames remaining in the active fade (callback only) */
+    Sint32 fadeFrames;
+    /** The total audio frames of the active fade (callback only) */
+    Sint32 fadeTotal;
+    /** Whether the active fade is a fade out (callback only) */
+    bool fadeOut;
+} AudioDecoder;
+#endif
+
 /**
  * Reference to the SDL implementation of the music player.
  *
@@ -115,6 +333,12 @@ typedef struct AudioPlayer {
     Uint32 startTime;
     /** Whether or not this channel was terminated manually */
     bool manual;
+#if defined (CU_MUSIC_STREAMING)
+    /** The decoder for OGG music */
+    AudioDecoder* decoder;
+    /** Whether the current music is played through the decoder */
+    bool streaming;
+#endif
 } AudioPlayer;
 
 /**
@@ -126,6 +350,32 @@ typedef struct AudioPlayer {
 typedef struct AudioMixer {
     AudioPlayer* background;
     std::vector< AudioChannel * > channels;
+#if defined (CU_AUDIO_SOFTMIX)
+    /** The lock for the channel playback state (never taken by the mixer) */
+    SDL_mutex* lock;
+    /** The number of output channels of the device */
+    int outputs;
+    /** The sample rate of the device */
+    int frequency;
+    /** The triple buffer of channel snapshots */
+    std::vector<AudioVoice> snapshots[3];
+    /** The snapshot the game thread writes next */
+    int back;
+    /** The snapshot the mixer reads */
+    int front;
+    /** The latest published snapshot (with SNAPSHOT_FRESH if unread) */
+    SDL_atomic_t middle;
+    /** The playback state of each channel (audio callback only) */
+    std::vector<AudioVoice> voices;
+    /** The progress of each channel, reported by the audio callback */
+    std::vector<AudioProgress> progress;
+    /** The floating point mix of the sound effects (audio callback only) */
+    std::vector<float> accum;
+    /** The playing channels, sorted by priority (audio callback only) */
+    std::vector<AudioVoice*> order;
+    /** The scheduled callback to garbage collect finished channels */
+    Uint32 collector;
+#endif
 } AudioMixer;
 
 /** The pointer to the engine root */
@@ -166,6 +416,268 @@ void InternalMusicFinished() {
     }
 }
 
+#if defined (CU_AUDIO_SOFTMIX)
+/**
+ * Adds the given samples, scaled by gain, to the floating point mix.
+ *
+ * @param dst       The floating point mix
+ * @param src       The samples to add
+ * @param samples   The number of samples
+ * @param gain      The volume scale factor
+ */
+static void InternalMixInto(float* dst, const Sint16* src, Uint32 samples, float gain) {
+    Uint32 ii = 0;
+#if defined (CU_MIX_SSE2)
+    __m128 scale = _mm_set1_ps(gain);
+    for(; ii+8 <= samples; ii += 8) {
+        __m128i pcm = _mm_loadu_si128((const __m128i*)(src+ii));
+        __m128i lo  = _mm_srai_epi32(_mm_unpacklo_epi16(pcm,pcm),16);
+        __m128i hi  = _mm_srai_epi32(_mm_unpackhi_epi16(pcm,pcm),16);
+        __m128 acc0 = _mm_loadu_ps(dst+ii);
+        __m128 acc1 = _mm_loadu_ps(dst+ii+4);
+        acc0 = _mm_add_ps(acc0,_mm_mul_ps(_mm_cvtepi32_ps(lo),scale));
+        acc1 = _mm_add_ps(acc1,_mm_mul_ps(_mm_cvtepi32_ps(hi),scale));
+        _mm_storeu_ps(dst+ii,acc0);
+        _mm_storeu_ps(dst+ii+4,acc1);
+    }
+#elif defined (CU_MIX_NEON)
+    for(; ii+8 <= samples; ii += 8) {
+        int16x8_t pcm = vld1q_s16(src+ii);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm)));
+        vst1q_f32(dst+ii,  vmlaq_n_f32(vld1q_f32(dst+ii),  lo,gain));
+        vst1q_f32(dst+ii+4,vmlaq_n_f32(vld1q_f32(dst+ii+4),hi,gain));
+    }
+#endif
+    for(; ii < samples; ii++) {
+        dst[ii] += src[ii]*gain;
+    }
+}
+
+/**
+ * Adds the floating point mix to the output stream with saturation.
+ *
+ * The music is added to the mix before clamping, so that loud effects
+ * over quiet music do not clip early.
+ *
+ * @param dst       The output stream (which already has the music)
+ * @param src       The floating point mix
+ * @param samples   The number of samples
+ */
+static void InternalMixResolve(Sint16* dst, const float* src, Uint32 samples) {
+    Uint32 ii = 0;
+#if defined (CU_MIX_SSE2)
+    // Clamp first, as out of range conversions produce INT_MIN
+    __m128 upper = _mm_set1_ps(32767.0f);
+    __m128 lower = _mm_set1_ps(-32768.0f);
+    for(; ii+8 <= samples; ii += 8) {
+        __m128i out = _mm_loadu_si128((const __m128i*)(dst+ii));
+        __m128i lo  = _mm_srai_epi32(_mm_unpacklo_epi16(out,out),16);
+        __m128i hi  = _mm_srai_epi32(_mm_unpackhi_epi16(out,out),16);
+        __m128 f0 = _mm_add_ps(_mm_cvtepi32_ps(lo),_mm_loadu_ps(src+ii));
+        __m128 f1 = _mm_add_ps(_mm_cvtepi32_ps(hi),_mm_loadu_ps(src+ii+4));
+        f0 = _mm_max_ps(_mm_min_ps(f0,upper),lower);
+        f1 = _mm_max_ps(_mm_min_ps(f1,upper),lower);
+        __m128i pcm = _mm_packs_epi32(_mm_cvttps_epi32(f0),_mm_cvttps_epi32(f1));
+        _mm_storeu_si128((__m128i*)(dst+ii),pcm);
+    }
+#elif defined (CU_MIX_NEON)
+    // NEON conversions already saturate
+    for(; ii+8 <= samples; ii += 8) {
+        int16x8_t out  = vld1q_s16(dst+ii);
+        float32x4_t f0 = vaddq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(out))), vld1q_f32(src+ii));
+        float32x4_t f1 = vaddq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(out))),vld1q_f32(src+ii+4));
+        int16x4_t lo = vqmovn_s32(vcvtq_s32_f32(f0));
+        int16x4_t hi = vqmovn_s32(vcvtq_s32_f32(f1));
+        vst1q_s16(dst+ii,vcombine_s16(lo,hi));
+    }
+#endif
+    for(; ii < samples; ii++) {
+        float value = dst[ii]+src[ii];
+        dst[ii] = (Sint16)(value > 32767.0f ? 32767.0f : (value < -32768.0f ? -32768.0f : value));
+    }
+}
+
+/**
+ * Advances the channel by the given number of audio frames.
+ *
+ * If mix is true, the channel is added to the floating point mix as it
+ * advances.  Otherwise, it advances silently.
+ *
+ * @param player    The channel playback state
+ * @param dst       The floating point mix
+ * @param frames    The number of audio frames to advance
+ * @param mix       Whether to add the channel to the mix
+ *
+ * @return true if the channel finished playing
+ */
+static bool InternalMixChannel(AudioVoice* player, float* dst, Uint32 frames, bool mix) {
+    int outputs = _engine->outputs;
+    bool expires = player->expire > 0;
+    if (expires && player->expire < frames) {
+        frames = player->expire;
+    }
+    if (expires) {
+        player->expire -= frames;
+    }
+    
+    while (frames > 0) {
+        if (player->position >= player->length) {
+            if (!player->looping || player->length == 0) {
+                return true;
+            }
+            player->position = 0;
+        }
+        Uint32 amt = std::min(player->length-player->position, frames);
+        if (mix) {
+            InternalMixInto(dst, player->data+player->position*outputs, amt*outputs, player->volume);
+        }
+        dst += amt*outputs;
+        frames -= amt;
+        player->position += amt;
+    }
+    return (expires && player->expire == 0) ||
+           (!player->looping && player->position >= player->length);
+}
+
+/**
+ * Publishes the playback state of every channel to the software mixer.
+ *
+ * The engine lock must be held.  The mixer picks up the snapshot at the
+ * start of its next block.
+ */
+static void InternalSoftPublish() {
+    std::vector<AudioVoice>& snapshot = _engine->snapshots[_engine->back];
+    for(size_t ii = 0; ii < snapshot.size(); ii++) {
+        AudioChannel* player = _engine->channels[ii];
+        if (player) {
+            snapshot[ii] = player->state;
+        } else {
+            snapshot[ii].data = nullptr;
+        }
+    }
+    _engine->back = SDL_AtomicSet(&_engine->middle, _engine->back | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+}
+
+/**
+ * Returns true if the mixer finished the current playback of the channel.
+ *
+ * The engine lock must be held.
+ *
+ * @param player    The sound channel
+ *
+ * @return true if the mixer finished the current playback of the channel.
+ */
+static bool InternalSoftFinished(AudioChannel* player) {
+    AudioProgress* progress = &_engine->progress[player->channel];
+    return (Uint32)SDL_AtomicGet(&progress->finished) == player->state.serial;
+}
+
+/**
+ * Garbage collects the channels that the software mixer finished.
+ *
+ * This is scheduled with the application, so the engine is always garbage
+ * collected on the game thread, and never in the audio callback.
+ *
+ * @return true (so the callback stays scheduled)
+ */
+static bool InternalSoftCollect() {
+    for(size_t ii = 0; ii < _engine->channels.size(); ii++) {
+        AudioChannel* player = _engine->channels[ii];
+        SDL_LockMutex(_engine->lock);
+        bool done = player && player->state.data && InternalSoftFinished(player);
+        if (done) {
+            player->state.data = nullptr;
+            player->state.position = player->state.length;
+        }
+        SDL_UnlockMutex(_engine->lock);
+        if (done) {
+            InternalChannelDone((int)ii);
+        }
+    }
+    return true;
+}
+
+/**
+ * The SDL_Mixer post-mix callback for the software mixer.
+ *
+ * This function mixes the sound effect channels on top of the music, in
+ * order of priority.  Once it has used up its time budget, the remaining
+ * channels advance without being heard.
+ *
+ * This function never takes a lock.  It mixes from the latest snapshot
+ * published by the game thread, and it only reports finished channels.
+ * They are garbage collected later by {@link InternalSoftCollect}.
+ *
+ * @param udata     The user data (unused)
+ * @param stream    The output stream
+ * @param len       The length of the output stream in bytes
+ */
+void InternalSoftMix(void* udata, Uint8* stream, int len) {
+    Uint32 samples = len/sizeof(Sint16);
+    Uint32 frames  = samples/_engine->outputs;
+    Uint64 start   = SDL_GetPerformanceCounter();
+    Uint64 budget  = (Uint64)(CU_AUDIO_MIX_BUDGET*SDL_GetPerformanceFrequency()*frames/_engine->frequency);
+
+    // Swap in the latest snapshot, if there is one
+    if (SDL_AtomicGet(&_engine->middle) & SNAPSHOT_FRESH) {
+        _engine->front = SDL_AtomicSet(&_engine->middle, _engine->front) & ~SNAPSHOT_FRESH;
+    }
+    const std::vector<AudioVoice>& snapshot = _engine->snapshots[_engine->front];
+    
+    std::vector<AudioVoice*>& order = _engine->order;
+    order.clear();
+    for(size_t ii = 0; ii < snapshot.size(); ii++) {
+        const AudioVoice& request = snapshot[ii];
+        AudioVoice* player = &_engine->voices[ii];
+        AudioProgress* progress = &_engine->progress[ii];
+        if (player->serial != request.serial) {
+            *player = request;
+            SDL_AtomicSet(&progress->frame, (int)player->position);
+            SDL_AtomicSet(&progress->serial, (int)player->serial);
+        } else if (player->data) {
+            if (player->deadline != request.deadline) {
+                player->expire   = request.expire;
+                player->deadline = request.deadline;
+            }
+            player->volume   = request.volume;
+            player->priority = request.priority;
+            player->looping  = request.looping;
+            player->paused   = request.paused;
+        }
+        
+        if (player->data && !player->paused) {
+            // Insertion sort, as there are few channels
+            order.push_back(player);
+            for(size_t jj = order.size()-1; jj > 0 && order[jj-1]->priority < player->priority; jj--) {
+                std::swap(order[jj-1],order[jj]);
+            }
+        }
+    }
+    
+    if (!order.empty()) {
+        if (_engine->accum.size() < samples) {
+            _engine->accum.resize(samples);
+        }
+        float* accum = _engine->accum.data();
+        std::fill(accum, accum+samples, 0.0f);
+        
+        bool culling = false;
+        for(auto it = order.begin(); it != order.end(); ++it) {
+            AudioVoice* player = *it;
+            AudioProgress* progress = &_engine->progress[player-_engine->voices.data()];
+            if (InternalMixChannel(player, accum, frames, !culling)) {
+                player->data = nullptr;
+                SDL_AtomicSet(&progress->finished, (int)player->serial);
+            }
+            SDL_AtomicSet(&progress->frame, (int)player->position);
+            culling = culling || SDL_GetPerformanceCounter()-start > budget;
+        }
+        InternalMixResolve((Sint16*)stream, accum, samples);
+    }
+}
+#endif
+
 /**
  * Initializes the audio engine for use.
  *
@@ -197,6 +709,31 @@ bool AudioStart(int frequency, int input, int output) {
     Mix_AllocateChannels(input);
     Mix_ChannelFinished(InternalChannelDone);
     Mix_HookMusicFinished(InternalMusicFinished);
+#if defined (CU_AUDIO_SOFTMIX)
+    Uint16 format;
+    Mix_QuerySpec(&_engine->frequency, &format, &_engine->outputs);
+    _engine->lock = SDL_CreateMutex();
+    for(int ii = 0; ii < 3; ii++) {
+        _engine->snapshots[ii].resize(input, AudioVoice());
+    }
+    _engine->back  = 0;
+    _engine->front = 1;
+    SDL_AtomicSet(&_engine->middle, 2);
+    _engine->voices.resize(input, AudioVoice());
+    _engine->progress.resize(input);
+    for(auto it = _engine->progress.begin(); it != _engine->progress.end(); ++it) {
+        SDL_AtomicSet(&it->serial, 0);
+        SDL_AtomicSet(&it->frame, 0);
+        SDL_AtomicSet(&it->finished, 0);
+    }
+    _engine->order.reserve(input);
+    _engine->accum.resize(MIX_BLOCK_SIZE*_engine->outputs);
+    Mix_SetPostMix(InternalSoftMix, nullptr);
+    _engine->collector = 0;
+    if (cugl::Application::get()) {
+        _engine->collector = cugl::Application::get()->schedule(InternalSoftCollect);
+    }
+#endif
     return true;
 }
 
@@ -217,6 +754,13 @@ void AudioStop() {
         }
     }
     
+#if defined (CU_AUDIO_SOFTMIX)
+    if (_engine->collector && cugl::Application::get()) {
+        cugl::Application::get()->unschedule(_engine->collector);
+    }
+    Mix_SetPostMix(nullptr, nullptr);
+    SDL_DestroyMutex(_engine->lock);
+#endif
     delete _engine;
     _engine = nullptr;
     Mix_CloseAudio();
@@ -318,6 +862,20 @@ double AudioGetBufferSampleRate(AudioBuffer* source) {
     return source->bitrate;
 }
 
+/**
+ * Returns the memory (in bytes) used by the given PCM buffer
+ *
+ * Chunks are converted to the device format when loaded, so this is the
+ * size of the converted PCM data.
+ *
+ * @param source    The PCM buffer
+ *
+ * @return the memory (in bytes) used by the given PCM buffer
+ */
+size_t AudioGetBufferBytes(AudioBuffer* source) {
+    return (size_t)source->chunk->alen;
+}
+
 #pragma mark -
 #pragma mark Music Assets
 /**
@@ -344,6 +902,7 @@ AudioStream* AudioLoadStream(const char* file) {
     
     AudioStream* buffer = new AudioStream();
     buffer->music = data;
+    buffer->path  = file;
     return buffer;
 }
 
@@ -431,6 +990,18 @@ AudioChannel* AudioAllocChannel(int channel) {
     if (player) {
         player->channel = channel;
         player->manual = false;
+#if defined (CU_AUDIO_SOFTMIX)
+        player->state.data = nullptr;
+        player->state.length = 0;
+        player->state.position = 0;
+        player->state.expire = 0;
+        player->state.volume = 1.0f;
+        player->state.priority = 0;
+        player->state.looping = false;
+        player->state.paused  = false;
+        player->state.serial  = 0;
+        player->state.deadline = 0;
+#endif
     }
     _engine->channels[channel] = player;
     return player;
@@ -469,6 +1040,18 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
     player->channels = source->channels;
     player->bitrate  = source->bitrate;
     
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.data = (const Sint16*)source->chunk->abuf;
+    player->state.length = (Uint32)source->frames;
+    player->state.position = std::min(start,player->state.length);
+    player->state.expire  = 0;
+    player->state.looping = loop;
+    player->state.paused  = false;
+    player->state.serial++;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_PlayChannel(player->channel, source->chunk, loop ? -1 : 0);
     
     // Adjust the byte offset if not at start
@@ -477,6 +1060,7 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
         Uint64 offset = start*((source->format & 0xFF)/8)*source->channels;
         Mix_SetOffset(player->channel, (int)offset);
     }
+#endif
 }
 
 /**
@@ -487,8 +1071,24 @@ void AudioPlayChannel(AudioChannel* player, AudioBuffer* source, bool loop, Uint
  * @param player    The sound channel
  */
 void AudioHaltChannel(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    bool playing = player->state.data != nullptr;
+    if (playing) {
+        player->state.position = (Uint32)AudioGetChannelFrame(player);
+        player->state.data = nullptr;
+        player->state.serial++;
+        player->manual = true;
+        InternalSoftPublish();
+    }
+    SDL_UnlockMutex(_engine->lock);
+    if (playing) {
+        InternalChannelDone(player->channel);
+    }
+#else
     player->manual = true;
     Mix_HaltChannel(player->channel);
+#endif
 }
 
 /**
@@ -501,7 +1101,18 @@ void AudioHaltChannel(AudioChannel* player) {
  * @param millis    The number of millisecond before halting the asset
  */
 void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.expire = (Uint32)((Uint64)millis*_engine->frequency/1000);
+    if (millis > 0 && player->state.expire == 0) {
+        player->state.expire = 1;
+    }
+    player->state.deadline++;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_ExpireChannel(player->channel,millis);
+#endif
 }
 
 /**
@@ -514,7 +1125,14 @@ void AudioExpireChannel(AudioChannel* player, Uint32 millis) {
  * @param player    The sound channel
  */
 void AudioPauseChannel(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.paused = true;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_Pause(player->channel);
+#endif
 }
 
 /**
@@ -526,7 +1144,14 @@ void AudioPauseChannel(AudioChannel* player) {
  * @param player    The sound channel
  */
 void AudioResumeChannel(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.paused = false;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_Resume(player->channel);
+#endif
 }
 
 /**
@@ -539,7 +1164,14 @@ void AudioResumeChannel(AudioChannel* player) {
  * @return true if this channel is actively playing.
  */
 bool AudioChannelPlaying(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    bool result = player->state.data != nullptr && !InternalSoftFinished(player);
+    SDL_UnlockMutex(_engine->lock);
+    return result;
+#else
     return (bool)Mix_Playing(player->channel);
+#endif
 }
 
 /**
@@ -553,7 +1185,14 @@ bool AudioChannelPlaying(AudioChannel* player) {
  * @return true if this channel is actively paused.
  */
 bool AudioChannelPaused(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    bool result = player->state.data != nullptr && !InternalSoftFinished(player) && player->state.paused;
+    SDL_UnlockMutex(_engine->lock);
+    return result;
+#else
     return (bool)Mix_Paused(player->channel);
+#endif
 }
 
 /**
@@ -566,7 +1205,33 @@ bool AudioChannelPaused(AudioChannel* player) {
  * @param volume   The volume (0 to 1) to play the asset
  */
 void AudioSetChannelVolume(AudioChannel* player, float volume) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.volume = volume;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_Volume(player->channel,(int)(MIX_MAX_VOLUME*volume));
+#endif
+}
+
+/**
+ * Sets the mixing priority for this sound channel
+ *
+ * Backends that mix the channels themselves with a time budget drop the
+ * lowest priority channels first.  SDL Mixer has no such budget, so this
+ * value only matters to the software mixer.
+ *
+ * @param player    The sound channel
+ * @param priority  The mixing priority (higher is more important)
+ */
+void AudioSetChannelPriority(AudioChannel* player, int priority) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.priority = priority;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#endif
 }
 
 /**
@@ -581,7 +1246,14 @@ void AudioSetChannelVolume(AudioChannel* player, float volume) {
  * @param loop      Whether to loop the current attached asset
  */
 void AudioSetChannelLoop(AudioChannel* player, bool loop) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    player->state.looping = loop;
+    InternalSoftPublish();
+    SDL_UnlockMutex(_engine->lock);
+#else
     Mix_SetLoop(player->channel, loop ? -1 : 0);
+#endif
 }
 
 /**
@@ -595,7 +1267,19 @@ void AudioSetChannelLoop(AudioChannel* player, bool loop) {
  * @return the current audio frame of the given sound channel
  */
 Uint64 AudioGetChannelFrame(AudioChannel* player) {
+#if defined (CU_AUDIO_SOFTMIX)
+    // The mixer only reports progress once it plays the current request
+    SDL_LockMutex(_engine->lock);
+    AudioProgress* progress = &_engine->progress[player->channel];
+    Uint64 result = player->state.position;
+    if ((Uint32)SDL_AtomicGet(&progress->serial) == player->state.serial) {
+        result = (Uint32)SDL_AtomicGet(&progress->frame);
+    }
+    SDL_UnlockMutex(_engine->lock);
+    return result;
+#else
     return Mix_GetOffset(player->channel);
+#endif
 }
 
 /**
@@ -608,11 +1292,582 @@ Uint64 AudioGetChannelFrame(AudioChannel* player) {
  * @param frame     The audio frame to jump to
  */
 void AudioSetChannelFrame(AudioChannel* player, Uint64 frame) {
+#if defined (CU_AUDIO_SOFTMIX)
+    SDL_LockMutex(_engine->lock);
+    if (player->state.data) {
+        player->state.position = (Uint32)std::min(frame,(Uint64)player->state.length);
+        player->state.serial++;
+        InternalSoftPublish();
+    }
+    SDL_UnlockMutex(_engine->lock);
+#else
     Uint64 offset = frame*((player->format & 0xFF)/8)*player->channels;
     Mix_SetOffset(player->channel,(int)offset);
+#endif
 }
 
 
+#if defined (CU_MUSIC_STREAMING)
+#pragma mark -
+#pragma mark Music Streaming
+/**
+ * The vorbis read callback for an SDL_RWops source
+ *
+ * @param ptr       The buffer to read into
+ * @param size      The size of each element
+ * @param nmemb     The number of elements to read
+ * @param source    The SDL_RWops source
+ *
+ * @return the number of elements read
+ */
+size_t InternalOggRead(void* ptr, size_t size, size_t nmemb, void* source) {
+    return SDL_RWread((SDL_RWops*)source, ptr, size, nmemb);
+}
+
+/**
+ * The vorbis seek callback for an SDL_RWops source
+ *
+ * @param source    The SDL_RWops source
+ * @param offset    The offset to seek to
+ * @param whence    The seek origin (SEEK_SET, SEEK_CUR or SEEK_END)
+ *
+ * @return 0 on success, -1 on failure
+ */
+int InternalOggSeek(void* source, ogg_int64_t offset, int whence) {
+    return SDL_RWseek((SDL_RWops*)source, offset, whence) < 0 ? -1 : 0;
+}
+
+/**
+ * The vorbis close callback for an SDL_RWops source
+ *
+ * @param source    The SDL_RWops source
+ *
+ * @return 0 on success
+ */
+int InternalOggClose(void* source) {
+    return SDL_RWclose((SDL_RWops*)source);
+}
+
+/**
+ * The vorbis tell callback for an SDL_RWops source
+ *
+ * @param source    The SDL_RWops source
+ *
+ * @return the current position in the source
+ */
+long InternalOggTell(void* source) {
+    return (long)SDL_RWtell((SDL_RWops*)source);
+}
+
+/** The vorbis callbacks for reading SDL_RWops */
+static ov_callbacks OGG_RWOPS_CALLBACKS = {
+    InternalOggRead, InternalOggSeek, InternalOggClose, InternalOggTell
+};
+
+/**
+ * The SDL_Mixer music hook for streaming music.
+ *
+ * This function is called in the audio callback, so it never decodes and it
+ * never blocks.  It only copies (and scales) PCM out of the ring buffer.  If
+ * the decoder has fallen behind, the rest of the block is left silent.
+ *
+ * @param udata     The music decoder
+ * @param stream    The output buffer
+ * @param len       The length of the output buffer in bytes
+ */
+void InternalStreamMix(void* udata, Uint8* stream, int len) {
+    AudioDecoder* decoder = (AudioDecoder*)udata;
+    int state = SDL_AtomicGet(&decoder->state);
+    if (state == STREAM_IDLE || state == STREAM_ENDED || SDL_AtomicGet(&decoder->paused)) {
+        return;
+    }
+    
+    // Pick up any fade out request from the main thread
+    int request = SDL_AtomicSet(&decoder->fadeRequest, 0);
+    if (request > 0) {
+        decoder->fadeTotal = (Sint32)((Sint64)request*decoder->frequency/1000);
+        decoder->fadeTotal = decoder->fadeTotal > 0 ? decoder->fadeTotal : 1;
+        decoder->fadeFrames = decoder->fadeTotal;
+        decoder->fadeOut = true;
+    }
+    
+    AudioRing* ring = &decoder->ring;
+    Uint32 mask  = ring->capacity-1;
+    Uint32 tail  = (Uint32)SDL_AtomicGet(&ring->tail);
+    Uint32 avail = (Uint32)SDL_AtomicGet(&ring->head)-tail;
+    Uint32 want  = (Uint32)len/(sizeof(Sint16)*decoder->channels);
+    Uint32 count = want < avail ? want : avail;
+    
+    Sint16* output = (Sint16*)stream;
+    Sint32 volume = SDL_AtomicGet(&decoder->volume);
+    bool finished = false;
+    for(Uint32 ii = 0; !finished && ii < count; ii++) {
+        Sint32 gain = volume;
+        if (decoder->fadeFrames > 0) {
+            Sint32 step = decoder->fadeOut ? decoder->fadeFrames : decoder->fadeTotal-decoder->fadeFrames;
+            gain = (Sint32)((Sint64)volume*step/decoder->fadeTotal);
+            decoder->fadeFrames--;
+            if (decoder->fadeOut && decoder->fadeFrames == 0) {
+                count = ii+1;
+                finished = true;
+            }
+        }
+        const Sint16* input = ring->data+((tail+ii) & mask)*decoder->channels;
+        for(int jj = 0; jj < decoder->channels; jj++) {
+            *output++ = (Sint16)(input[jj]*gain/MIX_MAX_VOLUME);
+        }
+    }
+    SDL_AtomicSet(&ring->tail, (int)(tail+count));
+    
+    if (finished) {
+        SDL_AtomicSet(&decoder->state, STREAM_ENDED);
+        SDL_CondSignal(decoder->wake);
+    } else if (count < want && state == STREAM_DRAINING) {
+        SDL_AtomicCAS(&decoder->state, STREAM_DRAINING, STREAM_ENDED);
+        SDL_CondSignal(decoder->wake);
+    } else if (avail-count < decoder->readAhead/2) {
+        SDL_CondSignal(decoder->wake);
+    }
+}
+
+/**
+ * Acquires the decoder lock once the decoder thread is not busy.
+ *
+ * The decoder thread decodes without the lock, so this is required before
+ * changing the vorbis file or the resampler.  The wait is at most a single
+ * block of decoding.
+ *
+ * @param decoder   The music decoder
+ */
+void StreamLock(AudioDecoder* decoder) {
+    SDL_LockMutex(decoder->lock);
+    while (decoder->busy) {
+        SDL_CondWait(decoder->idle, decoder->lock);
+    }
+}
+
+/**
+ * Discards any decoded audio that is not in the ring buffer.
+ *
+ * The decoder lock must be held (with the decoder not busy).
+ *
+ * @param decoder   The music decoder
+ */
+void StreamReset(AudioDecoder* decoder) {
+    decoder->position = 0;
+    decoder->primed = false;
+    decoder->pendingSize = 0;
+    decoder->pendingNext = 0;
+}
+
+/**
+ * Closes the vorbis file of the given decoder (if any)
+ *
+ * The decoder lock must be held (with the decoder not busy).
+ *
+ * @param decoder   The music decoder
+ */
+void StreamClose(AudioDecoder* decoder) {
+    if (decoder->open) {
+        ov_clear(&decoder->ogg);    // This closes the source as well
+        decoder->open = false;
+        decoder->source = nullptr;
+    }
+    StreamReset(decoder);
+}
+
+/**
+ * Returns true if the decoder opened the given file for streaming.
+ *
+ * The decoder lock must be held (with the decoder not busy).  On success,
+ * the ring buffer is empty and the decoder is positioned at the given time.
+ *
+ * @param decoder   The music decoder
+ * @param path      The path to the OGG file
+ * @param start     The position (in milliseconds) to start decoding
+ *
+ * @return true if the decoder opened the given file for streaming.
+ */
+bool StreamOpen(AudioDecoder* decoder, const std::string& path, Uint32 start) {
+    StreamClose(decoder);
+    decoder->source = SDL_RWFromFile(path.c_str(), "rb");
+    if (!decoder->source) {
+        CULogError("Unable to open music file '%s'", path.c_str());
+        return false;
+    } else if (ov_open_callbacks(decoder->source, &decoder->ogg, nullptr, 0, OGG_RWOPS_CALLBACKS) < 0) {
+        CULogError("Music file '%s' is not OGG Vorbis", path.c_str());
+        SDL_RWclose(decoder->source);
+        decoder->source = nullptr;
+        return false;
+    }
+    decoder->open = true;
+    
+    // A block of vorbis frames never makes more device frames than this
+    vorbis_info* info = ov_info(&decoder->ogg, -1);
+    decoder->inputs = info->channels;
+    decoder->step = (double)info->rate/decoder->frequency;
+    decoder->previous.resize(info->channels);
+    decoder->pending.resize(((size_t)(STREAM_DECODE_FRAMES/decoder->step)+2)*decoder->channels);
+    if (start > 0) {
+        ov_time_seek(&decoder->ogg, start/1000.0);
+    }
+    decoder->eof = false;
+    SDL_AtomicSet(&decoder->ring.head, 0);
+    SDL_AtomicSet(&decoder->ring.tail, 0);
+    return true;
+}
+
+/**
+ * Returns the given vorbis sample, converted to the given device channel.
+ *
+ * Frame 0 is the last frame of the previous block, and frame k > 0 is
+ * frame k-1 of the current block.  Mono music is played on every channel,
+ * and multichannel music is averaged for a mono device.
+ *
+ * @param decoder   The music decoder
+ * @param pcm       The current block of vorbis output
+ * @param frame     The frame position
+ * @param channel   The device channel
+ *
+ * @return the given vorbis sample, converted to the given device channel.
+ */
+float StreamSample(AudioDecoder* decoder, float** pcm, long frame, int channel) {
+    if (decoder->channels == 1 && decoder->inputs > 1) {
+        if (frame == 0) {
+            return 0.5f*(decoder->previous[0]+decoder->previous[1]);
+        }
+        return 0.5f*(pcm[0][frame-1]+pcm[1][frame-1]);
+    }
+    int source = channel < decoder->inputs ? channel : decoder->inputs-1;
+    return frame == 0 ? decoder->previous[source] : pcm[source][frame-1];
+}
+
+/**
+ * Resamples a block of vorbis output to the pending block of the decoder.
+ *
+ * This converts the rate and the channels with linear interpolation, and
+ * the samples to 16 bit integers.  It keeps the fractional position and the
+ * last frame, so that consecutive blocks join without a seam.  This is only
+ * called by the decoder thread while it is busy.
+ *
+ * @param decoder   The music decoder
+ * @param pcm       The block of vorbis output (one array per channel)
+ * @param frames    The number of frames in the block
+ */
+void StreamResample(AudioDecoder* decoder, float** pcm, long frames) {
+    if (!decoder->primed) {
+        for(int jj = 0; jj < decoder->inputs; jj++) {
+            decoder->previous[jj] = pcm[jj][0];
+        }
+        decoder->primed = true;
+    }
+    
+    Uint32 count = 0;
+    Sint16* output = decoder->pending.data();
+    double pos = decoder->position;
+    while (pos < frames) {
+        long frame = (long)pos;
+        float t = (float)(pos-frame);
+        for(int jj = 0; jj < decoder->channels; jj++) {
+            float a = StreamSample(decoder, pcm, frame,   jj);
+            float b = StreamSample(decoder, pcm, frame+1, jj);
+            float value = a+(b-a)*t;
+            value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+            *output++ = (Sint16)(value*32767.0f);
+        }
+        count++;
+        pos += decoder->step;
+    }
+    
+    decoder->position = pos-frames;
+    for(int jj = 0; jj < decoder->inputs; jj++) {
+        decoder->previous[jj] = pcm[jj][frames-1];
+    }
+    decoder->pendingSize = count;
+    decoder->pendingNext = 0;
+}
+
+/**
+ * Decodes music until the ring buffer holds the read-ahead.
+ *
+ * The decoder lock must be held, and it is still held when this function
+ * returns.  However, the lock is released while each block is decoded, and
+ * is only retaken to publish the block to the ring buffer.  This is only
+ * called by the decoder thread. If the decoder reaches the end of a music
+ * file that does not loop, it changes the state to STREAM_DRAINING.
+ *
+ * @param decoder   The music decoder
+ */
+void StreamFill(AudioDecoder* decoder) {
+    AudioRing* ring = &decoder->ring;
+    Uint32 mask = ring->capacity-1;
+    int channels = decoder->channels;
+    while (SDL_AtomicGet(&decoder->state) == STREAM_PLAYING) {
+        Uint32 head = (Uint32)SDL_AtomicGet(&ring->head);
+        Uint32 used = head-(Uint32)SDL_AtomicGet(&ring->tail);
+        if (used >= decoder->readAhead) {
+            return;
+        }
+        
+        // Move decoded audio into the ring before decoding more
+        Uint32 ready = decoder->pendingSize-decoder->pendingNext;
+        if (ready > 0) {
+            Uint32 amount = ring->capacity-used;
+            Uint32 edge = ring->capacity-(head & mask);
+            amount = amount < edge  ? amount : edge;
+            amount = amount < ready ? amount : ready;
+            std::copy(decoder->pending.data()+decoder->pendingNext*channels,
+                      decoder->pending.data()+(decoder->pendingNext+amount)*channels,
+                      ring->data+(head & mask)*channels);
+            decoder->pendingNext += amount;
+            SDL_AtomicSet(&ring->head, (int)(head+amount));
+            continue;
+        } else if (decoder->eof) {
+            SDL_AtomicCAS(&decoder->state, STREAM_PLAYING, STREAM_DRAINING);
+            return;
+        }
+        
+        // Nobody else touches the vorbis file or the resampler while we are busy
+        decoder->busy = true;
+        SDL_UnlockMutex(decoder->lock);
+        
+        float** pcm = nullptr;
+        int bitstream = 0;
+        bool eof = false;
+        long frames = ov_read_float(&decoder->ogg, &pcm, STREAM_DECODE_FRAMES, &bitstream);
+        if (frames > 0) {
+            StreamResample(decoder, pcm, frames);
+        } else if (frames == 0 && SDL_AtomicGet(&decoder->loop) && ov_pcm_seek(&decoder->ogg, 0) == 0) {
+            // Loop back to the beginning on the next block
+        } else if (frames != OV_HOLE) {
+            eof = true;
+        }
+        
+        SDL_LockMutex(decoder->lock);
+        decoder->busy = false;
+        decoder->eof = decoder->eof || eof;
+        SDL_CondBroadcast(decoder->idle);
+    }
+}
+
+/**
+ * The body of the decoder thread.
+ *
+ * The thread sleeps until it is signaled (or polls), and then decodes up to
+ * the read-ahead.  When the audio callback drains a finished stream, the
+ * thread reports the completion to the engine, just like SDL_Mixer would.
+ *
+ * @param data  The music decoder
+ *
+ * @return 0 when the thread exits
+ */
+int InternalStreamDecode(void* data) {
+    AudioDecoder* decoder = (AudioDecoder*)data;
+    SDL_LockMutex(decoder->lock);
+    while (SDL_AtomicGet(&decoder->alive)) {
+        if (SDL_AtomicGet(&decoder->state) == STREAM_PLAYING) {
+            StreamFill(decoder);
+        }
+        if (SDL_AtomicCAS(&decoder->state, STREAM_ENDED, STREAM_IDLE)) {
+            StreamClose(decoder);
+            SDL_UnlockMutex(decoder->lock);
+            InternalMusicFinished();
+            SDL_LockMutex(decoder->lock);
+        } else {
+            SDL_CondWaitTimeout(decoder->wake, decoder->lock, STREAM_POLL_TIME);
+        }
+    }
+    SDL_UnlockMutex(decoder->lock);
+    return 0;
+}
+
+/**
+ * Returns a newly allocated music decoder, with its thread running.
+ *
+ * The ring buffer is sized for the read-ahead in the device format, so the
+ * memory for streaming music does not depend on the length of the song.
+ *
+ * @return a newly allocated music decoder, with its thread running.
+ */
+AudioDecoder* StreamAlloc() {
+    int freq = 0;
+    Uint16 fmt = 0;
+    int chans = 0;
+    if (!Mix_QuerySpec(&freq, &fmt, &chans) || fmt != AUDIO_S16SYS) {
+        return nullptr;
+    }
+    
+    AudioDecoder* decoder = new AudioDecoder();
+    decoder->source  = nullptr;
+    decoder->open    = false;
+    decoder->eof     = false;
+    decoder->busy    = false;
+    decoder->inputs  = 0;
+    decoder->step    = 1.0;
+    decoder->channels  = chans;
+    decoder->frequency = freq;
+    decoder->readAhead = (Uint32)(CU_MUSIC_READ_AHEAD*freq);
+    decoder->fadeFrames = 0;
+    decoder->fadeTotal  = 0;
+    decoder->fadeOut    = false;
+    StreamReset(decoder);
+    
+    decoder->ring.capacity = 1;
+    while (decoder->ring.capacity < decoder->readAhead+MIX_BLOCK_SIZE) {
+        decoder->ring.capacity <<= 1;
+    }
+    decoder->ring.data = new Sint16[decoder->ring.capacity*chans];
+    SDL_AtomicSet(&decoder->ring.head, 0);
+    SDL_AtomicSet(&decoder->ring.tail, 0);
+    
+    SDL_AtomicSet(&decoder->state, STREAM_IDLE);
+    SDL_AtomicSet(&decoder->paused, 0);
+    SDL_AtomicSet(&decoder->loop, 0);
+    SDL_AtomicSet(&decoder->volume, MIX_MAX_VOLUME);
+    SDL_AtomicSet(&decoder->fadeRequest, 0);
+    SDL_AtomicSet(&decoder->alive, 1);
+    decoder->lock = SDL_CreateMutex();
+    decoder->wake = SDL_CreateCond();
+    decoder->idle = SDL_CreateCond();
+    decoder->thread = SDL_CreateThread(InternalStreamDecode, "CUMusicStream", decoder);
+    if (!decoder->thread) {
+        CULogError("Unable to start music decoder: %s", SDL_GetError());
+        SDL_DestroyCond(decoder->idle);
+        SDL_DestroyCond(decoder->wake);
+        SDL_DestroyMutex(decoder->lock);
+        delete[] decoder->ring.data;
+        delete decoder;
+        return nullptr;
+    }
+    return decoder;
+}
+
+/**
+ * Stops the decoder thread and frees the music decoder
+ *
+ * @param decoder   The music decoder
+ */
+void StreamFree(AudioDecoder* decoder) {
+    Mix_HookMusic(nullptr, nullptr);
+    SDL_AtomicSet(&decoder->alive, 0);
+    SDL_CondSignal(decoder->wake);
+    SDL_WaitThread(decoder->thread, nullptr);
+    StreamClose(decoder);
+    SDL_DestroyCond(decoder->idle);
+    SDL_DestroyCond(decoder->wake);
+    SDL_DestroyMutex(decoder->lock);
+    delete[] decoder->ring.data;
+    delete decoder;
+}
+
+/**
+ * Returns true if the OGG music asset started streaming.
+ *
+ * This replaces any music currently playing, without reporting it as
+ * finished.  If the file cannot be streamed, this returns false and the
+ * music should be played by SDL_Mixer instead.
+ *
+ * @param player    The music player
+ * @param source    The (streaming) audio asset
+ * @param loop      Whether to loop the given asset
+ * @param start     The position (in milliseconds) to start playback
+ * @param fade      The time (in milliseconds) to fade in playback
+ *
+ * @return true if the OGG music asset started streaming.
+ */
+bool StreamStart(AudioPlayer* player, AudioStream* source, bool loop, Uint32 start, Uint32 fade) {
+    AudioDecoder* decoder = player->decoder;
+    if (!decoder || Mix_GetMusicType(source->music) != MUS_OGG) {
+        return false;
+    }
+    
+    // Silence SDL_mixer without reporting the music as finished
+    if (!player->streaming && Mix_PlayingMusic()) {
+        Mix_HookMusicFinished(nullptr);
+        Mix_HaltMusic();
+        Mix_HookMusicFinished(InternalMusicFinished);
+    }
+
+    // The callback cannot see the decoder while it is unhooked
+    Mix_HookMusic(nullptr, nullptr);
+    StreamLock(decoder);
+    bool success = StreamOpen(decoder, source->path, start);
+    if (success) {
+        decoder->fadeTotal  = (Sint32)((Sint64)fade*decoder->frequency/1000);
+        decoder->fadeFrames = decoder->fadeTotal;
+        decoder->fadeOut = false;
+        SDL_AtomicSet(&decoder->fadeRequest, 0);
+        SDL_AtomicSet(&decoder->loop, loop ? 1 : 0);
+        SDL_AtomicSet(&decoder->paused, 0);
+        SDL_AtomicSet(&decoder->state, STREAM_PLAYING);
+    } else {
+        SDL_AtomicSet(&decoder->state, STREAM_IDLE);
+    }
+    SDL_UnlockMutex(decoder->lock);
+    
+    player->streaming = success;
+    if (success) {
+        SDL_CondSignal(decoder->wake);
+        Mix_HookMusic(InternalStreamMix, decoder);
+    }
+    return success;
+}
+
+/**
+ * Returns true if the player was streaming music that is now halted.
+ *
+ * This function detaches the decoder from the mixer, but it does not
+ * report the music as finished.  That is the responsibility of the caller.
+ *
+ * @param player    The music player
+ *
+ * @return true if the player was streaming music that is now halted.
+ */
+bool StreamHalt(AudioPlayer* player) {
+    if (!player->streaming) {
+        return false;
+    }
+    AudioDecoder* decoder = player->decoder;
+    Mix_HookMusic(nullptr, nullptr);
+    StreamLock(decoder);
+    int state = SDL_AtomicSet(&decoder->state, STREAM_IDLE);
+    StreamClose(decoder);
+    SDL_UnlockMutex(decoder->lock);
+    player->streaming = false;
+    return state != STREAM_IDLE;
+}
+
+/**
+ * Returns true if the streaming music moved to the given position.
+ *
+ * The buffered audio is discarded, so playback resumes at the new position
+ * as soon as the decoder catches up.
+ *
+ * @param player    The music player
+ * @param time      The new position in seconds
+ *
+ * @return true if the streaming music moved to the given position.
+ */
+bool StreamSeek(AudioPlayer* player, double time) {
+    AudioDecoder* decoder = player->decoder;
+    Mix_HookMusic(nullptr, nullptr);
+    StreamLock(decoder);
+    bool success = decoder->open && ov_time_seek(&decoder->ogg, time) == 0;
+    if (success) {
+        StreamReset(decoder);
+        SDL_AtomicSet(&decoder->ring.head, 0);
+        SDL_AtomicSet(&decoder->ring.tail, 0);
+        decoder->eof = false;
+        SDL_AtomicCAS(&decoder->state, STREAM_DRAINING, STREAM_PLAYING);
+    }
+    SDL_UnlockMutex(decoder->lock);
+    SDL_CondSignal(decoder->wake);
+    Mix_HookMusic(InternalStreamMix, decoder);
+    return success;
+}
+#endif
+
+
 #pragma mark -
 #pragma mark Background Music
 /**
@@ -633,6 +1888,10 @@ AudioPlayer* AudioAllocBackground() {
             player->music = nullptr;
             player->pauseTick = 0;
             player->startTick = 0;
+#if defined (CU_MUSIC_STREAMING)
+            player->decoder = StreamAlloc();
+            player->streaming = false;
+#endif
         }
         _engine->background = player;
     }
@@ -648,6 +1907,12 @@ AudioPlayer* AudioAllocBackground() {
  * @param channel   The music player to free
  */
 void AudioFreeBackground(AudioPlayer* player) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->decoder) {
+        StreamFree(player->decoder);
+        player->decoder = nullptr;
+    }
+#endif
     _engine->background = nullptr;
     delete player;
 }
@@ -679,6 +1944,13 @@ void AudioPlayBackground(AudioPlayer* player, AudioStream* source, bool loop, Ui
     player->startTime = start;
     player->music = source->music;
     
+#if defined (CU_MUSIC_STREAMING)
+    if (StreamStart(player, source, loop, start, 0)) {
+        return;
+    }
+    StreamHalt(player);
+#endif
+    
     // Do this quietly
     int volume = Mix_VolumeMusic(0);
     Mix_PlayMusic(source->music,(loop ? -1 : 0));
@@ -713,6 +1985,12 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
     player->startTime = start;
     player->music = source->music;
 
+#if defined (CU_MUSIC_STREAMING)
+    if (StreamStart(player, source, loop, start, fade)) {
+        return;
+    }
+    StreamHalt(player);
+#endif
     Mix_FadeInMusic(source->music,(loop ? -1 : 0),fade);
     Mix_SetMusicPosition(start/1000.0);
 }
@@ -726,6 +2004,14 @@ void AudioFadeInBackground(AudioPlayer* player, AudioStream* source, bool loop,
  */
 void AudioHaltBackground(AudioPlayer* player) {
     player->manual = true;
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        if (StreamHalt(player)) {
+            InternalMusicFinished();
+        }
+        return;
+    }
+#endif
     Mix_HaltMusic();
 }
 
@@ -740,6 +2026,12 @@ void AudioHaltBackground(AudioPlayer* player) {
  * @param millis    The number of millisecond before halting the asset
  */
 void AudioFadeOutBackground(AudioPlayer* player, Uint32 millis) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        SDL_AtomicSet(&player->decoder->fadeRequest, millis > 0 ? (int)millis : 1);
+        return;
+    }
+#endif
     Mix_FadeOutMusic(millis);
 }
 
@@ -754,6 +2046,12 @@ void AudioFadeOutBackground(AudioPlayer* player, Uint32 millis) {
  */
 void AudioPauseBackground(AudioPlayer* player) {
     player->pauseTick = SDL_GetTicks();
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        SDL_AtomicSet(&player->decoder->paused, 1);
+        return;
+    }
+#endif
     Mix_PauseMusic();
 }
 
@@ -768,6 +2066,12 @@ void AudioPauseBackground(AudioPlayer* player) {
 void AudioResumeBackground(AudioPlayer* player) {
     player->startTime = (Uint32)AudioGetBackgroundTime(player);
     player->startTick = SDL_GetTicks();
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        SDL_AtomicSet(&player->decoder->paused, 0);
+        return;
+    }
+#endif
     Mix_ResumeMusic();
 }
 
@@ -781,6 +2085,11 @@ void AudioResumeBackground(AudioPlayer* player) {
  * @return true if the background music is actively playing.
  */
 bool AudioBackgroundPlaying(AudioPlayer* player) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        return SDL_AtomicGet(&player->decoder->state) != STREAM_IDLE;
+    }
+#endif
     return (bool)Mix_PlayingMusic();
 }
 
@@ -795,6 +2104,11 @@ bool AudioBackgroundPlaying(AudioPlayer* player) {
  * @return true if the background music is actively paused.
  */
 bool AudioBackgroundPaused(AudioPlayer* player) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        return AudioBackgroundPlaying(player) && SDL_AtomicGet(&player->decoder->paused);
+    }
+#endif
     return (bool)Mix_PausedMusic();
 }
 
@@ -808,6 +2122,11 @@ bool AudioBackgroundPaused(AudioPlayer* player) {
  * @param volume    The volume (0 to 1) to play the asset
  */
 void AudioSetBackgroundVolume(AudioPlayer* player, float volume) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->decoder) {
+        SDL_AtomicSet(&player->decoder->volume, (int)(volume*MIX_MAX_VOLUME));
+    }
+#endif
     Mix_VolumeMusic((int)(volume*MIX_MAX_VOLUME));
 }
 
@@ -823,6 +2142,12 @@ void AudioSetBackgroundVolume(AudioPlayer* player, float volume) {
  * @param loop      Whether to loop the current attached asset
  */
 void AudioSetBackgroundLoop(AudioPlayer* player, bool loop) {
+#if defined (CU_MUSIC_STREAMING)
+    if (player->streaming) {
+        SDL_AtomicSet(&player->decoder->loop, loop ? 1 : 0);
+        return;
+    }
+#endif
     Mix_SetMusicLoop(loop ? -1 : 0);
 }
 
@@ -863,10 +2188,15 @@ double AudioGetBackgroundTime(AudioPlayer* player) {
  * @param loop      Whether to loop the current attached asset
  */
 void  AudioSetBackgroundTime(AudioPlayer* player, double time) {
-    if (Mix_SetMusicPosition(time) != -1) {
+#if defined (CU_MUSIC_STREAMING)
+    bool success = (player->streaming ? StreamSeek(player, time) : Mix_SetMusicPosition(time) != -1);
+#else
+    bool success = Mix_SetMusicPosition(time) != -1;
+#endif
+    if (success) {
         player->startTick = SDL_GetTicks();
         player->startTime = (Uint32)(time*1000);
-        if (Mix_PausedMusic()) {
+        if (AudioBackgroundPaused(player)) {
             player->pauseTick = player->startTick;
         }
         return;
@@ -166,6 +166,15 @@ namespace impl {
      * @return the number of sample rate (in HZ) for the given PCM buffer
      */
     double AudioGetBufferSampleRate(AudioBuffer* source);
+    
+    /**
+     * Returns the memory (in bytes) used by the given PCM buffer
+     *
+     * @param source    The PCM buffer
+     *
+     * @return the memory (in bytes) used by the given PCM buffer
+     */
+    size_t AudioGetBufferBytes(AudioBuffer* source);
 
     
 #pragma mark -
@@ -339,6 +348,18 @@ namespace impl {
      */
     void AudioSetChannelVolume(AudioChannel* player, float volume);
 
+    /**
+     * Sets the mixing priority for this sound channel
+     *
+     * Backends that mix the channels themselves with a time budget drop the
+     * lowest priority channels first.  Backends without a budget ignore this
+     * value.
+     *
+     * @param player    The sound channel
+     * @param priority  The mixing priority (higher is more important)
+     */
+    void AudioSetChannelPriority(AudioChannel* player, int priority);
+
     /**
      * Sets the loop option for this sound channel
      *
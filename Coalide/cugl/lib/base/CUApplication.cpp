@@ -35,6 +35,8 @@
 #include <cugl/base/CUDisplay.h>
 #include <cugl/input/CUInput.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUThreadPool.h>
+#include <cugl/renderer/CURenderSnapshot.h>
 #include <SDL/SDL_ttf.h>
 #include <algorithm>
 
@@ -44,6 +46,18 @@
 #define DEFAULT_HEIGHT  576
 /** The default smoothing window for fps calculation */
 #define FPS_WINDOW      10
+/** The number of frames kept by the flight recorder (5 seconds at 60 fps) */
+#define FLIGHT_WINDOW   300
+/** The number of frame intervals used to measure the pacing variance */
+#define PACING_WINDOW   120
+/** The milliseconds to spin (rather than sleep) before a frame deadline */
+#define PACING_SPIN     2
+/** How close (as a fraction) the FPS must be to a divisor of the refresh rate to snap to it */
+#define PACING_SNAP     0.05f
+/** The default frame rate when there is nothing to redraw */
+#define IDLE_FPS        15.0f
+/** The vertex capacity reserved by each render snapshot when pipelined */
+#define PIPELINE_CAPACITY   8192
 
 using namespace cugl;
 
@@ -62,17 +76,31 @@ Application* Application::_theapp = nullptr;
 Application::Application() :
 _name("CUGL Game"),
 _org("GDIAC"),
-_savesdir(""),
 _assetdir(""),
+_savesdir(""),
 _window(nullptr),
 _glContext(NULL),
 _state(State::NONE),
 _fullscreen(false),
 _highdpi(true),
-_finish(0),
+_clearColor(Color4f::CORNFLOWER), // Ah, XNA
+_period(0),
+_deadline(0),
+_swapInterval(0),
+_vsync(true),
+_synced(false),
+_idleFPS(IDLE_FPS),
+_idlePeriod(0),
+_idle(false),
+_exposed(true),
+_intervalNext(0),
+_intervalCount(0),
+_pipelined(false),
+_recorded(false),
+_presenting(false),
 _start(0),
-_funcid(0),
-_clearColor(Color4f::CORNFLOWER) // Ah, XNA
+_finish(0),
+_funcid(0)
 {
     _display.size.set(DEFAULT_WIDTH,DEFAULT_HEIGHT);
     setFPS(60.0f);
@@ -94,6 +122,7 @@ _clearColor(Color4f::CORNFLOWER) // Ah, XNA
  * it can be safely reinitialized.
  */
 void Application::dispose() {
+    setPipelined(false);
     if (_window != nullptr) {
         SDL_GL_DeleteContext(_glContext);
         SDL_DestroyWindow(_window);
@@ -106,6 +135,13 @@ void Application::dispose() {
     _fullscreen = false;
     _highdpi = true;
     _fpswindow.clear();
+    _intervals.clear();
+    _intervalNext = 0;
+    _intervalCount = 0;
+    _idleFPS = IDLE_FPS;
+    _idle = false;
+    _exposed = true;
+    _recorder = nullptr;
     _clearColor = Color4f::CORNFLOWER;
     setFPS(60.0f);
 }
@@ -178,8 +214,12 @@ bool Application::init() {
 #endif
     
     _fpswindow.resize(FPS_WINDOW,1.0f/_fps);
+    _intervals.assign(PACING_WINDOW,0.0f);
+    _recorder = FrameRecorder::alloc(FLIGHT_WINDOW,0);
+    _recorder->activate();
 
-    SDL_GL_SetSwapInterval(1);
+    // Now that we have a display and a context, pace to the refresh rate
+    updatePacing();
     Input::start();
     Application::_theapp = this;
     _state = State::STARTUP;
@@ -202,7 +242,8 @@ void Application::onStartup() {
     // Switch states and show to user
     SDL_ShowWindow(_window);
     _state = State::FOREGROUND;
-    _start = SDL_GetTicks();
+    _start = SDL_GetPerformanceCounter();
+    _deadline = _start;
 }
 
 /**
@@ -273,6 +314,14 @@ bool Application::getInput() {
                 _state = State::SHUTDOWN;
                 return false;
                 break;
+            case SDL_WINDOWEVENT:
+                // The last frame may be lost, even if nothing changed
+                if (event.window.event == SDL_WINDOWEVENT_EXPOSED ||
+                    event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                    event.window.event == SDL_WINDOWEVENT_RESTORED) {
+                    _exposed = true;
+                }
+                break;
             default:
                 // Ignore the event.
                 break;
@@ -291,36 +340,94 @@ bool Application::getInput() {
  * @return false if the application should quit next frame
  */
 bool Application::step() {
-    _finish = SDL_GetTicks();
+    _finish = SDL_GetPerformanceCounter();
     
-    Uint32 millis = _finish - _start;
-    float lastframe = millis/1000.0f;
-    _fpswindow.pop_front();
-    _fpswindow.push_back(1.0f/lastframe);
+    float lastframe = (float)((double)(_finish - _start)/SDL_GetPerformanceFrequency());
+    Uint32 millis = (Uint32)(lastframe*1000.0f);
+    if (!_idle) {
+        // An idle frame is not animation, and would skew the statistics
+        _fpswindow.pop_front();
+        _fpswindow.push_back(1.0f/lastframe);
+        _intervals[_intervalNext] = lastframe;
+        _intervalNext = (_intervalNext+1) % _intervals.size();
+        _intervalCount++;
+    }
     
     // Step the game one time
-    _start = SDL_GetTicks();
+    _start = _finish;
+    _recorder->beginFrame();
     bool running = getInput();
-    if (running &&  _state == State::FOREGROUND) {
+    bool drawn = false;
+    if (running &&  _state == State::FOREGROUND && _pipelined) {
         processCallbacks(millis);
-        update(lastframe);
+        FrameRecorder* recorder = _recorder.get();
+        bool exposed = _exposed;
+        _exposed = false;
+        _pipeline->addTask([this,recorder,lastframe,exposed] {
+            recorder->activate();
+            FrameRecorder::Scope scope(FrameRecorder::UPDATE);
+            update(lastframe);
+            _recorded = needsRedraw() || exposed;
+            if (_recorded) {
+                draw();
+            }
+        }, _pipelineGroup);
 
-        glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
-        glClear( GL_COLOR_BUFFER_BIT );
+        if (_presenting) {
+            FrameRecorder::Scope scope(FrameRecorder::RENDER);
+            glClearColor(_presentColor.r, _presentColor.g, _presentColor.b, _presentColor.a);
+            glClear( GL_COLOR_BUFFER_BIT );
+            
+            present();
+        }
+        
+        // Join before the swap, so the swap wait does not hide a slow update
+        _pipelineGroup->wait();
+        std::swap(_snapshots[0],_snapshots[1]);
+        _presentColor = _clearColor;
+        drawn = _presenting;
+        _presenting = _recorded;
 
-        draw();
+        if (drawn) {
+            FrameRecorder::Scope scope(FrameRecorder::SWAP);
+            SDL_GL_SwapWindow(_window);
+        }
+    } else if (running &&  _state == State::FOREGROUND) {
+        processCallbacks(millis);
+        {
+            FrameRecorder::Scope scope(FrameRecorder::UPDATE);
+            update(lastframe);
+        }
 
-        SDL_GL_SwapWindow(_window);
+        drawn = needsRedraw() || _exposed;
+        if (drawn) {
+            _exposed = false;
+            {
+                FrameRecorder::Scope scope(FrameRecorder::RENDER);
+                glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
+                glClear( GL_COLOR_BUFFER_BIT );
+
+                draw();
+            }
+
+            FrameRecorder::Scope scope(FrameRecorder::SWAP);
+            SDL_GL_SwapWindow(_window);
+        }
     } else {
         running = _state == State::BACKGROUND;
     }
 
-	// Sleep the remainder
-	_finish = SDL_GetTicks();
-	millis = _finish - _start;
-	if (millis < _delay) {
-		SDL_Delay(_delay - millis);
-	}
+    // A pipelined frame waiting to be presented is not idle
+    _idle = !drawn && !(_pipelined && _presenting);
+
+    // Sleep the remainder
+    {
+        FrameRecorder::Scope scope(FrameRecorder::SLEEP);
+        pace();
+    }
+    if (!_idle) {
+        _recorder->endFrame();
+    }
     
     return running;
 }
@@ -483,6 +590,138 @@ void Application::processCallbacks(Uint32 millis) {
 }
 
 
+/**
+ * Recomputes the frame period and the buffer swap interval.
+ *
+ * If the target FPS is close to the refresh rate of the display divided
+ * by a whole number, the FPS is snapped to that rate.  When vsync is on,
+ * the buffer swap then waits that many display refreshes.  Otherwise the
+ * application paces the frames itself.  It still keeps a swap interval of
+ * 1 in that case (such as an unknown refresh rate), so frames do not tear.
+ * Vsync is only turned off by {@link setVSync}.
+ */
+void Application::updatePacing() {
+    float rate = _fps;
+    _swapInterval = 0;
+    Display* display = Display::get();
+    float refresh = (display == nullptr ? 0 : display->getRefreshRate());
+    if (refresh > 0) {
+        int divisor = std::max(1,(int)(refresh/_fps+0.5f));
+        float snapped = refresh/divisor;
+        if (std::abs(snapped-_fps) <= PACING_SNAP*_fps) {
+            rate = snapped;
+            _swapInterval = divisor;
+        }
+    }
+    _period = (Uint64)(SDL_GetPerformanceFrequency()/rate);
+    _idlePeriod = (Uint64)(SDL_GetPerformanceFrequency()/std::min(_idleFPS,rate));
+    
+    // A hitch is any frame that takes twice the target frame time
+    if (_recorder != nullptr) {
+        _recorder->setBudget((Uint32)(2000000.0f/rate));
+    }
+    
+    _synced = false;
+    if (_glContext != NULL) {
+        if (!_vsync) {
+            SDL_GL_SetSwapInterval(0);
+        } else {
+            if (_swapInterval > 0) {
+                _synced = SDL_GL_SetSwapInterval(_swapInterval) == 0;
+            }
+            if (!_synced) {
+                // Pace the frames ourselves, on top of the display refresh
+                SDL_GL_SetSwapInterval(1);
+            }
+        }
+    }
+}
+
+/**
+ * Sets whether update and draw run on a game thread.
+ *
+ * When an application is pipelined, the methods {@link update} and
+ * {@link draw} run on a game thread, and draw records the frame to a
+ * snapshot instead of drawing it.  At the same time, the main thread
+ * calls {@link present} to draw the snapshot recorded in the previous
+ * frame.  The threads join at the end of every frame, and the snapshots
+ * are swapped.  This overlaps the simulation with the OpenGL submission,
+ * at the cost of one frame of latency.
+ *
+ * As update runs on the game thread, it must not make any OpenGL calls.
+ * This includes creating textures (which asset loaders already do on the
+ * main thread) and releasing the last reference to one. Such work should
+ * go in a callback of {@link schedule}, which is always executed on the
+ * main thread while the game thread is idle.  The timings of update are
+ * recorded in parallel with the render stage of the flight recorder.
+ *
+ * This method should only be called on the main thread, such as from
+ * {@link onStartup} or a scheduled callback. By default, this value is
+ * false.
+ *
+ * @param flag  Whether update and draw run on a game thread
+ */
+void Application::setPipelined(bool flag) {
+    if (flag == _pipelined) {
+        return;
+    } else if (flag) {
+        _pipeline = ThreadPool::alloc(1);
+        _pipelineGroup = WaitGroup::alloc();
+        _snapshots[0] = RenderSnapshot::alloc(PIPELINE_CAPACITY);
+        _snapshots[1] = RenderSnapshot::alloc(PIPELINE_CAPACITY);
+        _presentColor = _clearColor;
+    } else {
+        _pipeline->stop();
+        _pipeline = nullptr;
+        _pipelineGroup = nullptr;
+        _snapshots[0] = nullptr;
+        _snapshots[1] = nullptr;
+    }
+    _pipelined = flag;
+}
+
+/**
+ * Waits until the end of the current frame.
+ *
+ * If the buffer swap is synchronized with the display, the swap has
+ * already paced the frame, and this method only waits if the swap
+ * returned early.  Otherwise, this method waits for a deadline that
+ * advances by a fixed period each frame, so rounding never accumulates.
+ * It sleeps coarsely and then spins for the last few milliseconds, as
+ * the operating system sleep is not precise.
+ *
+ * If nothing was drawn this frame, this method waits out a frame at the
+ * idle FPS instead.
+ */
+void Application::pace() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (_idle) {
+        // Nothing was drawn, so there was no swap to wait on
+        _deadline = _start+_idlePeriod;
+    } else if (_synced) {
+        // A swap that returns this early did not wait for the display (e.g. hidden window)
+        _deadline = (now-_start < _period/2 ? _start+_period : now);
+    } else {
+        _deadline += _period;
+        if (now >= _deadline) {
+            // Do not race to catch up after a long frame
+            if (now-_deadline > _period) {
+                _deadline = now;
+            }
+            return;
+        }
+    }
+    
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 spin = (frequency*PACING_SPIN)/1000;
+    if (now+spin < _deadline) {
+        SDL_Delay((Uint32)(((_deadline-now-spin)*1000)/frequency));
+    }
+    while (SDL_GetPerformanceCounter() < _deadline) {
+        // Spin to the deadline
+    }
+}
+
 #pragma mark -
 #pragma mark Initialization Attributes
 /**
@@ -656,7 +895,7 @@ void Application::setOrganization(const std::string& name) {
  */
 void Application::setFPS(float fps) {
     _fps = fps;
-    _delay = (int)(1000.0f/_fps);
+    updatePacing();
 }
 
 /**
@@ -676,6 +915,33 @@ float Application::getAverageFPS() const {
     return total/_fpswindow.size();
 }
 
+/**
+ * Returns the variance of the recent frame intervals in milliseconds squared.
+ *
+ * A frame interval is the time between the start of two consecutive
+ * frames.  This value measures how stable the frame pacing is, which
+ * matters more to smooth motion than the average FPS.
+ *
+ * @return the variance of the recent frame intervals in milliseconds squared.
+ */
+float Application::getFrameIntervalVariance() const {
+    size_t count = std::min(_intervalCount,_intervals.size());
+    if (count < 2) {
+        return 0;
+    }
+    double mean = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        mean += _intervals[ii];
+    }
+    mean /= count;
+    double total = 0;
+    for(size_t ii = 0; ii < count; ii++) {
+        double diff = _intervals[ii]-mean;
+        total += diff*diff;
+    }
+    return (float)(1000000.0*total/(count-1));
+}
+
 /**
  * Returns the OpenGL description for this application
  *
@@ -52,7 +52,8 @@ Display* Display::_thedisplay = nullptr;
  * constructor directly.  Use the {@link start()} method instead.
  */
 Display::Display() :
-_aspect(Aspect::LANDSCAPE_16_9) {}
+_aspect(Aspect::LANDSCAPE_16_9),
+_refresh(0) {}
 
 /**
  * Initializes the display with the current screen information.
@@ -75,6 +76,12 @@ bool Display::init() {
     _usable = DisplayUsableBounds();
     _aspect = Display::getAspect(_bounds.size.width/_bounds.size.height);
     _scale  = DisplayPixelDensity();
+    
+    SDL_DisplayMode mode;
+    _refresh = 0;
+    if (SDL_GetCurrentDisplayMode(0,&mode) == 0 && mode.refresh_rate > 0) {
+        _refresh = (float)mode.refresh_rate;
+    }
     return true;
 }
 
@@ -91,6 +98,7 @@ void Display::dispose() {
     _bounds.size.set(0,0);
     _usable.size.set(0,0);
     _scale.setZero();
+    _refresh = 0;
     _aspect = Aspect::LANDSCAPE_16_9;
     SDL_Quit();
 }
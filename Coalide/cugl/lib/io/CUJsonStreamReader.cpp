@@ -0,0 +1,462 @@
+//
+//  CUJsonStreamReader.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an event-driven (SAX-style) JSON reader.  Unlike
+//  JsonReader, it never builds the JSON string or a DOM in memory.  Instead
+//  it parses the file a chunk at a time, reporting objects, arrays, keys and
+//  values to a JsonHandler as it encounters them.  This is the preferred way
+//  to read large files into an application-specific data structure, as peak
+//  memory is just the read buffer plus whatever the handler keeps.
+//
+//  By default, this module (and every module in the io package) accesses the
+//  application save directory.  If you want to access another directory, you
+//  will need to specify an absolute path for the file name.  Keep in mind that
+//  absolute paths are very dangerous on mobile devices, because they do not
+//  have proper file systems.  You should confine all files to either the asset
+//  or the save directory.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/io/CUJsonStreamReader.h>
+#include <cugl/assets/CUJsonValue.h>
+#include <cugl/util/CUDebug.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace cugl;
+
+/** The maximum nesting depth of arrays and objects */
+#define MAX_DEPTH   512
+
+#pragma mark -
+#pragma mark Initializers
+/**
+ * Initializes this reader for an in-memory JSON string.
+ *
+ * The string is copied into the read buffer, and there is no backing
+ * file.  The method {@link reset()} is not supported on such a reader.
+ *
+ * @param json  the JSON string to read
+ *
+ * @return true if the reader is initialized properly, false otherwise.
+ */
+bool JsonStreamReader::initWithString(const std::string& json) {
+    CUAssertLog(_bufoff < 0, "Reader is already initialized");
+    _name = "";
+    _stream  = nullptr;
+    _sbuffer = json;
+    _ssize   = (Sint64)json.size();
+    _scursor = _ssize;
+    _capacity = (Uint32)json.size();
+    _bufoff  = 0;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Internal Methods
+/**
+ * Returns the next non-whitespace character without consuming it.
+ *
+ * @return the next non-whitespace character without consuming it.
+ */
+int JsonStreamReader::peekToken() {
+    int c = peek();
+    while (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        _bufoff++;
+        c = peek();
+    }
+    return c;
+}
+
+/**
+ * Returns true if it read a string into the token buffer.
+ *
+ * The stream must be at the opening quote.
+ *
+ * @return true if it read a string into the token buffer.
+ */
+bool JsonStreamReader::readString() {
+    _token.clear();
+    _bufoff++;
+    while (true) {
+        // Copy unescaped runs straight out of the read buffer
+        int c = peek();
+        if (c < 0) {
+            return fail("unterminated string");
+        }
+        Sint32 start = _bufoff;
+        Sint32 end = (Sint32)_sbuffer.size();
+        while (_bufoff < end && _sbuffer[_bufoff] != '"' && _sbuffer[_bufoff] != '\\') {
+            _bufoff++;
+        }
+        _token.append(_sbuffer,start,_bufoff-start);
+        if (_bufoff == end) {
+            continue;
+        }
+
+        char s = _sbuffer[_bufoff++];
+        if (s == '"') {
+            return true;
+        }
+
+        c = peek();
+        _bufoff++;
+        switch (c) {
+            case '"':  _token.push_back('"');  break;
+            case '\\': _token.push_back('\\'); break;
+            case '/':  _token.push_back('/');  break;
+            case 'b':  _token.push_back('\b'); break;
+            case 'f':  _token.push_back('\f'); break;
+            case 'n':  _token.push_back('\n'); break;
+            case 'r':  _token.push_back('\r'); break;
+            case 't':  _token.push_back('\t'); break;
+            case 'u':
+            {
+                Uint32 code;
+                if (!readHex(code)) {
+                    return false;
+                }
+                if (code >= 0xD800 && code <= 0xDBFF && peek() == '\\') {
+                    Uint32 low;
+                    _bufoff++;
+                    if (peek() != 'u') {
+                        return fail("invalid surrogate pair");
+                    }
+                    _bufoff++;
+                    if (!readHex(low)) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code & 0x3FF) << 10) + (low & 0x3FF);
+                }
+                if (code < 0x80) {
+                    _token.push_back((char)code);
+                } else if (code < 0x800) {
+                    _token.push_back((char)(0xC0 | (code >> 6)));
+                    _token.push_back((char)(0x80 | (code & 0x3F)));
+                } else if (code < 0x10000) {
+                    _token.push_back((char)(0xE0 | (code >> 12)));
+                    _token.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                    _token.push_back((char)(0x80 | (code & 0x3F)));
+                } else {
+                    _token.push_back((char)(0xF0 | (code >> 18)));
+                    _token.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                    _token.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                    _token.push_back((char)(0x80 | (code & 0x3F)));
+                }
+            }
+                break;
+            default:
+                return fail("invalid escape sequence");
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns true if it read four hex digits, storing the result in code.
+ *
+ * @param code  The value to store the result
+ *
+ * @return true if it read four hex digits, storing the result in code.
+ */
+bool JsonStreamReader::readHex(Uint32& code) {
+    code = 0;
+    for(int ii = 0; ii < 4; ii++) {
+        int h = peek();
+        code <<= 4;
+        if (h >= '0' && h <= '9') {
+            code |= (Uint32)(h-'0');
+        } else if (h >= 'a' && h <= 'f') {
+            code |= (Uint32)(h-'a'+10);
+        } else if (h >= 'A' && h <= 'F') {
+            code |= (Uint32)(h-'A'+10);
+        } else {
+            return fail("invalid unicode escape");
+        }
+        _bufoff++;
+    }
+    return true;
+}
+
+/**
+ * Returns true if it read a number, storing the result in value.
+ *
+ * @param value The value to store the result
+ *
+ * @return true if it read a number, storing the result in value.
+ */
+bool JsonStreamReader::readNumber(double& value) {
+    _digits.clear();
+    int c = peek();
+    while ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+        _digits.push_back((char)c);
+        _bufoff++;
+        c = peek();
+    }
+    char* end = nullptr;
+    value = strtod(_digits.c_str(),&end);
+    if (_digits.empty() || *end != '\0') {
+        return fail("invalid number");
+    }
+    return true;
+}
+
+/**
+ * Returns true if the stream matches the given literal, consuming it.
+ *
+ * @param literal   The literal to match
+ *
+ * @return true if the stream matches the given literal, consuming it.
+ */
+bool JsonStreamReader::readLiteral(const char* literal) {
+    for(const char* c = literal; *c; c++) {
+        if (peek() != *c) {
+            return fail("unexpected token");
+        }
+        _bufoff++;
+    }
+    return true;
+}
+
+/**
+ * Returns true if it read an object key and the following colon.
+ *
+ * The key is reported to the handler.
+ *
+ * @param handler   The event handler
+ *
+ * @return true if it read an object key and the following colon.
+ */
+bool JsonStreamReader::readKey(JsonHandler& handler) {
+    if (peekToken() != '"') {
+        return fail("expected key");
+    } else if (!readString()) {
+        return false;
+    } else if (peekToken() != ':') {
+        return fail("expected ':'");
+    }
+    _bufoff++;
+    return handler.key(_token);
+}
+
+/**
+ * Returns false after reporting a parse error
+ *
+ * @param message   The error message
+ *
+ * @return false (for convenience)
+ */
+bool JsonStreamReader::fail(const char* message) {
+    CUAssertLog(false, "Invalid JSON in '%s': %s", _name.c_str(), message);
+    return false;
+}
+
+
+#pragma mark -
+#pragma mark Read Methods
+/**
+ * Returns true if it parsed the next JSON value in the stream.
+ *
+ * This method skips any leading whitespace, and then parses exactly one
+ * JSON value (usually an object), reporting events to the handler as it
+ * goes.  The stream is left just after that value.
+ *
+ * If there is a parsing error, this  method will return false.  Detailed
+ * information about the parsing error will be passed to an assert.  Hence
+ * error messages are suppressed if asserts are turned off.  This method
+ * also returns false (without an assert) if the handler aborts the parse.
+ *
+ * @param handler   The receiver of the parse events
+ *
+ * @return true if it parsed the next JSON value in the stream.
+ */
+bool JsonStreamReader::parse(JsonHandler& handler) {
+    CUAssertLog(ready(), "Attempt to read a finished stream");
+
+    // The open containers; the parser is iterative so depth costs no stack
+    std::vector<char> open;
+    while (true) {
+        // Read a value
+        int c = peekToken();
+        switch (c) {
+            case '{':
+                _bufoff++;
+                if (open.size() >= MAX_DEPTH) {
+                    return fail("nesting is too deep");
+                } else if (!handler.startObject()) {
+                    return false;
+                }
+                if (peekToken() == '}') {
+                    _bufoff++;
+                    if (!handler.endObject()) {
+                        return false;
+                    }
+                } else {
+                    open.push_back('{');
+                    if (!readKey(handler)) {
+                        return false;
+                    }
+                    continue;
+                }
+                break;
+            case '[':
+                _bufoff++;
+                if (open.size() >= MAX_DEPTH) {
+                    return fail("nesting is too deep");
+                } else if (!handler.startArray()) {
+                    return false;
+                }
+                if (peekToken() == ']') {
+                    _bufoff++;
+                    if (!handler.endArray()) {
+                        return false;
+                    }
+                } else {
+                    open.push_back('[');
+                    continue;
+                }
+                break;
+            case '"':
+                if (!readString() || !handler.string(_token)) {
+                    return false;
+                }
+                break;
+            case 't':
+                if (!readLiteral("true") || !handler.boolean(true)) {
+                    return false;
+                }
+                break;
+            case 'f':
+                if (!readLiteral("false") || !handler.boolean(false)) {
+                    return false;
+                }
+                break;
+            case 'n':
+                if (!readLiteral("null") || !handler.null()) {
+                    return false;
+                }
+                break;
+            default:
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    double value;
+                    if (!readNumber(value) || !handler.number(value)) {
+                        return false;
+                    }
+                } else {
+                    return fail(c < 0 ? "unexpected end of stream" : "unexpected token");
+                }
+                break;
+        }
+
+        // Close containers until we need another value
+        bool more = false;
+        while (!open.empty() && !more) {
+            c = peekToken();
+            _bufoff++;
+            if (c == ',') {
+                if (open.back() == '{' && !readKey(handler)) {
+                    return false;
+                }
+                more = true;
+            } else if (c == '}' && open.back() == '{') {
+                open.pop_back();
+                if (!handler.endObject()) {
+                    return false;
+                }
+            } else if (c == ']' && open.back() == '[') {
+                open.pop_back();
+                if (!handler.endArray()) {
+                    return false;
+                }
+            } else {
+                _bufoff--;
+                return fail(c < 0 ? "unexpected end of stream" : "expected ',' or closing bracket");
+            }
+        }
+        if (!more) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns true if it reported the given JSON tree to the handler.
+ *
+ * This method sends the same events as {@link parse}, but it walks a
+ * tree that is already parsed.  This allows a handler to read a JSON
+ * tree without formatting it as text and parsing it again.  This method
+ * returns false if the handler aborts the walk.
+ *
+ * @param json      The JSON tree to report
+ * @param handler   The receiver of the events
+ *
+ * @return true if it reported the given JSON tree to the handler.
+ */
+bool JsonStreamReader::walk(const JsonValue* json, JsonHandler& handler) {
+    switch (json->type()) {
+        case JsonValue::Type::NullType:
+            return handler.null();
+        case JsonValue::Type::BoolType:
+            return handler.boolean(json->asBool());
+        case JsonValue::Type::NumberType:
+            return handler.number(json->asDouble());
+        case JsonValue::Type::StringType:
+            return handler.string(json->asString());
+        case JsonValue::Type::ArrayType:
+            if (!handler.startArray()) {
+                return false;
+            }
+            for(size_t ii = 0; ii < json->size(); ii++) {
+                if (!walk(json->get((int)ii).get(), handler)) {
+                    return false;
+                }
+            }
+            return handler.endArray();
+        case JsonValue::Type::ObjectType:
+            if (!handler.startObject()) {
+                return false;
+            }
+            for(size_t ii = 0; ii < json->size(); ii++) {
+                std::shared_ptr<JsonValue> child = json->get((int)ii);
+                if (!handler.key(child->key()) || !walk(child.get(), handler)) {
+                    return false;
+                }
+            }
+            return handler.endObject();
+    }
+    return false;
+}
@@ -0,0 +1,171 @@
+//
+//  CURenderSnapshot.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides a recorded frame of sprite batch draw calls.  When a
+//  sprite batch records to a snapshot, every flush appends its vertices and
+//  indices to the snapshot, together with the texture, perspective, blending
+//  and drawing command of the flush.  The snapshot can then be replayed by
+//  the sprite batch on another thread.  This allows a game thread to update
+//  and traverse the scene graph for one frame while the thread that owns the
+//  OpenGL context draws the previous one.  A snapshot also records when the
+//  sprite batch switches render targets.
+//
+//  A snapshot is meant to be reused.  Clearing a snapshot keeps the capacity
+//  of its buffers, so a snapshot stops allocating after the first few frames.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/renderer/CURenderSnapshot.h>
+#include <cugl/renderer/CUTexture.h>
+#include <cugl/renderer/CURenderTarget.h>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Disposes all of the resources used by this snapshot.
+ *
+ * Unlike {@link clear}, this method releases the capacity of the buffers.
+ */
+void RenderSnapshot::dispose() {
+    _vertices.clear();
+    _vertices.shrink_to_fit();
+    _indices.clear();
+    _indices.shrink_to_fit();
+    _commands.clear();
+    _commands.shrink_to_fit();
+}
+
+/**
+ * Initializes an empty snapshot with the given vertex capacity.
+ *
+ * The index capacity will be 3 times the vertex capacity. The buffers
+ * still grow if a frame needs more than this.
+ *
+ * @param capacity  The number of vertices to reserve
+ *
+ * @return true if initialization was successful.
+ */
+bool RenderSnapshot::init(unsigned int capacity) {
+    _vertices.reserve(capacity);
+    _indices.reserve(3*capacity);
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Removes every command from this snapshot, keeping the capacity.
+ *
+ * This releases the texture references of the commands, so it should be
+ * called on the thread that owns the OpenGL context.
+ */
+void RenderSnapshot::clear() {
+    _vertices.clear();
+    _indices.clear();
+    _commands.clear();
+}
+
+/**
+ * Appends a mesh to this snapshot with the given pipeline state.
+ *
+ * The indices are relative to the given vertices, and are shifted to the
+ * vertex array of the snapshot.  If the pipeline state is the same as that
+ * of the previous command, the mesh is merged into that command.
+ *
+ * @param vertices      The vertices of the mesh
+ * @param vsize         The number of vertices
+ * @param indices       The indices of the mesh
+ * @param isize         The number of indices
+ * @param texture       The texture of the mesh
+ * @param perspective   The perspective matrix of the mesh
+ * @param command       The drawing command (GL_TRIANGLES or GL_LINES)
+ * @param equation      The blending equation
+ * @param srcFactor     The source factor for the blend function
+ * @param dstFactor     The destination factor for the blend function
+ */
+void RenderSnapshot::append(const Vertex2* vertices, unsigned int vsize,
+                            const GLuint* indices, unsigned int isize,
+                            const std::shared_ptr<Texture>& texture, const Mat4& perspective,
+                            GLenum command, GLenum equation, GLenum srcFactor, GLenum dstFactor) {
+    GLuint base = (GLuint)_vertices.size();
+    unsigned int offset = (unsigned int)_indices.size();
+    _vertices.insert(_vertices.end(), vertices, vertices+vsize);
+    for(unsigned int ii = 0; ii < isize; ii++) {
+        _indices.push_back(base+indices[ii]);
+    }
+
+    // A full sprite batch flushes without a state change
+    if (!_commands.empty() && _commands.back().texture != nullptr) {
+        Command& last = _commands.back();
+        if (last.command == command && last.blendEquation == equation &&
+            last.srcFactor == srcFactor && last.dstFactor == dstFactor &&
+            last.texture->getBuffer() == texture->getBuffer() && last.perspective == perspective) {
+            last.count += isize;
+            return;
+        }
+    }
+
+    _commands.emplace_back();
+    Command& next = _commands.back();
+    next.texture = texture;
+    next.perspective = perspective;
+    next.command = command;
+    next.blendEquation = equation;
+    next.srcFactor = srcFactor;
+    next.dstFactor = dstFactor;
+    next.offset = offset;
+    next.count = isize;
+}
+
+/**
+ * Appends a switch of the render target to this snapshot.
+ *
+ * The commands after this one draw to the given target, in the given
+ * viewport.  A nullptr target is the display, and the viewport is then
+ * ignored.  Commands are never merged across a switch.
+ *
+ * @param target    The render target to draw to (nullptr for the display)
+ * @param viewport  The region of the target to draw to
+ */
+void RenderSnapshot::appendTarget(const std::shared_ptr<RenderTarget>& target, const Rect& viewport) {
+    _commands.emplace_back();
+    Command& next = _commands.back();
+    next.offset = (unsigned int)_indices.size();
+    next.count = 0;
+    next.target = target;
+    next.viewport = viewport;
+}
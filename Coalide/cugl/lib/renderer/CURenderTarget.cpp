@@ -0,0 +1,155 @@
+//
+//  CURenderTarget.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  This module provides an offscreen framebuffer with a color texture.  A
+//  sprite batch can draw into a render target instead of the display, and
+//  the texture can then be drawn to the display like any other texture.  This
+//  is how a game draws part of a scene at a lower resolution and scales it
+//  up afterwards.
+//
+//  The target binds and restores the previous framebuffer and viewport, so it
+//  works with platforms (like iOS) where the display is not framebuffer 0.
+//
+//  This class uses our standard shared-pointer architecture.
+//
+//  1. The constructor does not perform any initialization; it just sets all
+//     attributes to their defaults.
+//
+//  2. All initialization takes place via init methods, which can fail if an
+//     object is initialized more than once.
+//
+//  3. All allocation takes place via static constructors which return a shared
+//     pointer.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/renderer/CURenderTarget.h>
+#include <cugl/util/CUDebug.h>
+
+using namespace cugl;
+
+#pragma mark Constructors
+/**
+ * Creates a degenerate render target with no framebuffer.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a render target
+ * on the heap, use one of the static constructors instead.
+ */
+RenderTarget::RenderTarget() :
+_framebuffer(0),
+_texture(nullptr),
+_clearColor(Color4f::CLEAR),
+_previous(0),
+_bound(false) {
+    _viewport[0] = _viewport[1] = _viewport[2] = _viewport[3] = 0;
+}
+
+/**
+ * Deletes the framebuffer and the texture of this render target.
+ *
+ * You must reinitialize the render target to use it.
+ */
+void RenderTarget::dispose() {
+    if (_bound) { unbind(); }
+    if (_framebuffer) { glDeleteFramebuffers(1,&_framebuffer); _framebuffer = 0; }
+    _texture = nullptr;
+    _clearColor = Color4f::CLEAR;
+}
+
+/**
+ * Initializes a render target with the given dimensions.
+ *
+ * The texture is an RGBA texture with linear filtering, so that it can
+ * be scaled up smoothly.
+ *
+ * @param width     The target width in pixels
+ * @param height    The target height in pixels
+ *
+ * @return true if initialization was successful.
+ */
+bool RenderTarget::init(int width, int height) {
+    if (_framebuffer) {
+        CUAssertLog(false, "Render target is already initialized");
+        return false; // In case asserts are off.
+    }
+    
+    _texture = Texture::allocWithData(nullptr, width, height);
+    if (_texture == nullptr) {
+        return false;
+    }
+    _texture->setMinFilter(GL_LINEAR);
+    _texture->setName("<render target>");
+    
+    GLint previous;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _texture->getBuffer(), 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        CULogError("Render target %dx%d is incomplete (status 0x%x)", width, height, status);
+        dispose();
+        return false;
+    }
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Binding
+/**
+ * Binds this target and clears it, drawing to the given region.
+ *
+ * The viewport is set to the region (in pixels), so the perspective of
+ * the drawing is scaled to fit it.  The previous framebuffer and viewport
+ * are restored by {@link unbind}.
+ *
+ * @param viewport  The region of the texture to draw to
+ */
+void RenderTarget::bind(const Rect& viewport) {
+    CUAssertLog(_framebuffer, "Attempt to bind an uninitialized render target");
+    if (!_bound) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_previous);
+        glGetIntegerv(GL_VIEWPORT, _viewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+        _bound = true;
+    }
+    glViewport((GLint)viewport.origin.x, (GLint)viewport.origin.y,
+               (GLsizei)viewport.size.width, (GLsizei)viewport.size.height);
+    glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+/**
+ * Restores the framebuffer and viewport active before this target was bound.
+ */
+void RenderTarget::unbind() {
+    if (!_bound) {
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, _previous);
+    glViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+    _bound = false;
+}
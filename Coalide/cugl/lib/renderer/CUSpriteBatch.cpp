@@ -9,9 +9,12 @@
 #include <cugl/renderer/CUSpriteBatch.h>
 #include <cugl/renderer/CUSpriteShader.h>
 #include <cugl/renderer/CUTexture.h>
+#include <cugl/renderer/CURenderSnapshot.h>
+#include <cugl/renderer/CURenderTarget.h>
 #include <cugl/math/CUAffine2.h>
 #include <cugl/math/CUPoly2.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUFrameRecorder.h>
 #include <SDL/SDL_image.h>
 
 using namespace cugl;
@@ -75,6 +78,11 @@ void SpriteBatch::dispose() {
     if (_vertBuffer) { glDeleteBuffers(1,&_vertBuffer); _vertBuffer = 0; }
     if (_shader != nullptr) { _shader = nullptr; }
     if (_texture != nullptr) { _texture = nullptr; }
+    _snapshot = nullptr;
+    if (_target != nullptr) {
+        _target->unbind();
+        _target = nullptr;
+    }
     
     _capacity = 0;
     _vertMax  = 0;
@@ -232,12 +240,12 @@ void SpriteBatch::setTexture(const std::shared_ptr<Texture>& texture) {
     if (texture == nullptr) {
         if (_texture != nullptr && _texture->getBuffer() != getBlankTexture()->getBuffer()) {
             if (_active) { flush(); }
-            _shader->setTexture(getBlankTexture());
+            if (_snapshot == nullptr) { _shader->setTexture(getBlankTexture()); }
             _texture = getBlankTexture();
         }
     } else if (_texture->getBuffer() != texture->getBuffer()) {  // Both must be not nullptr
         if (_active) { flush(); }
-        _shader->setTexture(texture);
+        if (_snapshot == nullptr) { _shader->setTexture(texture); }
         _texture = texture;
     }
 }
@@ -274,7 +282,7 @@ const std::shared_ptr<Texture>& SpriteBatch::getBlankTexture() {
 void SpriteBatch::setPerspective(const Mat4& perspective) {
     if (_active && _perspective != perspective) {
         flush();
-        _shader->setPerspective(perspective);
+        if (_snapshot == nullptr) { _shader->setPerspective(perspective); }
     }
     _perspective = perspective;
 }
@@ -299,7 +307,7 @@ void SpriteBatch::setPerspective(const Mat4& perspective) {
 void SpriteBatch::setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
     if (_active && (_srcFactor != srcFactor || _dstFactor != dstFactor)) {
         flush();
-        glBlendFunc(srcFactor, dstFactor);
+        if (_snapshot == nullptr) { glBlendFunc(srcFactor, dstFactor); }
     }
     
     _srcFactor = srcFactor;
@@ -323,7 +331,7 @@ void SpriteBatch::setBlendFunc(GLenum srcFactor, GLenum dstFactor) {
 void SpriteBatch::setBlendEquation(GLenum equation) {
     if (_active && _blendEquation != equation) {
         flush();
-        glBlendEquation(equation);
+        if (_snapshot == nullptr) { glBlendEquation(equation); }
     }
     
     _blendEquation = equation;
@@ -344,6 +352,54 @@ void SpriteBatch::setCommand(GLenum command) {
     _command = command;
 }
 
+/**
+ * Sets the render target to draw to, using the whole target.
+ *
+ * See {@link setRenderTarget(const std::shared_ptr<RenderTarget>&, const Rect&)}.
+ *
+ * @param target    The render target to draw to (nullptr for the display)
+ */
+void SpriteBatch::setRenderTarget(const std::shared_ptr<RenderTarget>& target) {
+    Rect viewport = Rect::ZERO;
+    if (target != nullptr) {
+        viewport.size.set((float)target->getWidth(), (float)target->getHeight());
+    }
+    setRenderTarget(target, viewport);
+}
+
+/**
+ * Sets the render target to draw to, using the given region.
+ *
+ * The target is bound (and cleared) immediately, and the region becomes
+ * the viewport, so the perspective matrix is scaled to fit it.  A nullptr
+ * target returns to drawing on the display, with the original viewport.
+ * When recording, the switch is recorded to the snapshot instead, and it
+ * takes place when the snapshot is replayed.
+ *
+ * You should return to the display before the end of the frame (or the
+ * end of the recording).  Changing this value will cause the sprite batch
+ * to flush.
+ *
+ * @param target    The render target to draw to (nullptr for the display)
+ * @param viewport  The region of the target to draw to (in pixels)
+ */
+void SpriteBatch::setRenderTarget(const std::shared_ptr<RenderTarget>& target, const Rect& viewport) {
+    if (_active) {
+        flush();
+    }
+    if (_snapshot != nullptr) {
+        _snapshot->appendTarget(target, viewport);
+    } else {
+        if (_target != nullptr && _target != target) {
+            _target->unbind();
+        }
+        if (target != nullptr) {
+            target->bind(viewport);
+        }
+    }
+    _target = target;
+}
+
 
 
 #pragma mark -
@@ -358,6 +414,11 @@ void SpriteBatch::setCommand(GLenum command) {
  * Calling this method will reset the vertex and OpenGL call counters to 0.
  */
 void SpriteBatch::begin() {
+    if (_snapshot != nullptr) {
+        _active = true;
+        return;
+    }
+    
     glDisable(GL_CULL_FACE);
     glDepthMask(false);
     glEnable(GL_BLEND);
@@ -381,7 +442,9 @@ void SpriteBatch::begin() {
  */
 void SpriteBatch::end() {
     flush();
-    _shader->unbind();
+    if (_snapshot == nullptr) {
+        _shader->unbind();
+    }
     _active = false;
 
 }
@@ -400,6 +463,15 @@ void SpriteBatch::flush() {
         return;
     }
     
+    if (_snapshot != nullptr) {
+        _snapshot->append(_vertData, _vertSize, _indxData, _indxSize, _texture, _perspective,
+                          _command, _blendEquation, _srcFactor, _dstFactor);
+        _vertTotal += _indxSize;
+        _callTotal++;
+        _vertSize = _indxSize = 0;
+        return;
+    }
+    
     glBindVertexArray (_vertArray);
     glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
     glBufferData( GL_ARRAY_BUFFER, _vertSize * sizeof(Vertex2), _vertData, GL_DYNAMIC_DRAW );
@@ -412,10 +484,108 @@ void SpriteBatch::flush() {
     // Increment the counters
     _vertTotal += _indxSize;
     _callTotal++;
+    FrameRecorder::countFlush(_indxSize);
     
     _vertSize = _indxSize = 0;
 }
 
+/**
+ * Sets the snapshot to record to instead of drawing.
+ *
+ * While a snapshot is set, this sprite batch makes no OpenGL calls. Every
+ * flush appends the mesh and the pipeline state to the snapshot instead,
+ * so the drawing pass can take place on a thread without the OpenGL
+ * context.  Setting the snapshot to nullptr returns to drawing.
+ *
+ * The snapshot is replayed with {@link replay} on the thread that owns
+ * the OpenGL context.  Recording and replaying may happen at the same
+ * time, provided that they use different snapshots.  This value may NOT
+ * be changed during a drawing pass.
+ *
+ * @param snapshot  The snapshot to record to (or nullptr to draw)
+ */
+void SpriteBatch::setSnapshot(const std::shared_ptr<RenderSnapshot>& snapshot) {
+    CUAssertLog(!_active, "Attempt to reassign snapshot while drawing is active");
+    if (_snapshot != nullptr && snapshot == nullptr) {
+        // The shader missed the state changes made while recording
+        _shader->setTexture(_texture);
+        _shader->setPerspective(_perspective);
+    }
+    _snapshot = snapshot;
+}
+
+/**
+ * Draws the given snapshot and then clears it.
+ *
+ * The whole snapshot is uploaded to the vertex buffers at once, and each
+ * command is a single draw call.  This method only uses the shader and
+ * the buffers of this sprite batch, and none of its drawing state, so it
+ * is safe to replay one snapshot while recording another.  It must be
+ * called on the thread that owns the OpenGL context, and not during a
+ * drawing pass of that thread.
+ *
+ * @param snapshot  The snapshot to draw
+ */
+void SpriteBatch::replay(const std::shared_ptr<RenderSnapshot>& snapshot) {
+    CUAssertLog(snapshot != _snapshot, "Attempt to replay the snapshot being recorded");
+    if (snapshot == nullptr || snapshot->isEmpty()) {
+        return;
+    }
+    
+    const std::vector<RenderSnapshot::Command>& commands = snapshot->getCommands();
+    glDisable(GL_CULL_FACE);
+    glDepthMask(false);
+    glEnable(GL_BLEND);
+    _shader->bind();
+    _shader->attach(_vertArray, _vertBuffer);
+    
+    glBindBuffer( GL_ARRAY_BUFFER, _vertBuffer );
+    glBufferData( GL_ARRAY_BUFFER, snapshot->getVertices().size() * sizeof(Vertex2),
+                  snapshot->getVertices().data(), GL_DYNAMIC_DRAW );
+    glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, _indxBuffer );
+    glBufferData( GL_ELEMENT_ARRAY_BUFFER, snapshot->getIndices().size() * sizeof(GLuint),
+                  snapshot->getIndices().data(), GL_DYNAMIC_DRAW );
+    
+    const RenderSnapshot::Command* state = nullptr;
+    RenderTarget* target = nullptr;
+    for(auto it = commands.begin(); it != commands.end(); ++it) {
+        if (it->texture == nullptr) {
+            // A switch of the render target
+            if (target != nullptr && target != it->target.get()) {
+                target->unbind();
+            }
+            target = it->target.get();
+            if (target != nullptr) {
+                target->bind(it->viewport);
+            }
+            continue;
+        }
+        
+        if (state == nullptr || it->blendEquation != state->blendEquation) {
+            glBlendEquation(it->blendEquation);
+        }
+        if (state == nullptr || it->srcFactor != state->srcFactor || it->dstFactor != state->dstFactor) {
+            glBlendFunc(it->srcFactor, it->dstFactor);
+        }
+        if (state == nullptr || it->perspective != state->perspective) {
+            _shader->setPerspective(it->perspective);
+        }
+        if (state == nullptr || it->texture->getBuffer() != state->texture->getBuffer()) {
+            _shader->setTexture(it->texture);
+        }
+        state = &(*it);
+        
+        glDrawElements(it->command, it->count, GL_UNSIGNED_INT, (const GLvoid*)(it->offset*sizeof(GLuint)));
+        FrameRecorder::countFlush(it->count);
+    }
+    
+    if (target != nullptr) {
+        target->unbind();
+    }
+    _shader->unbind();
+    snapshot->clear();
+}
+
 #pragma mark -
 #pragma mark Solid Shapes
 
@@ -234,6 +234,32 @@ void Texture::buildMipMaps() {
     _hasMipmaps = true;
 }
 
+/**
+ * Returns the approximate GPU memory used by this texture in bytes.
+ *
+ * The estimate is the size of the pixel data, plus a third for mipmaps.
+ * A subtexture shares the memory of its parent, so this method returns
+ * 0 for a subtexture.  It also returns 0 for an unallocated texture.
+ *
+ * @return the approximate GPU memory used by this texture in bytes.
+ */
+size_t Texture::getMemoryUsage() const {
+    if (_parent != nullptr || !_buffer) {
+        return 0;
+    }
+    size_t pixel = 4;
+    switch (_pixelFormat) {
+        case PixelFormat::RED:
+        case PixelFormat::ALPHA:
+            pixel = 1;
+            break;
+        default:
+            break;
+    }
+    size_t bytes = pixel*_width*_height;
+    return (_hasMipmaps ? bytes+bytes/3 : bytes);
+}
+
 /**
  * Sets the min filter of this texture.
  *
@@ -9,8 +9,11 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string>
+#include <cstring>
 #include <sstream>
+#include <set>
 #include <cugl/cugl.h>
+#include <Box2D/Collision/b2BroadPhase.h>
 
 #include "TCUMathTest.h"
 #include "TCU2DTest.h"
@@ -165,9 +168,220 @@ void testThread() {
     pool->addTask([=] { CULog("Thread 2"); });
     pool->addTask([=] { CULog("Thread 3"); });
     pool->addTask([=] { CULog("Thread 4"); });
+    
+    std::future<int> answer = pool->submit([=] { return 42; }, cugl::ThreadPool::Priority::LOW);
+    CUAssertLog(answer.get() == 42, "Future returned the wrong value");
+    
+    std::vector<int> squares(1000);
+    pool->parallelFor(0, squares.size(), 64, [&](size_t start, size_t stop) {
+        for(size_t ii = start; ii < stop; ii++) {
+            squares[ii] = (int)(ii*ii);
+        }
+    });
+    CUAssertLog(squares[999] == 998001, "Parallel loop did not complete");
+    
+    std::shared_ptr<cugl::WaitGroup> group = cugl::WaitGroup::alloc();
+    std::atomic<int> count(0);
+    for(int ii = 0; ii < 16; ii++) {
+        pool->addTask([&] { count++; }, group, cugl::ThreadPool::Priority::HIGH);
+    }
+    pool->wait(group);
+    CUAssertLog(count == 16, "Wait group returned early");
+    
+    // Every worker waits on low priority subtasks
+    std::shared_ptr<cugl::WaitGroup> outer = cugl::WaitGroup::alloc();
+    count = 0;
+    for(int ii = 0; ii < 2; ii++) {
+        pool->addTask([&,pool] {
+            std::shared_ptr<cugl::WaitGroup> inner = cugl::WaitGroup::alloc();
+            for(int jj = 0; jj < 4; jj++) {
+                pool->addTask([&] { count++; }, inner, cugl::ThreadPool::Priority::LOW);
+            }
+            pool->wait(inner);
+        }, outer, cugl::ThreadPool::Priority::HIGH);
+    }
+    pool->wait(outer);
+    CUAssertLog(count == 8, "Waiting workers did not run low priority subtasks");
+    
+    // Stopping the pool completes the groups of discarded tasks
+    for(int ii = 0; ii < 16; ii++) {
+        pool->addTask([&] { count++; }, group, cugl::ThreadPool::Priority::LOW);
+    }
+    pool->stop();
+    CUAssertLog(group->isDone(), "Stopping the pool left a wait group pending");
     pool = nullptr;
 }
 
+/** Collects broadphase pairs as an ordered set of user data */
+class PairSet {
+public:
+    std::set<std::pair<void*,void*>> pairs;
+    void AddPair(void* a, void* b) {
+        pairs.insert(a < b ? std::make_pair(a,b) : std::make_pair(b,a));
+    }
+};
+
+void testBroadphase() {
+    const int count = 2000;
+    const float width = 60.0f;
+    b2AABB bounds;
+    bounds.lowerBound.Set(0,0);
+    bounds.upperBound.Set(width,width);
+    
+    b2BroadPhase tree;
+    b2BroadPhase grid;
+    grid.UseUniformGrid(bounds,1.0f);
+    
+    // Tile-sized bodies bouncing around a bounded level
+    std::vector<b2Vec2> position(count);
+    std::vector<b2Vec2> velocity(count);
+    std::vector<int32> treeIds(count);
+    std::vector<int32> gridIds(count);
+    auto box = [&](int ii) {
+        b2AABB aabb;
+        aabb.lowerBound = position[ii]-b2Vec2(0.5f,0.5f);
+        aabb.upperBound = position[ii]+b2Vec2(0.5f,0.5f);
+        return aabb;
+    };
+    for(int ii = 0; ii < count; ii++) {
+        position[ii].Set(width*(rand() % 1000)/1000.0f, width*(rand() % 1000)/1000.0f);
+        velocity[ii].Set((rand() % 200-100)/10.0f, (rand() % 200-100)/10.0f);
+        treeIds[ii] = tree.CreateProxy(box(ii),&position[ii]);
+        gridIds[ii] = grid.CreateProxy(box(ii),&position[ii]);
+    }
+    
+    Uint64 treeTicks = 0;
+    Uint64 gridTicks = 0;
+    for(int step = 0; step < 300; step++) {
+        for(int ii = 0; ii < count; ii++) {
+            position[ii] += (1/60.0f)*velocity[ii];
+            if (position[ii].x < -2 || position[ii].x > width+2) { velocity[ii].x = -velocity[ii].x; }
+            if (position[ii].y < -2 || position[ii].y > width+2) { velocity[ii].y = -velocity[ii].y; }
+        }
+        
+        PairSet treePairs;
+        PairSet gridPairs;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for(int ii = 0; ii < count; ii++) {
+            tree.MoveProxy(treeIds[ii],box(ii),(1/60.0f)*velocity[ii]);
+        }
+        tree.UpdatePairs(&treePairs);
+        Uint64 middle = SDL_GetPerformanceCounter();
+        for(int ii = 0; ii < count; ii++) {
+            grid.MoveProxy(gridIds[ii],box(ii),(1/60.0f)*velocity[ii]);
+        }
+        grid.UpdatePairs(&gridPairs);
+        Uint64 end = SDL_GetPerformanceCounter();
+        treeTicks += middle-start;
+        gridTicks += end-middle;
+        CUAssertLog(treePairs.pairs == gridPairs.pairs, "Grid pairs differ from tree at step %d", step);
+    }
+    
+    double scale = 1000.0/(300*SDL_GetPerformanceFrequency());
+    CULog("Broadphase step: tree %.3f ms, grid %.3f ms", treeTicks*scale, gridTicks*scale);
+}
+
+void testRecorder() {
+    std::shared_ptr<cugl::FrameRecorder> recorder = cugl::FrameRecorder::alloc(4,0);
+    recorder->activate();
+    for(int ii = 0; ii < 6; ii++) {
+        recorder->beginFrame();
+        {
+            cugl::FrameRecorder::Scope outer(cugl::FrameRecorder::SORT);
+            cugl::FrameRecorder::Scope inner(cugl::FrameRecorder::SORT);
+            SDL_Delay(1);
+        }
+        cugl::FrameRecorder::countFlush(6);
+        recorder->endFrame();
+    }
+    CUAssertLog(recorder->size() == 4, "Recorder kept the wrong number of frames");
+    CUAssertLog(recorder->getFrame(0).index == 2, "Recorder lost the oldest frame");
+    CUAssertLog(recorder->getFrame(3).flushes == 1, "Recorder miscounted the flushes");
+    CUAssertLog(recorder->getFrame(3).vertices == 6, "Recorder miscounted the vertices");
+    CUAssertLog(recorder->getFrame(3).stages[cugl::FrameRecorder::SORT] <= recorder->getFrame(3).total,
+                "Nested scopes were counted twice");
+    recorder = nullptr;
+    CUAssertLog(cugl::FrameRecorder::get() == nullptr, "Recorder is still active after disposal");
+}
+
+void testSnapshot() {
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::RenderSnapshot> snapshot = cugl::RenderSnapshot::alloc(64);
+    batch->setSnapshot(snapshot);
+    batch->begin();
+    batch->fill(cugl::Rect(0,0,10,10));
+    batch->flush();
+    batch->fill(cugl::Rect(20,0,10,10));
+    batch->setBlendFunc(GL_ONE, GL_ONE);
+    batch->fill(cugl::Rect(40,0,10,10));
+    batch->end();
+    batch->setSnapshot(nullptr);
+    
+    CUAssertLog(snapshot->getCommands().size() == 2, "Snapshot did not merge flushes with the same state");
+    CUAssertLog(snapshot->getCommands()[0].count == 12, "Snapshot lost the indices of a merged flush");
+    CUAssertLog(snapshot->getIndices()[6] == 4, "Snapshot did not shift the indices of a flush");
+    batch->replay(snapshot);
+    CUAssertLog(snapshot->isEmpty(), "Snapshot was not cleared by the replay");
+    
+    // Render target switches are recorded too
+    std::shared_ptr<cugl::RenderTarget> target = cugl::RenderTarget::alloc(64,32);
+    CUAssertLog(target != nullptr && target->getWidth() == 64, "Render target was not allocated");
+    batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    batch->setSnapshot(snapshot);
+    batch->begin();
+    batch->fill(cugl::Rect(0,0,10,10));
+    batch->setRenderTarget(target, cugl::Rect(0,0,32,16));
+    batch->fill(cugl::Rect(20,0,10,10));
+    batch->setRenderTarget(nullptr);
+    batch->end();
+    batch->setSnapshot(nullptr);
+    
+    CUAssertLog(snapshot->getCommands().size() == 4, "Snapshot merged draws across a render target switch");
+    CUAssertLog(snapshot->getCommands()[1].target == target, "Snapshot lost a render target switch");
+    batch->replay(snapshot);
+    CUAssertLog(!target->isBound(), "Replay did not return to the display");
+}
+
+void testDirty() {
+    std::shared_ptr<cugl::SpriteBatch> batch = cugl::SpriteBatch::alloc();
+    std::shared_ptr<cugl::Scene> scene = cugl::Scene::alloc(64,64);
+    std::shared_ptr<cugl::Node> node = cugl::Node::alloc();
+    scene->addChild(node);
+    CUAssertLog(scene->isDirty(), "Adding a node did not dirty the scene");
+    scene->render(batch);
+    CUAssertLog(!scene->isDirty(), "Rendering did not clean the scene");
+    node->setPosition(node->getPosition());
+    node->setVisible(true);
+    CUAssertLog(!scene->isDirty(), "An unchanged node dirtied the scene");
+    node->setAngle(1.0f);
+    CUAssertLog(scene->isDirty(), "Rotating a node did not dirty the scene");
+    scene->render(batch);
+    scene->getCamera()->translate(cugl::Vec2(1,0));
+    scene->getCamera()->update();
+    CUAssertLog(scene->isDirty(), "Moving the camera did not dirty the scene");
+}
+
+cugl::FrameRecorder::Frame makeFrame(Uint64 index, Uint32 update, Uint32 render, Uint32 swap) {
+    cugl::FrameRecorder::Frame frame;
+    std::memset(&frame,0,sizeof(frame));
+    frame.index = index;
+    frame.stages[cugl::FrameRecorder::UPDATE] = update;
+    frame.stages[cugl::FrameRecorder::RENDER] = render;
+    frame.stages[cugl::FrameRecorder::SWAP]   = swap;
+    frame.total = update+render+swap;
+    return frame;
+}
+
+void testGpuBound() {
+    // Both frames miss a refresh at 60 FPS, and both swaps are long
+    float budget = 1000000.0f/60;
+    cugl::FrameRecorder::Frame gpu = makeFrame(0, 3000, 2000, 28333);
+    cugl::FrameRecorder::Frame cpu = makeFrame(1, 14000, 1500, 17833);
+    cugl::FrameRecorder::Frame fast = makeFrame(2, 3000, 2000, 11000);
+    CUAssertLog(cugl::FrameRecorder::isGpuBound(gpu, budget), "A slow swap was not GPU bound");
+    CUAssertLog(!cugl::FrameRecorder::isGpuBound(cpu, budget), "The vsync wait after a slow update was GPU bound");
+    CUAssertLog(!cugl::FrameRecorder::isGpuBound(fast, budget), "A frame that made the refresh was GPU bound");
+}
 
 int main() {
     cugl::Application app;
@@ -184,6 +398,11 @@ int main() {
     //testBinary();
     //testFree();
     testThread();
+    testBroadphase();
+    testRecorder();
+    testSnapshot();
+    testDirty();
+    testGpuBound();
     
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
     CULog("Little endian");
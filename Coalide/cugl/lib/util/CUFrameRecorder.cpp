@@ -0,0 +1,262 @@
+//
+//  CUFrameRecorder.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a flight recorder of frame timings.  The recorder keeps the
+//  subsystem timings of the last few seconds of animation frames in a fixed
+//  ring buffer.  When a frame runs over budget, the recorder writes the
+//  window of frames leading up to it to the save directory.  This gives us
+//  hitch data from player devices, instead of just a moving average.
+//
+//  The recorder is always on, so it is designed to be cheap.  The buffer is
+//  allocated once, and a timed scope is two clock reads.  Scopes are nesting
+//  aware, so a recursive method (like a scene graph sort) is timed only once.
+//
+//  CUGL zlib License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: Team FireCube
+//  Version: 10/18/26
+//
+#include <cugl/util/CUFrameRecorder.h>
+#include <cugl/util/CUDebug.h>
+#include <cugl/util/CUStrings.h>
+#include <cugl/io/CUTextWriter.h>
+#include <cstring>
+
+/** The number of snapshot files to cycle through by default */
+#define DEFAULT_SNAPSHOTS   8
+/** The frame time (in periods) that missed a display refresh */
+#define GPU_BOUND_MISS      1.25f
+/** The part of a frame period spent drawing and swapping when GPU bound */
+#define GPU_BOUND_SHARE     0.5f
+/** The largest part of a frame period spent updating when GPU bound */
+#define GPU_BOUND_UPDATE    0.5f
+
+using namespace cugl;
+
+/** The active recorder of this thread */
+thread_local FrameRecorder* FrameRecorder::_active = nullptr;
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates a recorder with no frames.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a recorder on
+ * the heap, use one of the static constructors instead.
+ */
+FrameRecorder::FrameRecorder() :
+_head(0),
+_count(0),
+_budget(0),
+_maxSnapshots(DEFAULT_SNAPSHOTS),
+_snapshots(0),
+_hitches(0),
+_cooldown(0) {
+    _writing = WaitGroup::alloc();
+    std::memset(&_current,0,sizeof(Frame));
+    std::memset(_depth,0,sizeof(_depth));
+}
+
+/**
+ * Disposes all of the resources used by this recorder.
+ *
+ * If this is the active recorder, it is deactivated.  If a snapshot is
+ * being written, this method blocks until it is done.
+ */
+void FrameRecorder::dispose() {
+    if (_active == this) {
+        _active = nullptr;
+    }
+    if (_writer != nullptr) {
+        _writing->wait();
+        _writer = nullptr;
+    }
+    _frames.clear();
+    _snapshot.clear();
+    _buffer.clear();
+    _head = 0;
+    _count = 0;
+    _budget = 0;
+    _snapshots = 0;
+    _hitches = 0;
+    _cooldown = 0;
+    std::memset(&_current,0,sizeof(Frame));
+    std::memset(_depth,0,sizeof(_depth));
+}
+
+/**
+ * Initializes a recorder with the given window and budget.
+ *
+ * A budget of 0 never writes a snapshot.
+ *
+ * @param window    The number of frames to keep
+ * @param budget    The longest frame (in microseconds) that is not a hitch
+ *
+ * @return true if the recorder is initialized properly, false otherwise.
+ */
+bool FrameRecorder::init(Uint32 window, Uint32 budget) {
+    CUAssertLog(window > 0, "A frame recorder must keep at least one frame");
+    Frame empty;
+    std::memset(&empty,0,sizeof(Frame));
+    _frames.assign(window,empty);
+    _snapshot.assign(window,empty);
+    _budget = budget;
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Starts recording a new frame.
+ */
+void FrameRecorder::beginFrame() {
+    std::memset(&_current,0,sizeof(Frame));
+    _current.index = _count;
+    _start.mark();
+}
+
+/**
+ * Finishes the current frame, and adds it to the ring buffer.
+ *
+ * If the frame is over budget, this may write a snapshot.
+ */
+void FrameRecorder::endFrame() {
+    _current.total = (Uint32)Timestamp::ellapsedMicros(_start,Timestamp());
+    _frames[_head] = _current;
+    _head = (_head+1) % _frames.size();
+    _count++;
+
+    if (_budget > 0 && _current.total > _budget) {
+        _hitches++;
+        // Never touch the snapshot while the writer is still using it
+        if (_maxSnapshots > 0 && _count > _cooldown && _writing->pending() == 0) {
+            size_t frames = size();
+            for(size_t ii = 0; ii < frames; ii++) {
+                _snapshot[ii] = getFrame(ii);
+            }
+            
+            Uint32 budget = _budget;
+            Uint64 hitch  = _current.index;
+            Uint32 file   = _snapshots % _maxSnapshots;
+            if (_writer == nullptr) {
+                _writer = ThreadPool::alloc(1);
+            }
+            if (_writer != nullptr) {
+                _writer->addTask([=] { writeSnapshot(frames,budget,hitch,file); },_writing);
+            } else {
+                writeSnapshot(frames,budget,hitch,file);
+            }
+            _snapshots++;
+            _cooldown = _count+_frames.size();
+        }
+    }
+}
+
+/**
+ * Returns a frame in the ring buffer.
+ *
+ * Frame 0 is the oldest frame in the buffer.
+ *
+ * @param index The frame position
+ *
+ * @return a frame in the ring buffer.
+ */
+const FrameRecorder::Frame& FrameRecorder::getFrame(size_t index) const {
+    CUAssertLog(index < size(), "Frame index %zu is out of bounds", index);
+    size_t oldest = (_count < _frames.size() ? 0 : _head);
+    return _frames[(oldest+index) % _frames.size()];
+}
+
+/**
+ * Writes the snapshot frames to the given snapshot file.
+ *
+ * This method is called by the writer thread.
+ *
+ * @param frames    The number of frames in the snapshot
+ * @param budget    The budget when the hitch occurred
+ * @param hitch     The frame that was over budget
+ * @param file      The number of the snapshot file
+ */
+void FrameRecorder::writeSnapshot(size_t frames, Uint32 budget, Uint64 hitch, Uint32 file) {
+    static const char* header = "frame,total,update,physics,sort,render,swap,sleep,flushes,vertices";
+
+    _buffer.clear();
+    _buffer.append("# budget ");
+    _buffer.append(cugl::to_string(budget));
+    _buffer.append(" us, hitch at frame ");
+    _buffer.append(cugl::to_string(hitch));
+    _buffer.append("\n");
+    _buffer.append(header);
+    _buffer.append("\n");
+    for(size_t ii = 0; ii < frames; ii++) {
+        const Frame& frame = _snapshot[ii];
+        _buffer.append(cugl::to_string(frame.index));
+        _buffer.append(",");
+        _buffer.append(cugl::to_string(frame.total));
+        for(int jj = 0; jj < FRAME_RECORDER_STAGES; jj++) {
+            _buffer.append(",");
+            _buffer.append(cugl::to_string(frame.stages[jj]));
+        }
+        _buffer.append(",");
+        _buffer.append(cugl::to_string(frame.flushes));
+        _buffer.append(",");
+        _buffer.append(cugl::to_string(frame.vertices));
+        _buffer.append("\n");
+    }
+
+    std::string path = "hitch_"+cugl::to_string(file)+".csv";
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(path);
+    if (writer == nullptr) {
+        CULogError("Could not write hitch snapshot %s",path.c_str());
+        return;
+    }
+    writer->write(_buffer);
+    writer->close();
+}
+
+
+#pragma mark -
+#pragma mark Analysis
+/**
+ * Returns true if the given frame is GPU bound.
+ *
+ * OpenGL ES has no portable GPU timer queries, so this is a heuristic.
+ * A frame is GPU bound when it misses a display refresh, and most of the
+ * frame period is spent drawing and waiting on the buffer swap (which
+ * blocks on the GPU).  A frame with a slow update also misses a refresh,
+ * and its swap then waits on vsync as long as a GPU bound swap.  Hence a
+ * frame is only GPU bound if its update is well under the frame period.
+ *
+ * @param frame     The frame timings
+ * @param budget    The frame period in microseconds
+ *
+ * @return true if the given frame is GPU bound.
+ */
+bool FrameRecorder::isGpuBound(const Frame& frame, float budget) {
+    // A slow update misses a refresh, and the swap then waits on vsync
+    if (frame.total <= budget*GPU_BOUND_MISS || frame.stages[UPDATE] > budget*GPU_BOUND_UPDATE) {
+        return false;
+    }
+    Uint32 gpu = frame.stages[RENDER]+frame.stages[SWAP];
+    return gpu > budget*GPU_BOUND_SHARE;
+}
@@ -6,6 +6,11 @@
 //  task is specified by a void function.  There are no guarantees about thread
 //  safety; that is responsibility of the author of each task.
 //
+//  The pool is a work-stealing scheduler.  Every worker owns a set of deques
+//  (one per priority lane).  A worker pops its own work LIFO, and steals the
+//  oldest work of its siblings when it runs dry.  Tasks may be tracked with
+//  futures or wait groups, and loops can be split with parallelFor.
+//
 //  This code is largely inspired from the Cocos2d file AudioEngine.cpp, from
 //  the code for asynchronous asset loading. We generalized that class added
 //  some notable safety changes.
@@ -33,9 +38,73 @@
 //  Version: 11/29/16
 //
 #include <cugl/util/CUThreadPool.h>
+#include <chrono>
 
 using namespace cugl;
 
+/** The number of idle polls a waiting thread makes before it naps */
+#define WAIT_SPIN_LIMIT   64
+/** The number of milliseconds a waiting thread naps between polls */
+#define WAIT_NAP_MILLIS    1
+
+/**
+ * The completion of a task in a wait group.
+ *
+ * The group is marked done when the last copy of the task is destroyed.
+ * That happens after the task executes, but also when the pool discards
+ * the task without executing it.
+ */
+class WaitGroupTicket {
+public:
+    /** The wait group of the task */
+    std::shared_ptr<cugl::WaitGroup> group;
+    
+    /** Creates a ticket for the given group */
+    WaitGroupTicket(const std::shared_ptr<cugl::WaitGroup>& owner) : group(owner) {}
+    
+    /** Marks the task done in its group */
+    ~WaitGroupTicket() { group->done(); }
+};
+
+#pragma mark -
+#pragma mark Wait Group
+/**
+ * Marks a single task in this group as complete.
+ *
+ * If this is the last outstanding task, any waiting thread is woken up.
+ */
+void WaitGroup::done() {
+    if (--_count <= 0) {
+        std::unique_lock<std::mutex> lk(_mutex);
+        _condition.notify_all();
+    }
+}
+
+/**
+ * Blocks the calling thread until every task in the group is complete.
+ *
+ * This method does not help with the tasks.  If called from a worker of
+ * the pool executing these tasks, use {@link ThreadPool#wait} instead to
+ * prevent a deadlock.
+ */
+void WaitGroup::wait() {
+    std::unique_lock<std::mutex> lk(_mutex);
+    _condition.wait(lk, [this] { return isDone(); });
+}
+
+/**
+ * Blocks the calling thread until the group is complete or time expires.
+ *
+ * @param millis    The maximum number of milliseconds to wait
+ *
+ * @return true if every task in the group is complete.
+ */
+bool WaitGroup::wait(Uint32 millis) {
+    std::unique_lock<std::mutex> lk(_mutex);
+    return _condition.wait_for(lk, std::chrono::milliseconds(millis), [this] { return isDone(); });
+}
+
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -43,12 +112,14 @@ using namespace cugl;
  *
  * A disposed thread pool can be safely reinitialized. However, it is a bad
  * idea to destroy the thread pool if the pool is not yet shut down. The
- * task queue is shared by the child threads, so we cannot delete it until
- * all the threads complete.  This destructor will block unti showndown.
+ * task deques are shared by the child threads, so we cannot delete them
+ * until all the threads complete.  This method joins the workers and so
+ * will block until shutdown.
  */
 void ThreadPool::dispose() {
     stop();
-    while (!isShutdown());
+    _queues.clear();
+    _pending = 0;
 }
 
 /**
@@ -63,43 +134,153 @@ void ThreadPool::dispose() {
  * @return true if the threed pool is initialized properly, false otherwise.
  */
 bool ThreadPool::init(int threads) {
+    _stop = false;
+    _complete = 0;
+    _pending = 0;
+    _nextQueue = 0;
+    
+    // The deques must all exist before any thread can steal
+    _queues.clear();
+    for (int index = 0; index < threads; ++index) {
+        _queues.push_back(std::unique_ptr<Worker>(new Worker(this,index)));
+    }
+    
     for (int index = 0; index < threads; ++index) {
 #ifdef CU_SDL_THREADS
-        _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)this));
+        _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)_queues[index].get()));
 #else
-        _workers.emplace_back(std::thread(std::bind(&ThreadPool::threadFunc, this)));
+        _workers.emplace_back(std::thread(std::bind(&ThreadPool::threadFunc, this, index)));
 #endif
     }
     return true;
 }
 
 
+#pragma mark -
+#pragma mark Scheduling
+/**
+ * Returns the index of the worker for the calling thread.
+ *
+ * If the calling thread is not part of this pool, this returns -1.
+ *
+ * @return the index of the worker for the calling thread.
+ */
+int ThreadPool::currentWorker() const {
+    SDL_threadID current = SDL_ThreadID();
+    for (auto it = _queues.begin(); it != _queues.end(); ++it) {
+        if ((*it)->thread.load() == current) {
+            return (*it)->index;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Pushes a task on the appropriate deque and wakes up a worker.
+ *
+ * @param task      The task to schedule
+ * @param priority  The priority lane of the task
+ */
+void ThreadPool::schedule(std::function<void()>&& task, Priority priority) {
+    if (_queues.empty() || _stop) {
+        return;
+    }
+    
+    // Workers keep their own children; everyone else deals round-robin
+    int index = currentWorker();
+    if (index < 0) {
+        index = (int)(_nextQueue++ % _queues.size());
+    }
+    
+    Worker* worker = _queues[index].get();
+    {
+        std::unique_lock<std::mutex> lk(worker->mutex);
+        worker->lanes[(int)priority].push_back(std::move(task));
+    }
+    _pending++;
+    
+    std::unique_lock<std::mutex> lk(_queueMutex);
+    _taskCondition.notify_one();
+}
+
+/**
+ * Acquires the most urgent available task, if any.
+ *
+ * The worker at the given index looks at its own deque first.  If that
+ * is empty, it steals from the other workers.  Only lanes at or above
+ * the given priority are considered.
+ *
+ * @param index     The worker index (or -1 for an external thread)
+ * @param task      The task to fill in
+ * @param priority  The least urgent lane to consider
+ *
+ * @return true if a task was acquired
+ */
+bool ThreadPool::acquire(int index, std::function<void()>& task, Priority priority) {
+    if (_pending.load() <= 0) {
+        return false;
+    }
+    
+    int size = (int)_queues.size();
+    int start = (index < 0 ? 0 : index);
+    for (int lane = 0; lane <= (int)priority; lane++) {
+        // Our own work first, newest first
+        if (index >= 0) {
+            Worker* worker = _queues[index].get();
+            std::unique_lock<std::mutex> lk(worker->mutex);
+            if (!worker->lanes[lane].empty()) {
+                task = std::move(worker->lanes[lane].back());
+                worker->lanes[lane].pop_back();
+                _pending--;
+                return true;
+            }
+        }
+        
+        // Now steal, oldest first
+        for (int ii = 1; ii <= size; ii++) {
+            int victim = (start+ii) % size;
+            if (victim == index) {
+                continue;
+            }
+            Worker* worker = _queues[victim].get();
+            std::unique_lock<std::mutex> lk(worker->mutex);
+            if (!worker->lanes[lane].empty()) {
+                task = std::move(worker->lanes[lane].front());
+                worker->lanes[lane].pop_front();
+                _pending--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
 #pragma mark -
 #pragma mark Thread Execution
 
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
+ * This function pulls tasks from the task deques, stealing if necessary.
  *
- * This implementation is safe to use with std::thread.
+ * @param index The index of the worker for this thread
  */
-void ThreadPool::threadFunc() {
+void ThreadPool::threadFunc(int index) {
+    _queues[index]->thread = SDL_ThreadID();
     while (!_stop) {
         std::function<void()> task = nullptr;
-        {   // Lock for save queue access
+        if (!acquire(index, task)) {
+            // Lock for safe sleeping
             std::unique_lock<std::mutex> lk(_queueMutex);
             if (_stop) {
                 break;
             }
-            // Pull the next task off the queue
-            if (!_taskQueue.empty()) {
-                task = std::move(_taskQueue.front());
-                _taskQueue.pop();
-            } else {
+            // Recheck under the lock so that we never miss a wakeup
+            if (_pending.load() <= 0) {
                 _taskCondition.wait(lk);
-                continue;
             }
+            continue;
         }
         // Perform the current task
         task();
@@ -110,38 +291,18 @@ void ThreadPool::threadFunc() {
 /**
  * The body function of a single thread.
  *
- * This function pulls tasks from the task queue.
+ * This function pulls tasks from the task deques, stealing if necessary.
  *
  * This static implementation uses the SDL thread API.  It should be used
  * on Android and Windows, which have special thread requirements.
  */
 int ThreadPool::sdlThreadFunc(void* ptr) {
-    ThreadPool* self = (ThreadPool*)ptr;
-    while (!self->_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(self->_queueMutex);
-            if (self->_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!self->_taskQueue.empty()) {
-                task = std::move(self->_taskQueue.front());
-                self->_taskQueue.pop();
-            } else {
-                self->_taskCondition.wait(lk);
-                continue;
-            }
-        }
-        // Perform the current task
-        task();
-    }
-    self->_complete++;
+    Worker* worker = (Worker*)ptr;
+    worker->pool->threadFunc(worker->index);
     return 0;
 }
 
 
-
 #pragma mark -
 #pragma mark Task Management
 /**
@@ -153,19 +314,135 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
  * worker.
  *
  * @param  task     the task function to add to the thread pool
+ * @param  priority the priority lane for this task
  */
-void ThreadPool::addTask(const std::function<void()> &task){
-    std::unique_lock<std::mutex> lk(_queueMutex);
-    _taskQueue.emplace(task);
-    _taskCondition.notify_one();
+void ThreadPool::addTask(const std::function<void()> &task, Priority priority) {
+    std::function<void()> copy = task;
+    schedule(std::move(copy), priority);
+}
+
+/**
+ * Adds a task to the thread pool as part of the given wait group.
+ *
+ * The task is added to the group before it is scheduled, and the group
+ * is notified once the task has executed (or has been discarded by
+ * {@link stop}).
+ *
+ * @param  task     the task function to add to the thread pool
+ * @param  group    the wait group to track this task
+ * @param  priority the priority lane for this task
+ */
+void ThreadPool::addTask(const std::function<void()> &task, const std::shared_ptr<WaitGroup>& group,
+                         Priority priority) {
+    group->add();
+    std::shared_ptr<WaitGroupTicket> ticket = std::make_shared<WaitGroupTicket>(group);
+    schedule([task,ticket] { task(); }, priority);
+}
+
+/**
+ * Blocks until every task in the wait group is complete.
+ *
+ * Unlike {@link WaitGroup#wait}, the calling thread helps out while it
+ * waits, executing any pending task (most urgent lane first).  The tasks
+ * of the group may be in any lane, so the caller never skips a lane.
+ * This makes it safe to wait from inside a task of this pool.
+ *
+ * @param  group    the wait group to wait on
+ */
+void ThreadPool::wait(const std::shared_ptr<WaitGroup>& group) {
+    int index = currentWorker();
+    int idle = 0;
+    while (!group->isDone() && !_stop) {
+        std::function<void()> task = nullptr;
+        if (acquire(index, task, Priority::LOW)) {
+            task();
+            idle = 0;
+        } else if (idle < WAIT_SPIN_LIMIT) {
+            // The remaining tasks are in flight on other workers
+            idle++;
+            std::this_thread::yield();
+        } else {
+            group->wait(WAIT_NAP_MILLIS);
+        }
+    }
+}
+
+/**
+ * Executes the body for every index in the range [begin,end) in parallel.
+ *
+ * The range is split into chunks of (at least) grain indices, and each
+ * chunk is passed to body as a half-open subrange [start,stop). The
+ * calling thread executes chunks as well, and this method returns only
+ * when the entire range is complete.  If the range is no bigger than a
+ * single grain, the body is executed directly on the calling thread.
+ *
+ * The chunks must be independent of each other.  The order in which
+ * they execute is not specified.
+ *
+ * @param  begin    the first index of the range
+ * @param  end      the index after the last index of the range
+ * @param  grain    the minimum number of indices in a chunk
+ * @param  body     the function to execute on each chunk
+ * @param  priority the priority lane for the chunks
+ */
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)>& body,
+                             Priority priority) {
+    if (end <= begin) {
+        return;
+    }
+    
+    grain = (grain == 0 ? 1 : grain);
+    size_t total = end-begin;
+    if (total <= grain || _queues.empty() || _stop) {
+        body(begin,end);
+        return;
+    }
+    
+    // Do not split into more pieces than we can use (workers plus caller)
+    size_t parts  = (total+grain-1)/grain;
+    size_t limit  = 4*(_queues.size()+1);
+    parts = (parts > limit ? limit : parts);
+    size_t chunk  = (total+parts-1)/parts;
+    
+    // Keep the first chunk for ourselves
+    std::shared_ptr<WaitGroup> group = WaitGroup::alloc();
+    for (size_t start = begin+chunk; start < end; start += chunk) {
+        size_t stop = (start+chunk < end ? start+chunk : end);
+        addTask([=] { body(start,stop); }, group, priority);
+    }
+    body(begin, begin+chunk < end ? begin+chunk : end);
+    wait(group);
+}
+
+/**
+ * Executes a single pending task on the calling thread, if there is one.
+ *
+ * This allows the main thread to contribute to the pool (for example,
+ * while waiting on a loading screen).  Only lanes at or above the given
+ * priority are considered.
+ *
+ * @param  priority the least urgent lane to consider
+ *
+ * @return true if a task was executed
+ */
+bool ThreadPool::runPendingTask(Priority priority) {
+    std::function<void()> task = nullptr;
+    if (acquire(currentWorker(), task, priority)) {
+        task();
+        return true;
+    }
+    return false;
 }
 
 /**
  * Stop the thread pool, marking it for shut down.
  *
- * A stopped thread pool is marked for shutdown, but it shutdown has not
- * necessarily completed.  Shutdown will be complete when the current child
- * threads have finished with their tasks.
+ * A stopped thread pool is marked for shutdown, and this method joins the
+ * child threads.  Shutdown will be complete when the current child
+ * threads have finished with their tasks.  Any task that has not started
+ * by then is discarded.  A discarded task still counts as done for its
+ * {@link WaitGroup}, so no thread is left waiting on it.
  */
 void ThreadPool::stop() {
     {
@@ -182,4 +459,18 @@ void ThreadPool::stop() {
         worker.join();
 #endif
     }
+    
+    // Joined threads cannot be joined again
+    _workers.clear();
+    _complete = 0;
+    
+    // Release the tasks that never started (breaking their promises, and
+    // completing their wait groups)
+    for (auto it = _queues.begin(); it != _queues.end(); ++it) {
+        std::unique_lock<std::mutex> lk((*it)->mutex);
+        for (int lane = 0; lane < LANES; lane++) {
+            (*it)->lanes[lane].clear();
+        }
+    }
+    _pending = 0;
 }
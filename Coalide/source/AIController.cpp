@@ -12,6 +12,9 @@
 using namespace cugl;
 
 bool AIController::init(std::shared_ptr<GameState> gamestate) {
+	// The scratch buffers are sized to the level, so drop the old ones
+	dispose();
+
 	int worldH = gamestate->getBounds().size.getIHeight();
 	int worldW = gamestate->getBounds().size.getIWidth();
 
@@ -33,12 +36,21 @@ bool AIController::init(std::shared_ptr<GameState> gamestate) {
 }
 
 void AIController::dispose() {
+	if (_openArray == nullptr) {
+		return;
+	}
 	for (int i = 0; i < _bounds.size.getIHeight(); i++) {
 		delete[] _openArray[i];
 		delete[] _closedArray[i];
 	}
 	delete[] _openArray;
 	delete[] _closedArray;
+	_openArray = nullptr;
+	_closedArray = nullptr;
+	_openList.clear();
+	_closedList.clear();
+	_nextMoves.clear();
+	_nearby.clear();
 }
 
 bool intersectsWater(Vec2 start, Vec2 end, std::shared_ptr<GameState> gamestate){
@@ -49,7 +61,7 @@ bool intersectsWater(Vec2 start, Vec2 end, std::shared_ptr<GameState> gamestate)
 	for (int i = 1; i <= 50; i++) {
 		Vec2 pt = start + trajectory / 50 * i;
 		if (pt.x < w-1 && pt.x > 0 && pt.y < h-1 && pt.y > 0) {
-			if (!gamestate->getTileBoard()[(int)floor(pt.y)][(int)floor(pt.x)]) {
+			if (gamestate->getTileBoard()[(int)floor(pt.y)][(int)floor(pt.x)].isWater()) {
 				return true;
 			}
 		}
@@ -76,13 +88,24 @@ bool AIController::slipperySlope(Vec2 landing, Vec2 aim, std::shared_ptr<EnemyMo
 	float d = (vi*vi) / (2 * a);
 	Vec2 slide = landing + aim*d*1.8;
 	Vec2 shortland = landing - aim*d*0.8;
-	if (slide.x < 0 || slide.x >= _bounds.size.getIWidth() || slide.y < 0 || slide.y >= _bounds.size.getIHeight() || !gamestate->getTileBoard()[(int)slide.y][(int)slide.x] || intersectsWater(shortland, slide, gamestate)) {
+	if (slide.x < 0 || slide.x >= _bounds.size.getIWidth() || slide.y < 0 || slide.y >= _bounds.size.getIHeight() || gamestate->getTileBoard()[(int)slide.y][(int)slide.x].isWater() || intersectsWater(shortland, slide, gamestate)) {
 		return true;
 	}
 	return false;
 }
 
 
+bool AIController::slingObstructed(Vec2 start, Vec2 end, std::shared_ptr<EnemyModel> enemy, std::shared_ptr<GameState> gamestate) {
+	bool obstructed = false;
+	gamestate->getUnits().querySegment(start, end, enemy->getWidth(), SpatialHash::OBJECTS,
+		[&obstructed](const std::shared_ptr<Obstacle>& obstacle, Uint32 category) {
+		obstructed = true;
+		return false;
+	});
+	return obstructed;
+}
+
+
 bool sortByScore(std::tuple<Vec2, Vec2, float> a, std::tuple<Vec2, Vec2, float> b) {
 	return std::get<2>(a) > std::get<2>(b);
 }
@@ -153,7 +176,7 @@ void AIController::AStar(Vec2 pos, float slingDist, Vec2 target, Vec2 origin, st
 			int y = (int)floor(vec.y);
 
 			if (x >= 0 && x < _bounds.size.getIWidth() && y >= 0 && y < _bounds.size.getIHeight()
-				&& !_closedArray[y][x] && !(i == 0 && j == 0) && gamestate->getTileBoard()[y][x] && !slipperySlope(vec, aim, enemy, gamestate)) {
+				&& !_closedArray[y][x] && !(i == 0 && j == 0) && !gamestate->getTileBoard()[y][x].isWater() && !slipperySlope(vec, aim, enemy, gamestate)) {
 				float h = target.distance(vec);
 				float g = origin.distance(vec);
 				if (!_openArray[y][x]) {
@@ -178,9 +201,11 @@ void AIController::AStar(Vec2 pos, float slingDist, Vec2 target, Vec2 origin, st
 
 std::shared_ptr<EnemyModel> shootSpore(Vec2 pos, Vec2 aim, std::shared_ptr<GameState> gamestate) {
 	std::shared_ptr<EnemyModel> spore = EnemyModel::alloc(pos, UNIT_DIM);
+	spore->setTimers(gamestate->getTimers());
 	spore->setTextureKey(SPORE);
 	spore->setSpore();
 	spore->setLinearDamping(0);
+	spore->setGrounded(false);
 	spore->setDensity(6);
 
 	b2Filter filter;
@@ -194,9 +219,7 @@ std::shared_ptr<EnemyModel> shootSpore(Vec2 pos, Vec2 aim, std::shared_ptr<GameS
 	gamestate->addSporeNode(spore);
 	gamestate->getWorld()->addObstacle(spore);
 
-	std::vector<std::shared_ptr<EnemyModel>> spores = gamestate->getSpores();
-	spores.push_back(spore);
-	gamestate->setSpores(spores);
+	gamestate->addSpore(spore);
 
 	return spore;
 }
@@ -210,8 +233,6 @@ std::shared_ptr<EnemyModel> shootSpore(Vec2 pos, Vec2 aim, std::shared_ptr<GameS
 std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> AIController::getEnemyMoves(std::shared_ptr<GameState> gamestate) {
     std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> moves;
 
-    std::vector<std::shared_ptr<EnemyModel>> enemies = gamestate->getEnemies();
-    
     Vec2 player_pos = gamestate->getPlayer()->getPosition();
 
 	for (int i = 0; i < _nextMoves.size(); i++) {
@@ -219,8 +240,16 @@ std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> AIController::getEnem
 	}
 	_nextMoves.clear();
 
-    for(std::shared_ptr<EnemyModel> enemy_ptr : enemies){
-		std::shared_ptr<EnemyModel> enemy = enemy_ptr;
+	// Only enemies within the largest sling range can act. Collect them first,
+	// since shooting spores adds to the spatial hash.
+	_nearby.clear();
+	gamestate->getUnits().queryRadius(player_pos, 12, SpatialHash::ENEMIES,
+		[this](const std::shared_ptr<Obstacle>& obstacle, Uint32 category) {
+		_nearby.push_back(std::static_pointer_cast<EnemyModel>(obstacle));
+		return true;
+	});
+
+    for(const std::shared_ptr<EnemyModel>& enemy : _nearby){
 		Vec2 enemy_pos = enemy->getPosition();
 		int enemyRange = 12;
 		if (enemy->isAcorn()) {
@@ -264,51 +293,47 @@ std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> AIController::getEnem
 					moves.push_back(std::make_tuple(enemy, aim));
 				}
 				*/
-				if (intersectsWater(enemy_pos, player_pos, gamestate)) {
-					if (!slipperySlope(enemy_pos + aim*d, aim, enemy, gamestate)) {
-						aim *= impulse;
-						if (!enemy->isPrepping()) {
-							moves.push_back(std::make_tuple(enemy, aim));
-						}
+				bool water = intersectsWater(enemy_pos, player_pos, gamestate);
+				if ((!water || !slipperySlope(enemy_pos + aim*d, aim, enemy, gamestate)) &&
+					!slingObstructed(enemy_pos, player_pos, enemy, gamestate)) {
+					aim *= impulse;
+					if (!enemy->isPrepping()) {
+						moves.push_back(std::make_tuple(enemy, aim));
 					}
-					else {
-						float theta = 3.14159 / 8;
-						float rotated = 0;
-						Vec2 rotatedAim1 = aim;
-						Vec2 rotatedAim2 = aim;
-						bool success = false;
-						while (abs(rotated) < 3.14159) {
-							rotatedAim1 = Vec2(rotatedAim1.x*cos(theta) - rotatedAim1.y*sin(theta), rotatedAim1.x*sin(theta) + rotatedAim1.y*cos(theta));
-							rotatedAim1.normalize();
-							rotatedAim2 = Vec2(rotatedAim2.x*cos(-theta) - rotatedAim2.y*sin(-theta), rotatedAim2.x*sin(-theta) + rotatedAim2.y*cos(-theta));
-							rotatedAim2.normalize();
-							if (!slipperySlope(enemy_pos + rotatedAim1*d, rotatedAim1, enemy, gamestate)) {
-								rotatedAim1 *= impulse;
-								if (!enemy->isPrepping()) {
-									moves.push_back(std::make_tuple(enemy, rotatedAim1));
-								}
-								success = true;
-								break;
-							}
-							else if (!slipperySlope(enemy_pos + rotatedAim2*d, rotatedAim2, enemy, gamestate)) {
-								rotatedAim2 *= impulse;
-								if (!enemy->isPrepping()) {
-									moves.push_back(std::make_tuple(enemy, rotatedAim2));
-								}
-								success = true;
-								break;
+				}
+				else {
+					float theta = 3.14159 / 8;
+					float rotated = 0;
+					Vec2 rotatedAim1 = aim;
+					Vec2 rotatedAim2 = aim;
+					bool success = false;
+					while (abs(rotated) < 3.14159) {
+						rotatedAim1 = Vec2(rotatedAim1.x*cos(theta) - rotatedAim1.y*sin(theta), rotatedAim1.x*sin(theta) + rotatedAim1.y*cos(theta));
+						rotatedAim1.normalize();
+						rotatedAim2 = Vec2(rotatedAim2.x*cos(-theta) - rotatedAim2.y*sin(-theta), rotatedAim2.x*sin(-theta) + rotatedAim2.y*cos(-theta));
+						rotatedAim2.normalize();
+						if (!slipperySlope(enemy_pos + rotatedAim1*d, rotatedAim1, enemy, gamestate) &&
+							!slingObstructed(enemy_pos, enemy_pos + rotatedAim1*d, enemy, gamestate)) {
+							rotatedAim1 *= impulse;
+							if (!enemy->isPrepping()) {
+								moves.push_back(std::make_tuple(enemy, rotatedAim1));
 							}
-							rotated += theta;
+							success = true;
+							break;
 						}
-						if (!success) {
-							enemy->setPrepping(false);
+						else if (!slipperySlope(enemy_pos + rotatedAim2*d, rotatedAim2, enemy, gamestate) &&
+							!slingObstructed(enemy_pos, enemy_pos + rotatedAim2*d, enemy, gamestate)) {
+							rotatedAim2 *= impulse;
+							if (!enemy->isPrepping()) {
+								moves.push_back(std::make_tuple(enemy, rotatedAim2));
+							}
+							success = true;
+							break;
 						}
+						rotated += theta;
 					}
-				}
-				else {
-					aim *= impulse;
-					if (!enemy->isPrepping()) {
-						moves.push_back(std::make_tuple(enemy, aim));
+					if (!success) {
+						enemy->setPrepping(false);
 					}
 				}
 			}
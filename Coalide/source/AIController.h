@@ -23,10 +23,13 @@ protected:
 
 	Rect _bounds;
 
+	/** The enemies near the player this frame (reused to avoid allocation) */
+	std::vector<std::shared_ptr<EnemyModel>> _nearby;
+
 public:
 #pragma mark -
 #pragma mark Constructors
-	AIController() { }
+	AIController() : _openArray(nullptr), _closedArray(nullptr) { }
 
 	~AIController() { dispose(); }
 
@@ -49,5 +52,15 @@ public:
 	std::vector<Vec2> calculateRoute(Vec2 pos, float slingDist, Vec2 target, std::shared_ptr<EnemyModel> enemy, std::shared_ptr<GameState> gamestate);
 
 	bool slipperySlope(Vec2 landing, Vec2 aim, std::shared_ptr<EnemyModel> enemy, std::shared_ptr<GameState> gamestate);
+
+	/**
+	 * Returns true if an object lies in the sling path of the enemy.
+	 *
+	 * @param start		The start of the sling path
+	 * @param end		The end of the sling path
+	 * @param enemy		The slinging enemy
+	 * @param gamestate	The current game state
+	 */
+	bool slingObstructed(Vec2 start, Vec2 end, std::shared_ptr<EnemyModel> enemy, std::shared_ptr<GameState> gamestate);
 };
 #endif /* __AI_CONTROLLER_H__ */
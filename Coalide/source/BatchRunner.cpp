@@ -0,0 +1,229 @@
+//
+//  BatchRunner.cpp
+//  Coalide
+//
+#include "BatchRunner.h"
+#include "LevelController.h"
+#include "PlayerModel.h"
+#include "EnemyModel.h"
+#include "Constants.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/** The simulated time of a frame (the world steps a fixed amount regardless) */
+#define BATCH_FRAME_TIME    (1.0f/60.0f)
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an uninitialized batch runner.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a runner on
+ * the heap, use one of the static constructors instead.
+ */
+BatchRunner::BatchRunner() :
+_frameLimit(BATCH_FRAME_LIMIT),
+_started(0),
+_rounds(0),
+_wins(0),
+_losses(0),
+_timeouts(0),
+_frames(0) {
+}
+
+/**
+ * Disposes all of the level instances and threads.
+ */
+void BatchRunner::dispose() {
+	if (_threads != nullptr) {
+		_threads->stop();
+		_threads = nullptr;
+	}
+	for (auto it = _instances.begin(); it != _instances.end(); ++it) {
+		(*it)->gameplay.dispose();
+		(*it)->level = nullptr;
+	}
+	_instances.clear();
+	_source.clear();
+	_policy = nullptr;
+}
+
+/**
+ * Initializes a batch runner for the given level.
+ *
+ * The level file is relative to the asset directory. The thread pool has
+ * one less worker than threads, as the thread calling {@link run} helps.
+ *
+ * @param file      The level file
+ * @param instances The number of level instances
+ * @param threads   The number of threads to simulate with
+ *
+ * @return true if the runner is initialized properly, false otherwise.
+ */
+bool BatchRunner::init(const std::string& file, int instances, int threads) {
+	CUAssertLog(instances > 0, "A batch needs at least one level instance");
+	std::shared_ptr<TextReader> reader = TextReader::allocWithAsset(file);
+	if (reader == nullptr) {
+		CULogError("Failed to read level file %s", file.c_str());
+		return false;
+	}
+	_source = reader->readAll();
+	reader->close();
+
+	_threads = ThreadPool::alloc(std::max(threads-1, 1));
+	if (_threads == nullptr) {
+		return false;
+	}
+	for (int ii = 0; ii < instances; ii++) {
+		_instances.push_back(std::unique_ptr<Instance>(new Instance()));
+	}
+	_policy = aimAtNearestEnemy();
+	return true;
+}
+
+
+#pragma mark -
+#pragma mark Policies
+/**
+ * Returns a policy that slings the player at the nearest enemy whenever
+ * it is able to.
+ *
+ * @return a policy that slings the player at the nearest enemy.
+ */
+BatchRunner::Policy BatchRunner::aimAtNearestEnemy() {
+	return [](const std::shared_ptr<GameState>& state, Uint32 frame) {
+		std::shared_ptr<PlayerModel> player = state->getPlayer();
+		if (!player->canSling() || player->isStunned()) {
+			return Vec2::ZERO;
+		}
+
+		Vec2 position = player->getPosition();
+		Vec2 target = position;
+		float best = -1;
+		for (const std::shared_ptr<EnemyModel>& enemy : state->getEnemies()) {
+			if (enemy->isRemoved() || enemy->didFall()) {
+				continue;
+			}
+			float distance = enemy->getPosition().distanceSquared(position);
+			if (best < 0 || distance < best) {
+				best = distance;
+				target = enemy->getPosition();
+			}
+		}
+		if (best <= 0) {
+			return Vec2::ZERO;
+		}
+		return (target-position).getNormalization()*BATCH_SLING_LENGTH;
+	};
+}
+
+/**
+ * Returns a policy that replays a fixed list of slings.
+ *
+ * Each sling is played on its frame, if the player is able to sling.
+ *
+ * @param script    The frames and slings, sorted by frame
+ *
+ * @return a policy that replays a fixed list of slings.
+ */
+BatchRunner::Policy BatchRunner::scripted(const std::vector<std::pair<Uint32, Vec2>>& script) {
+	return [script](const std::shared_ptr<GameState>& state, Uint32 frame) {
+		auto it = std::lower_bound(script.begin(), script.end(), frame,
+			[](const std::pair<Uint32, Vec2>& entry, Uint32 value) { return entry.first < value; });
+		if (it != script.end() && it->first == frame) {
+			return it->second;
+		}
+		return Vec2::ZERO;
+	};
+}
+
+
+#pragma mark -
+#pragma mark Simulation
+/**
+ * Plays a single round on the given instance from a fresh copy of the level.
+ *
+ * @param instance  The level instance
+ */
+void BatchRunner::playRound(Instance& instance) {
+	// Release the previous round before loading the next one
+	instance.gameplay.dispose();
+	instance.level = std::make_shared<LevelController>();
+	if (!instance.level->preload(JsonStreamReader::allocWithString(_source))) {
+		CULogError("Failed to load a simulated level");
+		instance.level = nullptr;
+		return;
+	}
+
+	// The instances already run in parallel, so the world is left without a solver pool
+	std::shared_ptr<GameState> state = instance.level->getGameState();
+	instance.gameplay.init(state, nullptr);
+
+	Uint32 frame = 0;
+	while (!instance.gameplay.isGameOver() && !instance.gameplay.isComplete() && frame < _frameLimit) {
+		Vec2 sling = _policy(state, frame);
+		if (!sling.isZero()) {
+			instance.gameplay.sling(sling);
+		}
+		instance.gameplay.update(BATCH_FRAME_TIME);
+		frame++;
+	}
+
+	_frames += frame;
+	if (instance.gameplay.isGameOver()) {
+		_losses++;
+	} else if (instance.gameplay.isComplete()) {
+		_wins++;
+	} else {
+		_timeouts++;
+	}
+}
+
+/**
+ * Plays rounds on the given instance until none are left to claim.
+ *
+ * @param instance  The level instance
+ */
+void BatchRunner::play(Instance& instance) {
+	while (_started.fetch_add(1) < _rounds) {
+		playRound(instance);
+	}
+}
+
+/**
+ * Plays the given number of rounds and returns the results.
+ *
+ * This blocks until every round is complete.
+ *
+ * @param rounds    The number of rounds to play
+ *
+ * @return the results of the batch
+ */
+BatchRunner::Report BatchRunner::run(Uint32 rounds) {
+	_started = 0;
+	_rounds = rounds;
+	_wins = 0;
+	_losses = 0;
+	_timeouts = 0;
+	_frames = 0;
+
+	Timestamp start;
+	_threads->parallelFor(0, _instances.size(), 1, [this](size_t begin, size_t end) {
+		for (size_t ii = begin; ii < end; ii++) {
+			play(*_instances[ii]);
+		}
+	});
+	Timestamp end;
+
+	Report report;
+	report.wins = _wins.load();
+	report.losses = _losses.load();
+	report.timeouts = _timeouts.load();
+	report.rounds = report.wins+report.losses+report.timeouts;
+	report.frames = _frames.load();
+	report.seconds = Timestamp::ellapsedMicros(start, end)/1000000.0;
+	report.threads = std::min(_threads->getThreadCount()+1, (int)_instances.size());
+	return report;
+}
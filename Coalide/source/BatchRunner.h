@@ -0,0 +1,218 @@
+//
+//  BatchRunner.h
+//  Coalide
+//
+#ifndef __BATCH_RUNNER_H__
+#define __BATCH_RUNNER_H__
+
+#include <cugl/cugl.h>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "GameplayController.h"
+
+using namespace cugl;
+
+/** Forward references */
+class LevelController;
+
+
+#pragma mark -
+#pragma mark Batch Runner
+
+/**
+* A runner that plays many rounds of a level without a window or audio.
+*
+* The runner keeps a fixed number of level instances. Each instance is an
+* isolated copy of the level with its own world, timers and controllers. The
+* instances are stepped concurrently on a thread pool. When a round ends, its
+* instance reloads the level and plays the next round, until the requested
+* number of rounds are done.
+*
+* The player is driven by a policy, which is called once per frame on the
+* thread of the instance. The policy may keep state, but it is shared by
+* every instance and must be safe to call concurrently.
+*
+* The levels have no scene graph. Textures, sparks and sounds are skipped, but
+* the rules are the same as in the GameScene.
+*/
+class BatchRunner {
+public:
+	/**
+	* A player policy returns the sling for the given frame of a round.
+	*
+	* The sling is in screen points, as read by the InputController. A zero
+	* sling means the player waits this frame.
+	*/
+	typedef std::function<Vec2(const std::shared_ptr<GameState>& state, Uint32 frame)> Policy;
+
+	/** The results of a batch */
+	struct Report {
+		/** The number of rounds played */
+		Uint32 rounds;
+		/** The number of rounds where every enemy was defeated */
+		Uint32 wins;
+		/** The number of rounds where the player was defeated */
+		Uint32 losses;
+		/** The number of rounds stopped at the frame limit */
+		Uint32 timeouts;
+		/** The number of frames simulated over all rounds */
+		Uint64 frames;
+		/** The wall time of the batch in seconds */
+		double seconds;
+		/** The number of threads that simulated the rounds */
+		int threads;
+
+		/** Returns the simulated frames per second of wall time */
+		double getFramesPerSecond() const { return seconds > 0 ? frames/seconds : 0; }
+
+		/** Returns the simulated frames per second of wall time on each thread */
+		double getFramesPerSecondPerCore() const { return threads > 0 ? getFramesPerSecond()/threads : 0; }
+	};
+
+private:
+	/** A level instance */
+	struct Instance {
+		/** The loaded level, which owns the game state */
+		std::shared_ptr<LevelController> level;
+		/** The rules of the level */
+		GameplayController gameplay;
+	};
+
+	/** The level file, read once so the instances do not touch the file system */
+	std::string _source;
+	/** The level instances */
+	std::vector<std::unique_ptr<Instance>> _instances;
+	/** The threads stepping the instances */
+	std::shared_ptr<ThreadPool> _threads;
+	/** The player policy */
+	Policy _policy;
+	/** The longest round in frames */
+	Uint32 _frameLimit;
+
+	/** The number of rounds claimed by the instances */
+	std::atomic<Uint32> _started;
+	/** The number of rounds requested */
+	Uint32 _rounds;
+	/** The number of rounds won */
+	std::atomic<Uint32> _wins;
+	/** The number of rounds lost */
+	std::atomic<Uint32> _losses;
+	/** The number of rounds stopped at the frame limit */
+	std::atomic<Uint32> _timeouts;
+	/** The number of frames simulated */
+	std::atomic<Uint64> _frames;
+
+	/**
+	* Plays rounds on the given instance until none are left to claim.
+	*
+	* @param instance  The level instance
+	*/
+	void play(Instance& instance);
+
+	/**
+	* Plays a single round on the given instance from a fresh copy of the level.
+	*
+	* @param instance  The level instance
+	*/
+	void playRound(Instance& instance);
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an uninitialized batch runner.
+	*
+	* NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a runner on
+	* the heap, use one of the static constructors instead.
+	*/
+	BatchRunner();
+
+	/**
+	* Destroys this batch runner, releasing all resources.
+	*/
+	~BatchRunner() { dispose(); }
+
+	/**
+	* Disposes all of the level instances and threads.
+	*/
+	void dispose();
+
+	/**
+	* Initializes a batch runner for the given level.
+	*
+	* The level file is relative to the asset directory. The thread pool has
+	* one less worker than threads, as the thread calling {@link run} helps.
+	*
+	* @param file      The level file
+	* @param instances The number of level instances
+	* @param threads   The number of threads to simulate with
+	*
+	* @return true if the runner is initialized properly, false otherwise.
+	*/
+	bool init(const std::string& file, int instances, int threads);
+
+	/**
+	* Returns a newly allocated batch runner for the given level.
+	*
+	* @param file      The level file
+	* @param instances The number of level instances
+	* @param threads   The number of threads to simulate with
+	*
+	* @return a newly allocated batch runner for the given level.
+	*/
+	static std::shared_ptr<BatchRunner> alloc(const std::string& file, int instances, int threads) {
+		std::shared_ptr<BatchRunner> result = std::make_shared<BatchRunner>();
+		return (result->init(file, instances, threads) ? result : nullptr);
+	}
+
+#pragma mark Settings
+	/**
+	* Sets the player policy.
+	*
+	* The default policy is {@link aimAtNearestEnemy}.
+	*
+	* @param policy    The player policy
+	*/
+	void setPolicy(const Policy& policy) { _policy = policy; }
+
+	/**
+	* Sets the longest round in frames.
+	*
+	* @param frames    The longest round in frames
+	*/
+	void setFrameLimit(Uint32 frames) { _frameLimit = frames; }
+
+	/**
+	* Returns a policy that slings the player at the nearest enemy whenever
+	* it is able to.
+	*
+	* @return a policy that slings the player at the nearest enemy.
+	*/
+	static Policy aimAtNearestEnemy();
+
+	/**
+	* Returns a policy that replays a fixed list of slings.
+	*
+	* Each sling is played on its frame, if the player is able to sling.
+	*
+	* @param script    The frames and slings, sorted by frame
+	*
+	* @return a policy that replays a fixed list of slings.
+	*/
+	static Policy scripted(const std::vector<std::pair<Uint32, Vec2>>& script);
+
+#pragma mark Simulation
+	/**
+	* Plays the given number of rounds and returns the results.
+	*
+	* This blocks until every round is complete.
+	*
+	* @param rounds    The number of rounds to play
+	*
+	* @return the results of the batch
+	*/
+	Report run(Uint32 rounds);
+};
+
+#endif /* __BATCH_RUNNER_H__ */
@@ -7,6 +7,7 @@
 #include <cugl/base/CUBase.h>
 #include "Constants.h"
 #include "LevelController.h"
+#include "BatchRunner.h"
 
 
 // This keeps us from having to write cugl:: all the time
@@ -32,9 +33,29 @@ void CoalideApp::onStartup() {
 	Input::activate<Mouse>();
 #endif
 	Input::activate<Keyboard>();
+
+#if defined (COALIDE_BATCH)
+	// Balancing builds simulate the level and quit, without loading any assets
+	runBatch();
+	Application::onStartup();
+	quit();
+	return;
+#endif
+
     // Create a sprite batch (and background color) to render the scene
     _batch = SpriteBatch::alloc();
     setClearColor(Color4(229,229,229,255));
+
+	// Update and record each frame on a game thread while the last one is drawn
+	setPipelined(true);
+
+	// The game thread cannot allocate this, so it is shared by every game scene
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	_worldTarget = RenderTarget::alloc(viewport[2], viewport[3]);
+
+	// Units meet only at the terrain, so their islands are solved in parallel
+	_solverThreads = ThreadPool::alloc(SOLVER_THREADS);
     
     // Create an asset manager to load all assets
     _assets = AssetManager::alloc();
@@ -62,6 +83,28 @@ void CoalideApp::onStartup() {
 }
 
 
+/**
+ * Plays rounds of the level without a window or audio, and logs the results.
+ *
+ * The player slings at the nearest enemy. Each level instance has its own
+ * world, timers and controllers, and the instances run on a thread pool.
+ */
+void CoalideApp::runBatch() {
+	std::shared_ptr<BatchRunner> runner = BatchRunner::alloc(LEVEL_FILE, BATCH_INSTANCES, BATCH_THREADS);
+	if (runner == nullptr) {
+		CULogError("Failed to start the batch simulation");
+		return;
+	}
+
+	BatchRunner::Report report = runner->run(BATCH_ROUNDS);
+	CULog("Simulated %u rounds (%u won, %u lost, %u timed out)",
+		  report.rounds, report.wins, report.losses, report.timeouts);
+	CULog("%llu frames in %.2f s on %d threads: %.0f frames/s per core",
+		  (unsigned long long)report.frames, report.seconds, report.threads,
+		  report.getFramesPerSecondPerCore());
+}
+
+
 void CoalideApp::onSuspend() {
 	Application::onSuspend();
 	if (_currentScene == CURRENT_SCENE::GAME_SCENE) {
@@ -93,6 +136,8 @@ void CoalideApp::onShutdown() {
 	_loadingScene.dispose();
 	_gameScene.dispose();
     _batch = nullptr;
+	_worldTarget = nullptr;
+	_solverThreads = nullptr;
     _assets = nullptr;
     
     // Deativate input
@@ -147,6 +192,8 @@ void CoalideApp::update(float timestep) {
 			if (_menuScene.didClickStart()) {
 				_menuScene.dispose();
 				_gameScene.init(_assets, _input, LEVEL_KEY);
+				_gameScene.setWorldTarget(_worldTarget);
+				_gameScene.setSolverThreads(_solverThreads);
 				_gameScene.reset(levelNames[_levelCt]);
 				_currentScene = CURRENT_SCENE::GAME_SCENE;
 			}
@@ -168,6 +215,8 @@ void CoalideApp::update(float timestep) {
 			else if (_levelSelectScene.didClickLevel()) {
 				_levelSelectScene.dispose();
 				_gameScene.init(_assets, _input, LEVEL_KEY);
+				_gameScene.setWorldTarget(_worldTarget);
+				_gameScene.setSolverThreads(_solverThreads);
 				_levelCt = _levelSelectScene.getCurrentLevel();
 				_gameScene.reset(levelNames[_levelCt]);
 				_currentScene = CURRENT_SCENE::GAME_SCENE;
@@ -229,6 +278,9 @@ void CoalideApp::update(float timestep) {
  * at all. The default implmentation does nothing.
  */
 void CoalideApp::draw() {
+	// When pipelined, this records the frame for present
+	_batch->setSnapshot(getRecordSnapshot());
+
     // This takes care of begin/end
 	if (!_loaded) {
 		_loadingScene.render(_batch);
@@ -246,6 +298,40 @@ void CoalideApp::draw() {
 	}
 }
 
+/**
+ * The method called to draw the previous frame while the next one updates.
+ *
+ * The application is pipelined, so this replays the frame recorded by
+ * the last call to draw.
+ */
+void CoalideApp::present() {
+	_batch->replay(getPresentSnapshot());
+}
+
+/**
+ * Returns true if the active scene changed since it was last drawn.
+ *
+ * Static screens (like the menus or a paused game) skip drawing, and
+ * the application idles at a low frame rate until something changes.
+ *
+ * @return true if the active scene changed since it was last drawn.
+ */
+bool CoalideApp::needsRedraw() {
+	if (!_loaded) {
+		return _loadingScene.isDirty();
+	}
+	switch (_currentScene) {
+		case CURRENT_SCENE::GAME_SCENE:
+			return _gameScene.isDirty();
+		case CURRENT_SCENE::MENU_SCENE:
+			return _menuScene.isDirty();
+		case CURRENT_SCENE::LEVEL_SELECT_SCENE:
+			return _levelSelectScene.isDirty();
+		default:
+			return true;
+	}
+}
+
 /**
  * Internal helper to build the scene graph.
  *
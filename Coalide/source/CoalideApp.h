@@ -24,6 +24,10 @@ protected:
 
     /** A 3152 style SpriteBatch to render the scene */
     std::shared_ptr<cugl::SpriteBatch>  _batch;
+	/** The offscreen target to draw the game world to at a reduced resolution */
+	std::shared_ptr<cugl::RenderTarget> _worldTarget;
+	/** The threads to solve the independent islands of each game world on */
+	std::shared_ptr<cugl::ThreadPool> _solverThreads;
 
 	// Player modes
 	/** The primary controller for the game world */
@@ -61,6 +65,11 @@ protected:
      *
      */
     void activateGameScene();
+
+    /**
+     * Plays rounds of the level without a window or audio, and logs the results.
+     */
+    void runBatch();
     
 public:
     /**
@@ -135,6 +144,24 @@ public:
      * at all. The default implmentation does nothing.
      */
     virtual void draw() override;
+
+	/**
+	 * The method called to draw the previous frame while the next one updates.
+	 *
+	 * The application is pipelined, so this replays the frame recorded by
+	 * the last call to draw.
+	 */
+	virtual void present() override;
+
+	/**
+	 * Returns true if the active scene changed since it was last drawn.
+	 *
+	 * Static screens (like the menus or a paused game) skip drawing, and
+	 * the application idles at a low frame rate until something changes.
+	 *
+	 * @return true if the active scene changed since it was last drawn.
+	 */
+	virtual bool needsRedraw() override;
     
 };
 
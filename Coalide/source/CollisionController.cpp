@@ -8,7 +8,6 @@
 #include "EnemyModel.h"
 #include "ObjectModel.h"
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
-#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 
 using namespace cugl;
 
@@ -19,11 +18,40 @@ using namespace cugl;
 
 #pragma mark -
 #pragma mark Constructors
+/**
+ * Initializes the collision controller.
+ *
+ * If there are no assets or no audio engine, collisions are silent. This
+ * allows levels to be simulated without an application.
+ *
+ * @param assets    The loaded assets (or nullptr for silent collisions)
+ *
+ * @return true if the controller is initialized properly, false otherwise.
+ */
 bool CollisionController::init(const std::shared_ptr<AssetManager>& assets) {
-    _thud = assets->get<Sound>("thud");	return true;
+    if (assets != nullptr && AudioEngine::get() != nullptr) {
+        _thud = assets->get<Sound>("thud");
+        _thudCue = AudioEngine::get()->registerCue(_thud, 1);
+    }
+	return true;
+}
+
+void CollisionController::dispose() {
+    if (_thudCue != -1 && AudioEngine::get() != nullptr) {
+        AudioEngine::get()->unregisterCue(_thudCue);
+    }
+    _thudCue = -1;
+    _thud = nullptr;
 }
 
-void CollisionController::dispose() { }
+/**
+ * Plays the thud sound, if collisions are not silent.
+ */
+void CollisionController::playThud() {
+    if (_thudCue != -1) {
+        AudioEngine::get()->playCue(_thudCue);
+    }
+}
 
 #pragma mark -
 #pragma mark Collision Handling
@@ -54,9 +82,7 @@ void CollisionController::beginContact(b2Contact* contact) {
 		if (soB->getName() == "player") {
 			PlayerModel* player = (PlayerModel*)soB;
             player->setCameraShakeAmplitude(1);
-            if(! AudioEngine::get()->isActiveEffect("thud")) {
-                AudioEngine::get()->playEffect("thud", _thud, false, _thud->getVolume());
-            }
+            playThud();
             player->setDirectionTexture(player->getPlayerDirection(), 5);
             player->setCoalided(true);
 			
@@ -95,9 +121,7 @@ void CollisionController::beginContact(b2Contact* contact) {
 		if (soA->getName() == "player") {
 			PlayerModel* player = (PlayerModel*)soA;
             player->setCameraShakeAmplitude(1);
-            if(! AudioEngine::get()->isActiveEffect("thud")) {
-                AudioEngine::get()->playEffect("thud", _thud, false, _thud->getVolume());
-            }
+            playThud();
 
             float angle = player->getLinearVelocity().getAngle();
             player->setCoalided(true);
@@ -15,16 +15,33 @@ class CollisionController {
 private:
     
     std::shared_ptr<cugl::Sound> _thud;
+    /** The audio cue for the thud sound (-1 if not registered) */
+    int _thudCue;
+
+    /**
+     * Plays the thud sound, if collisions are not silent.
+     */
+    void playThud();
     
 public:
 #pragma mark -
 #pragma mark Constructors
-	CollisionController() { }
+	CollisionController() : _thudCue(-1) { }
 
 	~CollisionController() { dispose(); }
 
 	void dispose();
 
+	/**
+	* Initializes the collision controller.
+	*
+	* If there are no assets or no audio engine, collisions are silent. This
+	* allows levels to be simulated without an application.
+	*
+	* @param assets	The loaded assets (or nullptr for silent collisions)
+	*
+	* @return true if the controller is initialized properly, false otherwise.
+	*/
 	bool init(const std::shared_ptr<AssetManager>& assets);
 
 
@@ -53,6 +53,8 @@
 
 #define DEFAULT_GRAVITY 0.0f
 #define GRAVITY	9.8f
+#define SOLVER_THREADS 3
+#define BROADPHASE_CELL 1.0f
 
 #define MIN_SPEED_FOR_CHARGING 4.0f
 #define GLOBAL_AIR_DRAG 1.5f
@@ -68,6 +70,14 @@
 /** The scene graph priorities of the various objects */
 #define TILE_PRIORITY       0
 #define UNIT_PRIORITY		1
+#define EFFECT_PRIORITY     2
+
+/** The seconds a collision spark is on screen (six frames at 60 fps) */
+#define SPARKS_LIFETIME     0.1f
+/** The most collision sparks on screen at once */
+#define SPARKS_CAPACITY     64
+/** The center of the onion sparks in the onion node */
+#define ONION_SPARKS_POINT  Vec2(64,42)
 
 /** The global fields of the level model */
 #define LAYERS_FIELD        "layers"
@@ -95,6 +105,19 @@
 /** The key for our loaded level */
 #define LEVEL_KEY    "level"
 
+#pragma mark -
+#pragma mark Batch Simulation
+/** The number of level instances simulated at once (build with COALIDE_BATCH) */
+#define BATCH_INSTANCES     16
+/** The number of threads stepping the level instances */
+#define BATCH_THREADS       4
+/** The number of rounds to simulate */
+#define BATCH_ROUNDS        1000
+/** The longest simulated round in frames (one minute at 60 fps) */
+#define BATCH_FRAME_LIMIT   3600
+/** The length of a simulated sling, in screen points */
+#define BATCH_SLING_LENGTH  400.0f
+
 /** Time slowdown rates */
 #define NORMAL_MOTION .015625
 #define SLOW_MOTION .002
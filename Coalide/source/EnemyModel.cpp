@@ -5,7 +5,6 @@
 
 #include "EnemyModel.h"
 #include "Constants.h"
-#include <cugl/util/CUTimestamp.h>
 
 #define MAX_SPEED_FOR_SLING .1
 #define IMPULSE_SCALE 8
@@ -36,7 +35,7 @@ bool EnemyModel::init(const Vec2 & pos, const Size & size) {
 		setDensity(4.8f);
 		setRestitution(0.5f);
 		setFixedRotation(true);
-
+		setGrounded(true);
 		_stunned = false;
 		_onFire = false;
         _slingCollisionLocked = false;
@@ -67,10 +66,12 @@ bool EnemyModel::init(const Vec2 & pos, const Size & size) {
 
 		_waterInbetween = false;
 
-		_previousTime = Timestamp();
+		_slingTime = 0;
+		_frame = 0;
+
         unsigned int rnd_seed = (unsigned int) (100 * pos.x + pos.y);
-        std::srand(rnd_seed);
-		_rndTimerReduction = std::rand() % 2000;
+        _random.seed(rnd_seed);
+		_rndTimerReduction = _random() % 2000;
 
 		return true;
 	}
@@ -79,16 +80,41 @@ bool EnemyModel::init(const Vec2 & pos, const Size & size) {
 }
 
 void EnemyModel::dispose() {
+	if (_timers != nullptr) {
+		_timers->cancel(_collisionTimer);
+		_timers->cancel(_stunTimer);
+		_timers = nullptr;
+	}
 	_node = nullptr;
-	_frictionJoint = nullptr;
+}
+
+/**
+ * Stuns this enemy for the given milliseconds of simulation time
+ */
+void EnemyModel::stunEnemy(int millis) {
+    CUAssertLog(_timers, "Enemy has no simulation timers");
+    _stunDuration = millis;
+    _stunned = true;
+    _timers->cancel(_stunTimer);
+    _stunTimer = _timers->schedule(millis, [this] { setStunned(false); });
+}
+
+/**
+ * Locks slinging until the collision timeout passes
+ */
+void EnemyModel::markCollisionTimeout() {
+    CUAssertLog(_timers, "Enemy has no simulation timers");
+    _slingCollisionLocked = true;
+    _timers->cancel(_collisionTimer);
+    _collisionTimer = _timers->schedule(COLLISION_TIMEOUT, [this] { _slingCollisionLocked = false; });
 }
 
 /**
  * Applies the impulse to the body of this enemy
  */
 void EnemyModel::applyLinearImpulse(Vec2& impulse) {
-    _previousTime.mark();
-    _rndTimerReduction = std::rand() % 3000;
+    _slingTime = _timers->now();
+    _rndTimerReduction = _random() % 3000;
     _body->SetLinearVelocity(b2Vec2(impulse.x,impulse.y));
 }
 
@@ -113,6 +139,9 @@ bool EnemyModel::inBounds(int width, int height){
  * @param angle  direction Nicoal facing in degrees
  */
 void EnemyModel::setDirectionTexture(float angle, bool isAcorn, int mode){
+    if (_node == nullptr) {
+        return;
+    }
     if(isAcorn){
 		float row_texture = 448 - (mode * 64.0f);
         if(angle > ONE_ANGLE && angle <= TWO_ANGLE){
@@ -162,6 +191,9 @@ void EnemyModel::setDirectionTexture(float angle, bool isAcorn, int mode){
 }
 
 void EnemyModel::setDirectionTexture(int dir, bool isAcorn, int mode) {
+	if (_node == nullptr) {
+		return;
+	}
 	if (isAcorn) {
 		float row_texture = 448.0f - (mode * 64.0f);
 		if (dir == 0) {
@@ -216,41 +248,28 @@ void EnemyModel::setDirectionTexture(int dir, bool isAcorn, int mode) {
 bool EnemyModel::timeoutElapsed(){
     //wait between 2 and 5 seconds
 	if (isMushroom()) {
-		return Timestamp().ellapsedMillis(_previousTime) >= (SPORE_TIMEOUT - _rndTimerReduction);
+		return _timers->ellapsedMillis(_slingTime) >= (SPORE_TIMEOUT - _rndTimerReduction);
 	}
 
-    return Timestamp().ellapsedMillis(_previousTime) >= (SLING_TIMEOUT - _rndTimerReduction);
-}
-
-void EnemyModel::updateSparks(bool visible) {
-	_sparks->setVisible(visible);
-}
-
-void EnemyModel::updateSparks() {
-	if (_sparks->isVisible()) {
-		int frame = _sparks->getFrame();
-		if (frame < 5) {
-			_sparks->setFrame(frame + 1);
-		}
-		else {
-			_sparks->setVisible(false);
-			_sparks->setFrame(0);
-		}
-	}
+    return _timers->ellapsedMillis(_slingTime) >= (SLING_TIMEOUT - _rndTimerReduction);
 }
 
 void EnemyModel::animateSpore() {
-	std::shared_ptr<AnimationNode> node = std::dynamic_pointer_cast<AnimationNode>(_node);
-	int frame = node->getFrame();
-	if (frame == 6) {
+	if (_frame == 6) {
 		setDestroyed();
 		return;
 	}
-	if (frame < 4) {
-		node->setFrame(4);
+	if (_frame < 4) {
+		_frame = 4;
 	}
 	else {
-		node->setFrame(frame + 1);
+		_frame++;
+	}
+
+	// The frame lives in the model, so a level without a scene graph still disperses
+	std::shared_ptr<AnimationNode> node = std::dynamic_pointer_cast<AnimationNode>(_node);
+	if (node != nullptr) {
+		node->setFrame(_frame);
 	}
 }
 
@@ -281,16 +300,7 @@ void EnemyModel::update(float dt) {
 		_node->setPosition(getPosition()*_drawscale);
 		_node->setAngle(getAngle());
 	}
-    auto ts = Timestamp();
-    if(_slingCollisionLocked && ts.ellapsedMillis(_collisionTimeout) >= COLLISION_TIMEOUT){
-        _slingCollisionLocked = false;
-    }
-    if(_stunned){
-        if(ts.ellapsedMillis(_stunTimeout) >= _stunDuration) {
-            setStunned(false);
-        }
-    }
-    /*else if(!canSling() && !isSpore()){
+    /*if(!_stunned && !canSling() && !isSpore()){
         _node->setColor(Color4::RED);
     } else {
         _node->setColor(Color4::WHITE);
@@ -299,7 +309,7 @@ void EnemyModel::update(float dt) {
         _shouldStopSoon = false;
         _body->SetLinearVelocity(b2Vec2(0,0));
     }
-    /*if(!isMushroom() && _waterInbetween && ts.ellapsedMillis(_noLineOfSiteTimeout) >= 2000){
-        _previousTime.mark();
+    /*if(!isMushroom() && _waterInbetween && _timers->ellapsedMillis(_noLineOfSiteTime) >= 2000){
+        _slingTime = _timers->now();
     }*/
 }
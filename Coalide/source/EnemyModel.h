@@ -5,8 +5,8 @@
 #ifndef __ENEMY_MODEL_H__
 #define __ENEMY_MODEL_H__
 #include <cugl/cugl.h>
-#include <cugl/util/CUTimestamp.h>
-#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
+#include <random>
+#include "TimerWheel.h"
 
 using namespace cugl;
 
@@ -17,12 +17,18 @@ class EnemyModel : public CapsuleObstacle {
 private:
     /** random reduction for the timer between slings */
     int _rndTimerReduction;
-    /** timeout for dashing after colliding */
-    Timestamp _collisionTimeout;
-    /** to keep track of how long to wait before resetting the _collisionTimeout */
-    Timestamp _noLineOfSiteTimeout;
-    /** to keep track of how long to wait before becoming unstunned */
-    Timestamp _stunTimeout;
+    /** the random generator for the sling timer (one per enemy, so levels can run in parallel) */
+    std::minstd_rand _random;
+    /** the current frame of the spore animation */
+    int _frame;
+    /** the simulation timers of the level */
+    std::shared_ptr<TimerWheel> _timers;
+    /** the timer to unlock dashing after colliding */
+    TimerWheel::TimerId _collisionTimer;
+    /** simulation time when the water cut off the line of sight */
+    Uint64 _noLineOfSiteTime;
+    /** the timer to end the current stun */
+    TimerWheel::TimerId _stunTimer;
     /** a collision happened and we want to stop soon */
     bool _shouldStopSoon;
     /** charging or floored */
@@ -37,17 +43,14 @@ protected:
 	/** The texture key for the enemy */
 	std::string _texture;
 
-	b2FrictionJoint* _frictionJoint;
-	float _friction;
-
 	/** The force to apply to this enemy */
 	Vec2 _force;
 
 	/** The ratio of the enemy sprite to the physics body */
 	float _drawscale;
     
-    /** timeout timer for enemy slinging */
-    Timestamp _previousTime;
+    /** simulation time of the last sling */
+    Uint64 _slingTime;
 
 	bool _stunned;
 	bool _onFire;
@@ -63,7 +66,6 @@ protected:
 	bool _destroyed;
 	bool _fell;
 
-	std::shared_ptr<cugl::AnimationNode> _sparks;
 	bool _sparky;
 
 	bool _shooting;
@@ -84,7 +86,7 @@ public:
 	/**
 	* Creates a new enemy at the origin.
 	*/
-	EnemyModel(void) : CapsuleObstacle() { }
+	EnemyModel(void) : CapsuleObstacle(), _collisionTimer(0), _noLineOfSiteTime(0), _stunTimer(0), _slingTime(0) { }
 
 	/**
 	* Destroys this enemy, releasing all resources.
@@ -123,15 +125,21 @@ public:
 
 #pragma mark -
 #pragma mark Status
+	/**
+	* Sets the simulation timers that run the stun and collision timeouts.
+	*
+	* @param timers The simulation timers of the level
+	*/
+	void setTimers(const std::shared_ptr<TimerWheel>& timers) { _timers = timers; }
+
 	bool isStunned() { return _stunned; }
 
 	void setStunned(bool stunned) { _stunned = stunned; }
     
-    void stunEnemy(int millis){
-        _stunDuration = millis;
-        _stunned = true;
-        _stunTimeout.mark();
-    }
+    /**
+     * Stuns this enemy for the given milliseconds of simulation time
+     */
+    void stunEnemy(int millis);
 
 	bool isFire() { return _onFire; }
 
@@ -141,7 +149,7 @@ public:
     
     void setWaterBetween(bool water) {
         if(_waterInbetween == false && water){
-            _noLineOfSiteTimeout.mark();
+            _noLineOfSiteTime = _timers->now();
             _waterInbetween = true;
         } else {
             _waterInbetween = water;
@@ -163,21 +171,6 @@ public:
 	* @param value the force applied to this enemy.
 	*/
 	void setForce(const Vec2& value) { _force.set(value); }
-
-	/**
-	* Returns the current friction.
-	*/
-	float getFriction() { return _friction; }
-
-	/**
-	* Sets the friction of the friction joint with the ground.
-	*/
-	void setFriction(float friction) override { _friction = friction; _frictionJoint->SetMaxForce(friction); _frictionJoint->SetMaxTorque(friction); }
-
-	/**
-	* Sets the friction joint with the ground.
-	*/
-	void setFrictionJoint(b2FrictionJoint* frictionJoint) { _frictionJoint = frictionJoint; }
     
     /**
      * Sets whether enemy is charging or floored.
@@ -227,11 +220,8 @@ public:
 
 	void setRoute(std::vector<Vec2> route) { _route = route; }
 
-	void setSparks(const std::shared_ptr<AnimationNode>& sparks) { _sparks = sparks; }
 	void setSparky(bool sparky) { _sparky = sparky; }
 	bool getSparky() { return _sparky; }
-	void updateSparks();
-	void updateSparks(bool visible);
 
 	bool isShooting() { return _shooting; }
 	bool isDispersing() { return _dispersing; }
@@ -335,10 +325,10 @@ public:
         _shouldStopSoon = true;
     }
     
-    void markCollisionTimeout(){
-        _slingCollisionLocked = true;
-        _collisionTimeout.mark();
-    }
+    /**
+     * Locks slinging until the collision timeout passes
+     */
+    void markCollisionTimeout();
     
     /**
      * Returns true if enemy is in bounds
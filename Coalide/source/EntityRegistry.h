@@ -0,0 +1,251 @@
+//
+//  EntityRegistry.h
+//  Coalide
+//
+#ifndef __ENTITY_REGISTRY_H__
+#define __ENTITY_REGISTRY_H__
+
+#include <cugl/cugl.h>
+#include <vector>
+#include <memory>
+
+using namespace cugl;
+
+
+#pragma mark -
+#pragma mark Entity Handle
+
+/**
+* A weak reference to an entity in an {@link EntityRegistry}.
+*
+* A handle names a slot and the generation of that slot.  When an entity is
+* removed, its slot generation changes, so old handles fail to resolve
+* instead of referring to whatever entity reuses the slot.
+*/
+struct EntityHandle {
+	/** The slot of the entity in the registry */
+	Uint32 index;
+	/** The generation of the slot when the handle was made */
+	Uint32 generation;
+
+	/** Creates a handle that refers to nothing */
+	EntityHandle() : index(0xFFFFFFFF), generation(0) { }
+
+	/** Returns true if the two handles refer to the same entity */
+	bool operator==(const EntityHandle& other) const {
+		return index == other.index && generation == other.generation;
+	}
+
+	/** Returns true if the two handles refer to different entities */
+	bool operator!=(const EntityHandle& other) const {
+		return !(*this == other);
+	}
+};
+
+
+#pragma mark -
+#pragma mark Entity Registry
+
+/**
+* A set of game entities with O(1) insertion and removal.
+*
+* The live entities are kept packed in a dense array, so that loops over the
+* registry never visit dead entities.  Removal swaps the last entity into the
+* hole, so the order of the entities is not stable.
+*
+* Like {@link ObstacleWorld}, entities are normally removed by marking them
+* (markRemoved) during the frame and calling {@link garbageCollect} once the
+* frame is done.  This keeps loops over the registry safe while they remove
+* entities.
+*/
+template <typename T>
+class EntityRegistry {
+public:
+	/** Iterator over the live entities */
+	typedef typename std::vector<std::shared_ptr<T>>::iterator iterator;
+	/** Const iterator over the live entities */
+	typedef typename std::vector<std::shared_ptr<T>>::const_iterator const_iterator;
+
+private:
+	/** A slot in the sparse handle table */
+	struct Slot {
+		/** The position of the entity in the dense array (or next free slot) */
+		Uint32 dense;
+		/** The current generation of this slot */
+		Uint32 generation;
+	};
+
+	/** The live entities, packed */
+	std::vector<std::shared_ptr<T>> _entities;
+	/** The slot of each entity in the dense array */
+	std::vector<Uint32> _owners;
+	/** The handle table */
+	std::vector<Slot> _slots;
+	/** The head of the free slot list */
+	Uint32 _free;
+
+	/** Marks the end of the free list */
+	static const Uint32 NO_SLOT = 0xFFFFFFFF;
+
+	/**
+	* Removes the entity at the given dense position.
+	*
+	* @param pos   The position of the entity in the dense array
+	*/
+	void erase(size_t pos) {
+		Uint32 slot = _owners[pos];
+		size_t last = _entities.size()-1;
+		if (pos != last) {
+			_entities[pos] = std::move(_entities[last]);
+			_owners[pos] = _owners[last];
+			_slots[_owners[pos]].dense = (Uint32)pos;
+		}
+		_entities.pop_back();
+		_owners.pop_back();
+
+		_slots[slot].generation++;
+		_slots[slot].dense = _free;
+		_free = slot;
+	}
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an empty registry.
+	*/
+	EntityRegistry() : _free(NO_SLOT) { }
+
+	/**
+	* Creates a registry with the given entities.
+	*
+	* @param entities  The initial entities
+	*/
+	EntityRegistry(const std::vector<std::shared_ptr<T>>& entities) : _free(NO_SLOT) {
+		for (auto it = entities.begin(); it != entities.end(); ++it) {
+			add(*it);
+		}
+	}
+
+#pragma mark Membership
+	/**
+	* Adds an entity to this registry.
+	*
+	* @param entity    The entity to add
+	*
+	* @return the handle for the new entity
+	*/
+	EntityHandle add(const std::shared_ptr<T>& entity) {
+		Uint32 slot = _free;
+		if (slot == NO_SLOT) {
+			slot = (Uint32)_slots.size();
+			Slot fresh;
+			fresh.generation = 0;
+			_slots.push_back(fresh);
+		} else {
+			_free = _slots[slot].dense;
+		}
+		_slots[slot].dense = (Uint32)_entities.size();
+		_entities.push_back(entity);
+		_owners.push_back(slot);
+
+		EntityHandle result;
+		result.index = slot;
+		result.generation = _slots[slot].generation;
+		return result;
+	}
+
+	/**
+	* Removes the entity for the given handle.
+	*
+	* This method invalidates the position of the last entity.  Do not call it
+	* while looping over the registry; use {@link garbageCollect} instead.
+	*
+	* @param handle    The entity handle
+	*
+	* @return true if the handle referred to a live entity
+	*/
+	bool remove(EntityHandle handle) {
+		if (!contains(handle)) {
+			return false;
+		}
+		erase(_slots[handle.index].dense);
+		return true;
+	}
+
+	/**
+	* Returns true if the handle refers to a live entity.
+	*
+	* @param handle    The entity handle
+	*
+	* @return true if the handle refers to a live entity.
+	*/
+	bool contains(EntityHandle handle) const {
+		return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+	}
+
+	/**
+	* Returns the entity for the given handle, or nullptr if it was removed.
+	*
+	* @param handle    The entity handle
+	*
+	* @return the entity for the given handle, or nullptr if it was removed.
+	*/
+	std::shared_ptr<T> get(EntityHandle handle) const {
+		return contains(handle) ? _entities[_slots[handle.index].dense] : nullptr;
+	}
+
+	/**
+	* Removes every entity marked for removal.
+	*
+	* Each removal is O(1).  Call this once the frame no longer loops over
+	* the registry.
+	*/
+	void garbageCollect() {
+		size_t ii = 0;
+		while (ii < _entities.size()) {
+			if (_entities[ii]->isRemoved()) {
+				erase(ii);
+			} else {
+				ii++;
+			}
+		}
+	}
+
+	/**
+	* Removes all entities, invalidating every handle.
+	*/
+	void clear() {
+		while (!_entities.empty()) {
+			erase(_entities.size()-1);
+		}
+	}
+
+#pragma mark Dense Access
+	/** Returns the number of live entities */
+	size_t size() const { return _entities.size(); }
+
+	/** Returns true if there are no live entities */
+	bool empty() const { return _entities.empty(); }
+
+	/** Returns the live entity at the given dense position */
+	const std::shared_ptr<T>& operator[](size_t pos) const { return _entities[pos]; }
+
+	/** Returns the handle of the live entity at the given dense position */
+	EntityHandle handleAt(size_t pos) const {
+		EntityHandle result;
+		result.index = _owners[pos];
+		result.generation = _slots[result.index].generation;
+		return result;
+	}
+
+	/** Returns an iterator to the first live entity */
+	iterator begin() { return _entities.begin(); }
+	/** Returns an iterator past the last live entity */
+	iterator end()   { return _entities.end(); }
+	/** Returns an iterator to the first live entity */
+	const_iterator begin() const { return _entities.begin(); }
+	/** Returns an iterator past the last live entity */
+	const_iterator end()   const { return _entities.end(); }
+};
+
+#endif /* __ENTITY_REGISTRY_H__ */
@@ -18,6 +18,13 @@ using namespace cugl;
 #define REPEATS  1
 #define ACT_KEY  "current"
 
+/** The smallest scale of the world resolution */
+#define MIN_RESOLUTION	0.5f
+/** The largest scale of the world resolution */
+#define MAX_RESOLUTION	1.0f
+/** The amount the world resolution changes in one step */
+#define RESOLUTION_STEP	0.1f
+
 #pragma mark -
 #pragma mark Constructors
 /**
@@ -67,14 +74,15 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, InputControlle
 	}
 
 	// Initialize the controllers used in the game mode
-	_collisions.init(_assets);
-	_ai.init(_gamestate);
+	_gameplay.init(_gamestate, _assets);
 	_input.init();
 
-	_enemyCount = _gamestate->getEnemies().size();
-
-	// Activate the collision callbacks for the physics world
-	activateWorldCollisions();
+	// The overlay outlives level reloads, so it is not part of the level scene graph
+	_perfnode = PerfHUD::alloc(_assets->get<Font>(PRIMARY_FONT), _assets);
+	if (_perfnode != nullptr) {
+		_perfnode->setVisible(false);
+		addChild(_perfnode, 4);
+	}
 
 	// Set up the scene graph
 	createSceneGraph(dimen);
@@ -96,6 +104,8 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, InputControlle
     counter = 0;
     deltaImage = 0.0f;
     up = true;
+
+	_scaler.init(MIN_RESOLUTION, MAX_RESOLUTION, RESOLUTION_STEP);
     
     std::srand(time(NULL));
 	return true;
@@ -107,12 +117,14 @@ bool GameScene::init(const std::shared_ptr<AssetManager>& assets, InputControlle
 void GameScene::dispose() {
 	if (_active) {
 		_input.dispose();
-		_collisions.dispose();
-		_ai.dispose();
+		_gameplay.dispose();
 		_rootnode = nullptr;
 		_winnode = nullptr;
 		_losenode = nullptr;
 		_loadnode = nullptr;
+		_perfnode = nullptr;
+		_target = nullptr;
+		_solver = nullptr;
 		_gamestate = nullptr;
 		_complete = false;
 		_debug = false;
@@ -158,27 +170,125 @@ void GameScene::createSceneGraph(Size dimen) {
 	// This root node becomes the physics world root node, all physics objects are added to this node
 	_gamestate->setAssets(_assets);
 	_gamestate->setRootNode(_rootnode);
+	if (_perfnode != nullptr) {
+		_perfnode->setGameState(_gamestate);
+	}
 }
 
+/**
+* Sets the offscreen target to draw the world to.
+*
+* With a target, the world is drawn at a resolution that adapts to the
+* GPU, and is then scaled up to the display.  The buttons and messages
+* are always drawn at the native resolution.  The target should be the
+* size of the display (in pixels), and must be allocated on the thread
+* that owns the OpenGL context.  A nullptr target draws the world natively.
+*
+* @param target	The offscreen target to draw the world to
+*/
+void GameScene::setWorldTarget(const std::shared_ptr<RenderTarget>& target) {
+	_target = target;
+	if (_target != nullptr) {
+		_target->setClearColor(Application::get()->getClearColor());
+	}
+	_scaler.reset();
+	setDirty(true);
+}
 
-#pragma mark -
-#pragma mark Physics Handling
+/**
+* Sets the thread pool to solve the world islands on.
+*
+* The pool is handed to the world of every level this scene plays, so
+* that the solver threads outlive the levels.  A nullptr pool solves
+* each world on the game thread.
+*
+* @param pool	The thread pool to solve the world islands on
+*/
+void GameScene::setSolverThreads(const std::shared_ptr<ThreadPool>& pool) {
+	_solver = pool;
+	if (_gamestate != nullptr) {
+		_gamestate->getWorld()->setSolverThreads(_solver);
+	}
+}
 
 /**
-* Activates world collision callbacks on the given physics world and sets the onBeginContact and beforeSolve callbacks
+* Draws the scene with the given SpriteBatch.
+*
+* If the world is drawn at a reduced resolution, it is drawn to the world
+* target first and scaled up.  The buttons and messages are then drawn
+* over it at the native resolution.
 *
-* @param world the physics world to activate world collision callbacks on
+* @param batch     The SpriteBatch to draw with.
 */
-void GameScene::activateWorldCollisions() {
-	_gamestate->getWorld()->activateCollisionCallbacks(true);
-	_gamestate->getWorld()->onBeginContact = [this](b2Contact* contact) {
-		_collisions.beginContact(contact);
-	};
-	_gamestate->getWorld()->beforeSolve = [this](b2Contact* contact, const b2Manifold* oldManifold) {
-		_collisions.beforeSolve(contact, oldManifold);
-	};
+void GameScene::render(const std::shared_ptr<SpriteBatch>& batch) {
+	float scale = getResolutionScale();
+	std::shared_ptr<Node> ui = (_gamestate == nullptr ? nullptr : _gamestate->getUINode());
+	if (scale >= 1.0f || ui == nullptr || ui->getParent() == nullptr) {
+		Scene::render(batch);
+		return;
+	}
+	if (isZAutoSort() && isZDirty()) {
+		sortZOrder();
+	}
+
+	// Draw the world without the buttons to the bottom left of the target
+	Mat4 camera = getCamera()->getCombined();
+	float width = roundf(_target->getWidth() * scale);
+	float height = roundf(_target->getHeight() * scale);
+	bool visible = ui->isVisible();
+	ui->setVisible(false);
+	batch->setRenderTarget(_target, Rect(0, 0, width, height));
+	batch->begin(camera);
+	_rootnode->render(batch, Mat4::IDENTITY, _color);
+	batch->end();
+	batch->setRenderTarget(nullptr);
+	ui->setVisible(visible);
+
+	// Scale that corner up to the whole display
+	float u = width / _target->getWidth();
+	float v = height / _target->getHeight();
+	Vertex2 quad[4];
+	quad[0].position.set(-1, -1);
+	quad[0].texcoord.set(0, 0);
+	quad[1].position.set(1, -1);
+	quad[1].texcoord.set(u, 0);
+	quad[2].position.set(1, 1);
+	quad[2].texcoord.set(u, v);
+	quad[3].position.set(-1, 1);
+	quad[3].texcoord.set(0, v);
+	for (int ii = 0; ii < 4; ii++) {
+		quad[ii].color = Color4::WHITE;
+	}
+	static const unsigned short indices[6] = { 0, 1, 2, 2, 3, 0 };
+
+	batch->begin(Mat4::IDENTITY);
+	batch->setBlendEquation(GL_FUNC_ADD);
+	batch->setBlendFunc(GL_ONE, GL_ZERO);
+	batch->setTexture(_target->getTexture());
+	batch->setColor(Color4::WHITE);
+	batch->fill(quad, 4, 0, indices, 6, 0, Mat4::IDENTITY);
+
+	// Draw the buttons and messages over it at the native resolution
+	batch->setPerspective(camera);
+	batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	if (visible) {
+		ui->render(batch, ui->getParent()->getNodeToWorldTransform(), _color);
+	}
+	for (auto it = _children.begin(); it != _children.end(); ++it) {
+		if (*it != _rootnode) {
+			(*it)->render(batch, Mat4::IDENTITY, _color);
+		}
+	}
+	batch->end();
+	batch->setBlendFunc(_srcFactor, _dstFactor);
+	batch->setBlendEquation(_blendEquation);
+
+	// Hiding the buttons does not change the frame
+	_rendered = camera;
+	_dirty = false;
 }
 
+
 #pragma mark -
 #pragma mark Gameplay Handling
 
@@ -200,6 +310,11 @@ void GameScene::update(float dt) {
 		return;
 	}
 
+	// A new world resolution needs a new frame
+	if (_target != nullptr && _scaler.update()) {
+		setDirty(true);
+	}
+
 	if (_gamestate->isPaused()) {
 		return;
 	}
@@ -211,15 +326,14 @@ void GameScene::update(float dt) {
 
 			// Access and initialize level
 			_gamestate = _assets->get<LevelController>(_levelKey)->getGameState();
-			activateWorldCollisions();
+			_gamestate->getWorld()->setSolverThreads(_solver);
+			_gameplay.init(_gamestate, _assets);
 
 			Size dimen = Application::get()->getDisplaySize();
 			dimen *= GAME_WIDTH / dimen.width;
 
 			createSceneGraph(dimen);
 
-			_enemyCount = _gamestate->getEnemies().size();
-
 			_reloading = false;
 		}
 		else {
@@ -248,6 +362,10 @@ void GameScene::update(float dt) {
 		setDebug(!isDebug());
 	}
 
+	if (_input.didPerf() && _perfnode != nullptr) {
+		_perfnode->setVisible(!_perfnode->isVisible());
+	}
+
 	if (_input.didExit()) {
 		CULog("Shutting down");
 		Application::get()->quit();
@@ -255,11 +373,10 @@ void GameScene::update(float dt) {
 
     std::shared_ptr<ObstacleWorld> world = _gamestate->getWorld();
     std::shared_ptr<PlayerModel> player = _gamestate->getPlayer();
-    Size gameBounds = _gamestate->getBounds().size;
-    Vec2 player_pos = player->getPosition();
     Vec2 currentAim = _input.getCurrentAim();
     // Much easier to work in degrees...
     float angle = currentAim.getAngle() * 180.0f / 3.14159f;
+    _gameplay.setAim(currentAim);
 
     // Touch input for sling is in pogress and sets the time slowing mechanic
     if(_input.didStartSling() && !player->isStunned()){
@@ -286,141 +403,22 @@ void GameScene::update(float dt) {
     }
 
     // Applies vector from touch input to player and set to charging state
-    if(_input.didSling(true) && player->canSling() && !player->isStunned()){
-        float angle = currentAim.getAngle() * 180.0f / 3.14159f;
-        cugl::Vec2 sling = _input.getLatestSlingVector();
-        player->applyLinearImpulse(sling);
-        player->setCharging(true);
-        // changes texture of nicoal
-        player->setDirectionTexture(angle, 2);
+    if(_input.didSling(true)){
+        _gameplay.sling(_input.getLatestSlingVector());
     }
 
-    // Caps player speed to MAX_PLAYER SPEED
-    if(player->getLinearVelocity().length() >= MAX_PLAYER_SPEED){
-        Vec2 capped_speed = player->getLinearVelocity().normalize().scale(MAX_PLAYER_SPEED);
-        player->setLinearVelocity(capped_speed);
-    }
-    
-    if(player->getCoalided() && player->getLinearVelocity().length() <= 0.0f){
-        if(player->isStunned()){
-            player->setDirectionTexture(player->getPlayerDirection(), 7);
-        } else {
-            player->setDirectionTexture(player->getPlayerDirection(), 0);
-            player ->setCoalided(false);
-        }
-    }
-
-    // Changes player state from charging if below speed threshold
-    if(player->getCharging() && player->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING){
-        player->setCharging(false);
-        player->_isSliding = true;
-        player->updateCircle(false);
-        // changes texture of nicoal
-        player->setDirectionTexture(angle, 3);
-    }
-    
-    if(player->_isSliding && player->getLinearVelocity().isNearZero()){
-        player->_isSliding = false;
-        player->updateCircle(false);
-        // changes texture of nicoal
-        player->setDirectionTexture(angle, 0);
-    }
-    
-	if (player->didFall()) {
-		player->setDirectionTexture(player->getPlayerDirection(), 8);
-		player->_drownTimer -= 1;
-		if (player->_drownTimer <= 0) {
-			_gameover = true;
-		}
-	}
-
     if(!player->canSling() || _input.getCameraPan().length()) {
         player->updateArrow(false);
         player->updateCircle(false);
     }
-    
-    // Applies movement vector to all enemies curently alive in the game and sets them to charging state
-	if (_enemyCount != 0) {
-		std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> enemiesToMove = _ai.getEnemyMoves(_gamestate);
-		for (std::tuple<std::shared_ptr<EnemyModel>, Vec2> pair : enemiesToMove) {
-			std::shared_ptr<EnemyModel> enemy = std::get<0>(pair);
-			Vec2 sling = std::get<1>(pair);
-			enemy->applyLinearImpulse(sling);
-			float angle = sling.getAngle(Vec2(-1.0f, 0.0f)) * 180.0f / 3.14159;
-
-			if (!enemy->isSpore()) {
-				enemy->setCharging(true);
-				enemy->setDirectionTexture(angle, enemy->isAcorn(), 2);
-			}
-		}
-	}
-
-	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
-		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
-		if (enemy->getCharging() && enemy->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING) {
-			enemy->setCharging(false);
-			enemy->setSliding(true);
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 3);
-		}
-
-		if (enemy->isSliding() && enemy->getLinearVelocity().isNearZero()) {
-			enemy->setSliding(false);
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 0);
-		}
-
-		if (enemy->getCoalided() && enemy->getLinearVelocity().length() <= 0.0f) {
-			if (enemy->isStunned()) {
-				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 6);
-			}
-			else {
-				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 0);
-				enemy->setCoalided(false);
-			}
-		}
-
-		if (enemy->isPrepping()) {
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 1);
-		}
-
-		if (!enemy->isRemoved() && enemy->didFall()) {
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
-			enemy->_drownTimer -= 1;
-			if (enemy->_drownTimer <= 0) {
-				removeEnemy(enemy);
-				_enemyCount--;
-			}
-		}
-	}
-    
-	if (player->getSparky()) {
-		player->updateSparks(true);
-		player->setSparky(false);
-		if (player->getLinearVelocity().length() > MIN_SPEED_FOR_CHARGING) {
-			player->setCharging(true);
-			player->setDirectionTexture(player->getPlayerDirection(), 5);
-		}
-	}
-	else {
-		player->updateSparks();
-	}
 
-	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
-		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
-		if (!enemy->isRemoved() && enemy->getSparky()) {
-			enemy->updateSparks(true);
-			enemy->setSparky(false);
-			if (enemy->getLinearVelocity().length() > MIN_SPEED_FOR_CHARGING) {
-				enemy->setCharging(true);
-				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 5);
-			}
-		}
-		else {
-			enemy->updateSparks();
-		}
+	// Play the rules of the level, including the physics step
+	_gamestate->getParticles()->update(dt);
+	_gameplay.update(dt);
+	if (_gameplay.isGameOver()) {
+		_gameover = true;
 	}
 
-	updateFriction();
-
 	bool noSmoothPan = false;
 	// Super collisions
 	/*if (player->isSuperCollide()) {
@@ -437,7 +435,7 @@ void GameScene::update(float dt) {
 	}*/
 
     // LEVEL COMPLETE: If all enemies are dead then level completed
-    if (_enemyCount == 0) {
+    if (_gameplay.isComplete()) {
         _complete = true;
 		getCamera()->setZoom(1);
     }
@@ -462,39 +460,6 @@ void GameScene::update(float dt) {
 
 	_gamestate->getWorldNode()->sortZOrder();
 
-    // Update the physics world
-    _gamestate->getWorld()->update(dt);
-    
-	for (int i = 0; i < _gamestate->getSpores().size(); i++) {
-		std::shared_ptr<EnemyModel> spore = _gamestate->getSpores()[i];
-		Vec2 spore_pos = spore->getPosition();
-
-		if (spore->isDestroyed()) {
-			removeEnemy(spore);
-		}
-
-		/** Need to remove spore from spore list? */
-		else if (!(spore_pos.x > 0 && spore_pos.y > 0 && spore_pos.x < _gamestate->getBounds().size.getIWidth() && spore_pos.y < _gamestate->getBounds().size.getIHeight())) {
-			removeEnemy(spore);
-		}
-
-		else if (spore->isDispersing()) {
-			spore->animateSpore();
-		}
-	}
-
-    for (int i = 0; i < _gamestate->getObjects().size(); i++) {
-        std::shared_ptr<ObjectModel> object = _gamestate->getObjects()[i];
-        if (object->isBroken()) {
-            removeObject(object);
-        }
-		else if (object->isAnimating()) {
-			object->animate();
-		}
-    }
-    
-    _gamestate->getWorld()->garbageCollect();
-
 	// update the camera
 	player->getNode()->getScene()->setOffset(cugl::Vec2(0,0));
 	cugl::Vec2 cameraPos = getCamera()->getPosition();
@@ -520,14 +485,15 @@ void GameScene::update(float dt) {
 		cameraTransX = playerPos.x - cameraPos.x;
 		cameraTransY = playerPos.y - cameraPos.y;
 
-		// smooth pan
+		// smooth pan (the follow rate is per 60 fps frame, so it is the same at any frame rate)
 		if (!noSmoothPan) {
+			float follow = 1.0f - powf(0.95f, dt * 60.0f);
 			if (std::abs(cameraTransX) > 5) {
-				cameraTransX *= .05;
+				cameraTransX *= follow;
 			}
 
 			if (std::abs(cameraTransY) > 5) {
-				cameraTransY *= .05;
+				cameraTransY *= follow;
 			}
 		}
 	}
@@ -549,134 +515,23 @@ void GameScene::update(float dt) {
     }
 	_gamestate->setUIPosition(getCamera()->getPosition());
 	getCamera()->translate(cugl::Vec2(round(cameraTransX),round(cameraTransY)));
-	
-}
-
-void GameScene::updateFriction() {
-	PlayerModel* player = _gamestate->getPlayer().get();
-	Vec2 player_pos = player->getPosition();
-	Size gameBounds = _gamestate->getBounds().size;
-
-    // LEVEL DEATH: Sets friction for player and checks if in bounds/death conditions for the game
-    if (player->inBounds(gameBounds.getIWidth(), gameBounds.getIHeight())) {
-        if (!player->getCharging()) {
-            float friction = _gamestate->getBoard()[std::max(0, (int)floor(player_pos.y-.25))][(int)floor(player_pos.x)];
-			if (friction == 0 && !player->didFall()) {
-				/*if (_gamestate->getBoard()[std::max(0, (int)floor(player_pos.y-.25))][std::min(gameBounds.getIWidth()-1, (int)floor(player_pos.x)-1)]) {
-					player->setPosition(player_pos.x + .3, player_pos.y);
-				}
-				if (_gamestate->getBoard()[std::max(0, (int)floor(player_pos.y-.25))][std::min(gameBounds.getIWidth()-1, (int)floor(player_pos.x+.5))]) {
-					player->setPosition(player_pos.x - .3, player_pos.y);
-				}
-				if (_gamestate->getBoard()[std::min(gameBounds.getIHeight()-1, (int)floor(player_pos.y+.25))][(int)floor(player_pos.x)]) {
-					player->setPosition(player_pos.x, player_pos.y - .3);
-				}*/
-
-				player->setFell();
-				player->setDirectionTexture(player->getPlayerDirection(), 8);
-			}
-            else if (friction != player->getFriction()) {
-                player->setFriction(friction);
-            }
-        }
-        else if (player->getFriction() > .1f) {
-            player->setFriction(0);
-        }
-    }
-    else {
-        player->setFriction(0);
-        player->setCharging(false);
-        player->setDirectionTexture(player->getPlayerDirection(), 8);
-        _gameover = true;
-    }
-
-	// Loops through enemies and sets friction and also checks for in bounds/death conditions
-	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
-		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
-        if(enemy->isRemoved())
-            continue;
-		Vec2 enemy_pos = enemy->getPosition();
-		if (!enemy->isSpore() && enemy_pos.x > 0 && enemy_pos.y > 0 && enemy_pos.x < _gamestate->getBounds().size.getIWidth() && enemy_pos.y < _gamestate->getBounds().size.getIHeight()) {
-			float friction = _gamestate->getBoard()[(int)floor(enemy_pos.y)][(int)floor(enemy_pos.x)];
-            if(!enemy->getCharging()) {
-                if(friction == 0 && !enemy->didFall()) {
-					enemy->setFell();
-					enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
-                }
-                else if(friction != enemy->getFriction()) {
-                    enemy->setFriction(friction);
-                }
-            }
-			else if (enemy->getFriction() > .1f) {
-				enemy->setFriction(0);
-			}
-        }
-        else if (!enemy->didFall()) {
-			enemy->setFell();
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
-		}
-		else {
-			enemy->setFriction(0);
-			enemy->setCharging(false);
-			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
-		}
-        
-        // Caps enemy speed to MAX_PLAYER SPEED
-        /*if(enemy->getLinearVelocity().length() >= MAX_PLAYER_SPEED){
-            Vec2 capped_speed = enemy->getLinearVelocity().normalize().scale(MAX_PLAYER_SPEED);
-            enemy->setLinearVelocity(capped_speed);
-        }*/
-        
-        // Changes enemy state from charging if below speed threshold
-        if(enemy->getCharging() && enemy->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING){
-            enemy->setCharging(false);
-		}
-		else {
-			enemy->setCharging(true);
-		}
-	}
 
-	// Loops through objects and sets friction and also checks for in bounds/death conditions
-	for (int i = 0; i < _gamestate->getObjects().size(); i++) {
-		std::shared_ptr<ObjectModel> object = _gamestate->getObjects()[i];
-		Vec2 object_pos = object->getPosition();
-		if (object_pos.x > 0 && object_pos.y > 0 && object_pos.x < _gamestate->getBounds().size.getIWidth() && object_pos.y < _gamestate->getBounds().size.getIHeight()) {
-			float friction = _gamestate->getBoard()[(int)floor(object_pos.y)][(int)floor(object_pos.x)];
-			if (friction == 0) {
-				if (object->isMovable()) {
-					object->animate();
-				}
-			}
-			else if (friction != object->getFriction()) {
-				object->setFriction(friction);
-			}
-		}
-		else {
-			object->setFriction(0);
-		}
+	// only draw the units in view (padded so sprites do not pop at the edges)
+	cugl::Vec2 viewBottom = Scene::screenToWorldCoords(cugl::Vec2());
+	cugl::Vec2 viewTop = Scene::screenToWorldCoords(cugl::Vec2(xMax,yMax));
+	cugl::Vec2 viewMin(std::min(viewBottom.x, viewTop.x), std::min(viewBottom.y, viewTop.y));
+	cugl::Vec2 viewMax(std::max(viewBottom.x, viewTop.x), std::max(viewBottom.y, viewTop.y));
+	viewMin /= _gamestate->getDrawScale();
+	viewMax /= _gamestate->getDrawScale();
+	_gamestate->cullUnits(cugl::Rect(viewMin - cugl::Vec2::ONE, (viewMax - viewMin) + 2 * cugl::Vec2::ONE));
+
+	// pin the performance overlay to the top left of the view
+	if (_perfnode != nullptr && _perfnode->isVisible()) {
+		_perfnode->setPosition(Scene::screenToWorldCoords(cugl::Vec2(8, 8)));
+		_perfnode->update(dt);
 	}
 }
 
-void GameScene::removeEnemy(std::shared_ptr<EnemyModel> enemy) {
-	// do not attempt to remove a bullet that has already been removed
-	if (enemy->isRemoved()) {
-		return;
-	}
-	_gamestate->getRootNode()->getChild(0)->removeChild(enemy->getNode());
-	enemy->setDebugScene(nullptr);
-	enemy->markRemoved(true);
-}
-
-void GameScene::removeObject(std::shared_ptr<ObjectModel> object) {
-	// do not attempt to remove a bullet that has already been removed
-	if (object->isRemoved()) {
-		return;
-	}
-	_gamestate->getRootNode()->getChild(0)->removeChild(object->getNode());
-	object->setDebugScene(nullptr);
-	object->markRemoved(true);
-}
-
 /**
 * Resets the status of the game so that we can play again.
 *
@@ -690,12 +545,12 @@ void GameScene::reset(const std::string& file) {
 	_reloading = true;
 	_assets->load<LevelController>(_levelKey, file);
 	_gamestate = _assets->get<LevelController>(_levelKey)->getGameState();
+	_gamestate->getWorld()->setSolverThreads(_solver);
 	setComplete(false);
 	_gameover = false;
 	_complete = false;
 	_gamestate->resetDidClickMenu();
-
-	_ai.init(_gamestate);
+	_scaler.reset();
     
     // reset the camera
     //cugl::Vec2 gameCenter = _gamestate->getBounds().size * 64. / 2.;
@@ -8,13 +8,14 @@
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <vector>
 #include "InputController.h"
-#include "CollisionController.h"
-#include "AIController.h"
+#include "GameplayController.h"
 #include "GameState.h"
 #include "LevelController.h"
 #include "PlayerModel.h"
 #include "EnemyModel.h"
 #include "ObjectModel.h"
+#include "PerfHUD.h"
+#include "ResolutionScaler.h"
 
 using namespace cugl;
 
@@ -37,10 +38,8 @@ protected:
 	// CONTROLLERS
 	/** Controller for abstracting out input across multiple platforms */
 	InputController _input;
-	/** Controller for handling collisions using Box2D */
-	CollisionController _collisions;
-	/** Controller for determining AI behavior */
-	AIController _ai;
+	/** Controller for the rules of the level (collisions, AI, win and loss) */
+	GameplayController _gameplay;
 
 	// VIEW
 	/** Reference to the physics root of the scene graph */
@@ -51,6 +50,14 @@ protected:
 	std::shared_ptr<Label> _losenode;
 	/** Reference to the reset message label */
 	std::shared_ptr<Label> _loadnode;
+	/** Reference to the performance overlay */
+	std::shared_ptr<PerfHUD> _perfnode;
+	/** The offscreen target to draw the world to (nullptr to draw it natively) */
+	std::shared_ptr<RenderTarget> _target;
+	/** Controller for the resolution of the world */
+	ResolutionScaler _scaler;
+	/** The thread pool to solve the world islands on (nullptr to solve serially) */
+	std::shared_ptr<ThreadPool> _solver;
 	
 	/** The current game state */
 	std::shared_ptr<GameState> _gamestate;
@@ -64,8 +71,6 @@ protected:
 	/** WHether or not the level is reloading after a loss or reset */
 	bool _reloading;
 
-	/** Number of enemies remaining. */
-	int _enemyCount;
     float counter;
     float deltaImage;
     bool up;
@@ -74,13 +79,6 @@ protected:
 	/** Level key for loading correct tileset. */
 	std::string _levelKey;
 
-	/**
-	* Activates world collision callbacks on the given physics world and sets the onBeginContact and beforeSolve callbacks
-	*
-	* @param world the physics world to activate world collision callbacks on
-	*/
-	void activateWorldCollisions();
-
 
 public:
 #pragma mark -
@@ -195,6 +193,62 @@ public:
 #pragma mark Scene Graph
 	void createSceneGraph(Size dimen);
 
+	/**
+	* Sets the offscreen target to draw the world to.
+	*
+	* With a target, the world is drawn at a resolution that adapts to the
+	* GPU, and is then scaled up to the display.  The buttons and messages
+	* are always drawn at the native resolution.  The target should be the
+	* size of the display (in pixels), and must be allocated on the thread
+	* that owns the OpenGL context.  A nullptr target draws the world natively.
+	*
+	* @param target	The offscreen target to draw the world to
+	*/
+	void setWorldTarget(const std::shared_ptr<RenderTarget>& target);
+
+	/**
+	* Returns the offscreen target to draw the world to.
+	*
+	* @return the offscreen target to draw the world to.
+	*/
+	const std::shared_ptr<RenderTarget>& getWorldTarget() const { return _target; }
+
+	/**
+	* Sets the thread pool to solve the world islands on.
+	*
+	* The pool is handed to the world of every level this scene plays, so
+	* that the solver threads outlive the levels.  A nullptr pool solves
+	* each world on the game thread.
+	*
+	* @param pool	The thread pool to solve the world islands on
+	*/
+	void setSolverThreads(const std::shared_ptr<ThreadPool>& pool);
+
+	/**
+	* Returns the thread pool to solve the world islands on.
+	*
+	* @return the thread pool to solve the world islands on.
+	*/
+	const std::shared_ptr<ThreadPool>& getSolverThreads() const { return _solver; }
+
+	/**
+	* Returns the current scale of the world resolution.
+	*
+	* @return the current scale of the world resolution.
+	*/
+	float getResolutionScale() const { return _target == nullptr ? 1.0f : _scaler.getScale(); }
+
+	/**
+	* Draws the scene with the given SpriteBatch.
+	*
+	* If the world is drawn at a reduced resolution, it is drawn to the world
+	* target first and scaled up.  The buttons and messages are then drawn
+	* over it at the native resolution.
+	*
+	* @param batch     The SpriteBatch to draw with.
+	*/
+	virtual void render(const std::shared_ptr<SpriteBatch>& batch) override;
+
 #pragma mark -
 #pragma mark Gameplay Handling
 	/**
@@ -206,12 +260,6 @@ public:
 	*/
 	void update(float dt);
 
-	void updateFriction();
-
-	void removeEnemy(std::shared_ptr<EnemyModel> enemy);
-	
-	void removeObject(std::shared_ptr<ObjectModel> object);
-
 	/**
 	* Resets the status of the game so that we can play again.
 	*/
@@ -23,6 +23,7 @@ void GameState::clearRootNode() {
     _worldnode->removeFromParent();
     _worldnode->removeAllChildren();
     _worldnode = nullptr;
+    _particles = nullptr;
     
     _debugnode->removeFromParent();
     _debugnode->removeAllChildren();
@@ -36,6 +37,7 @@ void GameState::clearRootNode() {
  */
 void GameState::dispose() {
 	_world = nullptr;
+	_timers = nullptr;
 	_uiNode = nullptr;
 	_pauseButton = nullptr;
 	_playButton = nullptr;
@@ -46,9 +48,97 @@ void GameState::dispose() {
 	_winText = nullptr;
 	_gameOverScreen = nullptr;
 	_gameOverText = nullptr;
+	_units.clear();
+	_shownUnits.clear();
+	_enemies.clear();
+	_spores.clear();
+	_objects.clear();
 	clearRootNode();
 }
 
+/**
+ * Drops the enemies, spores and objects marked as removed.
+ *
+ * This should be called once per frame, after the loops over the entities.
+ */
+void GameState::garbageCollect() {
+	// The hash goes first, while the registries still own the units
+	_units.garbageCollect();
+	_enemies.garbageCollect();
+	_spores.garbageCollect();
+	_objects.garbageCollect();
+}
+
+/**
+ * Sets the player in this game level.
+ */
+void GameState::setPlayer(std::shared_ptr<PlayerModel> player) {
+	_player = player;
+	_units.clear(SpatialHash::PLAYERS);
+	if (player != nullptr) {
+		_units.insert(player, SpatialHash::PLAYERS);
+	}
+}
+
+/**
+ * Sets the active enemies in this game level.
+ */
+void GameState::setEnemies(const std::vector<std::shared_ptr<EnemyModel>>& enemies) {
+	_enemies = EntityRegistry<EnemyModel>(enemies);
+	_units.clear(SpatialHash::ENEMIES);
+	for (auto it = enemies.begin(); it != enemies.end(); ++it) {
+		_units.insert(*it, SpatialHash::ENEMIES);
+	}
+}
+
+/**
+ * Adds a spore to this game level.
+ *
+ * @return the handle of the new spore
+ */
+EntityHandle GameState::addSpore(const std::shared_ptr<EnemyModel>& spore) {
+	_units.insert(spore, SpatialHash::SPORES);
+	return _spores.add(spore);
+}
+
+/**
+ * Sets the active objects in this game level.
+ */
+void GameState::setObjects(const std::vector<std::shared_ptr<ObjectModel>>& objects) {
+	_objects = EntityRegistry<ObjectModel>(objects);
+	_units.clear(SpatialHash::OBJECTS);
+	for (auto it = objects.begin(); it != objects.end(); ++it) {
+		_units.insert(*it, SpatialHash::OBJECTS);
+	}
+}
+
+/**
+ * Hides the enemy, object and spore nodes outside of the view.
+ *
+ * @param view  The visible region in physics coordinates
+ */
+void GameState::cullUnits(const Rect& view) {
+	for (auto it = _shownUnits.begin(); it != _shownUnits.end(); ++it) {
+		(*it)->setVisible(false);
+	}
+	_shownUnits.clear();
+
+	_units.queryRect(view, SpatialHash::ENEMIES | SpatialHash::OBJECTS | SpatialHash::SPORES,
+		[this](const std::shared_ptr<Obstacle>& obstacle, Uint32 category) {
+		std::shared_ptr<Node> node;
+		if (category == SpatialHash::OBJECTS) {
+			node = static_cast<ObjectModel*>(obstacle.get())->getNode();
+		} else {
+			node = static_cast<EnemyModel*>(obstacle.get())->getNode();
+		}
+		if (node != nullptr) {
+			node->setVisible(true);
+			_shownUnits.push_back(node);
+		}
+		return true;
+	});
+}
+
 /**
 * Sets the scene graph node for drawing purposes.
 *
@@ -71,14 +161,30 @@ void GameState::setRootNode(const std::shared_ptr<Node>& node) {
 	_worldnode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
 	_worldnode->setPosition(Vec2::ZERO);
 
-	_debugnode = Node::alloc();
+	// The debug node draws the world itself, so obstacles need no debug scene
+	_debugnode = ObstacleDebugNode::allocWithWorld(_world);
 	_debugnode->setScale(_scale); // Debug node draws in PHYSICS coordinates
 	_debugnode->setAnchor(Vec2::ANCHOR_BOTTOM_LEFT);
 	_debugnode->setPosition(Vec2::ZERO);
+	_debugnode->setVisible(false);
+	if (_world != nullptr) {
+		_world->setDebugFlags(ObstacleWorld::DEBUG_SHAPES | ObstacleWorld::DEBUG_CONTACTS);
+	}
 
 	_rootnode->addChild(_worldnode, 0);
 	_rootnode->addChild(_debugnode, 1);
 
+	// All collision sparks share one particle system
+	_particles = ParticleSystemNode::alloc();
+	ParticleSystemNode::Emitter sparks;
+	sparks.texture = _assets->get<Texture>("sparks");
+	sparks.cols = 6;
+	sparks.minLifetime = SPARKS_LIFETIME;
+	sparks.maxLifetime = SPARKS_LIFETIME;
+	sparks.capacity = SPARKS_CAPACITY;
+	_sparksEmitter = _particles->addEmitter(sparks);
+	_worldnode->addChild(_particles, EFFECT_PRIORITY);
+
 //    // Add the individual elements
 //    for (int i = 0; i < _tiles.size(); i++) {
 //        std::shared_ptr<TileModel> tile = _tiles[i];
@@ -111,76 +217,74 @@ void GameState::setRootNode(const std::shared_ptr<Node>& node) {
 //        _worldnode->addChild(dirtNode, TILE_PRIORITY);
 //    }
 	// Add the individual elements
-    for (int i = 0; i < _tiles.size(); i++) {
-        std::shared_ptr<TileModel> tile = _tiles[i];
-        std::shared_ptr<PolygonNode> dirtNode = nullptr;
-        std::shared_ptr<PolygonNode> iceNode = nullptr;
-        std::shared_ptr<PolygonNode> sandNode = nullptr;
-        std::shared_ptr<PolygonNode> waterDecal = nullptr;
-        std::shared_ptr<PolygonNode> waterBase = nullptr;
-
-        if(tile->hasWaterDecal()){
-            double* tileSubtexture = tile->getWaterDecalSubTexture();
-            waterDecal = PolygonNode::allocWithTexture(_assets->get<Texture>(tile->getWaterTextureKey())->getSubTexture(tileSubtexture[0], tileSubtexture[1], tileSubtexture[2], tileSubtexture[3]));
-        }
-        if(tile->hasWaterBase()){
-            double* tileSubtexture = tile->getWaterBaseSubTexture();
-            waterBase = PolygonNode::allocWithTexture(_assets->get<Texture>(tile->getWaterTextureKey())->getSubTexture(tileSubtexture[0], tileSubtexture[1], tileSubtexture[2], tileSubtexture[3]));
-            if(waterDecal != nullptr){
-                waterBase->setPosition(.5f *_scale.x, +.5f *_scale.y);
-				waterBase->setScale(1.01f);
-                waterDecal->addChild(waterBase);
-            }
-        }
-        if(tile->getType() == TILE_TYPE::GRASS || tile->getType() == TILE_TYPE::ICE || tile->getType() == TILE_TYPE::SAND){
-            double* tileSubtexture = tile->getDirtSubTexture();
-            dirtNode = PolygonNode::allocWithTexture(_assets->get<Texture>(tile->getDirtTextureKey())->getSubTexture(tileSubtexture[0], tileSubtexture[1], tileSubtexture[2], tileSubtexture[3]));
-            if(waterBase!=nullptr){
-                dirtNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
-				dirtNode->setScale(1.01f);
-                waterBase->addChild(dirtNode);
-            } else if(waterDecal != nullptr) {
-                waterDecal->addChild(dirtNode);
-                dirtNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
-				dirtNode->setScale(1.01f);
-            }
-        }
-        if(tile->getType() == TILE_TYPE::ICE || tile->getType() == TILE_TYPE::SAND){
-            double* tileSubtexture = tile->getIceSubTexture();
-            iceNode = PolygonNode::allocWithTexture(_assets->get<Texture>(tile->getIceTextureKey())->getSubTexture(tileSubtexture[0], tileSubtexture[1], tileSubtexture[2], tileSubtexture[3]));
-            iceNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
-			iceNode->setScale(1.01f);
-            dirtNode->addChild(iceNode);
-        }
-        if(tile->getType() == TILE_TYPE::SAND){
-            double* tileSubtexture = tile->getSandSubTexture();
-            sandNode = PolygonNode::allocWithTexture(_assets->get<Texture>(tile->getIceTextureKey())->getSubTexture(tileSubtexture[0], tileSubtexture[1], tileSubtexture[2], tileSubtexture[3]));
-            sandNode->setPosition(.5f *_scale.x, +.5f *_scale.y);;
-			sandNode->setScale(1.01f);
-            iceNode->addChild(sandNode);
-        }
-        if(waterDecal!=nullptr){
-            tile->setNode(waterDecal);
-            waterDecal->setPosition(tile->getPosition()*_scale);
-			waterDecal->setScale(1.005f);
-            _worldnode->addChild(waterDecal, TILE_PRIORITY);
-        }else if(waterBase!=nullptr){
-            tile->setNode(waterBase);
-            waterBase->setPosition(tile->getPosition()*_scale);
-			waterBase->setScale(1.005f);
-            _worldnode->addChild(waterBase, TILE_PRIORITY);
-        }
-    }
+	// Sub-textures are shared by every tile with the same tileset index
+	std::shared_ptr<TileSet> forest = TileSet::alloc(_assets->get<Texture>("tileset_forest.png"), 21, 8);
+	std::shared_ptr<TileSet> water  = TileSet::alloc(_assets->get<Texture>("tileset_water.png"), 7, 8);
+	const Rect& bounds = getBounds();
+	for (int y = 0; y < bounds.size.getIHeight(); y++) {
+		for (int x = 0; x < bounds.size.getIWidth(); x++) {
+			const TileModel& tile = _tileBoard[y][x];
+			if (tile.isEmpty()) {
+				continue;
+			}
+			std::shared_ptr<PolygonNode> dirtNode = nullptr;
+			std::shared_ptr<PolygonNode> iceNode = nullptr;
+			std::shared_ptr<PolygonNode> sandNode = nullptr;
+			std::shared_ptr<PolygonNode> waterDecal = nullptr;
+			std::shared_ptr<PolygonNode> waterBase = nullptr;
+
+			if (tile.hasLayer(TileModel::WATER_DECAL)) {
+				waterDecal = PolygonNode::allocWithTexture(water->getTile(tile.getLayer(TileModel::WATER_DECAL)));
+			}
+			if (tile.hasLayer(TileModel::WATER_BASE)) {
+				waterBase = PolygonNode::allocWithTexture(water->getTile(tile.getLayer(TileModel::WATER_BASE)));
+				if (waterDecal != nullptr) {
+					waterBase->setPosition(.5f *_scale.x, +.5f *_scale.y);
+					waterBase->setScale(1.01f);
+					waterDecal->addChild(waterBase);
+				}
+			}
+			if (tile.hasLayer(TileModel::DIRT)) {
+				dirtNode = PolygonNode::allocWithTexture(forest->getTile(tile.getLayer(TileModel::DIRT)));
+				if (waterBase != nullptr) {
+					dirtNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
+					dirtNode->setScale(1.01f);
+					waterBase->addChild(dirtNode);
+				} else if (waterDecal != nullptr) {
+					waterDecal->addChild(dirtNode);
+					dirtNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
+					dirtNode->setScale(1.01f);
+				}
+			}
+			if (dirtNode != nullptr && tile.hasLayer(TileModel::ICE)) {
+				iceNode = PolygonNode::allocWithTexture(forest->getTile(tile.getLayer(TileModel::ICE)));
+				iceNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
+				iceNode->setScale(1.01f);
+				dirtNode->addChild(iceNode);
+			}
+			if (iceNode != nullptr && tile.hasLayer(TileModel::SAND)) {
+				sandNode = PolygonNode::allocWithTexture(forest->getTile(tile.getLayer(TileModel::SAND)));
+				sandNode->setPosition(.5f *_scale.x, +.5f *_scale.y);
+				sandNode->setScale(1.01f);
+				iceNode->addChild(sandNode);
+			}
+
+			Vec2 pos(x + .5f, y + .5f);
+			if (waterDecal != nullptr) {
+				waterDecal->setPosition(pos*_scale);
+				waterDecal->setScale(1.005f);
+				_worldnode->addChild(waterDecal, TILE_PRIORITY);
+			} else if (waterBase != nullptr) {
+				waterBase->setPosition(pos*_scale);
+				waterBase->setScale(1.005f);
+				_worldnode->addChild(waterBase, TILE_PRIORITY);
+			}
+		}
+	}
 
 	if (_player != nullptr) {
         Rect nicoal_start = Rect(0.0f,448.0f,64.0f,64.0f);
         auto playerNode = PolygonNode::allocWithTexture(_assets->get<Texture>(_player->getTextureKey()), nicoal_start);
-        
-		//Collision sparks node
-		std::shared_ptr<cugl::AnimationNode> sparks = AnimationNode::alloc(_assets->get<Texture>("sparks"), 1, 6);
-		sparks->setVisible(false);
-		_player->setSparks(sparks);
-		playerNode->addChild(sparks);
 
         _player->setNode(playerNode);
 		_player->setDrawScale(_scale.x);
@@ -213,20 +317,12 @@ void GameState::setRootNode(const std::shared_ptr<Node>& node) {
                 enemyNode = PolygonNode::allocWithTexture(_assets->get<Texture>(enemy->getTextureKey()),Rect(0,0,64,64));
             }
 
-			//Collision sparks node
-			std::shared_ptr<cugl::AnimationNode> sparks = AnimationNode::alloc(_assets->get<Texture>("sparks"), 1, 6);
-			sparks->setVisible(false);
-			if (enemy->isOnion()) {
-				sparks->setAnchor(Vec2(0, 0));
-				sparks->setPosition(Vec2(32, 10));
-			}
-			enemy->setSparks(sparks);
-			enemyNode->addChild(sparks);
-
 			enemy->setNode(enemyNode);
 			enemy->setDrawScale(_scale.x);
 			//enemy->setDebugScene(_debugnode);
 
+			// Hidden until the first call to cullUnits
+			enemyNode->setVisible(false);
 			_worldnode->addChild(enemyNode, UNIT_PRIORITY);
 		}
 	}
@@ -253,6 +349,7 @@ void GameState::setRootNode(const std::shared_ptr<Node>& node) {
 				_worldnode->addChild(objectNode, UNIT_PRIORITY);
 			}
 			
+			object->getNode()->setVisible(false);
 			object->setDrawScale(_scale.x);
             
 			//object->setDebugScene(_debugnode);
@@ -390,14 +487,32 @@ void GameState::setRootNode(const std::shared_ptr<Node>& node) {
 }
 
 void GameState::addSporeNode(std::shared_ptr<EnemyModel> spore) {
+    // A simulated level has no scene graph
+    if (_worldnode == nullptr) {
+        return;
+    }
     auto sporeNode = AnimationNode::alloc(_assets->get<Texture>(spore->getTextureKey()), 1, 7);
 	spore->setNode(sporeNode);
     spore->setDrawScale(_scale.x);
     //spore->setDebugScene(_debugnode);
     
+    sporeNode->setVisible(false);
     _worldnode->addChild(sporeNode, UNIT_PRIORITY);
 }
 
+/**
+* Bursts collision sparks on a unit.
+*
+* @param node   The scene graph node of the unit
+* @param point  The center of the sparks in the coordinates of node
+*/
+void GameState::emitSparks(const std::shared_ptr<Node>& node, const Vec2& point) {
+	if (_particles == nullptr || node == nullptr) {
+		return;
+	}
+	_particles->burst(_sparksEmitter, node->nodeToParentCoords(point));
+}
+
 void GameState::showGameOverScreen(bool showing) {
 	if (showing) {
 		_quitButton->setVisible(true);
@@ -462,7 +577,8 @@ void GameState::didPause() {
 /**
  * Toggles whether to show the debug layer of this game world.
  *
- * The debug layer displays wireframe outlines of the physics fixtures.
+ * The debug layer displays wireframe outlines of the physics fixtures and
+ * the contact points.  Hiding it skips the debug drawing entirely.
  *
  * @param  flag whether to show the debug layer of this game world
  */
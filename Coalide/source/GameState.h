@@ -10,6 +10,9 @@
 #include <cugl/assets/CUAsset.h>
 #include <cugl/io/CUJsonReader.h>
 #include "Constants.h"
+#include "EntityRegistry.h"
+#include "TimerWheel.h"
+#include "SpatialHash.h"
 
 using namespace cugl;
 
@@ -39,17 +42,25 @@ protected:
 
 	std::shared_ptr<Node> _rootnode;
 	std::shared_ptr<Node> _worldnode;
-	std::shared_ptr<Node> _debugnode;
+	std::shared_ptr<ObstacleDebugNode> _debugnode;
+	/** The particle effects, drawn above the units */
+	std::shared_ptr<ParticleSystemNode> _particles;
+	/** The emitter of the collision sparks */
+	int _sparksEmitter;
 
 	std::shared_ptr<ObstacleWorld> _world;
+	std::shared_ptr<TimerWheel> _timers;
     std::shared_ptr<PlayerModel> _player;
-	std::vector<std::shared_ptr<EnemyModel>> _enemies;
-	std::vector<std::shared_ptr<ObjectModel>> _objects;
-	std::vector<std::shared_ptr<TileModel>> _tiles;
-	std::vector<std::shared_ptr<EnemyModel>> _spores;
+	EntityRegistry<EnemyModel> _enemies;
+	EntityRegistry<ObjectModel> _objects;
+	EntityRegistry<EnemyModel> _spores;
+	/** The spatial hash of the player, enemies, objects and spores */
+	SpatialHash _units;
+	/** The unit nodes shown by the last call to cullUnits */
+	std::vector<std::shared_ptr<Node>> _shownUnits;
 
 	int** _board;
-	std::shared_ptr<TileModel>** _tileBoard;
+	TileModel** _tileBoard;
 
 	// BUTTONS
 	std::shared_ptr<cugl::Node> _uiNode;
@@ -94,7 +105,7 @@ public:
 	/**
 	* Creates a new game state representing an empty level.
 	*/
-	GameState() { }
+	GameState() : _sparksEmitter(0) { }
 
 	/**
 	* Destroys this level, releasing all resources.
@@ -150,55 +161,68 @@ public:
 	/**
 	* Sets the player in this game level.
 	*/
-	void setPlayer(std::shared_ptr<PlayerModel> player) { _player = player; }
+	void setPlayer(std::shared_ptr<PlayerModel> player);
 
 	/**
 	* Returns the active enemies in this game level.
 	*
 	* @return the active enemies in this game level.
 	*/
-	std::vector<std::shared_ptr<EnemyModel>>& getEnemies() { return _enemies; }
+	EntityRegistry<EnemyModel>& getEnemies() { return _enemies; }
 
 	/**
 	* Sets the active enemies in this game level.
 	*/
-	void setEnemies(std::vector<std::shared_ptr<EnemyModel>> enemies) { _enemies = enemies; }
+	void setEnemies(const std::vector<std::shared_ptr<EnemyModel>>& enemies);
 
 	/**
-	* Returns the active enemies in this game level.
+	* Returns the active spores in this game level.
 	*
-	* @return the active enemies in this game level.
+	* @return the active spores in this game level.
 	*/
-	std::vector<std::shared_ptr<EnemyModel>>& getSpores() { return _spores; }
+	EntityRegistry<EnemyModel>& getSpores() { return _spores; }
 
 	/**
-	* Sets the active enemies in this game level.
+	* Adds a spore to this game level.
+	*
+	* @return the handle of the new spore
 	*/
-	void setSpores(std::vector<std::shared_ptr<EnemyModel>> spores) { _spores = spores; }
+	EntityHandle addSpore(const std::shared_ptr<EnemyModel>& spore);
 
 	/**
-	* Returns the active enemies in this game level.
+	* Returns the active objects in this game level.
 	*
-	* @return the active enemies in this game level.
+	* @return the active objects in this game level.
 	*/
-	std::vector<std::shared_ptr<ObjectModel>>& getObjects() { return _objects; }
+	EntityRegistry<ObjectModel>& getObjects() { return _objects; }
 
 	/**
-	* Sets the active enemies in this game level.
+	* Sets the active objects in this game level.
 	*/
-	void setObjects(std::vector<std::shared_ptr<ObjectModel>> objects) { _objects = objects; }
+	void setObjects(const std::vector<std::shared_ptr<ObjectModel>>& objects);
 
 	/**
-	* Returns the floor tiles in this game level.
+	* Returns the spatial hash of the units in this game level.
 	*
-	* @return the floor tiles in this game level.
+	* Update the hash after every physics step, before any queries.
+	*
+	* @return the spatial hash of the units in this game level.
 	*/
-	std::vector<std::shared_ptr<TileModel>>& getTiles() { return _tiles; }
+	SpatialHash& getUnits() { return _units; }
 
 	/**
-	* Sets the floor tiles in this game level.
+	* Hides the enemy, object and spore nodes outside of the view.
+	*
+	* @param view  The visible region in physics coordinates
 	*/
-	void setTiles(std::vector<std::shared_ptr<TileModel>> tiles) { _tiles = tiles; }
+	void cullUnits(const Rect& view);
+
+	/**
+	* Drops the enemies, spores and objects marked as removed.
+	*
+	* This should be called once per frame, after the loops over the entities.
+	*/
+	void garbageCollect();
 
 	/**
 	* Returns the physics world of this game level.
@@ -212,6 +236,18 @@ public:
 	*/
 	void setWorld(std::shared_ptr<ObstacleWorld> world) { _world = world; }
 
+	/**
+	* Returns the simulation timers of this game level.
+	*
+	* @return the simulation timers of this game level.
+	*/
+	std::shared_ptr<TimerWheel>& getTimers() { return _timers; }
+
+	/**
+	* Sets the simulation timers of this game level.
+	*/
+	void setTimers(std::shared_ptr<TimerWheel> timers) { _timers = timers; }
+
 	/**
 	* Returns the physics world of this game level.
 	*
@@ -224,12 +260,17 @@ public:
 	*/
 	void setBoard(int** board) { _board = board; }
 
-	std::shared_ptr<TileModel>** getTileBoard() { return _tileBoard; }
+	/**
+	* Returns the floor tiles of this game level, indexed by [y][x].
+	*
+	* @return the floor tiles of this game level, indexed by [y][x].
+	*/
+	TileModel** getTileBoard() { return _tileBoard; }
 
 	/**
-	* Sets the physics world of this game level.
+	* Sets the floor tiles of this game level, indexed by [y][x].
 	*/
-	void setTileBoard(std::shared_ptr<TileModel>** tileBoard) { _tileBoard = tileBoard; }
+	void setTileBoard(TileModel** tileBoard) { _tileBoard = tileBoard; }
 
 
 #pragma mark Physics Attributes
@@ -277,6 +318,23 @@ public:
 
 	void addSporeNode(const std::shared_ptr<EnemyModel> spore);
 
+	/**
+	* Returns the particle effects of this level.
+	*
+	* @return the particle effects of this level.
+	*/
+	const std::shared_ptr<ParticleSystemNode>& getParticles() const { return _particles; }
+
+	/**
+	* Bursts collision sparks on a unit.
+	*
+	* @param node   The scene graph node of the unit
+	* @param point  The center of the sparks in the coordinates of node
+	*
+	* This does nothing if the level has no scene graph.
+	*/
+	void emitSparks(const std::shared_ptr<Node>& node, const Vec2& point = Vec2::ZERO);
+
 	void showGameOverScreen(bool show);
 	void showWinScreen(bool show);
 
@@ -304,7 +362,8 @@ public:
 	/**
 	* Toggles whether to show the debug layer of this game world.
 	*
-	* The debug layer displays wireframe outlines of the physics fixtures.
+	* The debug layer displays wireframe outlines of the physics fixtures and
+	* the contact points.  Hiding it skips the debug drawing entirely.
 	*
 	* @param  flag whether to show the debug layer of this game world
 	*/
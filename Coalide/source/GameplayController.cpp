@@ -0,0 +1,357 @@
+//
+//	GameplayController.cpp
+//	Coalide
+//
+#include "GameplayController.h"
+#include "PlayerModel.h"
+#include "EnemyModel.h"
+#include "ObjectModel.h"
+#include "Constants.h"
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Constructors
+/**
+* Initializes the rules for the given level.
+*
+* This activates the collision callbacks of the level world. Without
+* assets, collisions are silent.
+*
+* @param gamestate	The level to play
+* @param assets		The loaded assets (or nullptr for a silent level)
+*
+* @return true if the controller is initialized properly, false otherwise.
+*/
+bool GameplayController::init(const std::shared_ptr<GameState>& gamestate, const std::shared_ptr<AssetManager>& assets) {
+	if (gamestate == nullptr) {
+		return false;
+	}
+	_collisions.dispose();
+
+	_gamestate = gamestate;
+	_collisions.init(assets);
+	_ai.init(_gamestate);
+
+	_enemyCount = _gamestate->getEnemies().size();
+	_complete = false;
+	_gameover = false;
+	_aimAngle = 0;
+
+	// Activate the collision callbacks for the physics world
+	_gamestate->getWorld()->activateCollisionCallbacks(true);
+	_gamestate->getWorld()->onBeginContact = [this](b2Contact* contact) {
+		_collisions.beginContact(contact);
+	};
+	_gamestate->getWorld()->beforeSolve = [this](b2Contact* contact, const b2Manifold* oldManifold) {
+		_collisions.beforeSolve(contact, oldManifold);
+	};
+	return true;
+}
+
+void GameplayController::dispose() {
+	if (_gamestate != nullptr && _gamestate->getWorld() != nullptr) {
+		_gamestate->getWorld()->onBeginContact = nullptr;
+		_gamestate->getWorld()->beforeSolve = nullptr;
+	}
+	_collisions.dispose();
+	_ai.dispose();
+	_gamestate = nullptr;
+	_enemyCount = 0;
+	_complete = false;
+	_gameover = false;
+}
+
+
+#pragma mark -
+#pragma mark Gameplay Handling
+/**
+* Slings the player, if the player is able to.
+*
+* @param impulse	The sling vector
+*
+* @return true if the player was slung
+*/
+bool GameplayController::sling(const Vec2& impulse) {
+	std::shared_ptr<PlayerModel> player = _gamestate->getPlayer();
+	if (!player->canSling() || player->isStunned()) {
+		return false;
+	}
+	Vec2 sling = impulse;
+	player->applyLinearImpulse(sling);
+	player->setCharging(true);
+	// changes texture of nicoal
+	player->setDirectionTexture(_aimAngle, 2);
+	return true;
+}
+
+/**
+* Advances the level by one frame.
+*
+* This moves the enemies, steps the physics world and the simulation
+* timers, and removes anything destroyed during the step.
+*
+* @param dt	The amount of time (in seconds) since the last frame
+*/
+void GameplayController::update(float dt) {
+	std::shared_ptr<ObstacleWorld> world = _gamestate->getWorld();
+	std::shared_ptr<PlayerModel> player = _gamestate->getPlayer();
+
+	// Caps player speed to MAX_PLAYER SPEED
+	if (player->getLinearVelocity().length() >= MAX_PLAYER_SPEED) {
+		Vec2 capped_speed = player->getLinearVelocity().normalize().scale(MAX_PLAYER_SPEED);
+		player->setLinearVelocity(capped_speed);
+	}
+
+	if (player->getCoalided() && player->getLinearVelocity().length() <= 0.0f) {
+		if (player->isStunned()) {
+			player->setDirectionTexture(player->getPlayerDirection(), 7);
+		} else {
+			player->setDirectionTexture(player->getPlayerDirection(), 0);
+			player->setCoalided(false);
+		}
+	}
+
+	// Changes player state from charging if below speed threshold
+	if (player->getCharging() && player->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING) {
+		player->setCharging(false);
+		player->_isSliding = true;
+		player->updateCircle(false);
+		// changes texture of nicoal
+		player->setDirectionTexture(_aimAngle, 3);
+	}
+
+	if (player->_isSliding && player->getLinearVelocity().isNearZero()) {
+		player->_isSliding = false;
+		player->updateCircle(false);
+		// changes texture of nicoal
+		player->setDirectionTexture(_aimAngle, 0);
+	}
+
+	if (player->didFall()) {
+		player->setDirectionTexture(player->getPlayerDirection(), 8);
+		player->_drownTimer -= 1;
+		if (player->_drownTimer <= 0) {
+			_gameover = true;
+		}
+	}
+
+	// Applies movement vector to all enemies curently alive in the game and sets them to charging state
+	if (_enemyCount != 0) {
+		std::vector<std::tuple<std::shared_ptr<EnemyModel>, Vec2>> enemiesToMove = _ai.getEnemyMoves(_gamestate);
+		for (std::tuple<std::shared_ptr<EnemyModel>, Vec2> pair : enemiesToMove) {
+			std::shared_ptr<EnemyModel> enemy = std::get<0>(pair);
+			Vec2 sling = std::get<1>(pair);
+			enemy->applyLinearImpulse(sling);
+			float angle = sling.getAngle(Vec2(-1.0f, 0.0f)) * 180.0f / 3.14159;
+
+			if (!enemy->isSpore()) {
+				enemy->setCharging(true);
+				enemy->setDirectionTexture(angle, enemy->isAcorn(), 2);
+			}
+		}
+	}
+
+	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
+		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
+		if (enemy->getCharging() && enemy->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING) {
+			enemy->setCharging(false);
+			enemy->setSliding(true);
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 3);
+		}
+
+		if (enemy->isSliding() && enemy->getLinearVelocity().isNearZero()) {
+			enemy->setSliding(false);
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 0);
+		}
+
+		if (enemy->getCoalided() && enemy->getLinearVelocity().length() <= 0.0f) {
+			if (enemy->isStunned()) {
+				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 6);
+			}
+			else {
+				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 0);
+				enemy->setCoalided(false);
+			}
+		}
+
+		if (enemy->isPrepping()) {
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 1);
+		}
+
+		if (!enemy->isRemoved() && enemy->didFall()) {
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
+			enemy->_drownTimer -= 1;
+			if (enemy->_drownTimer <= 0) {
+				removeEnemy(enemy);
+				_enemyCount--;
+			}
+		}
+	}
+
+	if (player->getSparky()) {
+		_gamestate->emitSparks(player->getNode());
+		player->setSparky(false);
+		if (player->getLinearVelocity().length() > MIN_SPEED_FOR_CHARGING) {
+			player->setCharging(true);
+			player->setDirectionTexture(player->getPlayerDirection(), 5);
+		}
+	}
+
+	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
+		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
+		if (!enemy->isRemoved() && enemy->getSparky()) {
+			_gamestate->emitSparks(enemy->getNode(), enemy->isOnion() ? ONION_SPARKS_POINT : Vec2::ZERO);
+			enemy->setSparky(false);
+			if (enemy->getLinearVelocity().length() > MIN_SPEED_FOR_CHARGING) {
+				enemy->setCharging(true);
+				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 5);
+			}
+		}
+	}
+
+	updateGround();
+
+	// LEVEL COMPLETE: If all enemies are dead then level completed
+	if (_enemyCount == 0) {
+		_complete = true;
+	}
+
+	// Update the physics world, then the timers on the same simulation clock
+	world->update(dt);
+	_gamestate->getTimers()->advance(world->getStepsize());
+	_gamestate->getUnits().update();
+
+	for (int i = 0; i < _gamestate->getSpores().size(); i++) {
+		std::shared_ptr<EnemyModel> spore = _gamestate->getSpores()[i];
+		Vec2 spore_pos = spore->getPosition();
+
+		if (spore->isDestroyed()) {
+			removeEnemy(spore);
+		}
+
+		/** Need to remove spore from spore list? */
+		else if (!(spore_pos.x > 0 && spore_pos.y > 0 && spore_pos.x < _gamestate->getBounds().size.getIWidth() && spore_pos.y < _gamestate->getBounds().size.getIHeight())) {
+			removeEnemy(spore);
+		}
+
+		else if (spore->isDispersing()) {
+			spore->animateSpore();
+		}
+	}
+
+	for (int i = 0; i < _gamestate->getObjects().size(); i++) {
+		std::shared_ptr<ObjectModel> object = _gamestate->getObjects()[i];
+		if (object->isBroken()) {
+			removeObject(object);
+		}
+		else if (object->isAnimating()) {
+			object->animate();
+		}
+	}
+
+	world->garbageCollect();
+	_gamestate->garbageCollect();
+}
+
+/**
+* Grounds the units that should feel the terrain friction, and checks
+* whether any unit has fallen into the water or out of the level.
+*/
+void GameplayController::updateGround() {
+	PlayerModel* player = _gamestate->getPlayer().get();
+	Vec2 player_pos = player->getPosition();
+	Size gameBounds = _gamestate->getBounds().size;
+
+	// LEVEL DEATH: Grounds the player and checks if in bounds/death conditions for the game
+	// (the world applies the friction of the cell under each grounded unit)
+	if (player->inBounds(gameBounds.getIWidth(), gameBounds.getIHeight())) {
+		player->setGrounded(!player->getCharging());
+		if (!player->getCharging()) {
+			float friction = _gamestate->getBoard()[std::max(0, (int)floor(player_pos.y-.25))][(int)floor(player_pos.x)];
+			if (friction == 0 && !player->didFall()) {
+				player->setFell();
+				player->setDirectionTexture(player->getPlayerDirection(), 8);
+			}
+		}
+	}
+	else {
+		player->setGrounded(false);
+		player->setCharging(false);
+		player->setDirectionTexture(player->getPlayerDirection(), 8);
+		_gameover = true;
+	}
+
+	// Loops through enemies and grounds them and also checks for in bounds/death conditions
+	for (int i = 0; i < _gamestate->getEnemies().size(); i++) {
+		std::shared_ptr<EnemyModel> enemy = _gamestate->getEnemies()[i];
+		if (enemy->isRemoved()) {
+			continue;
+		}
+		Vec2 enemy_pos = enemy->getPosition();
+		if (!enemy->isSpore() && enemy_pos.x > 0 && enemy_pos.y > 0 && enemy_pos.x < gameBounds.getIWidth() && enemy_pos.y < gameBounds.getIHeight()) {
+			float friction = _gamestate->getBoard()[(int)floor(enemy_pos.y)][(int)floor(enemy_pos.x)];
+			enemy->setGrounded(!enemy->getCharging());
+			if (!enemy->getCharging() && friction == 0 && !enemy->didFall()) {
+				enemy->setFell();
+				enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
+			}
+		}
+		else if (!enemy->didFall()) {
+			enemy->setFell();
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
+		}
+		else {
+			enemy->setGrounded(false);
+			enemy->setCharging(false);
+			enemy->setDirectionTexture(enemy->getDirection(), enemy->isAcorn(), 7);
+		}
+
+		// Changes enemy state from charging if below speed threshold
+		if (enemy->getCharging() && enemy->getLinearVelocity().length() < MIN_SPEED_FOR_CHARGING) {
+			enemy->setCharging(false);
+		}
+		else {
+			enemy->setCharging(true);
+		}
+	}
+
+	// Loops through objects and checks for in bounds/death conditions
+	for (int i = 0; i < _gamestate->getObjects().size(); i++) {
+		std::shared_ptr<ObjectModel> object = _gamestate->getObjects()[i];
+		Vec2 object_pos = object->getPosition();
+		if (object_pos.x > 0 && object_pos.y > 0 && object_pos.x < gameBounds.getIWidth() && object_pos.y < gameBounds.getIHeight()) {
+			float friction = _gamestate->getBoard()[(int)floor(object_pos.y)][(int)floor(object_pos.x)];
+			if (friction == 0 && object->isMovable()) {
+				object->animate();
+			}
+		}
+		else {
+			object->setGrounded(false);
+		}
+	}
+}
+
+void GameplayController::removeEnemy(const std::shared_ptr<EnemyModel>& enemy) {
+	// do not attempt to remove an enemy that has already been removed
+	if (enemy->isRemoved()) {
+		return;
+	}
+	if (enemy->getNode() != nullptr) {
+		enemy->getNode()->removeFromParent();
+	}
+	enemy->setDebugScene(nullptr);
+	enemy->markRemoved(true);
+}
+
+void GameplayController::removeObject(const std::shared_ptr<ObjectModel>& object) {
+	// do not attempt to remove an object that has already been removed
+	if (object->isRemoved()) {
+		return;
+	}
+	if (object->getNode() != nullptr) {
+		object->getNode()->removeFromParent();
+	}
+	object->setDebugScene(nullptr);
+	object->markRemoved(true);
+}
@@ -0,0 +1,116 @@
+//
+//	GameplayController.h
+//	Coalide
+//
+#ifndef __GAMEPLAY_CONTROLLER_H__
+#define __GAMEPLAY_CONTROLLER_H__
+#include <cugl/cugl.h>
+#include "CollisionController.h"
+#include "AIController.h"
+#include "GameState.h"
+
+using namespace cugl;
+
+/**
+* This class runs the rules of a single level.
+*
+* It owns the collision and AI controllers of the level, and steps the
+* physics, the enemies and the win and loss conditions. It never reads input
+* or touches the camera, so a level can be played by the GameScene or
+* simulated without an application (see BatchRunner).
+*
+* A level without a scene graph simply skips the textures and sparks.
+*/
+class GameplayController {
+protected:
+	/** The level being played */
+	std::shared_ptr<GameState> _gamestate;
+	/** Controller for handling collisions using Box2D */
+	CollisionController _collisions;
+	/** Controller for determining AI behavior */
+	AIController _ai;
+
+	/** Number of enemies remaining */
+	int _enemyCount;
+	/** Whether all of the enemies are gone */
+	bool _complete;
+	/** Whether the player has fallen or left the level */
+	bool _gameover;
+	/** The angle of the current aim in degrees (for the player textures) */
+	float _aimAngle;
+
+	/**
+	* Grounds the units that should feel the terrain friction, and checks
+	* whether any unit has fallen into the water or out of the level.
+	*/
+	void updateGround();
+
+public:
+#pragma mark -
+#pragma mark Constructors
+	GameplayController() : _enemyCount(0), _complete(false), _gameover(false), _aimAngle(0) { }
+
+	~GameplayController() { dispose(); }
+
+	void dispose();
+
+	/**
+	* Initializes the rules for the given level.
+	*
+	* This activates the collision callbacks of the level world. Without
+	* assets, collisions are silent.
+	*
+	* @param gamestate	The level to play
+	* @param assets		The loaded assets (or nullptr for a silent level)
+	*
+	* @return true if the controller is initialized properly, false otherwise.
+	*/
+	bool init(const std::shared_ptr<GameState>& gamestate, const std::shared_ptr<AssetManager>& assets);
+
+#pragma mark -
+#pragma mark State Access
+	/** Returns the level being played */
+	const std::shared_ptr<GameState>& getGameState() const { return _gamestate; }
+
+	/** Returns the number of enemies remaining */
+	int getEnemyCount() const { return _enemyCount; }
+
+	/** Returns true if all of the enemies are gone */
+	bool isComplete() const { return _complete; }
+
+	/** Returns true if the player has fallen or left the level */
+	bool isGameOver() const { return _gameover; }
+
+#pragma mark -
+#pragma mark Gameplay Handling
+	/**
+	* Sets the current aim of the player, which decides the player textures.
+	*
+	* @param aim	The aim vector
+	*/
+	void setAim(const Vec2& aim) { _aimAngle = aim.getAngle() * 180.0f / 3.14159f; }
+
+	/**
+	* Slings the player, if the player is able to.
+	*
+	* @param impulse	The sling vector
+	*
+	* @return true if the player was slung
+	*/
+	bool sling(const Vec2& impulse);
+
+	/**
+	* Advances the level by one frame.
+	*
+	* This moves the enemies, steps the physics world and the simulation
+	* timers, and removes anything destroyed during the step.
+	*
+	* @param dt	The amount of time (in seconds) since the last frame
+	*/
+	void update(float dt);
+
+	void removeEnemy(const std::shared_ptr<EnemyModel>& enemy);
+
+	void removeObject(const std::shared_ptr<ObjectModel>& object);
+};
+#endif /* __GAMEPLAY_CONTROLLER_H__ */
@@ -25,6 +25,8 @@ using namespace cugl;
 */
 bool InputController::init() {
 	_debugPressed = false;
+	_perfPressed = false;
+	_perfTouched = false;
 	_resetPressed = false;
 	_exitPressed = false;
     bool success = true;
@@ -118,6 +120,13 @@ void InputController::update(float dt) {
     // Map "keyboard" events to the current frame boundary
     _left  = keys->keyPressed(KeyCode::ARROW_LEFT);
     _right = keys->keyPressed(KeyCode::ARROW_RIGHT);
+
+#ifndef CU_TOUCH_SCREEN
+	_perfPressed = keys->keyPressed(KeyCode::P);
+#else
+	_perfPressed = _perfTouched;
+	_perfTouched = false;
+#endif
 }
 
 /**
@@ -174,6 +183,11 @@ void InputController::touchBeganCB(const TouchEvent& event, bool focus, int fing
 		_panning = true;
 		_mousedown = false;
 	}
+	else if (fingers == 3) {
+		_perfTouched = true;
+		_panning = false;
+		_mousedown = false;
+	}
 	else {
 		_mousedown = true;
 	}
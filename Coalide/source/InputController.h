@@ -10,6 +10,10 @@
 class InputController {
 private:
 	bool _debugPressed;
+	/** Whether the performance overlay was toggled this frame */
+	bool _perfPressed;
+	/** Whether a three finger touch began since the last update */
+	bool _perfTouched;
 	bool _resetPressed;
 	bool _exitPressed;
     bool _didSling;
@@ -99,6 +103,15 @@ public:
 	*/
 	bool didDebug() const { return _debugPressed; }
 
+	/**
+	* Returns true if the player wants to toggle the performance overlay.
+	*
+	* This is the P key on desktop, and a three finger touch on mobile.
+	*
+	* @return true if the player wants to toggle the performance overlay.
+	*/
+	bool didPerf() const { return _perfPressed; }
+
 	/**
 	* Returns true if the player wants to reset the game.
 	*
@@ -0,0 +1,217 @@
+//
+//	LevelBuilder.cpp
+//	Coalide
+//
+#include "LevelBuilder.h"
+
+// Depths of the interesting values (the root object is depth 1)
+#define SECTION_DEPTH	1
+#define FIELD_DEPTH		2
+#define CELL_DEPTH		4
+
+#pragma mark -
+#pragma mark Constructors
+/**
+* Creates an empty level builder.
+*/
+LevelBuilder::LevelBuilder() {
+	reset();
+}
+
+/**
+* Clears all level data, so that the builder may be reused.
+*/
+void LevelBuilder::reset() {
+	_rows = 0;
+	_cols = 0;
+	for (int ii = 0; ii < LAYER_COUNT; ii++) {
+		_textures[ii].clear();
+	}
+	_types.clear();
+	_player.row = 0;
+	_player.col = 0;
+	_acorns.clear();
+	_onions.clear();
+	_mushrooms.clear();
+	_crates.clear();
+	_rocks.clear();
+
+	_depth = 0;
+	_section = Section::NONE;
+	_field = Field::NONE;
+	_grid = nullptr;
+	_reading = false;
+	_list = nullptr;
+	_unit = nullptr;
+	_unitDepth = 0;
+}
+
+/**
+* Returns true if the level data is complete and consistent.
+*
+* Every layer must have exactly rows*cols cells, or be missing entirely.
+*/
+bool LevelBuilder::isValid() const {
+	size_t cells = (size_t)(_rows*_cols);
+	if (_rows <= 0 || _cols <= 0 || _types.size() != cells) {
+		return false;
+	}
+	for (int ii = 0; ii < LAYER_COUNT; ii++) {
+		if (!_textures[ii].empty() && _textures[ii].size() != cells) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+#pragma mark -
+#pragma mark Parse Events
+bool LevelBuilder::startObject() {
+	_depth++;
+	if (_section == Section::OBJECTS) {
+		if (_list != nullptr && _depth == CELL_DEPTH) {
+			_list->push_back(Unit());
+			_unit = &_list->back();
+			_unit->row = 0;
+			_unit->col = 0;
+			_unitDepth = _depth;
+		}
+		else if (_unit == &_player && _depth == FIELD_DEPTH+1) {
+			_unitDepth = _depth;
+		}
+	}
+	return true;
+}
+
+bool LevelBuilder::endObject() {
+	if (_depth == _unitDepth) {
+		_unit = nullptr;
+		_unitDepth = 0;
+	}
+	_depth--;
+	if (_depth < SECTION_DEPTH) {
+		_section = Section::NONE;
+	}
+	return true;
+}
+
+bool LevelBuilder::startArray() {
+	_depth++;
+	return true;
+}
+
+bool LevelBuilder::endArray() {
+	_depth--;
+	return true;
+}
+
+bool LevelBuilder::key(const std::string& key) {
+	if (_depth == SECTION_DEPTH) {
+		_grid = nullptr;
+		_reading = false;
+		_list = nullptr;
+		_unit = nullptr;
+		if (key == "levelInfo") {
+			_section = Section::INFO;
+		} else if (key == "textures") {
+			_section = Section::TEXTURES;
+		} else if (key == "terrain") {
+			_section = Section::TERRAIN;
+		} else if (key == "objects") {
+			_section = Section::OBJECTS;
+		} else {
+			_section = Section::NONE;
+		}
+	} else if (_depth == FIELD_DEPTH) {
+		_field = Field::NONE;
+		switch (_section) {
+		case Section::INFO:
+			_field = (key == "rows" ? Field::ROWS : (key == "cols" ? Field::COLS : Field::NONE));
+			break;
+		case Section::TEXTURES:
+			_grid = nullptr;
+			if (key == "waterDecals") {
+				_grid = &_textures[WATER_DECALS];
+			} else if (key == "water") {
+				_grid = &_textures[WATER];
+			} else if (key == "grass") {
+				_grid = &_textures[GRASS];
+			} else if (key == "ice") {
+				_grid = &_textures[ICE];
+			} else if (key == "sand") {
+				_grid = &_textures[SAND];
+			}
+			break;
+		case Section::TERRAIN:
+			_reading = (key == "types");
+			break;
+		case Section::OBJECTS:
+			_unit = nullptr;
+			_list = nullptr;
+			if (key == "player") {
+				_unit = &_player;
+			} else if (key == "acorns") {
+				_list = &_acorns;
+			} else if (key == "onions") {
+				_list = &_onions;
+			} else if (key == "mushrooms") {
+				_list = &_mushrooms;
+			} else if (key == "crates") {
+				_list = &_crates;
+			} else if (key == "rocks") {
+				_list = &_rocks;
+			}
+			break;
+		default:
+			break;
+		}
+	} else if (_unit != nullptr && _depth == _unitDepth) {
+		_field = (key == "row" ? Field::ROW : (key == "col" ? Field::COL : Field::NONE));
+	}
+	return true;
+}
+
+bool LevelBuilder::number(double value) {
+	switch (_section) {
+	case Section::INFO:
+		if (_depth == FIELD_DEPTH && _field == Field::ROWS) {
+			_rows = (int)value;
+		} else if (_depth == FIELD_DEPTH && _field == Field::COLS) {
+			_cols = (int)value;
+		}
+		break;
+	case Section::TEXTURES:
+		if (_grid != nullptr && _depth == CELL_DEPTH) {
+			_grid->push_back((int)value);
+		}
+		break;
+	case Section::OBJECTS:
+		if (_unit != nullptr && _depth == _unitDepth) {
+			if (_field == Field::ROW) {
+				_unit->row = (int)value;
+			} else if (_field == Field::COL) {
+				_unit->col = (int)value;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+bool LevelBuilder::string(const std::string& value) {
+	if (_section == Section::TERRAIN && _reading && _depth == CELL_DEPTH) {
+		if (value == "dirt") {
+			_types.push_back(TILE_TYPE::GRASS);
+		} else if (value == "ice") {
+			_types.push_back(TILE_TYPE::ICE);
+		} else if (value == "sand") {
+			_types.push_back(TILE_TYPE::SAND);
+		} else {
+			_types.push_back(TILE_TYPE::WATER);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,138 @@
+//
+//	LevelBuilder.h
+//	Coalide
+//
+#ifndef __LEVEL_BUILDER_H__
+#define __LEVEL_BUILDER_H__
+#include <cugl/cugl.h>
+#include "Constants.h"
+
+using namespace cugl;
+
+/**
+* Collects a level straight from a JsonStreamReader.
+*
+* The builder listens to the parse events of a level file and keeps only what
+* the LevelController needs: the level dimensions, the terrain type and texture
+* indices of every cell, and the grid position of every unit.  No JSON tree is
+* ever built.  The sections of the file may appear in any order.
+*/
+class LevelBuilder : public JsonHandler {
+public:
+	/** The texture layers of a level cell */
+	enum Layer {
+		WATER_DECALS,
+		WATER,
+		GRASS,
+		ICE,
+		SAND,
+		LAYER_COUNT
+	};
+
+	/** The grid position of a unit in the level file */
+	struct Unit {
+		int row;
+		int col;
+	};
+
+private:
+	/** The top level section of the file being read */
+	enum class Section { NONE, INFO, TEXTURES, TERRAIN, OBJECTS };
+	/** The field that the next number will be stored in */
+	enum class Field { NONE, ROWS, COLS, ROW, COL };
+
+	int _rows;
+	int _cols;
+	/** The texture index of each cell, row-major, one vector per layer */
+	std::vector<int> _textures[LAYER_COUNT];
+	/** The terrain type of each cell, row-major (WATER for empty cells) */
+	std::vector<TILE_TYPE> _types;
+
+	Unit _player;
+	std::vector<Unit> _acorns;
+	std::vector<Unit> _onions;
+	std::vector<Unit> _mushrooms;
+	std::vector<Unit> _crates;
+	std::vector<Unit> _rocks;
+
+	// Parse state
+	int _depth;
+	Section _section;
+	Field _field;
+	/** The texture layer being read (nullptr if none) */
+	std::vector<int>* _grid;
+	/** Whether the terrain types are being read */
+	bool _reading;
+	/** The unit list being read (nullptr if none or the player) */
+	std::vector<Unit>* _list;
+	/** The unit being read (nullptr if none) */
+	Unit* _unit;
+	/** The depth of the unit being read */
+	int _unitDepth;
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an empty level builder.
+	*/
+	LevelBuilder();
+
+	/**
+	* Clears all level data, so that the builder may be reused.
+	*/
+	void reset();
+
+	/**
+	* Returns true if the level data is complete and consistent.
+	*
+	* Every layer must have exactly rows*cols cells, or be missing entirely.
+	*/
+	bool isValid() const;
+
+
+#pragma mark -
+#pragma mark Accessors
+	/** Returns the number of rows in the level */
+	int getRows() const { return _rows; }
+
+	/** Returns the number of columns in the level */
+	int getCols() const { return _cols; }
+
+	/** Returns the terrain type of the cell at row r, column c (file order) */
+	TILE_TYPE getType(int r, int c) const { return _types[r*_cols+c]; }
+
+	/** Returns the texture index of the given layer at row r, column c, or -1 if none */
+	int getTexture(Layer layer, int r, int c) const {
+		return _textures[layer].empty() ? -1 : _textures[layer][r*_cols+c];
+	}
+
+	/** Returns the player position */
+	const Unit& getPlayer() const { return _player; }
+
+	/** Returns the acorn positions */
+	const std::vector<Unit>& getAcorns() const { return _acorns; }
+
+	/** Returns the onion positions */
+	const std::vector<Unit>& getOnions() const { return _onions; }
+
+	/** Returns the mushroom positions */
+	const std::vector<Unit>& getMushrooms() const { return _mushrooms; }
+
+	/** Returns the crate positions */
+	const std::vector<Unit>& getCrates() const { return _crates; }
+
+	/** Returns the rock positions */
+	const std::vector<Unit>& getRocks() const { return _rocks; }
+
+
+#pragma mark -
+#pragma mark Parse Events
+	bool startObject() override;
+	bool endObject() override;
+	bool startArray() override;
+	bool endArray() override;
+	bool key(const std::string& key) override;
+	bool number(double value) override;
+	bool string(const std::string& value) override;
+};
+#endif /* __LEVEL_BUILDER_H__ */
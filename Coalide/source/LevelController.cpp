@@ -9,11 +9,9 @@
 #include "TileModel.h"
 #include "ObjectModel.h"
 #include "Constants.h"
-#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <string>
 
-#define TILE_BORDER  0.00035
 
 using namespace cugl;
 
@@ -37,28 +35,57 @@ void LevelController::dispose() { }
 * @return true if successfully loaded the asset from a file
 */
 bool LevelController::preload(const std::string& file) {
-    std::shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(file);
-    return preload(reader->readJson());
+    std::shared_ptr<JsonStreamReader> reader = JsonStreamReader::allocWithAsset(file);
+    if (reader == nullptr) {
+        CUAssertLog(false, "Failed to load level file");
+        return false;
+    }
+    return preload(reader);
 }
 
 /**
 * Loads this game level from the source file
 *
+* The tree is already parsed, so it is walked straight into the LevelBuilder
+* instead of being formatted as text and parsed again.
+*
 * @return true if successfully loaded the asset from the json
 */
 bool LevelController::preload(const std::shared_ptr<JsonValue>& json) {
-    
-	if (json == nullptr) {
+	LevelBuilder level;
+	if (json == nullptr || !JsonStreamReader::walk(json.get(), level) || !level.isValid()) {
 		CUAssertLog(false, "Failed to load level file");
 		return false;
 	}
+	return preload(level);
+}
+
+/**
+* Loads this game level from a JSON stream, without building a JSON tree.
+*
+* The LevelBuilder keeps only the cell grids and unit positions, so the
+* peak memory is the read buffer plus those arrays.
+*
+* @return true if successfully loaded the level from the stream
+*/
+bool LevelController::preload(const std::shared_ptr<JsonStreamReader>& reader) {
+	LevelBuilder level;
+	if (!reader->parse(level) || !level.isValid()) {
+		CUAssertLog(false, "Failed to load level file");
+		return false;
+	}
+	return preload(level);
+}
+
+/**
+* Loads this game level from a level collected by a LevelBuilder.
+*
+* @return true if successfully loaded the level
+*/
+bool LevelController::preload(const LevelBuilder& level) {
 	// Initial geometry
-	auto levelInfo = json->get("levelInfo");
-	int canvasH = 64 * levelInfo->get("rows")->asInt();
-	int canvasW = 64 * levelInfo->get("cols")->asInt();
-    
-    
-	auto tilesets = json->get(TILESETS_FIELD);
+	int canvasH = 64 * level.getRows();
+	int canvasW = 64 * level.getCols();
 
     int tileW = 64;
     int tileH = 64;
@@ -74,227 +101,137 @@ bool LevelController::preload(const std::shared_ptr<JsonValue>& json) {
 
 	_scale.set(canvasW/worldW-1, canvasH/worldH-1);
 
-	_world = ObstacleWorld::alloc(_bounds, cugl::Vec2(0, DEFAULT_GRAVITY));
+	// Units are about a tile in size, so find collisions with a tile grid
+	_world = ObstacleWorld::alloc(_bounds, cugl::Vec2(0, DEFAULT_GRAVITY), BROADPHASE_CELL);
     
     //for time slow down
     _world->setLockStep(true);
     _world->setStepsize(NORMAL_MOTION);
+
+	// Stun and collision timeouts run on simulation time
+	_timers = TimerWheel::alloc();
 	
 	// Create the arena
-	if (!loadTerrain(json)) {
+	if (!loadTerrain(level)) {
 		CUAssertLog(false, "Failed to load world");
 		return false;
 	}
 
 //    // Create the player and enemy(s)
-    if (!loadUnits(json)) {
+    if (!loadUnits(level)) {
         CUAssertLog(false, "Failed to load player");
         return false;
     }
 
-	addFrictionJoints();
-
 	buildGameState();
 
 	return true;
 }
 
-bool LevelController::loadTerrain(const std::shared_ptr<JsonValue>& json) {
+bool LevelController::loadTerrain(const LevelBuilder& level) {
 	bool success = true;
 
 	int worldW = _bounds.size.getIWidth();
 	int worldH = _bounds.size.getIHeight();
 
-	_terrain = BoxObstacle::alloc(Vec2(worldW/2,worldH/2), Size(worldW, worldH));
-	_terrain->setName("terrain");
-	_terrain->setBodyType(b2_staticBody);
-
-	b2Filter filter;
-	filter.categoryBits = CATEGORY_TERRAIN;
-	filter.maskBits = NULL;
-	filter.groupIndex = NULL;
-	_terrain->setFilterData(filter);
-
-	_world->addObstacle(_terrain);
-    
-    auto levelInfo = json->get("levelInfo");
-    int rows = levelInfo->get("rows")->asInt();
-    int cols = levelInfo->get("cols")->asInt();
-    
-    auto terrain = json->get("terrain");
-    auto terrrainTypesArray = terrain->get("types");
-    
-    auto textures = json->get("textures");
-    auto sandTextureArray = textures->get("sand");
-    auto iceTextureArray = textures->get("ice");
-    auto dirtTextureArray = textures->get("grass");
-    auto waterBaseArray = textures->get("water");
-    auto waterDecalArray = textures->get("waterDecals");
-    
+    int rows = level.getRows();
+    int cols = level.getCols();
     
     _board = new int*[worldH];
-    _tileBoard = new std::shared_ptr<TileModel>*[worldH];
+    _tileBoard = new TileModel*[worldH];
 
     for (int i = 0; i < worldH; i++) {
         _board[i] = new int[worldW];
-        _tileBoard[i] = new std::shared_ptr<TileModel>[worldW];
+        _tileBoard[i] = new TileModel[worldW];
     }
 
     for(int r = 0; r<rows; r++){
-        auto typesArray = terrrainTypesArray->get(r);
-        auto innerSand = sandTextureArray->get(r);
-        auto innerIce = iceTextureArray->get(r);
-        auto innerDirt = dirtTextureArray->get(r);
-        auto innerWaterBase = waterBaseArray->get(r);
-        auto innerWaterDecal = waterDecalArray->get(r);
-
         for(int c = 0; c<cols; c++){
             
-            std::string type = typesArray->get(c)->asString();
-            if(type == "empty"){
+            TILE_TYPE type = level.getType(r, c);
+            TileModel& tile = _tileBoard[rows - 1 - r][c];
+            tile.setType(type);
+            tile.setLayer(TileModel::WATER_DECAL, level.getTexture(LevelBuilder::WATER_DECALS, r, c));
+            if(type == TILE_TYPE::WATER){
                 _board[rows - 1 - r][c] = 0;
-                int waterDecal = innerWaterDecal->get(c)->asInt();
-                if(waterDecal != -1){
-                    std::shared_ptr<TileModel> tile = TileModel::alloc(Vec2(c + .5, (rows - r) - .5), UNIT_DIM);
-                    tile->setType(TILE_TYPE::WATER);
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (waterDecal / 21));
-                    double subTextureX = (waterDecal % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    tile->setWaterDecalSubTexture((subTextureX / 7) + TILE_BORDER, (endX / 7), (subTextureY / 8) + TILE_BORDER, (endY / 8));
-                    tile->setWaterTextureKey("tileset_water.png");
-                    _tiles.push_back(tile);
-                    //_tileBoard[r][c] = tile;
-                }
             }
             else {
-                std::shared_ptr<TileModel> tile = TileModel::alloc(Vec2(c + .5, (rows - r) - .5), UNIT_DIM);
-                int sandTexture = innerSand->get(c)->asInt();
-                int iceTexture = innerIce->get(c)->asInt();
-                int dirtTexture = innerDirt->get(c)->asInt();
-                int waterBase = innerWaterBase->get(c)->asInt();
-                int waterDecal = innerWaterDecal->get(c)->asInt();
-                tile->setWaterTextureKey("tileset_water.png");
-                if(type == "sand"){
+                tile.setLayer(TileModel::WATER_BASE, level.getTexture(LevelBuilder::WATER, r, c));
+                tile.setLayer(TileModel::DIRT, level.getTexture(LevelBuilder::GRASS, r, c));
+                if(type == TILE_TYPE::SAND){
                     _board[rows - 1 - r][c] = 40;
-                    tile->setType(TILE_TYPE::SAND);
-                    tile->setSandTextureKey("tileset_forest.png");
-                    tile->setIceTextureKey("tileset_forest.png");
-                    tile->setDirtTextureKey("tileset_forest.png");
-                
+                    tile.setLayer(TileModel::ICE, level.getTexture(LevelBuilder::ICE, r, c));
+                    tile.setLayer(TileModel::SAND, level.getTexture(LevelBuilder::SAND, r, c));
                 }
-                if(type == "ice"){
+                if(type == TILE_TYPE::ICE){
                     _board[rows - 1 - r][c] = 1;
-                    tile->setType(TILE_TYPE::ICE);
-                    tile->setIceTextureKey("tileset_forest.png");
-                    tile->setDirtTextureKey("tileset_forest.png");
+                    tile.setLayer(TileModel::ICE, level.getTexture(LevelBuilder::ICE, r, c));
                 }
-                if(type == "dirt"){
+                if(type == TILE_TYPE::GRASS){
 					_board[rows - 1 - r][c] = 10;
-                    tile->setType(TILE_TYPE::GRASS);
-                    tile->setDirtTextureKey("tileset_forest.png");
-                }
-                if(sandTexture != -1){
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (sandTexture / 21));
-                    double subTextureX = (sandTexture % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    tile->setSandSubTexture((subTextureX / 21) + TILE_BORDER, (endX / 21) - TILE_BORDER, (subTextureY / 8) + TILE_BORDER, (endY / 8) - TILE_BORDER);
-                }
-                if(iceTexture != -1){
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (iceTexture / 21));
-                    double subTextureX = (iceTexture % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    tile->setIceSubTexture((subTextureX / 21) + TILE_BORDER, (endX / 21)- TILE_BORDER, (subTextureY / 8) + TILE_BORDER, (endY / 8) - TILE_BORDER);
-                }
-                if(dirtTexture != -1){
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (dirtTexture / 21));
-                    double subTextureX = (dirtTexture % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    tile->setDirtSubTexture((subTextureX / 21) + TILE_BORDER, (endX / 21) - TILE_BORDER, (subTextureY / 8) + TILE_BORDER, (endY / 8) - TILE_BORDER);
                 }
-                if(waterBase != -1){
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (waterBase / 21));
-                    double subTextureX = (waterBase % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    tile->setWaterBaseSubTexture((subTextureX / 7) + TILE_BORDER, (endX / 7) - TILE_BORDER, (subTextureY / 8) + TILE_BORDER, (endY / 8) - TILE_BORDER);
-                }
-                if(waterDecal != -1){
-                    //gives box to specify texture into texture atlas
-                    double subTextureY = ((int) (waterDecal / 21));
-                    double subTextureX = (waterDecal % 21);
-                    double endY = subTextureY + 1;
-                    double endX = subTextureX + 1;
-                    //tile->setWaterDecalSubTexture((subTextureX / 7) + TILE_BORDER, (endX / 7), (subTextureY / 8) + TILE_BORDER, (endY / 8));
-                    tile->setWaterDecalSubTexture((subTextureX / 7) + TILE_BORDER, (endX / 7) - TILE_BORDER, (subTextureY / 8) + TILE_BORDER, (endY / 8) - TILE_BORDER);
-                }
-                _tiles.push_back(tile);
-                _tileBoard[rows - 1 - r][c] = tile;
             }
         }
     }
+
+	// The world applies the ground friction of each cell to grounded units
+	_world->setSurfaceGrid(worldW, worldH);
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < cols; c++) {
+			_world->setSurfaceFriction(c, rows - 1 - r, (float)_board[rows - 1 - r][c]);
+		}
+	}
 	return success;
 }
 
-bool LevelController::loadUnits(const std::shared_ptr<cugl::JsonValue>& json) {
+bool LevelController::loadUnits(const LevelBuilder& level) {
 	bool success = true;
 	
-    auto levelInfo = json->get("levelInfo");
-    int rows = levelInfo->get("rows")->asInt();
-    
-    auto objects = json->get("objects");
+    int rows = level.getRows();
     
     // player
-    auto player = objects->get("player");
-    _player = PlayerModel::alloc(Vec2(player->get("col")->asInt() + .5, rows - player->get("row")->asInt() - .5), PLAYER_DIM);
+    const LevelBuilder::Unit& player = level.getPlayer();
+    _player = PlayerModel::alloc(Vec2(player.col + .5, rows - player.row - .5), PLAYER_DIM);
+    _player->setTimers(_timers);
     _world->addObstacle(_player);
     
     //acorns
-    auto acornArray = objects->get("acorns");
-    for(auto acorn : acornArray->_children){
+    for(const LevelBuilder::Unit& acorn : level.getAcorns()){
         std::shared_ptr<EnemyModel> enemy;
 
-        int r = acorn->get("row")->asInt();
-        int c = acorn->get("col")->asInt();
+        int r = acorn.row;
+        int c = acorn.col;
         enemy = EnemyModel::alloc(Vec2(c + .5, (rows - r) - .5), ACORN_DIM);
         enemy->setTextureKey(ACORN);
 		enemy->setAcorn();
 
+        enemy->setTimers(_timers);
         _world->addObstacle(enemy);
         _enemies.push_back(enemy);
     }
     
     //onions
-    auto onionArray = objects->get("onions");
-    for(auto onion : onionArray->_children){
+    for(const LevelBuilder::Unit& onion : level.getOnions()){
         std::shared_ptr<EnemyModel> enemy;
         
-        int r = onion->get("row")->asInt();
-        int c = onion->get("col")->asInt();
+        int r = onion.row;
+        int c = onion.col;
         enemy = EnemyModel::alloc(Vec2(c + .5, (rows - r) - .5), ONION_DIM);
         enemy->setTextureKey(ONION);
 		enemy->setDensity(2.5);
 		enemy->setOnion();
 
+        enemy->setTimers(_timers);
         _world->addObstacle(enemy);
         _enemies.push_back(enemy);
     }
     
     //mushrooms
-    auto mushroomArray = objects->get("mushrooms");
-    for(auto mushroom : mushroomArray->_children){
+    for(const LevelBuilder::Unit& mushroom : level.getMushrooms()){
         std::shared_ptr<EnemyModel> enemy;
         
-        int r = mushroom->get("row")->asInt();
-        int c = mushroom->get("col")->asInt();
+        int r = mushroom.row;
+        int c = mushroom.col;
         enemy = EnemyModel::alloc(Vec2(c + .5, (rows - r) - .5), MUSHROOM_DIM);
         enemy->setTextureKey(MUSHROOM);
 		enemy->setDensity(2.5);
@@ -306,6 +243,7 @@ bool LevelController::loadUnits(const std::shared_ptr<cugl::JsonValue>& json) {
         filter.groupIndex = NULL;
         enemy->setFilterData(filter);
         
+        enemy->setTimers(_timers);
         _world->addObstacle(enemy);
         _enemies.push_back(enemy);
     }
@@ -328,79 +266,49 @@ bool LevelController::loadUnits(const std::shared_ptr<cugl::JsonValue>& json) {
 	}*/
 
     //movable crates
-    auto crateArray = objects->get("crates");
-    for(auto crate : crateArray->_children){
+    for(const LevelBuilder::Unit& crate : level.getCrates()){
         std::shared_ptr<ObjectModel> object;
         
-        int r = crate->get("row")->asInt();
-        int c = crate->get("col")->asInt();
+        int r = crate.row;
+        int c = crate.col;
         object = ObjectModel::alloc(Vec2(c + .5, (rows - r) - .5), UNIT_DIM);
         object->setTextureKey(BREAKABLE_NAME);
         object->setName(BREAKABLE_NAME);
         object->setBodyType(b2_dynamicBody);
 		object->setType(OBJECT_TYPE::BREAKABLE);
         
+        object->setTimers(_timers);
         _world->addObstacle(object);
         _objects.push_back(object);
     }
     
     //rocks
-    auto rockArray = objects->get("rocks");
-    for(auto rock : rockArray->_children){
+    for(const LevelBuilder::Unit& rock : level.getRocks()){
         std::shared_ptr<ObjectModel> object;
         
-        int r = rock->get("row")->asInt();
-        int c = rock->get("col")->asInt();
+        int r = rock.row;
+        int c = rock.col;
         object = ObjectModel::alloc(Vec2(c + .5, (rows - r) - .5), UNIT_DIM);
         object->setTextureKey(IMMOBILE_NAME);
         object->setName(IMMOBILE_NAME);
         object->setBodyType(b2_staticBody);
 		object->setType(OBJECT_TYPE::IMMOBILE);
 
+        object->setTimers(_timers);
         _world->addObstacle(object);
         _objects.push_back(object);
     }
 	return success;
 }
 
-void LevelController::addFrictionJoints() {
-	b2FrictionJointDef jointDef;
-
-	jointDef.localAnchorA.SetZero();
-	jointDef.localAnchorB.SetZero();
-
-	jointDef.bodyB = _terrain->getBody();
-	jointDef.maxForce = 10;
-	jointDef.maxTorque = 10;
-
-	jointDef.bodyA = _player->getBody();
-	_player->setFrictionJoint((b2FrictionJoint*)(_world->getWorld()->CreateJoint(&jointDef)));
-
-	for (int i = 0; i < _enemies.size(); i++) {
-		jointDef.maxForce = 0;
-		jointDef.maxTorque = 0;
-
-		jointDef.bodyA = _enemies[i]->getBody();
-		_enemies[i]->setFrictionJoint((b2FrictionJoint*)(_world->getWorld()->CreateJoint(&jointDef)));
-	}
-
-	for (int i = 0; i < _objects.size(); i++) {
-		jointDef.maxForce = 0;
-		jointDef.maxTorque = 0;
-
-		jointDef.bodyA = _objects[i]->getBody();
-		_objects[i]->setFrictionJoint((b2FrictionJoint*)(_world->getWorld()->CreateJoint(&jointDef)));
-	}
-}
-
 void LevelController::buildGameState() {
 	_gamestate = GameState::alloc();
 
 	_gamestate->setPlayer(_player);
 	_gamestate->setEnemies(_enemies);
 	_gamestate->setObjects(_objects);
-	_gamestate->setTiles(_tiles);
 	_gamestate->setWorld(_world);
+	_gamestate->setTimers(_timers);
 	_gamestate->setBoard(_board);
 	_gamestate->setTileBoard(_tileBoard);
 	_gamestate->setDrawScale(_scale);
@@ -415,7 +323,7 @@ void LevelController::buildGameState() {
 void LevelController::unload() {
 	if (_player != nullptr) {
 		if (_world != nullptr) {
-			_gamestate->getWorld()->removeObstacle(_player.get());
+			_world->removeObstacle(_player.get());
 		}
 		_player = nullptr;
 	}
@@ -423,7 +331,7 @@ void LevelController::unload() {
 	for (int i = 0; i < _enemies.size(); i++) {
 		if (_world != nullptr) {
 			if (!_enemies[i]->isRemoved()) {
-				_gamestate->getWorld()->removeObstacle(_enemies[i].get());
+				_world->removeObstacle(_enemies[i].get());
 			}
 		}
 		_enemies[i] = nullptr;
@@ -433,32 +341,33 @@ void LevelController::unload() {
 	for (int i = 0; i < _objects.size(); i++) {
 		if (_world != nullptr) {
 			if (!_objects[i]->isRemoved()) {
-				_gamestate->getWorld()->removeObstacle(_objects[i].get());
+				_world->removeObstacle(_objects[i].get());
 			}	
 		}
 		_objects[i] = nullptr;
 	}
 	_objects.clear();
 
-	for (int i = 0; i < _bounds.size.getIHeight(); i++) {
-		delete[] _board[i];
-		delete[] _tileBoard[i];
+	// A level that failed to load may not have its boards yet
+	if (_board != nullptr) {
+		for (int i = 0; i < _bounds.size.getIHeight(); i++) {
+			delete[] _board[i];
+		}
+		delete[] _board;
+		_board = nullptr;
 	}
-
-	delete[] _board;
-	delete[] _tileBoard;
-	
-
-	//for (auto it = _tiles.begin(); it != _tiles.end(); ++it) {
-	//	if (_world != nullptr) {
-	//		_gamestate->getWorld()->removeObstacle((*it).get());
-	//	}
-	//	(*it) = nullptr;
-	//}
-	_tiles.clear();
+	if (_tileBoard != nullptr) {
+		for (int i = 0; i < _bounds.size.getIHeight(); i++) {
+			delete[] _tileBoard[i];
+		}
+		delete[] _tileBoard;
+		_tileBoard = nullptr;
+	}
+	_bounds = Rect::ZERO;
 
 	if (_world != nullptr) {
 		_world->clear();
 		_world = nullptr;
 	}
+	_timers = nullptr;
 }
@@ -7,6 +7,7 @@
 #include <cugl/cugl.h>
 #include "GameState.h"
 #include "Constants.h"
+#include "LevelBuilder.h"
 
 using namespace cugl;
 
@@ -29,15 +30,14 @@ protected:
 	Vec2 _scale;
 
 	std::shared_ptr<ObstacleWorld> _world;
+	std::shared_ptr<TimerWheel> _timers;
 	
 	std::shared_ptr<PlayerModel> _player;
 	std::vector<std::shared_ptr<EnemyModel>> _enemies;
 	std::vector<std::shared_ptr<ObjectModel>> _objects;
-	std::vector<std::shared_ptr<TileModel>> _tiles;
-	std::shared_ptr<BoxObstacle> _terrain;
 
 	int** _board;
-	std::shared_ptr<TileModel>** _tileBoard;
+	TileModel** _tileBoard;
 
 	bool _levelBuilt;
 
@@ -49,7 +49,8 @@ public:
 	* NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a model on
 	* the heap, use one of the static constructors instead.
 	*/
-	LevelController() : Asset(), _world(nullptr), _player(nullptr), _gamestate(nullptr), _levelBuilt(false) { }
+	LevelController() : Asset(), _gamestate(nullptr), _bounds(Rect::ZERO), _world(nullptr), _player(nullptr),
+		_board(nullptr), _tileBoard(nullptr), _levelBuilt(false) { }
 
 	/**
 	* Destroys this game state, releasing all resources.
@@ -85,6 +86,24 @@ public:
 	*/
 	virtual bool preload(const std::shared_ptr<JsonValue>& json) override;
 
+	/**
+	* Loads this game level from a JSON stream, without building a JSON tree.
+	*
+	* @param reader the stream positioned at the level object
+	*
+	* @return true if successfully loaded the level from the stream
+	*/
+	bool preload(const std::shared_ptr<JsonStreamReader>& reader);
+
+	/**
+	* Loads this game level from a level collected by a LevelBuilder.
+	*
+	* @param level the collected level
+	*
+	* @return true if successfully loaded the level
+	*/
+	bool preload(const LevelBuilder& level);
+
 	/**
 	* Unloads this game level, releasing all sources
 	*/
@@ -94,17 +113,14 @@ public:
 #pragma mark -
 #pragma mark Level Loading
 	/** Loads the floor tiles */
-	bool loadTerrain(const std::shared_ptr<JsonValue>& json);
+	bool loadTerrain(const LevelBuilder& level);
 
 	/** Loads a single floor tile */
 	bool loadLandTile(Vec2 tilePos, float tileVal, TILE_TYPE tileType, std::shared_ptr<JsonValue>& layer);
 	bool loadWaterTile(Vec2 tilePos, float tileVal, TILE_TYPE tileType, std::shared_ptr<JsonValue>& layer);
 
 	/** Loads the player, enemies, and inanimate objects */
-	bool loadUnits(const std::shared_ptr<JsonValue>& json);
-
-	/** Adds friction joints between units and the ground to simulate top-down friction. */
-	void addFrictionJoints();
+	bool loadUnits(const LevelBuilder& level);
 
 	/** Builds a game state from the loaded level */
 	void buildGameState();
@@ -5,7 +5,6 @@
 
 #include "ObjectModel.h"
 #include "Constants.h"
-#include <cugl/util/CUTimestamp.h>
 
 #define MAX_SPEED_FOR_SLING 2
 #define IMPULSE_SCALE 8
@@ -34,9 +33,11 @@ bool ObjectModel::init(const Vec2 & pos, const Size & size) {
 		setDensity(10.0f);
 		setRestitution(0.4f);
 		setFixedRotation(true);
+		setGrounded(true);
 
 		_broken = false;
 		_animating = false;
+		_frame = 0;
 
 		return true;
 	}
@@ -44,23 +45,45 @@ bool ObjectModel::init(const Vec2 & pos, const Size & size) {
 }
 
 void ObjectModel::dispose() {
+	if (_timers != nullptr) {
+		_timers->cancel(_stopTimer);
+		_timers = nullptr;
+	}
 	_node = nullptr;
-	_frictionJoint = nullptr;
+}
+
+/**
+* Stop this object after timeout milliseconds
+*/
+void ObjectModel::setShouldStop() {
+	CUAssertLog(_timers, "Object has no simulation timers");
+	_shouldStopSoon = true;
+	_timers->cancel(_stopTimer);
+	_stopTimer = _timers->schedule(COLLISION_TIMEOUT, [this] {
+		_shouldStopSoon = false;
+		if (_body != nullptr) {
+			_body->SetLinearVelocity(b2Vec2(0, 0));
+		}
+	});
 }
 
 void ObjectModel::animate() {
-	std::shared_ptr<AnimationNode> node = std::dynamic_pointer_cast<AnimationNode>(_node);
-	int frame = node->getFrame();
 	if (isBreakable()) {
-		if (frame < 5) {
-			node->setFrame(frame + 1);
+		if (_frame < 5) {
+			_frame++;
 		}
 		else {
 			setBroken();
 		}
 	}
-	else if (frame < 11) {
-		node->setFrame(frame + 1);
+	else if (_frame < 11) {
+		_frame++;
+	}
+
+	// The frame lives in the model, so a level without a scene graph still breaks
+	std::shared_ptr<AnimationNode> node = std::dynamic_pointer_cast<AnimationNode>(_node);
+	if (node != nullptr) {
+		node->setFrame(_frame);
 	}
 }
 
@@ -82,9 +105,4 @@ void ObjectModel::update(float dt) {
 		_node->setPosition(getPosition()*_drawscale);
 		_node->setAngle(getAngle());
 	}
-
-	if (_shouldStopSoon && Timestamp().ellapsedMillis(_collisionTimeout) >= COLLISION_TIMEOUT) {
-		_shouldStopSoon = false;
-		_body->SetLinearVelocity(b2Vec2(0, 0));
-	}
 }
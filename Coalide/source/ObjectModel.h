@@ -5,9 +5,8 @@
 #ifndef __OBJECT_MODEL_H__
 #define __OBJECT_MODEL_H__
 #include <cugl/cugl.h>
-#include <cugl/util/CUTimestamp.h>
-#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include "Constants.h"
+#include "TimerWheel.h"
 
 using namespace cugl;
 
@@ -21,19 +20,20 @@ protected:
 	/** The texture key */
 	std::string _texture;
 
-	/** to keep track of how long to wait before stopping */
-	Timestamp _collisionTimeout;
+	/** The simulation timers of the level */
+	std::shared_ptr<TimerWheel> _timers;
+	/** The timer to stop after a collision */
+	TimerWheel::TimerId _stopTimer;
 	/** a collision happened and we want to stop soon */
 	bool _shouldStopSoon;
 
-	b2FrictionJoint* _frictionJoint;
-	float _friction;
-
 	/** The force to apply */
 	Vec2 _force;
 
 	bool _broken;
 	bool _animating;
+	/** The current frame of the object animation */
+	int _frame;
 
 	/** The ratio of the sprite to the physics body */
 	float _drawscale;
@@ -46,7 +46,7 @@ public:
 	/**
 	* Creates a new enemy at the origin.
 	*/
-	ObjectModel(void) : CapsuleObstacle() { }
+	ObjectModel(void) : CapsuleObstacle(), _stopTimer(0) { }
 
 	/**
 	* Destroys this enemy, releasing all resources.
@@ -119,21 +119,6 @@ public:
 	*/
 	void setForce(const Vec2& value) { _force.set(value); }
 
-	/**
-	* Returns the current friction.
-	*/
-	float getFriction() { return _friction; }
-
-	/**
-	* Sets the friction of the friction joint with the ground.
-	*/
-	void setFriction(float friction) override { _friction = friction; _frictionJoint->SetMaxForce(friction); _frictionJoint->SetMaxTorque(friction); }
-
-	/**
-	* Sets the friction joint with the ground.
-	*/
-	void setFrictionJoint(b2FrictionJoint* frictionJoint) { _frictionJoint = frictionJoint; }
-
 	/**
 	* Returns the scene graph node representing this enemy.
 	*
@@ -176,6 +161,13 @@ public:
 	*/
 	void setDrawScale(float scale) { _drawscale = scale; }
 
+	/**
+	* Sets the simulation timers that run the stop timeout.
+	*
+	* @param timers The simulation timers of the level
+	*/
+	void setTimers(const std::shared_ptr<TimerWheel>& timers) { _timers = timers; }
+
 	/**
 	* Is this enemy already stopping soon
 	*/
@@ -200,10 +192,7 @@ public:
 	/**
 	* Stop this enemy after timeout milliseconds
 	*/
-	void setShouldStop() {
-		_collisionTimeout.mark();
-		_shouldStopSoon = true;
-	}
+	void setShouldStop();
 
 	/**
 	* Updates the object's physics state (NOT GAME LOGIC). This is the method
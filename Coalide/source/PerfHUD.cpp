@@ -0,0 +1,225 @@
+//
+//  PerfHUD.cpp
+//  Coalide
+//
+#include "PerfHUD.h"
+#include <Box2D/Dynamics/b2World.h>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+using namespace cugl;
+
+/** The seconds between refreshes of the text */
+#define PERF_HUD_REFRESH    0.25f
+/** The number of frame times to reserve for the percentiles */
+#define PERF_HUD_SAMPLES    300
+/** The scale of the overlay font */
+#define PERF_HUD_SCALE      0.3f
+/** The offset of the shadow in font pixels */
+#define PERF_HUD_SHADOW     4.0f
+/** The color of the overlay text */
+#define PERF_HUD_COLOR      Color4::WHITE
+/** The color of the overlay shadow */
+#define PERF_HUD_BACKDROP   Color4::BLACK
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an empty overlay.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an overlay on
+ * the heap, use one of the static constructors instead.
+ */
+PerfHUD::PerfHUD() : Node(),
+_elapsed(0) {
+	_name = "PerfHUD";
+	_text[0] = '\0';
+}
+
+/**
+ * Disposes all of the resources used by this overlay.
+ */
+void PerfHUD::dispose() {
+	_font = nullptr;
+	_atlas = nullptr;
+	_assets = nullptr;
+	_gamestate = nullptr;
+	_samples.clear();
+	_vertices.clear();
+	_indices.clear();
+	_text[0] = '\0';
+	_elapsed = 0;
+	Node::dispose();
+}
+
+/**
+ * Initializes an overlay with the given font and assets.
+ *
+ * @param font		The font of the overlay (which must have an atlas)
+ * @param assets		The assets to measure
+ *
+ * @return true if the overlay is initialized properly, false otherwise.
+ */
+bool PerfHUD::init(const std::shared_ptr<Font>& font, const std::shared_ptr<AssetManager>& assets) {
+	if (font == nullptr || !font->hasAtlas()) {
+		CULogError("The performance overlay needs a font with an atlas");
+		return false;
+	} else if (!Node::init()) {
+		return false;
+	}
+
+	_font = font;
+	_atlas = font->getAtlas();
+	_assets = assets;
+
+	// Every character is a text quad and a shadow quad
+	_samples.reserve(PERF_HUD_SAMPLES);
+	_vertices.reserve(8*PERF_HUD_CAPACITY);
+	_indices.reserve(12*PERF_HUD_CAPACITY);
+
+	setAnchor(Vec2::ANCHOR_TOP_LEFT);
+	setScale(PERF_HUD_SCALE);
+	_elapsed = PERF_HUD_REFRESH;
+	return true;
+}
+
+
+#pragma mark -
+#pragma mark Updating
+/**
+ * Returns the number of visible nodes in the given subtree.
+ *
+ * @param node	The subtree root
+ *
+ * @return the number of visible nodes in the given subtree.
+ */
+int PerfHUD::countVisible(const Node* node) {
+	if (!node->isVisible()) {
+		return 0;
+	}
+	int result = 1;
+	for (const std::shared_ptr<Node>& child : node->getChildren()) {
+		result += countVisible(child.get());
+	}
+	return result;
+}
+
+/**
+ * Rewrites the text of the overlay from the current measurements.
+ */
+void PerfHUD::refresh() {
+	int length = 0;
+	Application* app = Application::get();
+	FrameRecorder* recorder = app->getFrameRecorder();
+	if (recorder != nullptr && recorder->size() > 0) {
+		_samples.resize(recorder->size());
+		for (size_t ii = 0; ii < recorder->size(); ii++) {
+			_samples[ii] = recorder->getFrame(ii).total;
+		}
+		std::sort(_samples.begin(), _samples.end());
+		size_t last = _samples.size()-1;
+		const FrameRecorder::Frame& frame = recorder->getFrame(last);
+		length += snprintf(_text+length, PERF_HUD_CAPACITY-length,
+			"frame p50 %.1f  p95 %.1f  p99 %.1f ms  jitter %.2f ms\nphysics %.2f ms  sort %.2f ms\ndraws %u  vertices %u\n",
+			_samples[last/2]/1000.0f, _samples[(last*95)/100]/1000.0f, _samples[(last*99)/100]/1000.0f,
+			sqrtf(app->getFrameIntervalVariance()),
+			frame.stages[FrameRecorder::PHYSICS]/1000.0f, frame.stages[FrameRecorder::SORT]/1000.0f,
+			frame.flushes, frame.vertices);
+	}
+
+	if (_gamestate != nullptr && _gamestate->getWorld() != nullptr && length < PERF_HUD_CAPACITY) {
+		b2World* world = _gamestate->getWorld()->getWorld();
+		length += snprintf(_text+length, PERF_HUD_CAPACITY-length, "bodies %d  contacts %d  proxies %d\n",
+			world->GetBodyCount(), world->GetContactCount(), world->GetProxyCount());
+		if (_gamestate->getWorldNode() != nullptr && length < PERF_HUD_CAPACITY) {
+			length += snprintf(_text+length, PERF_HUD_CAPACITY-length, "nodes %d\n",
+				countVisible(_gamestate->getWorldNode().get()));
+		}
+	}
+
+	if (_assets != nullptr && length < PERF_HUD_CAPACITY) {
+		snprintf(_text+length, PERF_HUD_CAPACITY-length, "assets %.1f MB",
+			_assets->getMemoryUsage()/(1024.0f*1024.0f));
+	}
+}
+
+/**
+ * Rebuilds the quads of the overlay from its text.
+ */
+void PerfHUD::layout() {
+	_vertices.clear();
+	_indices.clear();
+
+	int lines = 1;
+	for (const char* c = _text; *c; c++) {
+		lines += (*c == '\n');
+	}
+
+	// Glyph origins are the bottom of the line, including the descent
+	float skip = (float)_font->getLineSkip();
+	float height = lines*skip;
+	Rect bounds(0, 0, 1.0e6f, height);
+	Vec2 offset(0, height-skip);
+	float width = 0;
+	for (const char* c = _text; *c; c++) {
+		if (*c == '\n') {
+			width = std::max(width, offset.x);
+			offset.set(0, offset.y-skip);
+		} else {
+			_font->getQuad((Uint32)(unsigned char)*c, offset, bounds, _vertices);
+		}
+	}
+	width = std::max(width, offset.x);
+
+	// The shadow quads come first, so the text is drawn over them
+	size_t count = _vertices.size();
+	_vertices.resize(2*count);
+	for (size_t ii = 0; ii < count; ii++) {
+		_vertices[count+ii] = _vertices[ii];
+		_vertices[count+ii].color = PERF_HUD_COLOR;
+		_vertices[ii].position += Vec2(PERF_HUD_SHADOW, -PERF_HUD_SHADOW);
+		_vertices[ii].color = PERF_HUD_BACKDROP;
+	}
+	for (unsigned short jj = 0; jj < _vertices.size(); jj += 4) {
+		_indices.push_back(jj  ); _indices.push_back(jj+1); _indices.push_back(jj+2);
+		_indices.push_back(jj+2); _indices.push_back(jj+3); _indices.push_back(jj  );
+	}
+	setContentSize(width+PERF_HUD_SHADOW, height+PERF_HUD_SHADOW);
+	markDirty();
+}
+
+/**
+ * Refreshes the text of the overlay if it is due.
+ *
+ * @param dt	The amount of time (in seconds) since the last frame
+ */
+void PerfHUD::update(float dt) {
+	_elapsed += dt;
+	if (_elapsed < PERF_HUD_REFRESH) {
+		return;
+	}
+	_elapsed = 0;
+	refresh();
+	layout();
+}
+
+/**
+ * Draws the overlay via the given SpriteBatch.
+ *
+ * @param batch     The SpriteBatch to draw with.
+ * @param transform The global transformation matrix.
+ * @param tint      The tint to blend with the Node color.
+ */
+void PerfHUD::draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) {
+	if (_vertices.empty()) {
+		return;
+	}
+	batch->setBlendEquation(GL_FUNC_ADD);
+	batch->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	batch->setTexture(_atlas);
+	batch->setColor(tint);
+	batch->fill(_vertices.data(), (unsigned int)_vertices.size(), 0,
+		_indices.data(), (unsigned int)_indices.size(), 0, transform);
+}
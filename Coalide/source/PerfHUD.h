@@ -0,0 +1,143 @@
+//
+//  PerfHUD.h
+//  Coalide
+//
+#ifndef __PERF_HUD_H__
+#define __PERF_HUD_H__
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "GameState.h"
+
+using namespace cugl;
+
+/** The largest number of characters shown by the overlay */
+#define PERF_HUD_CAPACITY   512
+
+
+#pragma mark -
+#pragma mark Performance HUD
+
+/**
+* A scene graph node that shows live performance numbers over the game.
+*
+* The overlay shows the frame time percentiles, the frame pacing jitter and
+* the physics step time from the application, the Box2D body, contact and
+* proxy counts, the sprite batch draw calls and vertices of the last frame,
+* the visible nodes of the world node, and the memory used by the assets.
+*
+* The text is refreshed a few times a second so that it is readable. It is
+* laid out directly from the font atlas into vertex buffers that are reserved
+* when the overlay is created, and it is drawn with a single fill (the shadow
+* uses the same atlas). Hence the overlay never allocates once it is running.
+*/
+class PerfHUD : public Node {
+protected:
+	/** The font of the overlay (which must have an atlas) */
+	std::shared_ptr<Font> _font;
+	/** The atlas texture of the font */
+	std::shared_ptr<Texture> _atlas;
+	/** The assets to measure */
+	std::shared_ptr<AssetManager> _assets;
+	/** The level to measure */
+	std::shared_ptr<GameState> _gamestate;
+
+	/** The frame times of the recorder, to sort for the percentiles */
+	std::vector<Uint32> _samples;
+	/** The glyph and shadow quads */
+	std::vector<Vertex2> _vertices;
+	/** The triangulation of the quads */
+	std::vector<unsigned short> _indices;
+	/** The text of the overlay */
+	char _text[PERF_HUD_CAPACITY];
+	/** The time since the text was refreshed */
+	float _elapsed;
+
+	/**
+	* Rewrites the text of the overlay from the current measurements.
+	*/
+	void refresh();
+
+	/**
+	* Rebuilds the quads of the overlay from its text.
+	*/
+	void layout();
+
+	/**
+	* Returns the number of visible nodes in the given subtree.
+	*
+	* @param node	The subtree root
+	*
+	* @return the number of visible nodes in the given subtree.
+	*/
+	static int countVisible(const Node* node);
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an empty overlay.
+	*
+	* NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an overlay on
+	* the heap, use one of the static constructors instead.
+	*/
+	PerfHUD();
+
+	/**
+	* Destroys this overlay, releasing all resources.
+	*/
+	~PerfHUD() { dispose(); }
+
+	/**
+	* Disposes all of the resources used by this overlay.
+	*/
+	virtual void dispose() override;
+
+	/**
+	* Initializes an overlay with the given font and assets.
+	*
+	* @param font		The font of the overlay (which must have an atlas)
+	* @param assets		The assets to measure
+	*
+	* @return true if the overlay is initialized properly, false otherwise.
+	*/
+	bool init(const std::shared_ptr<Font>& font, const std::shared_ptr<AssetManager>& assets);
+
+	/**
+	* Returns a newly allocated overlay with the given font and assets.
+	*
+	* @param font		The font of the overlay (which must have an atlas)
+	* @param assets		The assets to measure
+	*
+	* @return a newly allocated overlay with the given font and assets.
+	*/
+	static std::shared_ptr<PerfHUD> alloc(const std::shared_ptr<Font>& font, const std::shared_ptr<AssetManager>& assets) {
+		std::shared_ptr<PerfHUD> result = std::make_shared<PerfHUD>();
+		return (result->init(font, assets) ? result : nullptr);
+	}
+
+#pragma mark Updating
+	/**
+	* Sets the level to measure.
+	*
+	* @param gamestate	The level to measure
+	*/
+	void setGameState(const std::shared_ptr<GameState>& gamestate) { _gamestate = gamestate; }
+
+	/**
+	* Refreshes the text of the overlay if it is due.
+	*
+	* @param dt	The amount of time (in seconds) since the last frame
+	*/
+	void update(float dt);
+
+	/**
+	* Draws the overlay via the given SpriteBatch.
+	*
+	* @param batch     The SpriteBatch to draw with.
+	* @param transform The global transformation matrix.
+	* @param tint      The tint to blend with the Node color.
+	*/
+	virtual void draw(const std::shared_ptr<SpriteBatch>& batch, const Mat4& transform, Color4 tint) override;
+};
+
+#endif /* __PERF_HUD_H__ */
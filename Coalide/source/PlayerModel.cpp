@@ -36,6 +36,9 @@ bool PlayerModel::init(const Vec2 & pos, const Size & size) {
 		setDensity(4.0f);
 		setRestitution(0.5f);
 		setFixedRotation(true);
+		setGrounded(true);
+		// Stun on stop and camera shake run in update, even while asleep
+		setAlwaysUpdated(true);
 
 		_stunned = false;
         _stunOnStop = false;
@@ -53,8 +56,61 @@ bool PlayerModel::init(const Vec2 & pos, const Size & size) {
 }
 
 void PlayerModel::dispose() {
+	if (_timers != nullptr) {
+		_timers->cancel(_stopTimer);
+		_timers->cancel(_stunTimer);
+		_timers = nullptr;
+	}
 	_node = nullptr;
-	_frictionJoint = nullptr;
+}
+
+/**
+ * Stuns this player for 3 seconds of simulation time
+ */
+void PlayerModel::setStunned() {
+    if(!_stunned){
+        _stunDuration = 3000;
+        startStun();
+        updateArrow(false);
+        updateCircle(false);
+    }
+}
+
+/**
+ * Stuns this player for the given milliseconds once it slows down
+ */
+void PlayerModel::stunOnStop(int millis) {
+    if(!_stunned){
+        _stunDuration = millis;
+        _stunOnStop = true;
+        updateArrow(false);
+        updateCircle(false);
+    }
+}
+
+/**
+ * Stuns this player, scheduling the end of the stun
+ */
+void PlayerModel::startStun() {
+    CUAssertLog(_timers, "Player has no simulation timers");
+    _stunned = true;
+    _timers->cancel(_stunTimer);
+    _stunTimer = _timers->schedule(_stunDuration, [this] { _stunned = false; });
+}
+
+/**
+ * Stop this player after timeout milliseconds
+ */
+void PlayerModel::setShouldStop() {
+    CUAssertLog(_timers, "Player has no simulation timers");
+    _shouldStopSoon = true;
+    _timers->cancel(_stopTimer);
+    _stopTimer = _timers->schedule(COLLISION_TIMEOUT, [this] {
+        _shouldStopSoon = false;
+        if (_body != nullptr) {
+            _body->SetLinearVelocity(b2Vec2(0,0));
+        }
+    });
 }
 
 
@@ -98,6 +154,9 @@ bool PlayerModel::isSuperCollide() {
  * @param mode   the state of Nicoal (standing, sliding, chargning, etc)
  */
 void PlayerModel::setDirectionTexture(float angle, int mode){
+    if (_node == nullptr) {
+        return;
+    }
     float row_texture = 512.0f - (mode * 64.0f);
     
     if(angle > ONE_ANGLE && angle <= TWO_ANGLE){
@@ -143,6 +202,9 @@ void PlayerModel::setDirectionTexture(float angle, int mode){
 }
 
 void PlayerModel::setDirectionTexture(int dir, int mode){
+    if (_node == nullptr) {
+        return;
+    }
     float row_texture = 512.0f - (mode * 64.0f);
     
     if(dir == 0){
@@ -225,28 +287,15 @@ void PlayerModel::updateCircle(cugl::Vec2 aim, std::shared_ptr<Node> currNode, b
 }
 
 void PlayerModel::updateArrow(bool visible) {
-	_arrow->setVisible(visible);
+	if (_arrow != nullptr) {
+		_arrow->setVisible(visible);
+	}
 }
 
 void PlayerModel::updateCircle(bool visible) {
-    _circle->setVisible(visible);
-}
-
-void PlayerModel::updateSparks(bool visible) {
-	_sparks->setVisible(visible);
-}
-
-void PlayerModel::updateSparks() {
-	if (_sparks->isVisible()) {
-		int frame = _sparks->getFrame();
-		if (frame < 5) {
-			_sparks->setFrame(frame + 1);
-		}
-		else {
-			_sparks->setVisible(false);
-			_sparks->setFrame(0);
-		}
-	}
+    if (_circle != nullptr) {
+        _circle->setVisible(visible);
+    }
 }
 
 
@@ -273,17 +322,9 @@ void PlayerModel::update(float dt) {
 //            _node->setColor(_color);
         }
 	}
-    if(_shouldStopSoon && Timestamp().ellapsedMillis(_collisionTimeout) >= COLLISION_TIMEOUT){
-        _shouldStopSoon = false;
-        _body->SetLinearVelocity(b2Vec2(0,0));
-    }
     if(_stunOnStop && getLinearVelocity().length() <= MAX_SPEED_FOR_SLING){
         _stunOnStop = false;
-        _stunned = true;
-        _stunTimeout.mark();
-    }
-    if(_stunned && Timestamp().ellapsedMillis(_stunTimeout) >= _stunDuration){
-        _stunned = false;
+        startStun();
     }
     
     _cameraShakeAmplitude *= .9;
@@ -5,8 +5,8 @@
 #ifndef __PLAYER_MODEL_H__
 #define __PLAYER_MODEL_H__
 #include <cugl/cugl.h>
-#include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include "Constants.h"
+#include "TimerWheel.h"
 
 using namespace cugl;
 
@@ -17,10 +17,12 @@ class PlayerModel : public CapsuleObstacle {
 private:
     /** default tint */
     Color4 _color;
-    /** to keep track of how long to wait before stopping */
-    Timestamp _collisionTimeout;
-    /** to keep track of how long to wait before becoming unstunned */
-    Timestamp _stunTimeout;
+    /** the simulation timers of the level */
+    std::shared_ptr<TimerWheel> _timers;
+    /** the timer to stop after a collision */
+    TimerWheel::TimerId _stopTimer;
+    /** the timer to end the current stun */
+    TimerWheel::TimerId _stunTimer;
     /** a collision happened and we want to stop soon */
     bool _shouldStopSoon;
     /** charging or floored */
@@ -42,6 +44,11 @@ private:
     
     float _cameraShakeAmplitude = 0;
     
+    /**
+     * Stuns this player, scheduling the end of the stun
+     */
+    void startStun();
+    
 protected:
     std::shared_ptr<AssetManager> _assets;
 	std::shared_ptr<PolygonNode> _node;
@@ -55,12 +62,9 @@ protected:
     
     /** The animation actions */
     std::shared_ptr<cugl::Animate> _forward;
-	std::shared_ptr<cugl::AnimationNode> _sparks;
 	bool _sparky;
 
 	Vec2 _force;
-	b2FrictionJoint* _frictionJoint;
-	int _friction;
 
 	float _drawscale;
 
@@ -78,7 +82,7 @@ public:
 	/**
 	* Creates a new player at the origin.
 	*/
-	PlayerModel(void) : CapsuleObstacle() { }
+	PlayerModel(void) : CapsuleObstacle(), _stopTimer(0), _stunTimer(0) { }
 
 	/**
 	* Destroys the player, releasing all resources.
@@ -117,28 +121,24 @@ public:
 
 #pragma mark -
 #pragma mark Status
-	bool isStunned() { return _stunned; }
+	/**
+	* Sets the simulation timers that run the stun and stop timeouts.
+	*
+	* @param timers The simulation timers of the level
+	*/
+	void setTimers(const std::shared_ptr<TimerWheel>& timers) { _timers = timers; }
 
-	void setStunned() {
-        if(!_stunned){
-            _stunned = true;
-            _stunTimeout.mark();
-            _stunDuration = 3000;
-            updateArrow(false);
-            updateCircle(false);
-        }
+	bool isStunned() { return _stunned; }
 
-    }
+	/**
+	* Stuns this player for 3 seconds of simulation time
+	*/
+	void setStunned();
     
-    void stunOnStop(int millis){
-        if(!_stunned){
-            _stunTimeout.mark();
-            _stunDuration = millis;
-            _stunOnStop = true;
-            updateArrow(false);
-            updateCircle(false);
-        }
-    }
+    /**
+     * Stuns this player for the given milliseconds once it slows down
+     */
+    void stunOnStop(int millis);
 
 	bool isFire() { return _onFire; }
 
@@ -160,21 +160,6 @@ public:
 	*/
 	void setForce(const Vec2& value) { _force.set(value); }
     
-	/**
-	* Returns the current friction.
-	*/
-	int getFriction() { return _friction; }
-
-	/**
-	* Sets the friction of the friction joint with the ground.
-	*/
-	void setFriction(int friction) { _friction = friction; _frictionJoint->SetMaxForce(friction); _frictionJoint->SetMaxTorque(friction); }
-
-	/**
-	* Sets the friction joint with the ground.
-	*/
-	void setFrictionJoint(b2FrictionJoint* frictionJoint) { _frictionJoint = frictionJoint; }
-    
     /**
      * Sets whether player is charging or floored.
      *
@@ -218,7 +203,6 @@ public:
 	*/
 	void setArrow(const std::shared_ptr<Node>& arrow) { _arrow = arrow; }
     void setCircle(const std::shared_ptr<PolygonNode>& circle) { _circle = circle; }
-	void setSparks(const std::shared_ptr<AnimationNode>& sparks) { _sparks = sparks; }
     
     void setDirectionTexture(float angle, int mode);
     void setDirectionTexture(int dir, int mode);
@@ -298,8 +282,6 @@ public:
 	void updateArrow(bool visible);
     void updateCircle(cugl::Vec2 aim, std::shared_ptr<Node> currNode, bool visible);
     void updateCircle(bool visible);
-	void updateSparks();
-	void updateSparks(bool visible);
 
 #pragma mark -
 #pragma mark Physics
@@ -311,10 +293,7 @@ public:
     /**
      * Stop this player after timeout milliseconds
      */
-    void setShouldStop(){
-        _collisionTimeout.mark();
-        _shouldStopSoon = true;
-    }
+    void setShouldStop();
 
 	/**
 	* Updates the object's physics state (NOT GAME LOGIC). This is the method 
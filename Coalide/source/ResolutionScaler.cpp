@@ -0,0 +1,160 @@
+//
+//  ResolutionScaler.cpp
+//  Coalide
+//
+#include "ResolutionScaler.h"
+#include <algorithm>
+
+using namespace cugl;
+
+/** The number of frames judged together */
+#define SCALER_WINDOW       30
+/** The number of GPU bound frames in a window that steps the scale down */
+#define SCALER_MISS_LIMIT   3
+/** The number of stable windows required to step up at first */
+#define SCALER_PROBE        4
+/** The largest number of stable windows required to step up */
+#define SCALER_PROBE_MAX    64
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+* Creates a scaler at full resolution.
+*
+* The scaler must be initialized before it is used.
+*/
+ResolutionScaler::ResolutionScaler() :
+_scale(1.0f),
+_minScale(1.0f),
+_maxScale(1.0f),
+_step(0.1f),
+_last(0),
+_frames(0),
+_missed(0),
+_stable(0),
+_probe(SCALER_PROBE),
+_sinceUp(-1) {
+}
+
+/**
+* Initializes a scaler with the given bounds and step.
+*
+* The scaler starts at the largest scale.
+*
+* @param minScale	The smallest scale
+* @param maxScale	The largest scale
+* @param step		The amount to change the scale by in one step
+*
+* @return true if the scaler is initialized properly, false otherwise.
+*/
+bool ResolutionScaler::init(float minScale, float maxScale, float step) {
+	if (minScale <= 0 || minScale > maxScale || step <= 0) {
+		CULogError("Invalid resolution scale range [%.2f, %.2f] with step %.2f", minScale, maxScale, step);
+		return false;
+	}
+	_minScale = minScale;
+	_maxScale = maxScale;
+	_step = step;
+	reset();
+	return true;
+}
+
+/**
+* Returns the scaler to the largest scale, and forgets its history.
+*/
+void ResolutionScaler::reset() {
+	_scale = _maxScale;
+	_frames = 0;
+	_missed = 0;
+	_stable = 0;
+	_probe = SCALER_PROBE;
+	_sinceUp = -1;
+
+	// Do not judge the frames before the reset (e.g. a level load)
+	FrameRecorder* recorder = Application::get()->getFrameRecorder();
+	if (recorder != nullptr && recorder->size() > 0) {
+		_last = recorder->getFrame(recorder->size()-1).index;
+	}
+}
+
+
+#pragma mark -
+#pragma mark Scaling
+/**
+* Judges the frames recorded since the last update.
+*
+* This returns true if the scale changed.
+*
+* @return true if the scale changed.
+*/
+bool ResolutionScaler::update() {
+	FrameRecorder* recorder = Application::get()->getFrameRecorder();
+	if (recorder == nullptr || recorder->size() == 0) {
+		return false;
+	}
+
+	// Idle frames are not recorded, so there may be any number of new frames
+	size_t size = recorder->size();
+	size_t first = size;
+	while (first > 0 && recorder->getFrame(first-1).index > _last) {
+		first--;
+	}
+
+	float budget = 1000000.0f/Application::get()->getFPS();
+	float before = _scale;
+	for (size_t ii = first; ii < size; ii++) {
+		judgeFrame(recorder->getFrame(ii), budget);
+	}
+	return _scale != before;
+}
+
+/**
+* Judges a single frame against the given budget.
+*
+* This is called by {@link update} for each new frame in the recorder.
+* It is exposed so that synthetic frames can be judged.
+*
+* @param frame	The frame timings
+* @param budget	The frame period in microseconds
+*/
+void ResolutionScaler::judgeFrame(const FrameRecorder::Frame& frame, float budget) {
+	if (FrameRecorder::isGpuBound(frame, budget)) {
+		_missed++;
+	}
+	_last = frame.index;
+	if (++_frames == SCALER_WINDOW) {
+		judge();
+	}
+}
+
+/**
+* Judges the current window, and steps the scale if necessary.
+*/
+void ResolutionScaler::judge() {
+	if (_missed > SCALER_MISS_LIMIT) {
+		if (_sinceUp >= 0) {
+			// The last step up was too far, so wait longer to try again
+			_probe = std::min(2*_probe, SCALER_PROBE_MAX);
+		}
+		_scale = std::max(_minScale, _scale-_step);
+		_stable = 0;
+		_sinceUp = -1;
+	} else if (_missed == 0) {
+		_stable++;
+		if (_stable >= _probe && _scale < _maxScale) {
+			_scale = std::min(_maxScale, _scale+_step);
+			_stable = 0;
+			_sinceUp = 0;
+		}
+	} else {
+		_stable = 0;
+	}
+
+	// A step up that lasts a whole probe was a success
+	if (_sinceUp >= 0 && ++_sinceUp > _probe) {
+		_sinceUp = -1;
+	}
+	_frames = 0;
+	_missed = 0;
+}
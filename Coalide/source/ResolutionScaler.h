@@ -0,0 +1,128 @@
+//
+//  ResolutionScaler.h
+//  Coalide
+//
+#ifndef __RESOLUTION_SCALER_H__
+#define __RESOLUTION_SCALER_H__
+
+#include <cugl/cugl.h>
+
+using namespace cugl;
+
+
+#pragma mark -
+#pragma mark Resolution Scaler
+
+/**
+* A controller that picks the resolution to draw the game world at.
+*
+* OpenGL ES has no portable GPU timer queries, so the scaler judges the GPU
+* from the frame recorder instead (see {@link FrameRecorder#isGpuBound}).
+* Frames that are slow because of the update are ignored, as a lower
+* resolution would not help them.
+*
+* The frames are judged in windows.  The scale steps down after a window
+* with too many GPU bound frames, and steps up after a probe of windows with
+* none.  If a step up is followed by a step down within the next probe, the
+* probe doubles, so the scale does not oscillate around the limit of the GPU.
+*/
+class ResolutionScaler {
+protected:
+	/** The current scale of the world resolution */
+	float _scale;
+	/** The smallest scale */
+	float _minScale;
+	/** The largest scale */
+	float _maxScale;
+	/** The amount to change the scale by in one step */
+	float _step;
+
+	/** The index of the last frame judged */
+	Uint64 _last;
+	/** The number of frames judged in the current window */
+	int _frames;
+	/** The number of GPU bound frames in the current window */
+	int _missed;
+	/** The number of consecutive windows without a GPU bound frame */
+	int _stable;
+	/** The number of stable windows required to step up */
+	int _probe;
+	/** The number of windows since the last step up (or -1 if none is pending) */
+	int _sinceUp;
+
+	/**
+	* Judges the current window, and steps the scale if necessary.
+	*/
+	void judge();
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates a scaler at full resolution.
+	*
+	* The scaler must be initialized before it is used.
+	*/
+	ResolutionScaler();
+
+	/**
+	* Initializes a scaler with the given bounds and step.
+	*
+	* The scaler starts at the largest scale.
+	*
+	* @param minScale	The smallest scale
+	* @param maxScale	The largest scale
+	* @param step		The amount to change the scale by in one step
+	*
+	* @return true if the scaler is initialized properly, false otherwise.
+	*/
+	bool init(float minScale, float maxScale, float step);
+
+	/**
+	* Returns the scaler to the largest scale, and forgets its history.
+	*/
+	void reset();
+
+#pragma mark Scaling
+	/**
+	* Judges the frames recorded since the last update.
+	*
+	* This returns true if the scale changed.
+	*
+	* @return true if the scale changed.
+	*/
+	bool update();
+
+	/**
+	* Judges a single frame against the given budget.
+	*
+	* This is called by {@link update} for each new frame in the recorder.
+	* It is exposed so that synthetic frames can be judged.
+	*
+	* @param frame	The frame timings
+	* @param budget	The frame period in microseconds
+	*/
+	void judgeFrame(const FrameRecorder::Frame& frame, float budget);
+
+	/**
+	* Returns the current scale of the world resolution.
+	*
+	* @return the current scale of the world resolution.
+	*/
+	float getScale() const { return _scale; }
+
+	/**
+	* Returns the smallest scale.
+	*
+	* @return the smallest scale.
+	*/
+	float getMinScale() const { return _minScale; }
+
+	/**
+	* Returns the largest scale.
+	*
+	* @return the largest scale.
+	*/
+	float getMaxScale() const { return _maxScale; }
+};
+
+#endif /* __RESOLUTION_SCALER_H__ */
@@ -0,0 +1,187 @@
+//
+//  SpatialHash.cpp
+//  Coalide
+//
+#include "SpatialHash.h"
+#include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Fixture.h>
+#include <Box2D/Collision/Shapes/b2Shape.h>
+
+using namespace cugl;
+
+/** The radius of a unit without a body */
+static const float SPATIAL_HASH_RADIUS = 0.5f;
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an empty spatial hash.
+ *
+ * @param cellSize  The width and height of a cell in physics units
+ * @param buckets   The number of buckets (rounded up to a power of two)
+ */
+SpatialHash::SpatialHash(float cellSize, int buckets) :
+_cellSize(cellSize),
+_invCellSize(1.0f/cellSize),
+_maxRadius(0) {
+	int size = 1;
+	while (size < buckets) {
+		size <<= 1;
+	}
+	_buckets.assign(size, -1);
+}
+
+
+#pragma mark -
+#pragma mark Internals
+/**
+ * Places the entry in the bucket of its cell.
+ *
+ * @param index The entry index
+ */
+void SpatialHash::link(int index) {
+	Entry& entry = _entries[index];
+	int bucket = bucketOf(entry.cellX, entry.cellY);
+	entry.prev = -1;
+	entry.next = _buckets[bucket];
+	if (entry.next != -1) {
+		_entries[entry.next].prev = index;
+	}
+	_buckets[bucket] = index;
+}
+
+/**
+ * Removes the entry from its bucket.
+ *
+ * @param index The entry index
+ */
+void SpatialHash::unlink(int index) {
+	Entry& entry = _entries[index];
+	if (entry.prev != -1) {
+		_entries[entry.prev].next = entry.next;
+	} else {
+		_buckets[bucketOf(entry.cellX, entry.cellY)] = entry.next;
+	}
+	if (entry.next != -1) {
+		_entries[entry.next].prev = entry.prev;
+	}
+}
+
+/**
+ * Removes the entry, moving the last entry into its place.
+ *
+ * @param index The entry index
+ */
+void SpatialHash::erase(int index) {
+	unlink(index);
+	int last = (int)_entries.size()-1;
+	if (index != last) {
+		_entries[index] = std::move(_entries[last]);
+
+		// Point the neighbors of the moved entry at its new index
+		Entry& entry = _entries[index];
+		if (entry.prev != -1) {
+			_entries[entry.prev].next = index;
+		} else {
+			_buckets[bucketOf(entry.cellX, entry.cellY)] = index;
+		}
+		if (entry.next != -1) {
+			_entries[entry.next].prev = index;
+		}
+	}
+	_entries.pop_back();
+}
+
+
+#pragma mark -
+#pragma mark Membership
+/**
+ * Adds a unit to this hash.
+ *
+ * The radius of the unit is measured from the fixtures of its body.
+ *
+ * @param obstacle  The unit obstacle
+ * @param category  The unit category
+ */
+void SpatialHash::insert(const std::shared_ptr<Obstacle>& obstacle, Uint32 category) {
+	Entry entry;
+	entry.obstacle = obstacle;
+	entry.category = category;
+	entry.position = obstacle->getPosition();
+	entry.radius = SPATIAL_HASH_RADIUS;
+
+	b2Body* body = obstacle->getBody();
+	if (body != nullptr && body->GetFixtureList() != nullptr) {
+		entry.radius = 0;
+		const b2Transform& xf = body->GetTransform();
+		for (b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext()) {
+			for (int32 child = 0; child < f->GetShape()->GetChildCount(); child++) {
+				b2AABB aabb;
+				f->GetShape()->ComputeAABB(&aabb, xf, child);
+				float dx = std::max(std::abs(aabb.lowerBound.x-xf.p.x), std::abs(aabb.upperBound.x-xf.p.x));
+				float dy = std::max(std::abs(aabb.lowerBound.y-xf.p.y), std::abs(aabb.upperBound.y-xf.p.y));
+				entry.radius = std::max(entry.radius, sqrtf(dx*dx+dy*dy));
+			}
+		}
+	}
+
+	entry.cellX = cellOf(entry.position.x);
+	entry.cellY = cellOf(entry.position.y);
+	_maxRadius = std::max(_maxRadius, entry.radius);
+	_entries.push_back(entry);
+	link((int)_entries.size()-1);
+}
+
+/**
+ * Relinks every unit that moved into another cell.
+ *
+ * Call this after every physics step.
+ */
+void SpatialHash::update() {
+	for (int ii = 0; ii < (int)_entries.size(); ii++) {
+		Entry& entry = _entries[ii];
+		entry.position = entry.obstacle->getPosition();
+		int x = cellOf(entry.position.x);
+		int y = cellOf(entry.position.y);
+		if (x != entry.cellX || y != entry.cellY) {
+			unlink(ii);
+			entry.cellX = x;
+			entry.cellY = y;
+			link(ii);
+		}
+	}
+}
+
+/**
+ * Removes every unit marked for removal.
+ */
+void SpatialHash::garbageCollect() {
+	int ii = 0;
+	while (ii < (int)_entries.size()) {
+		if (_entries[ii].obstacle->isRemoved()) {
+			erase(ii);
+		} else {
+			ii++;
+		}
+	}
+}
+
+/**
+ * Removes every unit in the given categories.
+ *
+ * @param mask  The categories to remove
+ */
+void SpatialHash::clear(Uint32 mask) {
+	int ii = 0;
+	while (ii < (int)_entries.size()) {
+		if (_entries[ii].category & mask) {
+			erase(ii);
+		} else {
+			ii++;
+		}
+	}
+	if (_entries.empty()) {
+		_maxRadius = 0;
+	}
+}
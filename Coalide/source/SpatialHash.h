@@ -0,0 +1,320 @@
+//
+//  SpatialHash.h
+//  Coalide
+//
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include <cugl/cugl.h>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+using namespace cugl;
+
+/** The width and height of a hash cell in physics units */
+#define SPATIAL_HASH_CELL       2.0f
+/** The number of hash buckets (a power of two) */
+#define SPATIAL_HASH_BUCKETS    1024
+
+
+#pragma mark -
+#pragma mark Spatial Hash
+
+/**
+* A uniform-grid spatial hash of the units in a level.
+*
+* Each unit sits in the grid cell under its position, and each cell hashes
+* to one of a fixed number of buckets.  The grid is unbounded, so units that
+* slide off the level are still found.
+*
+* Call {@link update} after every physics step.  It only relinks the units
+* that changed cells.  Call {@link garbageCollect} before the level drops the
+* units marked as removed.
+*
+* The queries visit the matching units with a callback instead of building
+* a list, so they never allocate.  The callback has the signature
+*
+*     bool visit(const std::shared_ptr<Obstacle>& obstacle, Uint32 category)
+*
+* and returns false to stop the query.  Each unit is visited at most once.
+*/
+class SpatialHash {
+public:
+	/** The categories of units, which may be combined into a query mask */
+	enum Category {
+		/** The player avatar */
+		PLAYERS = 0x01,
+		/** The enemies (not including spores) */
+		ENEMIES = 0x02,
+		/** The crates and other objects */
+		OBJECTS = 0x04,
+		/** The spores shot by mushrooms */
+		SPORES  = 0x08,
+		/** Every category */
+		ALL     = 0x0F
+	};
+
+private:
+	/** A unit in the hash */
+	struct Entry {
+		/** The unit obstacle */
+		std::shared_ptr<Obstacle> obstacle;
+		/** The unit category */
+		Uint32 category;
+		/** The unit position at the last update */
+		Vec2 position;
+		/** The radius of a circle around the position holding the unit */
+		float radius;
+		/** The column of the unit cell */
+		int cellX;
+		/** The row of the unit cell */
+		int cellY;
+		/** The previous entry in the bucket (or -1) */
+		int prev;
+		/** The next entry in the bucket (or -1) */
+		int next;
+	};
+
+	/** The units, packed */
+	std::vector<Entry> _entries;
+	/** The first entry of each bucket (or -1) */
+	std::vector<int> _buckets;
+	/** The width and height of a cell */
+	float _cellSize;
+	/** The reciprocal of the cell size */
+	float _invCellSize;
+	/** The largest unit radius, which pads every query */
+	float _maxRadius;
+
+	/**
+	* Returns the cell coordinate of a position coordinate.
+	*
+	* @param value The position coordinate
+	*/
+	int cellOf(float value) const { return (int)floorf(value*_invCellSize); }
+
+	/**
+	* Returns the bucket of a cell.
+	*
+	* @param x The cell column
+	* @param y The cell row
+	*/
+	int bucketOf(int x, int y) const {
+		Uint32 hash = ((Uint32)x*73856093u) ^ ((Uint32)y*19349663u);
+		return (int)(hash & (Uint32)(_buckets.size()-1));
+	}
+
+	/**
+	* Places the entry in the bucket of its cell.
+	*
+	* @param index The entry index
+	*/
+	void link(int index);
+
+	/**
+	* Removes the entry from its bucket.
+	*
+	* @param index The entry index
+	*/
+	void unlink(int index);
+
+	/**
+	* Removes the entry, moving the last entry into its place.
+	*
+	* @param index The entry index
+	*/
+	void erase(int index);
+
+	/**
+	* Visits the matching entries of the cells in the given range.
+	*
+	* If the range has more cells than there are entries, this scans the
+	* entries instead.  The test decides which entries are visited.
+	*
+	* @return false if the visitor stopped the query
+	*/
+	template <typename T, typename F>
+	bool visitCells(int minX, int minY, int maxX, int maxY, Uint32 mask, T test, F& visit) const;
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an empty spatial hash.
+	*
+	* @param cellSize  The width and height of a cell in physics units
+	* @param buckets   The number of buckets (rounded up to a power of two)
+	*/
+	SpatialHash(float cellSize = SPATIAL_HASH_CELL, int buckets = SPATIAL_HASH_BUCKETS);
+
+#pragma mark Membership
+	/**
+	* Adds a unit to this hash.
+	*
+	* The radius of the unit is measured from the fixtures of its body.
+	*
+	* @param obstacle  The unit obstacle
+	* @param category  The unit category
+	*/
+	void insert(const std::shared_ptr<Obstacle>& obstacle, Uint32 category);
+
+	/**
+	* Relinks every unit that moved into another cell.
+	*
+	* Call this after every physics step.
+	*/
+	void update();
+
+	/**
+	* Removes every unit marked for removal.
+	*/
+	void garbageCollect();
+
+	/**
+	* Removes every unit in the given categories.
+	*
+	* @param mask  The categories to remove
+	*/
+	void clear(Uint32 mask = ALL);
+
+	/** Returns the number of units in this hash */
+	size_t size() const { return _entries.size(); }
+
+#pragma mark Queries
+	/**
+	* Visits the units that overlap the given rectangle.
+	*
+	* @param rect  The rectangle in physics coordinates
+	* @param mask  The categories to visit
+	* @param visit The callback for each unit
+	*/
+	template <typename F>
+	void queryRect(const Rect& rect, Uint32 mask, F visit) const;
+
+	/**
+	* Visits the units that overlap the given circle.
+	*
+	* @param center    The circle center in physics coordinates
+	* @param radius    The circle radius
+	* @param mask      The categories to visit
+	* @param visit     The callback for each unit
+	*/
+	template <typename F>
+	void queryRadius(const Vec2& center, float radius, Uint32 mask, F visit) const;
+
+	/**
+	* Visits the units that overlap the given swept segment.
+	*
+	* The segment is thickened by half of the width on each side, as for
+	* the path of a body of that width.
+	*
+	* @param start The segment start in physics coordinates
+	* @param end   The segment end in physics coordinates
+	* @param width The width of the swept body
+	* @param mask  The categories to visit
+	* @param visit The callback for each unit
+	*/
+	template <typename F>
+	void querySegment(const Vec2& start, const Vec2& end, float width, Uint32 mask, F visit) const;
+};
+
+
+#pragma mark -
+#pragma mark Query Templates
+
+template <typename T, typename F>
+bool SpatialHash::visitCells(int minX, int minY, int maxX, int maxY, Uint32 mask, T test, F& visit) const {
+	if (maxX < minX || maxY < minY) {
+		return true;
+	}
+
+	// A large range is cheaper to answer from the entries directly
+	if ((size_t)(maxX-minX+1)*(size_t)(maxY-minY+1) > _entries.size()) {
+		for (size_t ii = 0; ii < _entries.size(); ii++) {
+			const Entry& entry = _entries[ii];
+			if ((entry.category & mask) && entry.cellX >= minX && entry.cellX <= maxX &&
+				entry.cellY >= minY && entry.cellY <= maxY && test(entry)) {
+				if (!visit(entry.obstacle, entry.category)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	for (int y = minY; y <= maxY; y++) {
+		for (int x = minX; x <= maxX; x++) {
+			// Other cells may share the bucket, so check the cell too
+			for (int index = _buckets[bucketOf(x, y)]; index != -1; index = _entries[index].next) {
+				const Entry& entry = _entries[index];
+				if ((entry.category & mask) && entry.cellX == x && entry.cellY == y && test(entry)) {
+					if (!visit(entry.obstacle, entry.category)) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+template <typename F>
+void SpatialHash::queryRect(const Rect& rect, Uint32 mask, F visit) const {
+	float minX = rect.getMinX();
+	float minY = rect.getMinY();
+	float maxX = rect.getMaxX();
+	float maxY = rect.getMaxY();
+	auto test = [=](const Entry& entry) {
+		float dx = entry.position.x - std::max(minX, std::min(entry.position.x, maxX));
+		float dy = entry.position.y - std::max(minY, std::min(entry.position.y, maxY));
+		return dx*dx+dy*dy <= entry.radius*entry.radius;
+	};
+	visitCells(cellOf(minX-_maxRadius), cellOf(minY-_maxRadius),
+			   cellOf(maxX+_maxRadius), cellOf(maxY+_maxRadius), mask, test, visit);
+}
+
+template <typename F>
+void SpatialHash::queryRadius(const Vec2& center, float radius, Uint32 mask, F visit) const {
+	auto test = [=](const Entry& entry) {
+		float reach = radius+entry.radius;
+		return entry.position.distanceSquared(center) <= reach*reach;
+	};
+	float pad = radius+_maxRadius;
+	visitCells(cellOf(center.x-pad), cellOf(center.y-pad),
+			   cellOf(center.x+pad), cellOf(center.y+pad), mask, test, visit);
+}
+
+template <typename F>
+void SpatialHash::querySegment(const Vec2& start, const Vec2& end, float width, Uint32 mask, F visit) const {
+	Vec2 delta = end-start;
+	float length2 = delta.lengthSquared();
+	float half = width/2.0f;
+	auto test = [=](const Entry& entry) {
+		float t = length2 > 0 ? (entry.position-start).dot(delta)/length2 : 0.0f;
+		t = std::max(0.0f, std::min(t, 1.0f));
+		float reach = half+entry.radius;
+		return entry.position.distanceSquared(start+delta*t) <= reach*reach;
+	};
+
+	// Visit one column at a time, covering only the rows the segment crosses
+	float pad = half+_maxRadius;
+	int minX = cellOf(std::min(start.x, end.x)-pad);
+	int maxX = cellOf(std::max(start.x, end.x)+pad);
+	for (int x = minX; x <= maxX; x++) {
+		float lo = std::max(x*_cellSize-pad, std::min(start.x, end.x));
+		float hi = std::min((x+1)*_cellSize+pad, std::max(start.x, end.x));
+		float y0, y1;
+		if (delta.x == 0) {
+			y0 = start.y;
+			y1 = end.y;
+		} else {
+			y0 = start.y+delta.y*(lo-start.x)/delta.x;
+			y1 = start.y+delta.y*(hi-start.x)/delta.x;
+		}
+		if (!visitCells(x, cellOf(std::min(y0, y1)-pad), x, cellOf(std::max(y0, y1)+pad), mask, test, visit)) {
+			return;
+		}
+	}
+}
+
+#endif /* __SPATIAL_HASH_H__ */
@@ -9,37 +9,51 @@ using namespace cugl;
 
 
 /**
-* Initializes a new floor tile with the given position and size.
-*
-* @param  pos      Initial position in world coordinates
-* @param  size   	The dimensions of the crate.
-*
-* @return  true if the obstacle is initialized properly, false otherwise.
+* Destroys this tileset, releasing all resources.
 */
-bool TileModel::init(const Vec2 & pos, const Size & size) {
-	if (BoxObstacle::init(pos, Vec2(size.width, size.height))) {
-		setName(TILE_NAME);
-		setBodyType(b2_staticBody);
-		return true;
-	}
-	return false;
+void TileSet::dispose() {
+	_tiles.clear();
+	_texture = nullptr;
+	_cols = 0;
+	_rows = 0;
 }
 
 /**
-* Destroys this floor tile, releasing all resources.
+* Initializes a tileset for the given texture.
+*
+* @param  texture  The tileset texture
+* @param  cols     The number of tile columns in the texture
+* @param  rows     The number of tile rows in the texture
+*
+* @return  true if the tileset is initialized properly, false otherwise.
 */
-void TileModel::dispose() { }
+bool TileSet::init(const std::shared_ptr<Texture>& texture, int cols, int rows) {
+	if (texture == nullptr) {
+		CULogError("Tileset has no texture");
+		return false;
+	}
+	_texture = texture;
+	_cols = cols;
+	_rows = rows;
+	_tiles.resize(TILESET_STRIDE*rows);
+	return true;
+}
 
 /**
-* Updates the object's physics state (NOT GAME LOGIC). This is the method
-* that updates the scene graph and is called after collision resolution.
+* Returns the sub-texture for the given tileset index.
+*
+* @param  index    The tileset index
 *
-* @param dt Timing values from parent loop
+* @return the sub-texture for the given tileset index.
 */
-void TileModel::update(float dt) {
-	Obstacle::update(dt);
-	if (_node != nullptr) {
-		_node->setPosition(getPosition()*_drawscale);
-		_node->setAngle(getAngle());
+const std::shared_ptr<Texture>& TileSet::getTile(int index) {
+	CUAssertLog(index >= 0 && index < (int)_tiles.size(), "Tileset index %d out of range", index);
+	if (_tiles[index] == nullptr) {
+		// Level indices are laid out in rows of TILESET_STRIDE
+		double x = index % TILESET_STRIDE;
+		double y = index / TILESET_STRIDE;
+		_tiles[index] = _texture->getSubTexture(x / _cols + TILE_BORDER, (x + 1) / _cols - TILE_BORDER,
+												y / _rows + TILE_BORDER, (y + 1) / _rows - TILE_BORDER);
 	}
+	return _tiles[index];
 }
@@ -5,332 +5,189 @@
 #ifndef __TILE_MODEL_H__
 #define __TILE_MODEL_H__
 
-#include <cugl/2d/physics/CUBoxObstacle.h>
+#include <cugl/cugl.h>
+#include <vector>
 #include "Constants.h"
 
 using namespace cugl;
 
+/** The number of tile indices in a row of a level tileset */
+#define TILESET_STRIDE  21
+/** The inset (in texture coordinates) of each tile, to hide seams */
+#define TILE_BORDER     0.00035
+
 
 #pragma mark -
 #pragma mark Tile Model
 
 /**
-* A crate in the rocket lander game.
+* A floor tile in the level grid.
 *
-* Note that this class does keeps track of its own assets via keys, so that
-* they can be attached later as part of the scene graph.
+* Tiles never have a physics body, so this is a plain record of a few bytes
+* rather than an obstacle.  Its position is implied by its cell in the tile
+* board.  Each layer is an index into a shared tileset (see {@link TileSet}),
+* or -1 if the tile has nothing in that layer.  The textures are resolved once
+* per tileset index when the scene graph is built.
 */
-class TileModel : public BoxObstacle {
+class TileModel {
+public:
+	/** The layers of a tile, from bottom to top */
+	enum Layer : int {
+		/** The decal drawn under the water base (water tileset) */
+		WATER_DECAL = 0,
+		/** The water edge around the land (water tileset) */
+		WATER_BASE,
+		/** The dirt layer shared by all land (forest tileset) */
+		DIRT,
+		/** The ice layer of sand and ice tiles (forest tileset) */
+		ICE,
+		/** The sand layer of sand tiles (forest tileset) */
+		SAND,
+		/** The number of layers */
+		LAYER_COUNT
+	};
+
 private:
-    bool _hasWaterBase = false;
-    bool _hasWaterDecal = false;
-protected:
-	std::shared_ptr<Node> _node;
+	/** The tile type */
 	TILE_TYPE _tileType;
-	float _friction;
-	
-	float _drawscale;
-
-    std::string _sandTexture; //only exists if tile is sand
-    std::string _iceTexture; //only exists if tile is sand or ice
-    std::string _dirtTexture; //only exists if tile is sand, ice, or dirt
-    std::string _waterTexture;
-    
-    double _sandSubtexture[4] = {-5.0,-5.0,-5.0,-5.0};
-    double _iceSubtexture[4]= {-5.0,-5.0,-5.0,-5.0};
-    double _dirtSubtexture[4]= {-5.0,-5.0,-5.0,-5.0};
-    double _waterBaseSubtexture[4]= {-5.0,-5.0,-5.0,-5.0};
-    double _waterDecalSubtexture[4]= {-5.0,-5.0,-5.0,-5.0};
-
-
-
-
+	/** The tileset index of each layer, or -1 if absent */
+	Sint16 _layers[LAYER_COUNT];
 
 public:
 #pragma mark -
 #pragma mark Constructors
 	/*
-	* Creates a new floor tile at the origin.
+	* Creates a new water tile with no layers.
 	*/
-	TileModel() : BoxObstacle() { }
+	TileModel() : _tileType(TILE_TYPE::WATER) {
+		for (int ii = 0; ii < LAYER_COUNT; ii++) {
+			_layers[ii] = -1;
+		}
+	}
 
+#pragma mark -
+#pragma mark Accessors
 	/**
-	* Destroys this floor tile, releasing all resources.
+	* Returns the tile type.
 	*/
-	virtual ~TileModel() { dispose(); }
+	TILE_TYPE getType() const { return _tileType; }
 
 	/**
-	* Destroys this floor tile, releasing all resources.
+	* Sets the tile type.
 	*/
-	void dispose();
+	void setType(TILE_TYPE tileType) { _tileType = tileType; }
 
 	/**
-	* Initializes a new floor tile at the origin.
-	*
-	* @return  true if the obstacle is initialized properly, false otherwise.
+	* Returns the tileset index of the given layer, or -1 if absent.
 	*/
-	virtual bool init() override { return init(Vec2::ZERO, Size::ZERO); }
+	int getLayer(Layer layer) const { return _layers[layer]; }
 
 	/**
-	* Initializes a new floor tile with the given position
-	*
-	* @param  pos  Initial position in world coordinates
-	*
-	* @return  true if the obstacle is initialized properly, false otherwise.
+	* Sets the tileset index of the given layer (-1 to clear it).
 	*/
-	virtual bool init(const Vec2& pos) override { return init(pos, Size(1, 1)); }
+	void setLayer(Layer layer, int index) { _layers[layer] = (Sint16)index; }
 
 	/**
-	* Initializes a new floor tile with the given position and size.
-	*
-	* @param  pos      Initial position in world coordinates
-	* @param  size   	The dimensions of the crate.
-	*
-	* @return  true if the obstacle is initialized properly, false otherwise.
+	* Returns true if the given layer is present.
 	*/
-	virtual bool init(const Vec2& pos, const Size& size) override;
-
-
-#pragma mark -
-#pragma mark Static Constructors
-	/**
-	* Creates a new floor tile at the origin.
-	*
-	* @return  A newly allocated Crate, at the origin
-	*/
-	static std::shared_ptr<TileModel> alloc() {
-		std::shared_ptr<TileModel> result = std::make_shared<TileModel>();
-		return (result->init() ? result : nullptr);
-	}
+	bool hasLayer(Layer layer) const { return _layers[layer] != -1; }
 
 	/**
-	* Creates a new floor tile with the given position
-	*
-	* @param  pos  Initial position in world coordinates
-	*
-	* @return  A newly allocated Crate, at the given position
+	* Returns true if this tile has nothing to draw.
 	*/
-	static std::shared_ptr<TileModel> alloc(const Vec2& pos) {
-		std::shared_ptr<TileModel> result = std::make_shared<TileModel>();
-		return (result->init(pos) ? result : nullptr);
+	bool isEmpty() const {
+		for (int ii = 0; ii < LAYER_COUNT; ii++) {
+			if (_layers[ii] != -1) {
+				return false;
+			}
+		}
+		return true;
 	}
 
+#pragma mark -
+#pragma mark Type Checkers
 	/**
-	* Creates a new floor tile with the given position and size.
-	*
-	* @param  pos      Initial position in world coordinates
-	* @param  size   	The dimensions of the crate.
-	*
-	* @return  A newly allocated Crate, at the given position, with the given size
+	* Returns true if the tile is water
 	*/
-	static std::shared_ptr<TileModel> alloc(const Vec2& pos, const Size& size) {
-		std::shared_ptr<TileModel> result = std::make_shared<TileModel>();
-		return (result->init(pos, size) ? result : nullptr);
+	bool isWater() const {
+		return _tileType == TILE_TYPE::WATER;
 	}
+};
 
 
 #pragma mark -
-#pragma mark Accessors
-	/**
-	* Returns the tile type.
-	*/
-	TILE_TYPE getType() { return _tileType; }
+#pragma mark Tile Set
 
-	/**
-	* Sets the tile type.
-	*/
-	void setType(TILE_TYPE tileType) { _tileType = tileType; }
-    
-    bool hasWaterBase(){ return _hasWaterBase;}
-    bool hasWaterDecal(){ return _hasWaterDecal;}
-    
-
-	/**
-	* Returns the friction.
-	*/
-	float getFriction() { return _friction; }
+/**
+* A tileset texture shared by all of the tiles of a level.
+*
+* Tiles refer to a tileset by index.  The sub-texture for an index is created
+* the first time it is requested and reused by every other tile with that
+* index.
+*/
+class TileSet {
+protected:
+	/** The tileset texture */
+	std::shared_ptr<Texture> _texture;
+	/** The number of tile columns in the texture */
+	int _cols;
+	/** The number of tile rows in the texture */
+	int _rows;
+	/** The resolved sub-textures, by tileset index */
+	std::vector<std::shared_ptr<Texture>> _tiles;
 
-	/**
-	* Sets the friction.
+public:
+#pragma mark -
+#pragma mark Constructors
+	/*
+	* Creates an empty tileset.
 	*/
-	void setFriction(float friction) override { _friction = friction; }
+	TileSet() : _cols(0), _rows(0) { }
 
 	/**
-	* Returns the scene graph node representing this floor tile.
-	*
-	* @return the scene graph node representing this floor tile.
+	* Destroys this tileset, releasing all resources.
 	*/
-	const std::shared_ptr<Node>& getNode() const { return _node; }
+	~TileSet() { dispose(); }
 
 	/**
-	* Sets the scene graph node representing this floor tile.
-	*
-	* @param node  The scene graph node representing this floor tile.
+	* Destroys this tileset, releasing all resources.
 	*/
-	void setNode(const std::shared_ptr<Node>& node) { _node = node; }
+	void dispose();
 
 	/**
-	* Returns the texture (key) for this floor tile
+	* Initializes a tileset for the given texture.
 	*
-	* @return the texture (key) for this floor tile
-	*/
-	const std::string& getSandTextureKey() const { return _sandTexture; }
-    
-    /**
-     * Returns the texture (key) for this floor tile
-     *
-     * @return the texture (key) for this floor tile
-     */
-    const std::string& getWaterTextureKey() const { return _waterTexture; }
-
-    /**
-     * Returns the texture (key) for this floor tile
-     *
-     * @return the texture (key) for this floor tile
-     */
-    const std::string& getIceTextureKey() const { return _iceTexture; }
-    /**
-     * Returns the texture (key) for this floor tile
-     *
-     * @return the texture (key) for this floor tile
-     */
-    const std::string& getDirtTextureKey() const { return _dirtTexture; }
-	/**
-	* Sets the texture (key) for this floor tile
+	* @param  texture  The tileset texture
+	* @param  cols     The number of tile columns in the texture
+	* @param  rows     The number of tile rows in the texture
 	*
-	* @param  strip    the texture (key) for this floor tile
-	*/
-	void setSandTextureKey(std::string strip) { _sandTexture = strip; }
-    
-    /**
-     * Sets the texture (key) for this floor tile
-     *
-     * @param  strip    the texture (key) for this floor tile
-     */
-    void setWaterTextureKey(std::string strip) { _waterTexture = strip; }
-    
-    /**
-     * Sets the texture (key) for this floor tile
-     *
-     * @param  strip    the texture (key) for this floor tile
-     */
-    void setIceTextureKey(std::string strip) { _iceTexture = strip; }
-    
-    /**
-     * Sets the texture (key) for this floor tile
-     *
-     * @param  strip    the texture (key) for this floor tile
-     */
-    void setDirtTextureKey(std::string strip) { _dirtTexture = strip; }
-    
-	/**
-	* Returns the points to get the subtexture for the tile in the tileset.
-	*/
-	double* getSandSubTexture() { return _sandSubtexture; }
-    
-    /**
-     * Returns the points to get the subtexture for the tile in the tileset.
-     */
-    double* getWaterBaseSubTexture() { return _waterBaseSubtexture; }
-    
-    /**
-     * Returns the points to get the subtexture for the tile in the tileset.
-     */
-    double* getWaterDecalSubTexture() { return _waterDecalSubtexture; }
-    
-    /**
-     * Returns the points to get the subtexture for the tile in the tileset.
-     */
-    double* getIceSubTexture() { return _iceSubtexture; }
-    
-    /**
-     * Returns the points to get the subtexture for the tile in the tileset.
-     */
-    double* getDirtSubTexture() { return _dirtSubtexture; }
-
-    /**
-     * Sets the points to get the subtexture for the tile in the tileset.
-     */
-    void setWaterBaseSubTexture(double x0, double y0, double x1, double y1) {
-        _hasWaterBase = true;
-        _waterBaseSubtexture[0] = x0;
-        _waterBaseSubtexture[1] = y0;
-        _waterBaseSubtexture[2] = x1;
-        _waterBaseSubtexture[3] = y1;
-    }
-    
-    /**
-     * Sets the points to get the subtexture for the tile in the tileset.
-     */
-    void setWaterDecalSubTexture(double x0, double y0, double x1, double y1) {
-        _hasWaterDecal = true;
-        _waterDecalSubtexture[0] = x0;
-        _waterDecalSubtexture[1] = y0;
-        _waterDecalSubtexture[2] = x1;
-        _waterDecalSubtexture[3] = y1;
-    }
-    
-	/**
-	* Sets the points to get the subtexture for the tile in the tileset.
+	* @return  true if the tileset is initialized properly, false otherwise.
 	*/
-	void setSandSubTexture(double x0, double y0, double x1, double y1) {
-		_sandSubtexture[0] = x0;
-		_sandSubtexture[1] = y0;
-		_sandSubtexture[2] = x1;
-		_sandSubtexture[3] = y1;
-	}
-    
-    /**
-     * Sets the points to get the subtexture for the tile in the tileset.
-     */
-    void setIceSubTexture(double x0, double y0, double x1, double y1) {
-        _iceSubtexture[0] = x0;
-        _iceSubtexture[1] = y0;
-        _iceSubtexture[2] = x1;
-        _iceSubtexture[3] = y1;
-    }
-    
-    /**
-     * Sets the points to get the subtexture for the tile in the tileset.
-     */
-    void setDirtSubTexture(double x0, double y0, double x1, double y1) {
-        _dirtSubtexture[0] = x0;
-        _dirtSubtexture[1] = y0;
-        _dirtSubtexture[2] = x1;
-        _dirtSubtexture[3] = y1;
-    }
+	bool init(const std::shared_ptr<Texture>& texture, int cols, int rows);
 
 	/**
-	* Returns the ratio of the sprite to the physics body.
+	* Creates a tileset for the given texture.
 	*
-	* @return the ratio of the sprite to the physics body.
-	*/
-	float getDrawScale() const { return _drawscale; }
-
-	/**
-	* Sets the ratio of the sprite to the physics body.
+	* @param  texture  The tileset texture
+	* @param  cols     The number of tile columns in the texture
+	* @param  rows     The number of tile rows in the texture
 	*
-	* @param scale The ratio of the sprite to the physics body.
-	*/
-	void setDrawScale(float scale) { _drawscale = scale; }
-
-#pragma mark -
-#pragma mark Type Checkers
-	/**
-	* Returns true if the tile is water
+	* @return  A newly allocated tileset
 	*/
-	bool isWater() {
-		return _tileType == TILE_TYPE::WATER;
+	static std::shared_ptr<TileSet> alloc(const std::shared_ptr<Texture>& texture, int cols, int rows) {
+		std::shared_ptr<TileSet> result = std::make_shared<TileSet>();
+		return (result->init(texture, cols, rows) ? result : nullptr);
 	}
 
 #pragma mark -
-#pragma mark Update
+#pragma mark Accessors
 	/**
-	* Updates the object's physics state (NOT GAME LOGIC). This is the method
-	* that updates the scene graph and is called after collision resolution.
+	* Returns the sub-texture for the given tileset index.
+	*
+	* @param  index    The tileset index
 	*
-	* @param dt Timing values from parent loop
+	* @return the sub-texture for the given tileset index.
 	*/
-	void update (float dt) override;
+	const std::shared_ptr<Texture>& getTile(int index);
 };
 #endif /* __TILE_MODEL_H__ */
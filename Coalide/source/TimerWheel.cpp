@@ -0,0 +1,248 @@
+//
+//  TimerWheel.cpp
+//  Coalide
+//
+#include "TimerWheel.h"
+
+using namespace cugl;
+
+/** The mask for the slot of a level */
+#define SLOT_MASK   (TIMER_WHEEL_SLOTS-1)
+/** The longest delay the wheel can hold */
+#define MAX_DELAY   ((((Uint64)1) << (TIMER_WHEEL_BITS*TIMER_WHEEL_LEVELS)) - 1)
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Creates an empty timer wheel at time 0.
+ *
+ * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a wheel on
+ * the heap, use one of the static constructors instead.
+ */
+TimerWheel::TimerWheel() :
+_free(-1),
+_count(0),
+_now(0),
+_remainder(0) {
+	for (int ii = 0; ii < TIMER_WHEEL_LEVELS*TIMER_WHEEL_SLOTS; ii++) {
+		_slots[ii] = -1;
+	}
+}
+
+/**
+ * Disposes all of the timers without running them.
+ */
+void TimerWheel::dispose() {
+	// Keep the nodes, so that stale identifiers stay stale
+	for (int ii = 0; ii < (int)_nodes.size(); ii++) {
+		if (_nodes[ii].slot != -1) {
+			unlink(ii);
+			release(ii);
+		}
+	}
+}
+
+/**
+ * Initializes an empty timer wheel at time 0.
+ *
+ * @return true if the wheel is initialized properly, false otherwise.
+ */
+bool TimerWheel::init() {
+	dispose();
+	_now = 0;
+	_remainder = 0;
+	return true;
+}
+
+
+#pragma mark -
+#pragma mark Internals
+/**
+ * Places the node in the slot for its expiration.
+ *
+ * @param index The node index
+ */
+void TimerWheel::link(int index) {
+	Node& node = _nodes[index];
+
+	// Pick the finest level whose range covers the delay
+	Uint64 delta = node.expires - _now;
+	int level = 0;
+	while (level < TIMER_WHEEL_LEVELS-1 && delta >= (((Uint64)1) << (TIMER_WHEEL_BITS*(level+1)))) {
+		level++;
+	}
+	int slot = level*TIMER_WHEEL_SLOTS + (int)((node.expires >> (TIMER_WHEEL_BITS*level)) & SLOT_MASK);
+
+	node.slot = slot;
+	node.prev = -1;
+	node.next = _slots[slot];
+	if (node.next != -1) {
+		_nodes[node.next].prev = index;
+	}
+	_slots[slot] = index;
+}
+
+/**
+ * Removes the node from its slot.
+ *
+ * @param index The node index
+ */
+void TimerWheel::unlink(int index) {
+	Node& node = _nodes[index];
+	if (node.prev != -1) {
+		_nodes[node.prev].next = node.next;
+	} else {
+		_slots[node.slot] = node.next;
+	}
+	if (node.next != -1) {
+		_nodes[node.next].prev = node.prev;
+	}
+	node.prev = -1;
+	node.next = -1;
+}
+
+/**
+ * Returns the node to the free list, invalidating its identifier.
+ *
+ * @param index The node index
+ */
+void TimerWheel::release(int index) {
+	Node& node = _nodes[index];
+	node.callback = nullptr;
+	node.slot = -1;
+	node.generation = (node.generation == 0xFFFFFFFF ? 1 : node.generation+1);
+	node.next = _free;
+	_free = index;
+	_count--;
+}
+
+/**
+ * Moves the nodes of a coarse slot to the finer levels.
+ *
+ * @param level The level of the slot
+ * @param slot  The slot in that level
+ */
+void TimerWheel::cascade(int level, int slot) {
+	int pos = level*TIMER_WHEEL_SLOTS+slot;
+	int index = _slots[pos];
+	_slots[pos] = -1;
+	while (index != -1) {
+		int next = _nodes[index].next;
+		link(index);
+		index = next;
+	}
+}
+
+/**
+ * Returns the node index for an identifier, or -1 if it is stale.
+ *
+ * @param timer The timer identifier
+ */
+int TimerWheel::lookup(TimerId timer) const {
+	Uint32 index = (Uint32)(timer & 0xFFFFFFFF);
+	Uint32 generation = (Uint32)(timer >> 32);
+	if (index >= _nodes.size()) {
+		return -1;
+	}
+	const Node& node = _nodes[index];
+	return (node.slot != -1 && node.generation == generation) ? (int)index : -1;
+}
+
+
+#pragma mark -
+#pragma mark Timers
+/**
+ * Schedules a callback to run after the given simulation delay.
+ *
+ * A delay of 0 runs the callback on the next call to {@link advance}.
+ *
+ * @param millis    The delay in milliseconds of simulation time
+ * @param callback  The callback to run on expiration
+ *
+ * @return the timer identifier
+ */
+TimerWheel::TimerId TimerWheel::schedule(Uint64 millis, const std::function<void()>& callback) {
+	int index = _free;
+	if (index == -1) {
+		index = (int)_nodes.size();
+		Node fresh;
+		fresh.generation = 1;
+		fresh.slot = -1;
+		fresh.prev = -1;
+		fresh.next = -1;
+		_nodes.push_back(fresh);
+	} else {
+		_free = _nodes[index].next;
+	}
+
+	Node& node = _nodes[index];
+	node.callback = callback;
+	node.expires = _now + std::max((Uint64)1, std::min(millis, (Uint64)MAX_DELAY));
+	_count++;
+	link(index);
+	return (((TimerId)node.generation) << 32) | (TimerId)index;
+}
+
+/**
+ * Cancels a scheduled timer.
+ *
+ * It is safe to cancel a timer that has already run or was cancelled.
+ *
+ * @param timer The timer identifier
+ *
+ * @return true if the timer was still scheduled
+ */
+bool TimerWheel::cancel(TimerId timer) {
+	int index = lookup(timer);
+	if (index == -1) {
+		return false;
+	}
+	unlink(index);
+	release(index);
+	return true;
+}
+
+
+#pragma mark -
+#pragma mark Simulation Time
+/**
+ * Advances simulation time, running every timer that expires.
+ *
+ * @param seconds   The simulation time step in seconds
+ */
+void TimerWheel::advance(float seconds) {
+	_remainder += seconds*1000.0;
+	Uint64 ticks = (Uint64)_remainder;
+	_remainder -= (double)ticks;
+
+	while (ticks > 0) {
+		if (_count == 0) {
+			// Nothing can expire, so skip ahead
+			_now += ticks;
+			return;
+		}
+		ticks--;
+		_now++;
+
+		// Bring the coarser slots down as each of their ranges begins
+		Uint64 time = _now;
+		for (int level = 1; level < TIMER_WHEEL_LEVELS && (time & SLOT_MASK) == 0; level++) {
+			time >>= TIMER_WHEEL_BITS;
+			cascade(level, (int)(time & SLOT_MASK));
+		}
+
+		// Everything in this slot expires now
+		int slot = (int)(_now & SLOT_MASK);
+		while (_slots[slot] != -1) {
+			int index = _slots[slot];
+			CUAssertLog(_nodes[index].expires == _now, "Timer wheel slot out of order");
+			std::function<void()> callback = std::move(_nodes[index].callback);
+			unlink(index);
+			release(index);
+			if (callback) {
+				callback();
+			}
+		}
+	}
+}
@@ -0,0 +1,214 @@
+//
+//  TimerWheel.h
+//  Coalide
+//
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <cugl/cugl.h>
+#include <functional>
+#include <vector>
+
+using namespace cugl;
+
+/** The number of bits of the tick for each level of the wheel */
+#define TIMER_WHEEL_BITS    6
+/** The number of slots in each level of the wheel */
+#define TIMER_WHEEL_SLOTS   (1 << TIMER_WHEEL_BITS)
+/** The number of levels in the wheel (64^4 ms is about 4.6 hours) */
+#define TIMER_WHEEL_LEVELS  4
+
+
+#pragma mark -
+#pragma mark Timer Wheel
+
+/**
+* A hierarchical timer wheel driven by simulation time.
+*
+* Game entities schedule a callback to run after a delay, instead of polling
+* a clock every frame.  Time only advances when the game calls {@link advance}
+* with the simulation step, so timers respect slow motion and pausing.
+*
+* The wheel counts time in whole milliseconds (ticks).  A timer is placed in
+* the coarsest level whose range covers its delay, and it cascades to a finer
+* level as its expiration nears.  Scheduling and cancelling are O(1), and
+* advancing visits only the slots that come due.
+*
+* Callbacks run inside of {@link advance}.  They may schedule or cancel other
+* timers.  An entity that schedules a callback on itself must cancel it when
+* it is disposed.
+*/
+class TimerWheel {
+public:
+	/** A timer identifier; 0 is never a valid timer */
+	typedef Uint64 TimerId;
+
+private:
+	/** A scheduled timer (or a free node) */
+	struct Node {
+		/** The callback to run on expiration */
+		std::function<void()> callback;
+		/** The tick when this timer expires */
+		Uint64 expires;
+		/** The generation of this node, to detect stale identifiers */
+		Uint32 generation;
+		/** The wheel slot holding this node, or -1 if unscheduled */
+		int slot;
+		/** The previous node in the slot (or -1) */
+		int prev;
+		/** The next node in the slot, or the next free node (or -1) */
+		int next;
+	};
+
+	/** The timer nodes */
+	std::vector<Node> _nodes;
+	/** The head of the free node list */
+	int _free;
+	/** The head of the list of each slot, for every level */
+	int _slots[TIMER_WHEEL_LEVELS*TIMER_WHEEL_SLOTS];
+	/** The number of scheduled timers */
+	size_t _count;
+	/** The current tick */
+	Uint64 _now;
+	/** The fraction of a tick not yet applied */
+	double _remainder;
+
+	/**
+	* Places the node in the slot for its expiration.
+	*
+	* @param index The node index
+	*/
+	void link(int index);
+
+	/**
+	* Removes the node from its slot.
+	*
+	* @param index The node index
+	*/
+	void unlink(int index);
+
+	/**
+	* Returns the node to the free list, invalidating its identifier.
+	*
+	* @param index The node index
+	*/
+	void release(int index);
+
+	/**
+	* Moves the nodes of a coarse slot to the finer levels.
+	*
+	* @param level The level of the slot
+	* @param slot  The slot in that level
+	*/
+	void cascade(int level, int slot);
+
+	/**
+	* Returns the node index for an identifier, or -1 if it is stale.
+	*
+	* @param timer The timer identifier
+	*/
+	int lookup(TimerId timer) const;
+
+public:
+#pragma mark Constructors
+	/**
+	* Creates an empty timer wheel at time 0.
+	*
+	* NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a wheel on
+	* the heap, use one of the static constructors instead.
+	*/
+	TimerWheel();
+
+	/**
+	* Destroys this timer wheel, releasing all resources.
+	*/
+	~TimerWheel() { dispose(); }
+
+	/**
+	* Disposes all of the timers without running them.
+	*/
+	void dispose();
+
+	/**
+	* Initializes an empty timer wheel at time 0.
+	*
+	* @return true if the wheel is initialized properly, false otherwise.
+	*/
+	bool init();
+
+	/**
+	* Returns a newly allocated timer wheel at time 0.
+	*
+	* @return a newly allocated timer wheel at time 0.
+	*/
+	static std::shared_ptr<TimerWheel> alloc() {
+		std::shared_ptr<TimerWheel> result = std::make_shared<TimerWheel>();
+		return (result->init() ? result : nullptr);
+	}
+
+#pragma mark Timers
+	/**
+	* Schedules a callback to run after the given simulation delay.
+	*
+	* A delay of 0 runs the callback on the next call to {@link advance}.
+	*
+	* @param millis    The delay in milliseconds of simulation time
+	* @param callback  The callback to run on expiration
+	*
+	* @return the timer identifier
+	*/
+	TimerId schedule(Uint64 millis, const std::function<void()>& callback);
+
+	/**
+	* Cancels a scheduled timer.
+	*
+	* It is safe to cancel a timer that has already run or was cancelled.
+	*
+	* @param timer The timer identifier
+	*
+	* @return true if the timer was still scheduled
+	*/
+	bool cancel(TimerId timer);
+
+	/**
+	* Returns true if the timer is still scheduled.
+	*
+	* @param timer The timer identifier
+	*
+	* @return true if the timer is still scheduled.
+	*/
+	bool isScheduled(TimerId timer) const { return lookup(timer) != -1; }
+
+	/**
+	* Returns the number of scheduled timers.
+	*
+	* @return the number of scheduled timers.
+	*/
+	size_t size() const { return _count; }
+
+#pragma mark Simulation Time
+	/**
+	* Advances simulation time, running every timer that expires.
+	*
+	* @param seconds   The simulation time step in seconds
+	*/
+	void advance(float seconds);
+
+	/**
+	* Returns the current simulation time in milliseconds.
+	*
+	* @return the current simulation time in milliseconds.
+	*/
+	Uint64 now() const { return _now; }
+
+	/**
+	* Returns the simulation milliseconds elapsed since the given time.
+	*
+	* @param since A previous value of {@link now}
+	*
+	* @return the simulation milliseconds elapsed since the given time.
+	*/
+	Uint64 ellapsedMillis(Uint64 since) const { return _now - since; }
+};
+
+#endif /* __TIMER_WHEEL_H__ */